@@ -19,11 +19,14 @@
 #include "device/device.h"
 #include "render/buffers.h"
 #include "render/camera.h"
+#include "render/film.h"
 #include "render/integrator.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/stats.h"
 
 #include "util/util_args.h"
+#include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_function.h"
 #include "util/util_image.h"
@@ -54,6 +57,7 @@ struct Options {
   bool quiet;
   bool show_help, interactive, pause;
   string output_path;
+  string render_time_path;
 } options;
 
 static void session_print(const string &str)
@@ -113,6 +117,38 @@ static bool write_render(const uchar *pixels, int w, int h, int channels)
   return true;
 }
 
+static bool write_render_time()
+{
+  RenderBuffers *buffers = options.session->buffers;
+  const int w = buffers->params.width;
+  const int h = buffers->params.height;
+  const int samples = options.session_params.samples;
+
+  vector<float> pixels(w * h);
+  if (!buffers->copy_from_device() ||
+      !buffers->get_pass_rect("Render Time", 1.0f, samples, 1, &pixels[0])) {
+    return false;
+  }
+
+  unique_ptr<ImageOutput> out = unique_ptr<ImageOutput>(
+      ImageOutput::create(options.render_time_path));
+  if (!out) {
+    return false;
+  }
+
+  ImageSpec spec(w, h, 1, TypeDesc::FLOAT);
+  if (!out->open(options.render_time_path, spec)) {
+    return false;
+  }
+
+  /* conversion for different top/bottom convention */
+  out->write_image(TypeDesc::FLOAT, &pixels[(h - 1) * w], AutoStride, -w * (int)sizeof(float));
+
+  out->close();
+
+  return true;
+}
+
 static BufferParams &session_buffer_params()
 {
   static BufferParams buffer_params;
@@ -120,6 +156,7 @@ static BufferParams &session_buffer_params()
   buffer_params.height = options.height;
   buffer_params.full_width = options.width;
   buffer_params.full_height = options.height;
+  buffer_params.passes = options.scene->passes;
 
   return buffer_params;
 }
@@ -141,6 +178,14 @@ static void scene_init()
     options.height = options.scene->camera->height;
   }
 
+  /* Per pixel render time pass. */
+  if (!options.render_time_path.empty()) {
+    vector<Pass> passes = options.scene->passes;
+    Pass::add(PASS_RENDER_TIME, passes, "Render Time");
+    options.scene->film->tag_passes_update(options.scene, passes);
+    options.scene->film->tag_update(options.scene);
+  }
+
   /* Calculate Viewplane */
   options.scene->camera->compute_auto_viewplane();
 }
@@ -168,6 +213,22 @@ static void session_init()
 static void session_exit()
 {
   if (options.session) {
+    if (!options.render_time_path.empty() && !write_render_time()) {
+      fprintf(stderr, "Failed to write render time to %s\n", options.render_time_path.c_str());
+    }
+
+    if (options.session_params.use_profiling) {
+      RenderStats stats;
+      options.session->collect_statistics(&stats);
+      printf("\n%s\n", stats.full_report().c_str());
+    }
+
+    if (options.session_params.background && !options.quiet) {
+      double total_time, render_time;
+      options.session->progress.get_time(total_time, render_time);
+      printf("\nRender time: %.2fs (total %.2fs)\n", render_time, total_time);
+    }
+
     delete options.session;
     options.session = NULL;
   }
@@ -390,7 +451,7 @@ static void options_parse(int argc, const char **argv)
 
   /* parse options */
   ArgParse ap;
-  bool help = false, debug = false, version = false;
+  bool help = false, debug = false, version = false, cpu_split_kernel = false;
   int verbosity = 1;
 
   ap.options("Usage: cycles [options] file.xml",
@@ -417,6 +478,12 @@ static void options_parse(int argc, const char **argv)
              "--output %s",
              &options.output_path,
              "File path to write output image",
+             "--output-render-time %s",
+             &options.render_time_path,
+             "File path to write per pixel render time in milliseconds (CPU only)",
+             "--profile",
+             &options.session_params.use_profiling,
+             "Print render time spent per shader and object (CPU only)",
              "--threads %d",
              &options.session_params.threads,
              "CPU Rendering Threads",
@@ -432,6 +499,9 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--cpu-split-kernel",
+             &cpu_split_kernel,
+             "Render with the CPU split kernel instead of the megakernel (CPU only)",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -462,6 +532,10 @@ static void options_parse(int argc, const char **argv)
     util_logging_verbosity_set(verbosity);
   }
 
+  if (cpu_split_kernel) {
+    DebugFlags().cpu.split_kernel = true;
+  }
+
   if (list) {
     vector<DeviceInfo> devices = Device::available_devices();
     printf("Devices:\n");
@@ -502,7 +576,11 @@ static void options_parse(int argc, const char **argv)
 
   bool device_available = false;
   if (!devices.empty()) {
-    options.session_params.device = devices.front();
+    /* Render on all servers at once. */
+    options.session_params.device = (device_type == DEVICE_NETWORK) ?
+                                        Device::get_multi_device(
+                                            devices, options.session_params.threads, false) :
+                                        devices.front();
     device_available = true;
   }
 
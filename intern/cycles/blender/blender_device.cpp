@@ -61,10 +61,11 @@ DeviceInfo blender_device_info(BL::Preferences &b_preferences, BL::Scene &b_scen
   DeviceInfo device = Device::available_devices(DEVICE_MASK_CPU).front();
 
   if (get_enum(cscene, "device") == 2) {
-    /* Find network device. */
+    /* Find network devices, tiles are distributed over all servers. */
     vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK_NETWORK);
     if (!devices.empty()) {
-      return devices.front();
+      int threads = blender_device_threads(b_scene);
+      return Device::get_multi_device(devices, threads, background);
     }
   }
   else if (get_enum(cscene, "device") == 1) {
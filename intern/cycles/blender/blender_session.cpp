@@ -225,7 +225,6 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
   }
 
   session->progress.reset();
-  scene->reset();
 
   session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -234,11 +233,29 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
    */
   session->stats.mem_peak = session->stats.mem_used;
 
-  /* There is no single depsgraph to use for the entire render.
-   * See note on create_session().
-   */
-  /* sync object should be re-created */
-  sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  if (is_new_session) {
+    /* Nothing was synchronized yet. */
+  }
+  else if (b_engine.is_depsgraph_reused()) {
+    /* Blender kept the depsgraph of the previous render, so the scene data synchronized from it
+     * stays valid. Only tag what changed since then, for sync_data() to apply those changes
+     * (transforms, deformed geometry, edited shaders) without rebuilding everything else. */
+    sync->sync_recalc(b_depsgraph, b_v3d);
+  }
+  else {
+    /* There is no single depsgraph to use for the entire render.
+     * See note on create_session().
+     *
+     * With a new depsgraph the synchronized data can't be matched to Blender data anymore, so
+     * free it and synchronize everything again. Images are kept by the image manager. */
+    thread_scoped_lock scene_lock(scene->mutex);
+    scene->device_free();
+    scene->reset();
+
+    /* sync object should be re-created */
+    delete sync;
+    sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  }
 
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
@@ -1124,6 +1141,10 @@ void BlenderSession::free_blender_memory_if_possible()
      */
     return;
   }
+  if (scene->params.persistent_data) {
+    /* The depsgraph is kept by Blender for the next render to only synchronize changes. */
+    return;
+  }
   b_engine.free_blender_memory();
 }
 
@@ -102,6 +102,14 @@ class BVH {
 
   void refit(Progress &progress);
 
+  /* Whether refitting made the tree so much worse than when it was built that it is better to
+   * build it again. Only BVH2 measures this. Embree builds the modified trees again when they are
+   * refitted, and OptiX updates them in place without a way to measure their quality. */
+  virtual bool need_rebuild_after_refit() const
+  {
+    return false;
+  }
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
@@ -23,12 +23,15 @@
 #include "bvh/bvh_node.h"
 #include "bvh/bvh_unaligned.h"
 
+#include "util/util_logging.h"
+#include "util/util_string.h"
+
 CCL_NAMESPACE_BEGIN
 
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
-    : BVH(params_, geometry_, objects_)
+    : BVH(params_, geometry_, objects_), built_nodes_cost(0.0f), refit_nodes_cost(0.0f)
 {
 }
 
@@ -65,6 +68,15 @@ void BVH2::pack_inner(const BVHStackEntry &e, const BVHStackEntry &e0, const BVH
   if (e0.node->is_unaligned || e1.node->is_unaligned) {
     pack_unaligned_inner(e, e0, e1);
   }
+  else if (params.use_compact_nodes) {
+    pack_quantized_node(e.idx,
+                        e0.node->bounds,
+                        e1.node->bounds,
+                        e0.encodeIdx(),
+                        e1.encodeIdx(),
+                        e0.node->visibility,
+                        e1.node->visibility);
+  }
   else {
     pack_aligned_inner(e, e0, e1);
   }
@@ -95,9 +107,9 @@ void BVH2::pack_aligned_node(int idx,
   assert(c0 < 0 || c0 < pack.nodes.size());
   assert(c1 < 0 || c1 < pack.nodes.size());
 
+  const uint node_flags = PATH_RAY_NODE_UNALIGNED | PATH_RAY_NODE_QUANTIZED;
   int4 data[BVH_NODE_SIZE] = {
-      make_int4(
-          visibility0 & ~PATH_RAY_NODE_UNALIGNED, visibility1 & ~PATH_RAY_NODE_UNALIGNED, c0, c1),
+      make_int4(visibility0 & ~node_flags, visibility1 & ~node_flags, c0, c1),
       make_int4(__float_as_int(b0.min.x),
                 __float_as_int(b1.min.x),
                 __float_as_int(b0.max.x),
@@ -147,8 +159,9 @@ void BVH2::pack_unaligned_node(int idx,
   float4 data[BVH_UNALIGNED_NODE_SIZE];
   Transform space0 = BVHUnaligned::compute_node_transform(bounds0, aligned_space0);
   Transform space1 = BVHUnaligned::compute_node_transform(bounds1, aligned_space1);
-  data[0] = make_float4(__int_as_float(visibility0 | PATH_RAY_NODE_UNALIGNED),
-                        __int_as_float(visibility1 | PATH_RAY_NODE_UNALIGNED),
+  data[0] = make_float4(
+      __int_as_float((visibility0 & ~PATH_RAY_NODE_QUANTIZED) | PATH_RAY_NODE_UNALIGNED),
+      __int_as_float((visibility1 & ~PATH_RAY_NODE_QUANTIZED) | PATH_RAY_NODE_UNALIGNED),
                         __int_as_float(c0),
                         __int_as_float(c1));
 
@@ -162,21 +175,131 @@ void BVH2::pack_unaligned_node(int idx,
   memcpy(&pack.nodes[idx], data, sizeof(float4) * BVH_UNALIGNED_NODE_SIZE);
 }
 
+/* Quantized nodes store the bounds of both children with 8 bits per value, relative to the
+ * lower corner of their union and scaled by a power of two per axis. Decoding is then exact in
+ * the kernel, and the bounds are rounded outwards so they always enclose the original ones. */
+
+static float quantized_node_scale(uint biased_exponent)
+{
+  return __uint_as_float(biased_exponent << 23);
+}
+
+static void quantize_node_axis(const float lower,
+                               const float upper,
+                               const float child_min[2],
+                               const float child_max[2],
+                               const bool child_valid[2],
+                               uint &biased_exponent,
+                               uint &bounds)
+{
+  /* Smallest scale for which the whole range fits, normal floats only. */
+  const float extent = upper - lower;
+  int exponent = 0;
+  if (extent > 0.0f && isfinite_safe(extent)) {
+    frexpf(extent / 255.0f, &exponent);
+  }
+  biased_exponent = clamp(exponent + 126, 1, 254);
+  while (biased_exponent < 254 && lower + 255.0f * quantized_node_scale(biased_exponent) < upper) {
+    biased_exponent++;
+  }
+
+  const float scale = quantized_node_scale(biased_exponent);
+  uint q_min[2] = {0, 0}, q_max[2] = {0, 0};
+  for (int i = 0; i < 2; i++) {
+    if (!child_valid[i]) {
+      continue;
+    }
+    int lo = (int)floorf(min((child_min[i] - lower) / scale, 255.0f));
+    while (lo > 0 && lower + (float)lo * scale > child_min[i]) {
+      lo--;
+    }
+    int hi = (int)ceilf(min((child_max[i] - lower) / scale, 255.0f));
+    while (hi < 255 && lower + (float)hi * scale < child_max[i]) {
+      hi++;
+    }
+    q_min[i] = clamp(lo, 0, 255);
+    q_max[i] = clamp(hi, 0, 255);
+  }
+
+  bounds = q_min[0] | (q_min[1] << 8) | (q_max[0] << 16) | (q_max[1] << 24);
+}
+
+void BVH2::pack_quantized_node(int idx,
+                               const BoundBox &b0,
+                               const BoundBox &b1,
+                               int c0,
+                               int c1,
+                               uint visibility0,
+                               uint visibility1)
+{
+  assert(idx + BVH_QUANTIZED_NODE_SIZE <= pack.nodes.size());
+  assert(c0 < 0 || c0 < pack.nodes.size());
+  assert(c1 < 0 || c1 < pack.nodes.size());
+
+  /* Children without valid bounds can't be represented, they are never intersected instead. */
+  const bool child_valid[2] = {b0.valid(), b1.valid()};
+  BoundBox bounds = BoundBox::empty;
+  if (child_valid[0]) {
+    bounds.grow(b0);
+  }
+  if (child_valid[1]) {
+    bounds.grow(b1);
+  }
+  if (!bounds.valid()) {
+    bounds = BoundBox(make_float3(0.0f, 0.0f, 0.0f));
+  }
+
+  const uint node_flags = PATH_RAY_NODE_UNALIGNED | PATH_RAY_NODE_QUANTIZED;
+  const uint visibility[2] = {child_valid[0] ? visibility0 & ~node_flags : 0,
+                              child_valid[1] ? visibility1 & ~node_flags : 0};
+
+  uint exponents[3], quantized_bounds[3];
+  for (int axis = 0; axis < 3; axis++) {
+    const float child_min[2] = {b0.min[axis], b1.min[axis]};
+    const float child_max[2] = {b0.max[axis], b1.max[axis]};
+    quantize_node_axis(bounds.min[axis],
+                       bounds.max[axis],
+                       child_min,
+                       child_max,
+                       child_valid,
+                       exponents[axis],
+                       quantized_bounds[axis]);
+  }
+
+  int4 data[BVH_QUANTIZED_NODE_SIZE] = {
+      make_int4(visibility[0] | PATH_RAY_NODE_QUANTIZED, visibility[1], c0, c1),
+      make_int4(__float_as_int(bounds.min.x),
+                __float_as_int(bounds.min.y),
+                __float_as_int(bounds.min.z),
+                exponents[0] | (exponents[1] << 8) | (exponents[2] << 16)),
+      make_int4(quantized_bounds[0], quantized_bounds[1], quantized_bounds[2], 0),
+  };
+
+  memcpy(&pack.nodes[idx], data, sizeof(int4) * BVH_QUANTIZED_NODE_SIZE);
+}
+
+int BVH2::inner_node_size(const BVHNode *node) const
+{
+  if (node->has_unaligned()) {
+    return BVH_UNALIGNED_NODE_SIZE;
+  }
+  return (params.use_compact_nodes) ? BVH_QUANTIZED_NODE_SIZE : BVH_NODE_SIZE;
+}
+
 void BVH2::pack_nodes(const BVHNode *root)
 {
   const size_t num_nodes = root->getSubtreeSize(BVH_STAT_NODE_COUNT);
   const size_t num_leaf_nodes = root->getSubtreeSize(BVH_STAT_LEAF_COUNT);
   assert(num_leaf_nodes <= num_nodes);
   const size_t num_inner_nodes = num_nodes - num_leaf_nodes;
-  size_t node_size;
-  if (params.use_unaligned_nodes) {
-    const size_t num_unaligned_nodes = root->getSubtreeSize(BVH_STAT_UNALIGNED_INNER_COUNT);
-    node_size = (num_unaligned_nodes * BVH_UNALIGNED_NODE_SIZE) +
-                (num_inner_nodes - num_unaligned_nodes) * BVH_NODE_SIZE;
-  }
-  else {
-    node_size = num_inner_nodes * BVH_NODE_SIZE;
-  }
+  const size_t num_unaligned_nodes = (params.use_unaligned_nodes) ?
+                                         root->getSubtreeSize(BVH_STAT_UNALIGNED_INNER_COUNT) :
+                                         0;
+  const size_t num_aligned_nodes = num_inner_nodes - num_unaligned_nodes;
+  const size_t aligned_node_size = (params.use_compact_nodes) ? BVH_QUANTIZED_NODE_SIZE :
+                                                                BVH_NODE_SIZE;
+  const size_t node_size = num_unaligned_nodes * BVH_UNALIGNED_NODE_SIZE +
+                           num_aligned_nodes * aligned_node_size;
   /* Resize arrays */
   pack.nodes.clear();
   pack.leaf_nodes.clear();
@@ -190,6 +313,7 @@ void BVH2::pack_nodes(const BVHNode *root)
   }
 
   int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+  float nodes_area = 0.0f;
 
   vector<BVHStackEntry> stack;
   stack.reserve(BVHParams::MAX_DEPTH * 2);
@@ -198,7 +322,7 @@ void BVH2::pack_nodes(const BVHNode *root)
   }
   else {
     stack.push_back(BVHStackEntry(root, nextNodeIdx));
-    nextNodeIdx += root->has_unaligned() ? BVH_UNALIGNED_NODE_SIZE : BVH_NODE_SIZE;
+    nextNodeIdx += inner_node_size(root);
   }
 
   while (stack.size()) {
@@ -219,8 +343,7 @@ void BVH2::pack_nodes(const BVHNode *root)
         }
         else {
           idx[i] = nextNodeIdx;
-          nextNodeIdx += e.node->get_child(i)->has_unaligned() ? BVH_UNALIGNED_NODE_SIZE :
-                                                                 BVH_NODE_SIZE;
+          nextNodeIdx += inner_node_size(e.node->get_child(i));
         }
       }
 
@@ -228,11 +351,27 @@ void BVH2::pack_nodes(const BVHNode *root)
       stack.push_back(BVHStackEntry(e.node->get_child(1), idx[1]));
 
       pack_inner(e, stack[stack.size() - 2], stack[stack.size() - 1]);
+
+      nodes_area += e.node->get_child(0)->bounds.safe_area() +
+                    e.node->get_child(1)->bounds.safe_area();
     }
   }
   assert(node_size == nextNodeIdx);
+
+  if (params.use_compact_nodes) {
+    const size_t saved_size = num_aligned_nodes * (BVH_NODE_SIZE - BVH_QUANTIZED_NODE_SIZE) *
+                              sizeof(int4);
+    VLOG(2) << "Packed " << num_inner_nodes << " compact BVH inner nodes in "
+            << string_human_readable_size(node_size * sizeof(int4)) << ", saved "
+            << string_human_readable_size(saved_size) << ".";
+  }
   /* root index to start traversal at, to handle case of single leaf node */
   pack.root_index = (root->is_leaf()) ? -1 : 0;
+
+  const float root_area = root->bounds.safe_area();
+  built_nodes_cost = (params.top_level || params.use_unaligned_nodes || root_area == 0.0f) ?
+                         0.0f :
+                         nodes_area / root_area;
 }
 
 void BVH2::refit_nodes()
@@ -241,7 +380,20 @@ void BVH2::refit_nodes()
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
+  refit_nodes_cost = 0.0f;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+
+  const float root_area = bbox.safe_area();
+  refit_nodes_cost = (root_area == 0.0f) ? 0.0f : refit_nodes_cost / root_area;
+}
+
+bool BVH2::need_rebuild_after_refit() const
+{
+  /* Rebuilding is much more expensive than refitting, only do it when traversal got
+   * significantly slower. */
+  const float max_cost_increase = 1.5f;
+
+  return built_nodes_cost > 0.0f && refit_nodes_cost > built_nodes_cost * max_cost_increase;
 }
 
 void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
@@ -264,10 +416,15 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     memcpy(&pack.leaf_nodes[idx], leaf_data, sizeof(float4) * BVH_NODE_LEAF_SIZE);
   }
   else {
-    assert(idx + BVH_NODE_SIZE <= pack.nodes.size());
+    assert(idx < pack.nodes.size());
 
     const int4 *data = &pack.nodes[idx];
     const bool is_unaligned = (data[0].x & PATH_RAY_NODE_UNALIGNED) != 0;
+    const bool is_quantized = (data[0].x & PATH_RAY_NODE_QUANTIZED) != 0;
+    assert(idx + (is_unaligned ? BVH_UNALIGNED_NODE_SIZE :
+                  is_quantized ? BVH_QUANTIZED_NODE_SIZE :
+                                 BVH_NODE_SIZE) <=
+           pack.nodes.size());
     const int c0 = data[0].z;
     const int c1 = data[0].w;
     /* refit inner node, set bbox from children */
@@ -282,6 +439,9 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
       pack_unaligned_node(
           idx, aligned_space, aligned_space, bbox0, bbox1, c0, c1, visibility0, visibility1);
     }
+    else if (is_quantized) {
+      pack_quantized_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
+    }
     else {
       pack_aligned_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
     }
@@ -289,6 +449,9 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+
+    /* Accumulated area, divided by the root one at the end of #refit_nodes. */
+    refit_nodes_cost += bbox0.safe_area() + bbox1.safe_area();
   }
 }
 
@@ -37,12 +37,16 @@ class Progress;
 #define BVH_NODE_SIZE 4
 #define BVH_NODE_LEAF_SIZE 1
 #define BVH_UNALIGNED_NODE_SIZE 7
+#define BVH_QUANTIZED_NODE_SIZE 3
 
 /* BVH2
  *
  * Typical BVH with each node having two children.
  */
 class BVH2 : public BVH {
+ public:
+  bool need_rebuild_after_refit() const override;
+
  protected:
   /* constructor */
   friend class BVH;
@@ -55,6 +59,7 @@ class BVH2 : public BVH {
 
   /* pack */
   void pack_nodes(const BVHNode *root) override;
+  int inner_node_size(const BVHNode *node) const;
 
   void pack_leaf(const BVHStackEntry &e, const LeafNode *leaf);
   void pack_inner(const BVHStackEntry &e, const BVHStackEntry &e0, const BVHStackEntry &e1);
@@ -83,9 +88,23 @@ class BVH2 : public BVH {
                            uint visibility0,
                            uint visibility1);
 
+  void pack_quantized_node(int idx,
+                           const BoundBox &b0,
+                           const BoundBox &b1,
+                           int c0,
+                           int c1,
+                           uint visibility0,
+                           uint visibility1);
+
   /* refit */
   void refit_nodes() override;
   void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+
+  /* Sum of the surface areas of the nodes relative to the root one, which is proportional to
+   * the cost of traversing the tree (SAH). Computed when building and refitting, 0.0 when the
+   * tree is not refitted (top level, unaligned nodes). */
+  float built_nodes_cost;
+  float refit_nodes_cost;
 };
 
 CCL_NAMESPACE_END
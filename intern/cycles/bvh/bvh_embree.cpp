@@ -389,7 +389,7 @@ void BVHEmbree::build(Progress &progress, Stats *stats_)
   const RTCSceneFlags scene_flags = (dynamic ? RTC_SCENE_FLAG_DYNAMIC : RTC_SCENE_FLAG_NONE) |
                                     RTC_SCENE_FLAG_COMPACT | RTC_SCENE_FLAG_ROBUST;
   rtcSetSceneFlags(scene, scene_flags);
-  build_quality = dynamic ? RTC_BUILD_QUALITY_LOW :
+  build_quality = params.use_fast_build ? RTC_BUILD_QUALITY_LOW :
                             (params.use_spatial_split ? RTC_BUILD_QUALITY_HIGH :
                                                         RTC_BUILD_QUALITY_MEDIUM);
   rtcSetSceneBuildQuality(scene, build_quality);
@@ -972,6 +972,14 @@ void BVHEmbree::refit_nodes()
   }
   rtcCommitScene(scene);
 }
+
+bool BVHEmbree::need_rebuild_after_refit() const
+{
+  /* Geometry never uses RTC_BUILD_QUALITY_REFIT, so committing the updated vertex buffers in
+   * #refit_nodes makes Embree build the trees of the modified geometry again. They don't get
+   * worse over time. */
+  return false;
+}
 CCL_NAMESPACE_END
 
 #endif /* WITH_EMBREE */
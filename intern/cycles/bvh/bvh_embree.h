@@ -39,6 +39,7 @@ class BVHEmbree : public BVH {
  public:
   virtual void build(Progress &progress, Stats *stats) override;
   virtual void copy_to_device(Progress &progress, DeviceScene *dscene) override;
+  virtual bool need_rebuild_after_refit() const override;
   virtual ~BVHEmbree();
   RTCScene scene;
   static void destroy(RTCScene);
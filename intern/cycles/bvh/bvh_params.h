@@ -74,6 +74,12 @@ class BVHParams {
    */
   bool use_unaligned_nodes;
 
+  /* Store the bounds of aligned nodes quantized to 8 bits relative to the node, using 25% less
+   * memory for inner nodes at the cost of slightly larger bounds.
+   * Only used for BVH2.
+   */
+  bool use_compact_nodes;
+
   /* Split time range to this number of steps and create leaf node for each
    * of this time steps.
    *
@@ -88,6 +94,9 @@ class BVHParams {
   /* Same as in SceneParams. */
   int bvh_type;
 
+  /* Favor build time over traversal performance, for BVHs updated interactively. */
+  bool use_fast_build;
+
   /* These are needed for Embree. */
   int curve_subdivisions;
 
@@ -115,11 +124,13 @@ class BVHParams {
     top_level = false;
     bvh_layout = BVH_LAYOUT_BVH2;
     use_unaligned_nodes = false;
+    use_compact_nodes = false;
 
     num_motion_curve_steps = 0;
     num_motion_triangle_steps = 0;
 
     bvh_type = 0;
+    use_fast_build = false;
 
     curve_subdivisions = 4;
   }
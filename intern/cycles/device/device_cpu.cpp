@@ -62,6 +62,7 @@
 #include "util/util_system.h"
 #include "util/util_task.h"
 #include "util/util_thread.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -911,6 +912,7 @@ class CPUDevice : public Device {
   void render(DeviceTask &task, RenderTile &tile, KernelGlobals *kg)
   {
     const bool use_coverage = kernel_data.film.cryptomatte_passes & CRYPT_ACCURATE;
+    const int pass_render_time = kernel_data.film.pass_render_time;
 
     scoped_timer timer(&tile.buffers->render_time);
 
@@ -938,7 +940,16 @@ class CPUDevice : public Device {
             if (use_coverage) {
               coverage.init_pixel(x, y);
             }
-            path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+            if (pass_render_time) {
+              const double time_start = time_dt();
+              path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+              float *pixel_buffer = render_buffer + (tile.offset + x + y * tile.stride) *
+                                                        kernel_data.film.pass_stride;
+              pixel_buffer[pass_render_time] += (float)((time_dt() - time_start) * 1000.0);
+            }
+            else {
+              path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+            }
           }
         }
       }
@@ -1593,11 +1604,22 @@ int2 CPUSplitKernel::split_kernel_local_size()
   return make_int2(1, 1);
 }
 
-int2 CPUSplitKernel::split_kernel_global_size(device_memory & /*kg*/,
-                                              device_memory & /*data*/,
+int2 CPUSplitKernel::split_kernel_global_size(device_memory &kg,
+                                              device_memory &data,
                                               DeviceTask & /*task*/)
 {
-  return make_int2(1, 1);
+  /* Keep enough paths in flight for the shading work to be sorted by shader in whole blocks,
+   * while limiting the memory used by the state of every render thread. */
+  const uint64_t max_buffer_size = 64 * 1024 * 1024;
+  const int num_elements = clamp(
+      (int)std::min(max_elements_for_max_buffer_size(kg, data, max_buffer_size),
+                    (size_t)SHADER_SORT_BLOCK_SIZE),
+      64,
+      SHADER_SORT_BLOCK_SIZE);
+  const int2 global_size = make_int2(64, num_elements / 64);
+
+  VLOG(1) << "Global size: " << global_size << ".";
+  return global_size;
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory &kernel_globals,
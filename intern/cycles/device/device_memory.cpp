@@ -31,6 +31,7 @@ device_memory::device_memory(Device *device, const char *name, MemoryType type)
       data_depth(0),
       type(type),
       name(name),
+      host_updated_by_tiles(false),
       device(device),
       device_pointer(0),
       host_pointer(0),
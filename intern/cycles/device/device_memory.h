@@ -216,6 +216,9 @@ class device_memory {
   size_t data_depth;
   MemoryType type;
   const char *name;
+  /* Host copy is kept up to date by the released tiles, copying it back from the device can be
+   * skipped by devices that transfer the tiles themselves. */
+  bool host_updated_by_tiles;
 
   /* Pointers. */
   Device *device;
@@ -20,6 +20,9 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_time.h"
+
+#include <atomic>
 
 #if defined(WITH_NETWORK)
 
@@ -41,6 +44,32 @@ static TileList::iterator tile_list_find(TileList &tile_list, RenderTile &tile)
   return tile_list.end();
 }
 
+/* Number of floats of a tile in the render buffer, rows are sent without the padding between
+ * them. */
+static size_t tile_pixels_size(const RenderTile &tile, int pass_stride)
+{
+  return (size_t)tile.w * tile.h * pass_stride;
+}
+
+static float *tile_row_pointer(float *buffer, const RenderTile &tile, int y, int pass_stride)
+{
+  return buffer + (size_t)(tile.offset + tile.x + (tile.y + y) * tile.stride) * pass_stride;
+}
+
+/* Split "host[:port]" into its parts, using the default server port when none is given. */
+static void network_address_split(const string &address, string &host, string &port)
+{
+  const size_t colon = address.rfind(':');
+  if (colon == string::npos) {
+    host = address;
+    port = string_printf("%d", SERVER_PORT);
+  }
+  else {
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+  }
+}
+
 class NetworkDevice : public Device {
  public:
   boost::asio::io_service io_service;
@@ -48,22 +77,37 @@ class NetworkDevice : public Device {
   device_ptr mem_counter;
   DeviceTask the_task; /* todo: handle multiple tasks */
 
+  /* Messages received during a task are handled by this thread, so that all servers of a
+   * multi device render at the same time. */
+  thread *task_thread;
+
   thread_mutex rpc_lock;
 
+  /* Statistics, reported per task. */
+  string address;
+  NetworkStats network_stats;
+  int task_tiles;
+  int64_t task_pixel_samples;
+  double task_render_time;
+  double task_start_time;
+
   virtual bool show_samples() const
   {
     return false;
   }
 
-  NetworkDevice(DeviceInfo &info, Stats &stats, Profiler &profiler, const char *address)
-      : Device(info, stats, profiler, true), socket(io_service)
+  NetworkDevice(DeviceInfo &info, Stats &stats, Profiler &profiler)
+      : Device(info, stats, profiler, true), socket(io_service), task_thread(NULL)
   {
     error_func = NetworkError();
-    stringstream portstr;
-    portstr << SERVER_PORT;
+
+    /* The device identifier is the address of the server. */
+    address = info.id.substr(strlen("NETWORK_"));
+    string host, port;
+    network_address_split(address, host, port);
 
     tcp::resolver resolver(io_service);
-    tcp::resolver::query query(address, portstr.str());
+    tcp::resolver::query query(host, port);
     tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
     tcp::resolver::iterator end;
 
@@ -73,15 +117,21 @@ class NetworkDevice : public Device {
       socket.connect(*endpoint_iterator++, error);
     }
 
-    if (error)
+    if (error) {
       error_func.network_error(error.message());
+      set_error(string_printf("Failed to connect to render server %s: %s",
+                              address.c_str(),
+                              error.message().c_str()));
+    }
 
     mem_counter = 0;
   }
 
   ~NetworkDevice()
   {
-    RPCSend snd(socket, &error_func, "stop");
+    task_thread_join();
+
+    RPCSend snd(socket, &error_func, "stop", &network_stats);
     snd.write();
   }
 
@@ -101,8 +151,10 @@ class NetworkDevice : public Device {
     thread_scoped_lock lock(rpc_lock);
 
     mem.device_pointer = ++mem_counter;
+    mem.device_size = mem.memory_size();
+    stats.mem_alloc(mem.device_size);
 
-    RPCSend snd(socket, &error_func, "mem_alloc");
+    RPCSend snd(socket, &error_func, "mem_alloc", &network_stats);
     snd.add(mem);
     snd.write();
   }
@@ -111,20 +163,30 @@ class NetworkDevice : public Device {
   {
     thread_scoped_lock lock(rpc_lock);
 
-    RPCSend snd(socket, &error_func, "mem_copy_to");
+    /* Textures and global memory are copied without being allocated first. */
+    mem_pointer_ensure(mem);
+
+    RPCSend snd(socket, &error_func, "mem_copy_to", &network_stats);
 
     snd.add(mem);
     snd.write();
-    snd.write_buffer(mem.host_pointer, mem.memory_size());
+    snd.write_buffer_compressed(mem.host_pointer, mem.memory_size());
   }
 
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
   {
+    /* The host copy of render buffers is kept up to date with the pixels sent along with the
+     * released tiles, no need to transfer them again. */
+    if (mem.host_updated_by_tiles) {
+      return;
+    }
+
     thread_scoped_lock lock(rpc_lock);
 
-    size_t data_size = mem.memory_size();
+    const size_t offset = (size_t)elem * y * w;
+    const size_t size = (size_t)elem * w * h;
 
-    RPCSend snd(socket, &error_func, "mem_copy_from");
+    RPCSend snd(socket, &error_func, "mem_copy_from", &network_stats);
 
     snd.add(mem);
     snd.add(y);
@@ -133,15 +195,21 @@ class NetworkDevice : public Device {
     snd.add(elem);
     snd.write();
 
-    RPCReceive rcv(socket, &error_func);
-    rcv.read_buffer(mem.host_pointer, data_size);
+    RPCReceive rcv(socket, &error_func, &network_stats);
+    rcv.read_buffer_compressed((uint8_t *)mem.host_pointer + offset, size);
   }
 
   void mem_zero(device_memory &mem)
   {
     thread_scoped_lock lock(rpc_lock);
 
-    RPCSend snd(socket, &error_func, "mem_zero");
+    mem_pointer_ensure(mem);
+
+    if (mem.host_pointer) {
+      memset(mem.host_pointer, 0, mem.memory_size());
+    }
+
+    RPCSend snd(socket, &error_func, "mem_zero", &network_stats);
 
     snd.add(mem);
     snd.write();
@@ -152,12 +220,14 @@ class NetworkDevice : public Device {
     if (mem.device_pointer) {
       thread_scoped_lock lock(rpc_lock);
 
-      RPCSend snd(socket, &error_func, "mem_free");
+      RPCSend snd(socket, &error_func, "mem_free", &network_stats);
 
       snd.add(mem);
       snd.write();
 
       mem.device_pointer = 0;
+      stats.mem_free(mem.device_size);
+      mem.device_size = 0;
     }
   }
 
@@ -165,7 +235,7 @@ class NetworkDevice : public Device {
   {
     thread_scoped_lock lock(rpc_lock);
 
-    RPCSend snd(socket, &error_func, "const_copy_to");
+    RPCSend snd(socket, &error_func, "const_copy_to", &network_stats);
 
     string name_string(name);
 
@@ -182,15 +252,12 @@ class NetworkDevice : public Device {
 
     thread_scoped_lock lock(rpc_lock);
 
-    RPCSend snd(socket, &error_func, "load_kernels");
-    snd.add(requested_features.experimental);
-    snd.add(requested_features.max_closure);
-    snd.add(requested_features.max_nodes_group);
-    snd.add(requested_features.nodes_features);
+    RPCSend snd(socket, &error_func, "load_kernels", &network_stats);
+    snd.add(requested_features);
     snd.write();
 
     bool result;
-    RPCReceive rcv(socket, &error_func);
+    RPCReceive rcv(socket, &error_func, &network_stats);
     rcv.read(result);
 
     return result;
@@ -198,130 +265,215 @@ class NetworkDevice : public Device {
 
   void task_add(DeviceTask &task)
   {
+    task_thread_join();
+
     thread_scoped_lock lock(rpc_lock);
 
     the_task = task;
 
-    RPCSend snd(socket, &error_func, "task_add");
+    task_tiles = 0;
+    task_pixel_samples = 0;
+    task_render_time = 0.0;
+    task_start_time = time_dt();
+
+    RPCSend snd(socket, &error_func, "task_add", &network_stats);
     snd.add(task);
     snd.write();
+
+    /* The server starts rendering right away, acquiring tiles through us. */
+    RPCSend snd_wait(socket, &error_func, "task_wait", &network_stats);
+    snd_wait.write();
+
+    task_thread = new thread(function_bind(&NetworkDevice::task_receive, this));
   }
 
   void task_wait()
   {
-    thread_scoped_lock lock(rpc_lock);
+    task_thread_join();
+  }
 
-    RPCSend snd(socket, &error_func, "task_wait");
+  void task_cancel()
+  {
+    thread_scoped_lock lock(rpc_lock);
+    RPCSend snd(socket, &error_func, "task_cancel", &network_stats);
     snd.write();
+  }
 
-    lock.unlock();
+  int get_split_task_count(DeviceTask &)
+  {
+    return 1;
+  }
 
+ protected:
+  /* Memory that was never allocated gets its pointer on first use. */
+  void mem_pointer_ensure(device_memory &mem)
+  {
+    if (!mem.device_pointer) {
+      mem.device_pointer = ++mem_counter;
+    }
+    else {
+      stats.mem_free(mem.device_size);
+    }
+    mem.device_size = mem.memory_size();
+    stats.mem_alloc(mem.device_size);
+  }
+
+  void task_thread_join()
+  {
+    if (task_thread) {
+      task_thread->join();
+      delete task_thread;
+      task_thread = NULL;
+    }
+  }
+
+  /* Handle the server requests for the running task, until the server is done with it. Only
+   * this thread reads from the socket while a task runs. */
+  void task_receive()
+  {
     TileList the_tiles;
+    vector<float> pixels;
 
-    /* todo: run this threaded for connecting to multiple clients */
     for (;;) {
       if (error_func.have_error())
         break;
 
-      RenderTile tile;
-
-      lock.lock();
-      RPCReceive rcv(socket, &error_func);
+      RPCReceive rcv(socket, &error_func, &network_stats);
 
       if (rcv.name == "acquire_tile") {
-        lock.unlock();
+        RenderTile tile;
 
         /* todo: watch out for recursive calls! */
-        if (the_task.acquire_tile(this, tile)) { /* write return as bool */
+        if (the_task.acquire_tile(this, tile, the_task.tile_types)) { /* write return as bool */
           the_tiles.push_back(tile);
 
-          lock.lock();
-          RPCSend snd(socket, &error_func, "acquire_tile");
+          thread_scoped_lock lock(rpc_lock);
+          RPCSend snd(socket, &error_func, "acquire_tile", &network_stats);
           snd.add(tile);
           snd.write();
-          lock.unlock();
         }
         else {
-          lock.lock();
-          RPCSend snd(socket, &error_func, "acquire_tile_none");
+          thread_scoped_lock lock(rpc_lock);
+          RPCSend snd(socket, &error_func, "acquire_tile_none", &network_stats);
           snd.write();
-          lock.unlock();
         }
       }
       else if (rcv.name == "release_tile") {
+        RenderTile tile;
+        double render_time;
         rcv.read(tile);
-        lock.unlock();
+        rcv.read(render_time);
 
         TileList::iterator it = tile_list_find(the_tiles, tile);
-        if (it != the_tiles.end()) {
-          tile.buffers = it->buffers;
-          the_tiles.erase(it);
+        if (it == the_tiles.end()) {
+          error_func.network_error("Network receive error: released unknown tile");
+          break;
         }
 
-        assert(tile.buffers != NULL);
+        tile.buffer = it->buffer;
+        tile.buffers = it->buffers;
+        the_tiles.erase(it);
 
-        the_task.release_tile(tile);
+        /* Pixels of the tile follow, copy them into the host memory of the tile buffers. */
+        const int pass_stride = the_task.pass_stride;
+        pixels.resize(tile_pixels_size(tile, pass_stride));
+        rcv.read_buffer_compressed(pixels.data(), pixels.size() * sizeof(float));
+
+        float *buffer = (float *)tile.buffers->buffer.host_pointer;
+        for (int y = 0; y < tile.h; y++) {
+          memcpy(tile_row_pointer(buffer, tile, y, pass_stride),
+                 &pixels[(size_t)y * tile.w * pass_stride],
+                 sizeof(float) * tile.w * pass_stride);
+        }
 
-        lock.lock();
-        RPCSend snd(socket, &error_func, "release_tile");
-        snd.write();
-        lock.unlock();
+        const int64_t pixel_samples = (int64_t)tile.w * tile.h *
+                                      (tile.sample - tile.start_sample);
+        tile.buffers->render_time += render_time;
+
+        task_tiles++;
+        task_pixel_samples += pixel_samples;
+        task_render_time += render_time;
+
+        the_task.update_progress_sample(pixel_samples, tile.sample);
+        the_task.release_tile(tile);
       }
       else if (rcv.name == "task_wait_done") {
-        lock.unlock();
         break;
       }
-      else
-        lock.unlock();
+      else if (!error_func.have_error()) {
+        error_func.network_error("Network receive error: unexpected call \"" + rcv.name + "\"");
+      }
     }
-  }
 
-  void task_cancel()
-  {
-    thread_scoped_lock lock(rpc_lock);
-    RPCSend snd(socket, &error_func, "task_cancel");
-    snd.write();
-  }
+    if (error_func.have_error()) {
+      set_error("Network error: " + error_func.get_error());
+    }
 
-  int get_split_task_count(DeviceTask &)
-  {
-    return 1;
+    const double task_time = time_dt() - task_start_time;
+    VLOG(1) << "Render server " << address << ": " << task_tiles << " tiles, "
+            << string_human_readable_number(task_pixel_samples) << " pixel samples in "
+            << task_time << " seconds ("
+            << string_human_readable_number((task_time > 0.0) ? task_pixel_samples / task_time :
+                                                                0)
+            << " pixel samples per second), " << task_render_time
+            << " seconds of render time, " << network_stats.full_report();
   }
 
  private:
   NetworkError error_func;
 };
 
-Device *device_network_create(DeviceInfo &info,
-                              Stats &stats,
-                              Profiler &profiler,
-                              const char *address)
+Device *device_network_create(DeviceInfo &info, Stats &stats, Profiler &profiler)
 {
-  return new NetworkDevice(info, stats, profiler, address);
+  return new NetworkDevice(info, stats, profiler);
 }
 
+/* Servers are listed in the CYCLES_NETWORK_SERVERS environment variable as comma separated
+ * "host[:port]" addresses. Without it, servers on the local network are discovered. */
 void device_network_info(vector<DeviceInfo> &devices)
 {
-  DeviceInfo info;
+  vector<string> servers;
+
+  const char *servers_env = getenv("CYCLES_NETWORK_SERVERS");
+  if (servers_env) {
+    string_split(servers, servers_env, ",");
+  }
+  else {
+    ServerDiscovery discovery(true);
+    time_sleep(1.0);
+
+    servers = discovery.get_server_list();
+
+    if (servers.empty()) {
+      servers.push_back(string_printf("127.0.0.1:%d", SERVER_PORT));
+    }
+  }
 
-  info.type = DEVICE_NETWORK;
-  info.description = "Network Device";
-  info.id = "NETWORK";
-  info.num = 0;
+  foreach (string &server, servers) {
+    const string address = string_strip(server);
+    if (address.empty()) {
+      continue;
+    }
+
+    DeviceInfo info;
 
-  /* todo: get this info from device */
-  info.has_volume_decoupled = false;
-  info.has_adaptive_stop_per_sample = false;
-  info.has_osl = false;
-  info.denoisers = DENOISER_NONE;
+    info.type = DEVICE_NETWORK;
+    info.description = "Network Device (" + address + ")";
+    info.id = "NETWORK_" + address;
+    info.num = devices.size();
 
-  devices.push_back(info);
+    /* todo: get this info from device */
+    info.has_volume_decoupled = false;
+    info.has_adaptive_stop_per_sample = false;
+    info.has_osl = false;
+    info.denoisers = DENOISER_NONE;
+
+    devices.push_back(info);
+  }
 }
 
 class DeviceServer {
  public:
-  thread_mutex rpc_lock;
-
   void network_error(const string &message)
   {
     error_func.network_error(message);
@@ -333,7 +485,12 @@ class DeviceServer {
   }
 
   DeviceServer(Device *device_, tcp::socket &socket_)
-      : device(device_), socket(socket_), stop(false), blocked_waiting(false)
+      : device(device_),
+        socket(socket_),
+        stop(false),
+        task_cancelled(false),
+        task_pass_stride(0),
+        wait_thread(NULL)
   {
     error_func = NetworkError();
   }
@@ -341,26 +498,33 @@ class DeviceServer {
   void listen()
   {
     /* receive remote function calls */
-    for (;;) {
-      listen_step();
+    while (!have_error()) {
+      RPCReceive rcv(socket, &error_func, &network_stats);
 
-      if (stop)
+      if (have_error()) {
         break;
-    }
-  }
+      }
 
- protected:
-  void listen_step()
-  {
-    thread_scoped_lock lock(rpc_lock);
-    RPCReceive rcv(socket, &error_func);
+      if (rcv.name == "stop")
+        break;
+      else
+        process(rcv);
+    }
 
-    if (rcv.name == "stop")
+    /* Wake up render threads waiting for a tile, there will be none anymore. */
+    {
+      thread_scoped_lock queue_lock(queue_mutex);
       stop = true;
-    else
-      process(rcv, lock);
+      queue_cond.notify_all();
+    }
+
+    if (wait_thread) {
+      device->task_cancel();
+    }
+    wait_thread_join();
   }
 
+ protected:
   /* create a memory buffer for a device buffer and insert it into mem_data */
   DataVector &data_vector_insert(device_ptr client_pointer, size_t data_size)
   {
@@ -387,9 +551,23 @@ class DeviceServer {
     return i->second;
   }
 
+  /* find the memory buffer of a device buffer, creating it for memory that was not allocated
+   * before being copied or zeroed */
+  DataVector &data_vector_find_or_insert(device_ptr client_pointer, size_t data_size)
+  {
+    DataVector &data_v = mem_data[client_pointer];
+    data_v.resize(data_size);
+    return data_v;
+  }
+
   /* setup mapping and reverse mapping of client_pointer<->real_pointer */
   void pointer_mapping_insert(device_ptr client_pointer, device_ptr real_pointer)
   {
+    /* empty memory is not allocated on the device */
+    if (!real_pointer) {
+      return;
+    }
+
     pair<PtrMap::iterator, bool> mapins;
 
     /* insert mapping from client pointer to our real device pointer */
@@ -401,17 +579,19 @@ class DeviceServer {
     assert(mapins.second);
   }
 
+  /* returns zero for memory that does not exist on the device yet */
   device_ptr device_ptr_from_client_pointer(device_ptr client_pointer)
   {
     PtrMap::iterator i = ptr_map.find(client_pointer);
-    assert(i != ptr_map.end());
-    return i->second;
+    return (i != ptr_map.end()) ? i->second : 0;
   }
 
   device_ptr device_ptr_from_client_pointer_erase(device_ptr client_pointer)
   {
     PtrMap::iterator i = ptr_map.find(client_pointer);
-    assert(i != ptr_map.end());
+    if (i == ptr_map.end()) {
+      return 0;
+    }
 
     device_ptr result = i->second;
 
@@ -423,33 +603,26 @@ class DeviceServer {
     assert(irev != ptr_imap.end());
     ptr_imap.erase(irev);
 
-    /* erase the data vector */
-    DataMap::iterator idata = mem_data.find(client_pointer);
-    assert(idata != mem_data.end());
-    mem_data.erase(idata);
-
     return result;
   }
 
-  /* note that the lock must be already acquired upon entry.
-   * This is necessary because the caller often peeks at
-   * the header and delegates control to here when it doesn't
-   * specifically handle the current RPC.
-   * The lock must be unlocked before returning */
-  void process(RPCReceive &rcv, thread_scoped_lock &lock)
+  void process(RPCReceive &rcv)
   {
     if (rcv.name == "mem_alloc") {
       string name;
       network_device_memory mem(device);
       rcv.read(mem, name);
-      lock.unlock();
 
-      /* Allocate host side data buffer. */
-      size_t data_size = mem.memory_size();
+      thread_scoped_lock map_lock(map_mutex);
+
+      /* Allocate host side data buffer, device only memory has none. */
       device_ptr client_pointer = mem.device_pointer;
+      mem.device_pointer = 0;
 
-      DataVector &data_v = data_vector_insert(client_pointer, data_size);
-      mem.host_pointer = (data_size) ? (void *)&(data_v[0]) : 0;
+      if (mem.type != MEM_DEVICE_ONLY) {
+        DataVector &data_v = data_vector_insert(client_pointer, mem.memory_size());
+        mem.host_pointer = (data_v.size()) ? (void *)&(data_v[0]) : 0;
+      }
 
       /* Perform the allocation on the actual device. */
       device->mem_alloc(mem);
@@ -457,37 +630,37 @@ class DeviceServer {
       /* Store a mapping to/from client_pointer and real device pointer. */
       pointer_mapping_insert(client_pointer, mem.device_pointer);
     }
-    else if (rcv.name == "mem_copy_to") {
+    else if (rcv.name == "mem_copy_to" || rcv.name == "mem_zero") {
+      const bool zero = (rcv.name == "mem_zero");
       string name;
       network_device_memory mem(device);
       rcv.read(mem, name);
-      lock.unlock();
 
-      size_t data_size = mem.memory_size();
+      thread_scoped_lock map_lock(map_mutex);
+
       device_ptr client_pointer = mem.device_pointer;
 
-      if (client_pointer) {
-        /* Lookup existing host side data buffer. */
-        DataVector &data_v = data_vector_find(client_pointer);
-        mem.host_pointer = (void *)&data_v[0];
+      /* Lookup or allocate host side data buffer. */
+      DataVector &data_v = data_vector_find_or_insert(client_pointer, mem.memory_size());
+      mem.host_pointer = (data_v.size()) ? (void *)&(data_v[0]) : 0;
+
+      /* Translate the client pointer to a real device pointer. */
+      const device_ptr real_pointer = device_ptr_from_client_pointer(client_pointer);
+      mem.device_pointer = real_pointer;
 
-        /* Translate the client pointer to a real device pointer. */
-        mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
+      if (zero) {
+        device->mem_zero(mem);
       }
       else {
-        /* Allocate host side data buffer. */
-        DataVector &data_v = data_vector_insert(client_pointer, data_size);
-        mem.host_pointer = (data_size) ? (void *)&(data_v[0]) : 0;
+        /* Copy data from network into memory buffer, and from there to the device. */
+        rcv.read_buffer_compressed(mem.host_pointer, mem.memory_size());
+        device->mem_copy_to(mem);
       }
 
-      /* Copy data from network into memory buffer. */
-      rcv.read_buffer((uint8_t *)mem.host_pointer, data_size);
-
-      /* Copy the data from the memory buffer to the device buffer. */
-      device->mem_copy_to(mem);
-
-      if (!client_pointer) {
-        /* Store a mapping to/from client_pointer and real device pointer. */
+      /* Store a mapping to/from client_pointer and real device pointer, textures get a new
+       * pointer when copied again. */
+      if (mem.device_pointer != real_pointer) {
+        device_ptr_from_client_pointer_erase(client_pointer);
         pointer_mapping_insert(client_pointer, mem.device_pointer);
       }
     }
@@ -502,65 +675,48 @@ class DeviceServer {
       rcv.read(h);
       rcv.read(elem);
 
+      thread_scoped_lock map_lock(map_mutex);
+
       device_ptr client_pointer = mem.device_pointer;
       mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
 
       DataVector &data_v = data_vector_find(client_pointer);
-
-      mem.host_pointer = (device_ptr) & (data_v[0]);
+      mem.host_pointer = (void *)&data_v[0];
 
       device->mem_copy_from(mem, y, w, h, elem);
 
-      size_t data_size = mem.memory_size();
+      /* Only send back the requested rows. */
+      const size_t offset = (size_t)elem * y * w;
+      const size_t size = (size_t)elem * w * h;
 
-      RPCSend snd(socket, &error_func, "mem_copy_from");
+      thread_scoped_lock send_lock(send_mutex);
+      RPCSend snd(socket, &error_func, "mem_copy_from", &network_stats);
       snd.write();
-      snd.write_buffer((uint8_t *)mem.host_pointer, data_size);
-      lock.unlock();
-    }
-    else if (rcv.name == "mem_zero") {
-      string name;
-      network_device_memory mem(device);
-      rcv.read(mem, name);
-      lock.unlock();
-
-      size_t data_size = mem.memory_size();
-      device_ptr client_pointer = mem.device_pointer;
-
-      if (client_pointer) {
-        /* Lookup existing host side data buffer. */
-        DataVector &data_v = data_vector_find(client_pointer);
-        mem.host_pointer = (void *)&data_v[0];
-
-        /* Translate the client pointer to a real device pointer. */
-        mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
-      }
-      else {
-        /* Allocate host side data buffer. */
-        DataVector &data_v = data_vector_insert(client_pointer, data_size);
-        mem.host_pointer = (void *) ? (device_ptr) & (data_v[0]) : 0;
-      }
-
-      /* Zero memory. */
-      device->mem_zero(mem);
-
-      if (!client_pointer) {
-        /* Store a mapping to/from client_pointer and real device pointer. */
-        pointer_mapping_insert(client_pointer, mem.device_pointer);
-      }
+      snd.write_buffer_compressed(&data_v[offset], size);
     }
     else if (rcv.name == "mem_free") {
       string name;
       network_device_memory mem(device);
 
       rcv.read(mem, name);
-      lock.unlock();
+
+      thread_scoped_lock map_lock(map_mutex);
 
       device_ptr client_pointer = mem.device_pointer;
 
+      DataMap::iterator idata = mem_data.find(client_pointer);
+      mem.host_pointer = (idata != mem_data.end() && idata->second.size()) ?
+                             (void *)&idata->second[0] :
+                             0;
       mem.device_pointer = device_ptr_from_client_pointer_erase(client_pointer);
+      mem.device_size = mem.memory_size();
 
       device->mem_free(mem);
+
+      /* erase the data vector */
+      if (idata != mem_data.end()) {
+        mem_data.erase(idata);
+      }
     }
     else if (rcv.name == "const_copy_to") {
       string name_string;
@@ -571,139 +727,157 @@ class DeviceServer {
 
       vector<char> host_vector(size);
       rcv.read_buffer(&host_vector[0], size);
-      lock.unlock();
 
       device->const_copy_to(name_string.c_str(), &host_vector[0], size);
     }
     else if (rcv.name == "load_kernels") {
       DeviceRequestedFeatures requested_features;
-      rcv.read(requested_features.experimental);
-      rcv.read(requested_features.max_closure);
-      rcv.read(requested_features.max_nodes_group);
-      rcv.read(requested_features.nodes_features);
+      rcv.read(requested_features);
 
       bool result;
       result = device->load_kernels(requested_features);
-      RPCSend snd(socket, &error_func, "load_kernels");
+
+      thread_scoped_lock send_lock(send_mutex);
+      RPCSend snd(socket, &error_func, "load_kernels", &network_stats);
       snd.add(result);
       snd.write();
-      lock.unlock();
     }
     else if (rcv.name == "task_add") {
       DeviceTask task;
 
       rcv.read(task);
-      lock.unlock();
 
-      if (task.buffer)
-        task.buffer = device_ptr_from_client_pointer(task.buffer);
+      {
+        thread_scoped_lock map_lock(map_mutex);
 
-      if (task.rgba_half)
-        task.rgba_half = device_ptr_from_client_pointer(task.rgba_half);
+        if (task.buffer)
+          task.buffer = device_ptr_from_client_pointer(task.buffer);
 
-      if (task.rgba_byte)
-        task.rgba_byte = device_ptr_from_client_pointer(task.rgba_byte);
+        if (task.rgba_half)
+          task.rgba_half = device_ptr_from_client_pointer(task.rgba_half);
 
-      if (task.shader_input)
-        task.shader_input = device_ptr_from_client_pointer(task.shader_input);
+        if (task.rgba_byte)
+          task.rgba_byte = device_ptr_from_client_pointer(task.rgba_byte);
 
-      if (task.shader_output)
-        task.shader_output = device_ptr_from_client_pointer(task.shader_output);
+        if (task.shader_input)
+          task.shader_input = device_ptr_from_client_pointer(task.shader_input);
 
-      task.acquire_tile = function_bind(&DeviceServer::task_acquire_tile, this, _1, _2);
+        if (task.shader_output)
+          task.shader_output = device_ptr_from_client_pointer(task.shader_output);
+      }
+
+      task.acquire_tile = function_bind(&DeviceServer::task_acquire_tile, this, _1, _2, _3);
       task.release_tile = function_bind(&DeviceServer::task_release_tile, this, _1);
-      task.update_progress_sample = function_bind(&DeviceServer::task_update_progress_sample,
-                                                  this);
+      task.update_progress_sample = function_bind(
+          &DeviceServer::task_update_progress_sample, this, _1, _2);
       task.update_tile_sample = function_bind(&DeviceServer::task_update_tile_sample, this, _1);
       task.get_cancel = function_bind(&DeviceServer::task_get_cancel, this);
 
+      task_cancelled = false;
+      task_pass_stride = task.pass_stride;
+      task_tiles = 0;
+      task_start_time = time_dt();
+
       device->task_add(task);
     }
     else if (rcv.name == "task_wait") {
-      lock.unlock();
-
-      blocked_waiting = true;
-      device->task_wait();
-      blocked_waiting = false;
-
-      lock.lock();
-      RPCSend snd(socket, &error_func, "task_wait_done");
-      snd.write();
-      lock.unlock();
+      /* Wait in another thread, this one keeps receiving the tiles for the render threads. */
+      wait_thread_join();
+      wait_thread = new thread(function_bind(&DeviceServer::task_wait, this));
     }
     else if (rcv.name == "task_cancel") {
-      lock.unlock();
+      task_cancelled = true;
       device->task_cancel();
     }
     else if (rcv.name == "acquire_tile") {
       AcquireEntry entry;
       entry.name = rcv.name;
       rcv.read(entry.tile);
+
+      thread_scoped_lock queue_lock(queue_mutex);
       acquire_queue.push_back(entry);
-      lock.unlock();
+      queue_cond.notify_one();
     }
     else if (rcv.name == "acquire_tile_none") {
       AcquireEntry entry;
       entry.name = rcv.name;
+
+      thread_scoped_lock queue_lock(queue_mutex);
       acquire_queue.push_back(entry);
-      lock.unlock();
-    }
-    else if (rcv.name == "release_tile") {
-      AcquireEntry entry;
-      entry.name = rcv.name;
-      acquire_queue.push_back(entry);
-      lock.unlock();
+      queue_cond.notify_one();
     }
     else {
       cout << "Error: unexpected RPC receive call \"" + rcv.name + "\"\n";
-      lock.unlock();
     }
   }
 
-  bool task_acquire_tile(Device *, RenderTile &tile)
+  void task_wait()
   {
-    thread_scoped_lock acquire_lock(acquire_mutex);
+    device->task_wait();
 
-    bool result = false;
+    printf("Rendered %d tiles in %.2f seconds, %s\n",
+           task_tiles,
+           time_dt() - task_start_time,
+           network_stats.full_report().c_str());
 
-    RPCSend snd(socket, &error_func, "acquire_tile");
+    thread_scoped_lock send_lock(send_mutex);
+    RPCSend snd(socket, &error_func, "task_wait_done", &network_stats);
     snd.write();
+  }
 
-    do {
-      if (blocked_waiting)
-        listen_step();
+  void wait_thread_join()
+  {
+    if (wait_thread) {
+      wait_thread->join();
+      delete wait_thread;
+      wait_thread = NULL;
+    }
+  }
 
-      /* todo: avoid busy wait loop */
-      thread_scoped_lock lock(rpc_lock);
+  bool task_acquire_tile(Device *, RenderTile &tile, uint)
+  {
+    /* One request at a time, so replies can't be mixed up between render threads. */
+    thread_scoped_lock acquire_lock(acquire_mutex);
 
-      if (!acquire_queue.empty()) {
-        AcquireEntry entry = acquire_queue.front();
-        acquire_queue.pop_front();
+    {
+      thread_scoped_lock send_lock(send_mutex);
+      RPCSend snd(socket, &error_func, "acquire_tile", &network_stats);
+      snd.write();
+    }
 
-        if (entry.name == "acquire_tile") {
-          tile = entry.tile;
+    thread_scoped_lock queue_lock(queue_mutex);
+    while (acquire_queue.empty() && !stop) {
+      queue_cond.wait(queue_lock);
+    }
 
-          if (tile.buffer)
-            tile.buffer = ptr_map[tile.buffer];
+    if (acquire_queue.empty()) {
+      return false;
+    }
 
-          result = true;
-          break;
-        }
-        else if (entry.name == "acquire_tile_none") {
-          break;
-        }
-        else {
-          cout << "Error: unexpected acquire RPC receive call \"" + entry.name + "\"\n";
-        }
-      }
-    } while (acquire_queue.empty() && !stop && !have_error());
+    AcquireEntry entry = acquire_queue.front();
+    acquire_queue.pop_front();
+    queue_lock.unlock();
 
-    return result;
+    if (entry.name != "acquire_tile") {
+      return false;
+    }
+
+    tile = entry.tile;
+
+    thread_scoped_lock map_lock(map_mutex);
+
+    if (tile.buffer)
+      tile.buffer = device_ptr_from_client_pointer(tile.buffer);
+
+    /* Only used by the device to store the render time. */
+    tile.buffers = new RenderBuffers(device);
+
+    return true;
   }
 
-  void task_update_progress_sample()
+  void task_update_progress_sample(long, int)
   {
-    ; /* skip */
+    ; /* skip, progress is reported by the client as tiles are released */
   }
 
   void task_update_tile_sample(RenderTile &)
@@ -711,46 +885,58 @@ class DeviceServer {
     ; /* skip */
   }
 
+  /* Send the tile back along with its pixels, gathered from the render buffer. */
   void task_release_tile(RenderTile &tile)
   {
-    thread_scoped_lock acquire_lock(acquire_mutex);
+    const double render_time = tile.buffers->render_time;
+    delete tile.buffers;
+    tile.buffers = NULL;
 
-    if (tile.buffer)
-      tile.buffer = ptr_imap[tile.buffer];
+    thread_scoped_lock map_lock(map_mutex);
 
-    {
-      thread_scoped_lock lock(rpc_lock);
-      RPCSend snd(socket, &error_func, "release_tile");
-      snd.add(tile);
-      snd.write();
-      lock.unlock();
+    const device_ptr real_pointer = tile.buffer;
+    tile.buffer = ptr_imap[real_pointer];
+
+    DataVector &data_v = data_vector_find(tile.buffer);
+    float *buffer = (float *)&data_v[0];
+
+    if (device->info.type != DEVICE_CPU) {
+      /* Render buffers are not shared with the host, copy them back first. */
+      network_device_memory mem(device);
+      mem.type = MEM_READ_WRITE;
+      mem.data_type = TYPE_FLOAT;
+      mem.data_elements = 1;
+      mem.data_size = data_v.size() / sizeof(float);
+      mem.data_width = mem.data_size;
+      mem.data_height = 1;
+      mem.host_pointer = buffer;
+      mem.device_pointer = real_pointer;
+
+      device->mem_copy_from(mem, 0, mem.data_width, 1, sizeof(float));
     }
 
-    do {
-      if (blocked_waiting)
-        listen_step();
+    vector<float> pixels(tile_pixels_size(tile, task_pass_stride));
+    for (int y = 0; y < tile.h; y++) {
+      memcpy(&pixels[(size_t)y * tile.w * task_pass_stride],
+             tile_row_pointer(buffer, tile, y, task_pass_stride),
+             sizeof(float) * tile.w * task_pass_stride);
+    }
 
-      /* todo: avoid busy wait loop */
-      thread_scoped_lock lock(rpc_lock);
+    map_lock.unlock();
 
-      if (!acquire_queue.empty()) {
-        AcquireEntry entry = acquire_queue.front();
-        acquire_queue.pop_front();
+    thread_scoped_lock send_lock(send_mutex);
+    RPCSend snd(socket, &error_func, "release_tile", &network_stats);
+    snd.add(tile);
+    snd.add(render_time);
+    snd.write();
+    snd.write_buffer_compressed(pixels.data(), pixels.size() * sizeof(float));
 
-        if (entry.name == "release_tile") {
-          lock.unlock();
-          break;
-        }
-        else {
-          cout << "Error: unexpected release RPC receive call \"" + entry.name + "\"\n";
-        }
-      }
-    } while (acquire_queue.empty() && !stop);
+    task_tiles++;
   }
 
   bool task_get_cancel()
   {
-    return false;
+    return task_cancelled || have_error();
   }
 
   /* properties */
@@ -758,6 +944,7 @@ class DeviceServer {
   tcp::socket &socket;
 
   /* mapping of remote to local pointer */
+  thread_mutex map_mutex;
   PtrMap ptr_map;
   PtrMap ptr_imap;
   DataMap mem_data;
@@ -767,11 +954,24 @@ class DeviceServer {
     RenderTile tile;
   };
 
+  /* Tiles received for the render threads. */
   thread_mutex acquire_mutex;
+  thread_mutex queue_mutex;
+  thread_condition_variable queue_cond;
   list<AcquireEntry> acquire_queue;
-
   bool stop;
-  bool blocked_waiting;
+
+  /* Render threads and the receiving thread all send messages. */
+  thread_mutex send_mutex;
+
+  /* Running task, cancelled from the client or by a lost connection. */
+  std::atomic<bool> task_cancelled;
+  int task_pass_stride;
+  int task_tiles;
+  double task_start_time;
+  thread *wait_thread;
+
+  NetworkStats network_stats;
 
  private:
   NetworkError error_func;
@@ -779,16 +979,16 @@ class DeviceServer {
   /* todo: free memory and device (osl) on network error */
 };
 
-void Device::server_run()
+void Device::server_run(int port)
 {
   try {
     /* starts thread that responds to discovery requests */
-    ServerDiscovery discovery;
+    ServerDiscovery discovery(false, port);
 
     for (;;) {
       /* accept connection */
       boost::asio::io_service io_service;
-      tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), SERVER_PORT));
+      tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), port));
 
       tcp::socket socket(io_service);
       acceptor.accept(socket);
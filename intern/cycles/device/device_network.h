@@ -33,10 +33,15 @@
 #  include <iostream>
 #  include <sstream>
 
+#  include <zlib.h>
+
+#  include "device/device.h"
+
 #  include "render/buffers.h"
 
 #  include "util/util_foreach.h"
 #  include "util/util_list.h"
+#  include "util/util_logging.h"
 #  include "util/util_map.h"
 #  include "util/util_param.h"
 #  include "util/util_string.h"
@@ -56,6 +61,10 @@ static const int DISCOVER_PORT = 5121;
 static const string DISCOVER_REQUEST_MSG = "REQUEST_RENDER_SERVER_IP";
 static const string DISCOVER_REPLY_MSG = "REPLY_RENDER_SERVER_IP";
 
+/* Buffers are compressed in chunks of this size, which keeps the temporary memory bounded and
+ * the sizes within the range zlib supports on all platforms. */
+static const size_t COMPRESS_CHUNK_SIZE = 64 * 1024 * 1024;
+
 #  if 0
 typedef boost::archive::text_oarchive o_archive;
 typedef boost::archive::text_iarchive i_archive;
@@ -64,17 +73,24 @@ typedef boost::archive::binary_oarchive o_archive;
 typedef boost::archive::binary_iarchive i_archive;
 #  endif
 
-/* Serialization of device memory */
+/* Serialization of device memory
+ *
+ * Textures need their slot and texture info on the server, so all memory is received as a
+ * texture and the device only looks at the texture members when the type is MEM_TEXTURE. */
 
-class network_device_memory : public device_memory {
+class network_device_memory : public device_texture {
  public:
-  network_device_memory(Device *device) : device_memory(device, "", MEM_READ_ONLY)
+  network_device_memory(Device *device)
+      : device_texture(
+            device, "", 0, IMAGE_DATA_TYPE_FLOAT, INTERPOLATION_NONE, EXTENSION_REPEAT)
   {
   }
 
   ~network_device_memory()
   {
+    /* Memory is owned by the server, not freed along with this description of it. */
     device_pointer = 0;
+    host_pointer = 0;
   };
 
   vector<char> local_data;
@@ -101,7 +117,12 @@ class NetworkError {
 
   bool have_error()
   {
-    return true ? error_count > 0 : false;
+    return error_count > 0;
+  }
+
+  const string &get_error()
+  {
+    return error;
   }
 
  private:
@@ -109,16 +130,43 @@ class NetworkError {
   int error_count;
 };
 
+/* Amount of data exchanged over a connection, for statistics. Buffers are the bulk of the data
+ * (scene arrays and render results), their size is tracked before and after compression. */
+class NetworkStats {
+ public:
+  NetworkStats()
+      : bytes_sent(0), bytes_received(0), buffer_bytes(0), buffer_bytes_compressed(0)
+  {
+  }
+
+  string full_report() const
+  {
+    return string_printf("sent %s, received %s, buffers compressed from %s to %s",
+                         string_human_readable_size(bytes_sent).c_str(),
+                         string_human_readable_size(bytes_received).c_str(),
+                         string_human_readable_size(buffer_bytes).c_str(),
+                         string_human_readable_size(buffer_bytes_compressed).c_str());
+  }
+
+  size_t bytes_sent;
+  size_t bytes_received;
+  size_t buffer_bytes;
+  size_t buffer_bytes_compressed;
+};
+
 /* Remote procedure call Send */
 
 class RPCSend {
  public:
-  RPCSend(tcp::socket &socket_, NetworkError *e, const string &name_ = "")
-      : name(name_), socket(socket_), archive(archive_stream), sent(false)
+  RPCSend(tcp::socket &socket_,
+          NetworkError *e,
+          const string &name_ = "",
+          NetworkStats *stats_ = NULL)
+      : name(name_), socket(socket_), archive(archive_stream), sent(false), stats(stats_)
   {
     archive &name_;
     error_func = e;
-    fprintf(stderr, "rpc send %s\n", name.c_str());
+    VLOG(4) << "RPC send " << name;
   }
 
   ~RPCSend()
@@ -129,9 +177,17 @@ class RPCSend {
   {
     archive &mem.data_type &mem.data_elements &mem.data_size;
     archive &mem.data_width &mem.data_height &mem.data_depth &mem.device_pointer;
-    archive &mem.type &string(mem.name);
-    archive &mem.interpolation &mem.extension;
-    archive &mem.device_pointer;
+    archive &mem.type &string(mem.name ? mem.name : "");
+
+    if (mem.type == MEM_TEXTURE) {
+      const device_texture &tex = (const device_texture &)mem;
+      const TextureInfo &info = tex.info;
+      archive &tex.slot;
+      archive &info.data_type &info.interpolation &info.extension;
+      archive &info.width &info.height &info.depth;
+      archive &info.use_transform_3d;
+      add_transform(info.transform_3d);
+    }
   }
 
   template<typename T> void add(const T &data)
@@ -145,19 +201,37 @@ class RPCSend {
     archive &type &task.x &task.y &task.w &task.h;
     archive &task.rgba_byte &task.rgba_half &task.buffer &task.sample &task.num_samples;
     archive &task.offset &task.stride;
-    archive &task.shader_input &task.shader_output &task.shader_eval_type;
+    archive &task.shader_input &task.shader_output &task.shader_eval_type &task.shader_filter;
     archive &task.shader_x &task.shader_w;
-    archive &task.need_finish_queue;
+    archive &task.tile_types;
+    archive &task.pass_stride &task.frame_stride &task.target_pass_stride;
+    archive &task.pass_denoising_data &task.pass_denoising_clean;
+    archive &task.need_finish_queue &task.integrator_branched;
+    archive &task.adaptive_sampling.use &task.adaptive_sampling.adaptive_step;
+    archive &task.adaptive_sampling.min_samples;
   }
 
   void add(const RenderTile &tile)
   {
-    archive &tile.x &tile.y &tile.w &tile.h;
+    int task = (int)tile.task;
+    archive &task &tile.x &tile.y &tile.w &tile.h;
     archive &tile.start_sample &tile.num_samples &tile.sample;
-    archive &tile.resolution &tile.offset &tile.stride;
+    archive &tile.resolution &tile.offset &tile.stride &tile.tile_index;
     archive &tile.buffer;
   }
 
+  void add(const DeviceRequestedFeatures &features)
+  {
+    archive &features.experimental &features.max_nodes_group &features.nodes_features;
+    archive &features.use_hair &features.use_hair_thick;
+    archive &features.use_object_motion &features.use_camera_motion;
+    archive &features.use_baking &features.use_subsurface &features.use_volume;
+    archive &features.use_integrator_branched &features.use_patch_evaluation;
+    archive &features.use_transparent &features.use_shadow_tricks &features.use_principled;
+    archive &features.use_denoising &features.use_shader_raytrace;
+    archive &features.use_true_displacement &features.use_background_light;
+  }
+
   void write()
   {
     boost::system::error_code error;
@@ -183,10 +257,14 @@ class RPCSend {
     if (error.value())
       error_func->network_error(error.message());
 
+    if (stats) {
+      stats->bytes_sent += header_str.size() + archive_str.size();
+    }
+
     sent = true;
   }
 
-  void write_buffer(void *buffer, size_t size)
+  void write_buffer(const void *buffer, size_t size)
   {
     boost::system::error_code error;
 
@@ -195,23 +273,70 @@ class RPCSend {
 
     if (error.value())
       error_func->network_error(error.message());
+
+    if (stats) {
+      stats->bytes_sent += size;
+    }
+  }
+
+  /* Send a buffer compressed in chunks, each preceded by its compressed size. Render buffers and
+   * most scene arrays compress well, which makes a big difference on slower networks. */
+  void write_buffer_compressed(const void *buffer, size_t size)
+  {
+    vector<uint8_t> compressed;
+
+    for (size_t offset = 0; offset < size; offset += COMPRESS_CHUNK_SIZE) {
+      const size_t chunk_size = std::min(size - offset, COMPRESS_CHUNK_SIZE);
+      uLongf compressed_size = compressBound(chunk_size);
+      compressed.resize(compressed_size);
+
+      if (compress2(compressed.data(),
+                    &compressed_size,
+                    (const Bytef *)buffer + offset,
+                    chunk_size,
+                    Z_BEST_SPEED) != Z_OK) {
+        error_func->network_error("Network send error: failed to compress buffer");
+        return;
+      }
+
+      ostringstream header_stream;
+      header_stream << setw(16) << hex << (size_t)compressed_size;
+      string header_str = header_stream.str();
+
+      write_buffer(header_str.data(), header_str.size());
+      write_buffer(compressed.data(), compressed_size);
+
+      if (stats) {
+        stats->buffer_bytes += chunk_size;
+        stats->buffer_bytes_compressed += compressed_size;
+      }
+    }
   }
 
  protected:
+  void add_transform(const Transform &tfm)
+  {
+    for (int i = 0; i < 3; i++) {
+      const float4 row = (i == 0) ? tfm.x : (i == 1) ? tfm.y : tfm.z;
+      archive &row.x &row.y &row.z &row.w;
+    }
+  }
+
   string name;
   tcp::socket &socket;
   ostringstream archive_stream;
   o_archive archive;
   bool sent;
   NetworkError *error_func;
+  NetworkStats *stats;
 };
 
 /* Remote procedure call Receive */
 
 class RPCReceive {
  public:
-  RPCReceive(tcp::socket &socket_, NetworkError *e)
-      : socket(socket_), archive_stream(NULL), archive(NULL)
+  RPCReceive(tcp::socket &socket_, NetworkError *e, NetworkStats *stats_ = NULL)
+      : socket(socket_), archive_stream(NULL), archive(NULL), stats(stats_)
   {
     error_func = e;
     /* read head with fixed size */
@@ -246,7 +371,11 @@ class RPCReceive {
           archive = new i_archive(*archive_stream);
 
           *archive &name;
-          fprintf(stderr, "rpc receive %s\n", name.c_str());
+          VLOG(4) << "RPC receive " << name;
+
+          if (stats) {
+            stats->bytes_received += header.size() + data_size;
+          }
         }
         else {
           error_func->network_error("Network receive error: data size doesn't match header");
@@ -272,8 +401,15 @@ class RPCReceive {
     *archive &mem.data_type &mem.data_elements &mem.data_size;
     *archive &mem.data_width &mem.data_height &mem.data_depth &mem.device_pointer;
     *archive &mem.type &name;
-    *archive &mem.interpolation &mem.extension;
-    *archive &mem.device_pointer;
+
+    if (mem.type == MEM_TEXTURE) {
+      TextureInfo &info = mem.info;
+      *archive &mem.slot;
+      *archive &info.data_type &info.interpolation &info.extension;
+      *archive &info.width &info.height &info.depth;
+      *archive &info.use_transform_3d;
+      read_transform(info.transform_3d);
+    }
 
     mem.name = name.c_str();
     mem.host_pointer = 0;
@@ -298,8 +434,58 @@ class RPCReceive {
       error_func->network_error(error.message());
     }
 
-    if (len != size)
-      cout << "Network receive error: buffer size doesn't match expected size\n";
+    if (len != size) {
+      error_func->network_error("Network receive error: buffer size doesn't match expected size");
+    }
+
+    if (stats) {
+      stats->bytes_received += len;
+    }
+  }
+
+  /* Receive a buffer sent with RPCSend::write_buffer_compressed(). */
+  void read_buffer_compressed(void *buffer, size_t size)
+  {
+    vector<uint8_t> compressed;
+
+    for (size_t offset = 0; offset < size; offset += COMPRESS_CHUNK_SIZE) {
+      const size_t chunk_size = std::min(size - offset, COMPRESS_CHUNK_SIZE);
+
+      char header[16];
+      read_buffer(header, sizeof(header));
+
+      size_t compressed_size;
+      istringstream header_stream(string(header, sizeof(header)));
+      if (!(header_stream >> hex >> compressed_size)) {
+        error_func->network_error("Network receive error: can't decode compressed size");
+        return;
+      }
+
+      /* Don't trust the size sent over the network, the sender never produces more than this. */
+      if (compressed_size == 0 || compressed_size > compressBound(chunk_size)) {
+        error_func->network_error("Network receive error: invalid compressed size");
+        return;
+      }
+
+      compressed.resize(compressed_size);
+      read_buffer(compressed.data(), compressed_size);
+
+      uLongf uncompressed_size = chunk_size;
+      if (error_func->have_error() ||
+          uncompress((Bytef *)buffer + offset,
+                     &uncompressed_size,
+                     compressed.data(),
+                     compressed_size) != Z_OK ||
+          uncompressed_size != chunk_size) {
+        error_func->network_error("Network receive error: failed to decompress buffer");
+        return;
+      }
+
+      if (stats) {
+        stats->buffer_bytes += chunk_size;
+        stats->buffer_bytes_compressed += compressed_size;
+      }
+    }
   }
 
   void read(DeviceTask &task)
@@ -309,39 +495,67 @@ class RPCReceive {
     *archive &type &task.x &task.y &task.w &task.h;
     *archive &task.rgba_byte &task.rgba_half &task.buffer &task.sample &task.num_samples;
     *archive &task.offset &task.stride;
-    *archive &task.shader_input &task.shader_output &task.shader_eval_type;
+    *archive &task.shader_input &task.shader_output &task.shader_eval_type &task.shader_filter;
     *archive &task.shader_x &task.shader_w;
-    *archive &task.need_finish_queue;
+    *archive &task.tile_types;
+    *archive &task.pass_stride &task.frame_stride &task.target_pass_stride;
+    *archive &task.pass_denoising_data &task.pass_denoising_clean;
+    *archive &task.need_finish_queue &task.integrator_branched;
+    *archive &task.adaptive_sampling.use &task.adaptive_sampling.adaptive_step;
+    *archive &task.adaptive_sampling.min_samples;
 
     task.type = (DeviceTask::Type)type;
   }
 
   void read(RenderTile &tile)
   {
-    *archive &tile.x &tile.y &tile.w &tile.h;
+    int task;
+    *archive &task &tile.x &tile.y &tile.w &tile.h;
     *archive &tile.start_sample &tile.num_samples &tile.sample;
-    *archive &tile.resolution &tile.offset &tile.stride;
+    *archive &tile.resolution &tile.offset &tile.stride &tile.tile_index;
     *archive &tile.buffer;
 
+    tile.task = (RenderTile::Task)task;
     tile.buffers = NULL;
   }
 
+  void read(DeviceRequestedFeatures &features)
+  {
+    *archive &features.experimental &features.max_nodes_group &features.nodes_features;
+    *archive &features.use_hair &features.use_hair_thick;
+    *archive &features.use_object_motion &features.use_camera_motion;
+    *archive &features.use_baking &features.use_subsurface &features.use_volume;
+    *archive &features.use_integrator_branched &features.use_patch_evaluation;
+    *archive &features.use_transparent &features.use_shadow_tricks &features.use_principled;
+    *archive &features.use_denoising &features.use_shader_raytrace;
+    *archive &features.use_true_displacement &features.use_background_light;
+  }
+
   string name;
 
  protected:
+  void read_transform(Transform &tfm)
+  {
+    for (int i = 0; i < 3; i++) {
+      float4 &row = (i == 0) ? tfm.x : (i == 1) ? tfm.y : tfm.z;
+      *archive &row.x &row.y &row.z &row.w;
+    }
+  }
+
   tcp::socket &socket;
   string archive_str;
   istringstream *archive_stream;
   i_archive *archive;
   NetworkError *error_func;
+  NetworkStats *stats;
 };
 
 /* Server auto discovery */
 
 class ServerDiscovery {
  public:
-  explicit ServerDiscovery(bool discover = false)
-      : listen_socket(io_service), collect_servers(false)
+  explicit ServerDiscovery(bool discover = false, int server_port_ = SERVER_PORT)
+      : listen_socket(io_service), collect_servers(false), server_port(server_port_)
   {
     /* setup listen socket */
     listen_endpoint.address(boost::asio::ip::address_v4::any());
@@ -402,8 +616,14 @@ class ServerDiscovery {
 
       /* handle incoming message */
       if (collect_servers) {
-        if (msg == DISCOVER_REPLY_MSG) {
-          string address = receive_endpoint.address().to_string();
+        /* Replies are followed by the port the server listens on, so that multiple servers can
+         * run on the same host. */
+        if (string_startswith(msg, DISCOVER_REPLY_MSG.c_str())) {
+          string port = string_strip(msg.substr(DISCOVER_REPLY_MSG.size()));
+          if (port.empty()) {
+            port = string_printf("%d", SERVER_PORT);
+          }
+          string address = receive_endpoint.address().to_string() + ":" + port;
 
           mutex.lock();
 
@@ -419,7 +639,7 @@ class ServerDiscovery {
       else {
         /* reply to request */
         if (msg == DISCOVER_REQUEST_MSG)
-          broadcast_message(DISCOVER_REPLY_MSG);
+          broadcast_message(string_printf("%s %d", DISCOVER_REPLY_MSG.c_str(), server_port));
       }
     }
 
@@ -481,6 +701,9 @@ class ServerDiscovery {
   /* collection of server addresses in list */
   bool collect_servers;
   vector<string> servers;
+
+  /* port advertised in replies to discovery requests */
+  int server_port;
 };
 
 CCL_NAMESPACE_END
@@ -28,6 +28,69 @@ ccl_device_forceinline Transform bvh_unaligned_node_fetch_space(KernelGlobals *k
   return space;
 }
 
+/* Quantized nodes store the child bounds as 8 bit offsets from the lower corner of the node,
+ * scaled by a power of two per axis. */
+ccl_device_forceinline float bvh_quantized_node_bound(const float lower,
+                                                      const float scale,
+                                                      const uint bounds,
+                                                      const int i)
+{
+  return lower + (float)((bounds >> (i * 8)) & 0xff) * scale;
+}
+
+ccl_device_forceinline int bvh_quantized_node_intersect(KernelGlobals *kg,
+                                                        const float3 P,
+                                                        const float3 idir,
+                                                        const float t,
+                                                        const int node_addr,
+                                                        const uint visibility,
+                                                        float dist[2])
+{
+  /* fetch node data */
+#ifdef __VISIBILITY_FLAG__
+  float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+#endif
+  float4 node0 = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+  float4 node1 = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
+
+  const uint exponents = __float_as_uint(node0.w);
+  const float scale_x = __uint_as_float((exponents & 0xff) << 23);
+  const float scale_y = __uint_as_float(((exponents >> 8) & 0xff) << 23);
+  const float scale_z = __uint_as_float(((exponents >> 16) & 0xff) << 23);
+  const uint bounds_x = __float_as_uint(node1.x);
+  const uint bounds_y = __float_as_uint(node1.y);
+  const uint bounds_z = __float_as_uint(node1.z);
+
+  /* intersect ray against child nodes */
+  float c0lox = (bvh_quantized_node_bound(node0.x, scale_x, bounds_x, 0) - P.x) * idir.x;
+  float c0hix = (bvh_quantized_node_bound(node0.x, scale_x, bounds_x, 2) - P.x) * idir.x;
+  float c0loy = (bvh_quantized_node_bound(node0.y, scale_y, bounds_y, 0) - P.y) * idir.y;
+  float c0hiy = (bvh_quantized_node_bound(node0.y, scale_y, bounds_y, 2) - P.y) * idir.y;
+  float c0loz = (bvh_quantized_node_bound(node0.z, scale_z, bounds_z, 0) - P.z) * idir.z;
+  float c0hiz = (bvh_quantized_node_bound(node0.z, scale_z, bounds_z, 2) - P.z) * idir.z;
+  float c0min = max4(0.0f, min(c0lox, c0hix), min(c0loy, c0hiy), min(c0loz, c0hiz));
+  float c0max = min4(t, max(c0lox, c0hix), max(c0loy, c0hiy), max(c0loz, c0hiz));
+
+  float c1lox = (bvh_quantized_node_bound(node0.x, scale_x, bounds_x, 1) - P.x) * idir.x;
+  float c1hix = (bvh_quantized_node_bound(node0.x, scale_x, bounds_x, 3) - P.x) * idir.x;
+  float c1loy = (bvh_quantized_node_bound(node0.y, scale_y, bounds_y, 1) - P.y) * idir.y;
+  float c1hiy = (bvh_quantized_node_bound(node0.y, scale_y, bounds_y, 3) - P.y) * idir.y;
+  float c1loz = (bvh_quantized_node_bound(node0.z, scale_z, bounds_z, 1) - P.z) * idir.z;
+  float c1hiz = (bvh_quantized_node_bound(node0.z, scale_z, bounds_z, 3) - P.z) * idir.z;
+  float c1min = max4(0.0f, min(c1lox, c1hix), min(c1loy, c1hiy), min(c1loz, c1hiz));
+  float c1max = min4(t, max(c1lox, c1hix), max(c1loy, c1hiy), max(c1loz, c1hiz));
+
+  dist[0] = c0min;
+  dist[1] = c1min;
+
+#ifdef __VISIBILITY_FLAG__
+  return (((c0max >= c0min) && (__float_as_uint(cnodes.x) & visibility)) ? 1 : 0) |
+         (((c1max >= c1min) && (__float_as_uint(cnodes.y) & visibility)) ? 2 : 0);
+#else
+  return ((c0max >= c0min) ? 1 : 0) | ((c1max >= c1min) ? 2 : 0);
+#endif
+}
+
 ccl_device_forceinline int bvh_aligned_node_intersect(KernelGlobals *kg,
                                                       const float3 P,
                                                       const float3 idir,
@@ -36,11 +99,11 @@ ccl_device_forceinline int bvh_aligned_node_intersect(KernelGlobals *kg,
                                                       const uint visibility,
                                                       float dist[2])
 {
-
   /* fetch node data */
-#ifdef __VISIBILITY_FLAG__
   float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
-#endif
+  if (__float_as_uint(cnodes.x) & PATH_RAY_NODE_QUANTIZED) {
+    return bvh_quantized_node_intersect(kg, P, idir, t, node_addr, visibility, dist);
+  }
   float4 node0 = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
   float4 node1 = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
   float4 node2 = kernel_tex_fetch(__bvh_nodes, node_addr + 3);
@@ -54,7 +54,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
   }
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-  /* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
   /* bitonic sort */
@@ -77,6 +76,40 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       }
     }
   }
+#  else
+  /* On the CPU the local size is 1, a single thread sorts the whole block.
+   * Bottom-up merge sort, stable so that rays of the same shader keep their order. */
+  ushort sorted_index[SHADER_SORT_BLOCK_SIZE];
+  ushort *src = local_index;
+  ushort *dst = sorted_index;
+
+  for (uint width = 1; width < SHADER_SORT_BLOCK_SIZE; width <<= 1) {
+    for (uint start = 0; start < SHADER_SORT_BLOCK_SIZE; start += 2 * width) {
+      const uint mid = start + width;
+      const uint end = start + 2 * width;
+      uint i = start, j = mid, k = start;
+
+      while (i < mid && j < end) {
+        dst[k++] = (local_value[src[j]] < local_value[src[i]]) ? src[j++] : src[i++];
+      }
+      while (i < mid) {
+        dst[k++] = src[i++];
+      }
+      while (j < end) {
+        dst[k++] = src[j++];
+      }
+    }
+
+    ushort *tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+
+  if (src != local_index) {
+    for (uint i = 0; i < SHADER_SORT_BLOCK_SIZE; i++) {
+      local_index[i] = src[i];
+    }
+  }
 #  endif /* __KERNEL_OPENCL__ */
 
   /* copy to destination */
@@ -134,6 +134,7 @@ RenderBuffers::RenderBuffers(Device *device)
       map_neighbor_copied(false),
       render_time(0.0f)
 {
+  buffer.host_updated_by_tiles = true;
 }
 
 RenderBuffers::~RenderBuffers()
@@ -298,8 +299,15 @@ bool RenderBuffers::get_pass_rect(
 
     int size = params.width * params.height;
 
-    if (components == 1 && type == PASS_RENDER_TIME) {
-      /* Render time is not stored by kernel, but measured per tile. */
+    if (components == 1 && type == PASS_RENDER_TIME &&
+        buffer.device->info.type == DEVICE_CPU) {
+      /* Render time in milliseconds accumulated per pixel by the CPU device. */
+      for (int i = 0; i < size; i++, in += pass_stride, pixels++) {
+        pixels[0] = *in * scale;
+      }
+    }
+    else if (components == 1 && type == PASS_RENDER_TIME) {
+      /* Render time is not stored by other devices, but measured per tile. */
       float val = (float)(1000.0 * render_time / (params.width * params.height * sample));
       for (int i = 0; i < size; i++, pixels++) {
         pixels[0] = val;
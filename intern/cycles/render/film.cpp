@@ -204,8 +204,9 @@ void Pass::add(PassType type, vector<Pass> &passes, const char *name)
       break;
 #endif
     case PASS_RENDER_TIME:
-      /* This pass is handled entirely on the host side. */
-      pass.components = 0;
+      /* Written by the CPU device only, other devices use the per tile render time. */
+      pass.components = 1;
+      pass.exposure = false;
       break;
 
     case PASS_DIFFUSE_COLOR:
@@ -432,6 +433,7 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 
   kfilm->light_pass_flag = 0;
   kfilm->pass_stride = 0;
+  kfilm->pass_render_time = 0;
   kfilm->use_light_pass = use_light_visibility;
   kfilm->pass_aov_value_num = 0;
   kfilm->pass_aov_color_num = 0;
@@ -566,6 +568,7 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
         break;
 #endif
       case PASS_RENDER_TIME:
+        kfilm->pass_render_time = kfilm->pass_stride;
         break;
       case PASS_CRYPTOMATTE:
         kfilm->pass_cryptomatte = have_cryptomatte ?
@@ -203,15 +203,25 @@ void Geometry::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    bool rebuild = (bvh == NULL) || need_update_rebuild;
+
+    if (!rebuild) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
       bvh->objects = objects;
 
       bvh->refit(*progress);
+
+      /* The tree gets worse as the geometry deforms, rebuild it once refitting is not worth it
+       * anymore. */
+      if (bvh->need_rebuild_after_refit()) {
+        VLOG(1) << "BVH of " << name << " degraded by refitting, rebuilding.";
+        rebuild = true;
+      }
     }
-    else {
+
+    if (rebuild) {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
@@ -219,9 +229,12 @@ void Geometry::compute_bvh(
       bparams.bvh_layout = bvh_layout;
       bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                     params->use_bvh_unaligned_nodes;
+      bparams.use_compact_nodes = params->use_bvh_compact_nodes;
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
+      bparams.use_fast_build = (params->bvh_type == SceneParams::BVH_DYNAMIC &&
+                                !params->background);
       bparams.curve_subdivisions = params->curve_subdivisions();
 
       delete bvh;
@@ -1143,9 +1156,12 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
   bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                 scene->params.use_bvh_unaligned_nodes;
+  bparams.use_compact_nodes = scene->params.use_bvh_compact_nodes;
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
+  bparams.use_fast_build = (scene->params.bvh_type == SceneParams::BVH_DYNAMIC &&
+                            !scene->params.background);
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
 
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
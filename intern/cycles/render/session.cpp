@@ -407,8 +407,8 @@ bool Session::acquire_tile(RenderTile &rtile, Device *tile_device, uint tile_typ
   rtile.y = tile_manager.state.buffer.full_y + tile->y;
   rtile.w = tile->w;
   rtile.h = tile->h;
-  rtile.start_sample = tile_manager.state.sample;
-  rtile.num_samples = tile_manager.state.num_samples;
+  rtile.start_sample = tile_manager.state.sample + tile->sample_offset;
+  rtile.num_samples = (tile->num_samples) ? tile->num_samples : tile_manager.state.num_samples;
   rtile.resolution = tile_manager.state.resolution_divider;
   rtile.tile_index = tile->index;
 
@@ -422,7 +422,13 @@ bool Session::acquire_tile(RenderTile &rtile, Device *tile_device, uint tile_typ
     rtile.task = RenderTile::PATH_TRACE;
   }
 
-  tile_lock.unlock();
+  /* Pieces of a split tile render into the buffers of the tile, unless they render a separate
+   * range of samples. Keep the lock while setting up shared buffers. */
+  Tile *buffers_tile = tile->has_own_buffers() ? tile : &tile_manager.state.tiles[tile->parent];
+
+  if (tile->has_own_buffers()) {
+    tile_lock.unlock();
+  }
 
   /* in case of a permanent buffer, return it, otherwise we will allocate
    * a new temporary buffer */
@@ -446,26 +452,30 @@ bool Session::acquire_tile(RenderTile &rtile, Device *tile_device, uint tile_typ
     return true;
   }
 
-  if (tile->buffers == NULL) {
+  if (buffers_tile->buffers == NULL) {
     /* fill buffer parameters */
     BufferParams buffer_params = tile_manager.params;
-    buffer_params.full_x = rtile.x;
-    buffer_params.full_y = rtile.y;
-    buffer_params.width = rtile.w;
-    buffer_params.height = rtile.h;
+    buffer_params.full_x = tile_manager.state.buffer.full_x + buffers_tile->x;
+    buffer_params.full_y = tile_manager.state.buffer.full_y + buffers_tile->y;
+    buffer_params.width = buffers_tile->w;
+    buffer_params.height = buffers_tile->h;
 
     /* allocate buffers */
-    tile->buffers = new RenderBuffers(tile_device);
-    tile->buffers->reset(buffer_params);
+    buffers_tile->buffers = new RenderBuffers(tile_device);
+    buffers_tile->buffers->reset(buffer_params);
   }
 
-  tile->buffers->map_neighbor_copied = false;
+  buffers_tile->buffers->map_neighbor_copied = false;
 
-  tile->buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+  buffers_tile->buffers->params.get_offset_stride(rtile.offset, rtile.stride);
 
-  rtile.buffer = tile->buffers->buffer.device_pointer;
-  rtile.buffers = tile->buffers;
-  rtile.sample = tile_manager.state.sample;
+  rtile.buffer = buffers_tile->buffers->buffer.device_pointer;
+  rtile.buffers = buffers_tile->buffers;
+  rtile.sample = rtile.start_sample;
+
+  if (tile_lock.owns_lock()) {
+    tile_lock.unlock();
+  }
 
   if (read_bake_tile_cb) {
     /* This will read any passes needed as input for baking. */
@@ -489,7 +499,11 @@ void Session::update_tile_sample(RenderTile &rtile)
 {
   thread_scoped_lock tile_lock(tile_mutex);
 
-  if (update_render_tile_cb) {
+  /* Pieces only have part of the result, it is shown once the tile is finished. Pieces of a
+   * spatial split also share the buffers of the whole tile, which do not fit the piece rect. */
+  const Tile &tile = tile_manager.state.tiles[rtile.tile_index];
+
+  if (update_render_tile_cb && tile.parent == -1) {
     if (params.progressive_refine == false) {
       /* todo: optimize this by making it thread safe and removing lock */
 
@@ -504,6 +518,14 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
 {
   thread_scoped_lock tile_lock(tile_mutex);
 
+  if (tile_manager.state.tiles[rtile.tile_index].parent != -1) {
+    /* The tile a piece is part of is finished along with its last piece. */
+    if (!release_tile_piece(rtile)) {
+      update_status_time();
+      return;
+    }
+  }
+
   progress.add_finished_tile(rtile.task == RenderTile::DENOISE);
 
   bool delete_tile;
@@ -532,6 +554,54 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
   denoising_cond.notify_all();
 }
 
+/* Returns whether this was the last piece of its tile, in which case the render tile is changed
+ * to the entire tile, with the samples rendered separately added to it. */
+bool Session::release_tile_piece(RenderTile &rtile)
+{
+  if (!tile_manager.finish_piece(rtile.tile_index)) {
+    return false;
+  }
+
+  Tile &tile = tile_manager.state.tiles[tile_manager.state.tiles[rtile.tile_index].parent];
+  RenderBuffers *tile_buffers = tile.buffers;
+  const int pass_stride = tile_buffers->params.get_passes_size();
+
+  /* Only done now that no piece renders into the tile buffers anymore. Tiles are only split for
+   * CPU rendering, so there is no need to copy buffers from the device. */
+  for (size_t i = tile_manager.state.num_tiles; i < tile_manager.state.tiles.size(); i++) {
+    Tile &piece = tile_manager.state.tiles[i];
+    if (piece.parent != tile.index || piece.buffers == NULL) {
+      continue;
+    }
+
+    for (int y = 0; y < piece.h; y++) {
+      const float *src = piece.buffers->buffer.data() + (size_t)y * piece.w * pass_stride;
+      float *dst = tile_buffers->buffer.data() +
+                   ((size_t)(piece.y - tile.y + y) * tile.w + (piece.x - tile.x)) * pass_stride;
+      for (int j = 0; j < piece.w * pass_stride; j++) {
+        dst[j] += src[j];
+      }
+    }
+
+    delete piece.buffers;
+    piece.buffers = NULL;
+  }
+
+  rtile.x = tile_manager.state.buffer.full_x + tile.x;
+  rtile.y = tile_manager.state.buffer.full_y + tile.y;
+  rtile.w = tile.w;
+  rtile.h = tile.h;
+  rtile.tile_index = tile.index;
+  rtile.start_sample = tile_manager.state.sample;
+  rtile.num_samples = tile_manager.state.num_samples;
+  rtile.sample = rtile.start_sample + rtile.num_samples;
+  rtile.buffers = tile_buffers;
+  rtile.buffer = tile_buffers->buffer.device_pointer;
+  tile_buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+
+  return true;
+}
+
 void Session::map_neighbor_tiles(RenderTileNeighbors &neighbors, Device *tile_device)
 {
   thread_scoped_lock tile_lock(tile_mutex);
@@ -802,6 +872,14 @@ bool Session::draw(BufferParams &buffer_params, DeviceDrawParams &draw_params)
 
 void Session::reset_(BufferParams &buffer_params, int samples)
 {
+  /* Split the last tiles of final renders on the CPU, to keep all threads busy until the frame
+   * is done. Pieces render into the buffers of their tile, which need to be on the host. */
+  const bool split_tiles = params.background && !params.progressive_refine && !buffers &&
+                           params.device.type == DEVICE_CPU && !read_bake_tile_cb &&
+                           !tile_manager.schedule_denoising;
+  tile_manager.split_num_threads = (split_tiles) ? TaskScheduler::num_threads() : 0;
+  tile_manager.split_samples = split_tiles && !params.adaptive_sampling;
+
   if (buffers && buffer_params.modified(tile_manager.params)) {
     gpu_draw_ready = false;
     buffers->reset(buffer_params);
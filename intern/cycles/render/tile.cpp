@@ -22,6 +22,13 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Tiles are not split into pieces smaller than this size or number of samples. */
+static const int SPLIT_MIN_SIZE = 16;
+static const int SPLIT_MIN_SAMPLES = 8;
+
+/* Pieces are stored after the tiles, room is reserved for this many pieces per thread. */
+static const int SPLIT_MAX_PIECES_PER_THREAD = 64;
+
 namespace {
 
 class TileComparator {
@@ -107,6 +114,8 @@ TileManager::TileManager(bool progressive_,
   preserve_tile_device = preserve_tile_device_;
   background = background_;
   schedule_denoising = false;
+  split_num_threads = 0;
+  split_samples = false;
 
   range_start_sample = 0;
   range_num_samples = -1;
@@ -121,7 +130,7 @@ TileManager::~TileManager()
 
 void TileManager::device_free()
 {
-  if (schedule_denoising || progressive) {
+  if (schedule_denoising || progressive || split_num_threads > 0) {
     for (int i = 0; i < state.tiles.size(); i++) {
       delete state.tiles[i].buffers;
       state.tiles[i].buffers = NULL;
@@ -382,6 +391,12 @@ void TileManager::set_tiles()
 
   state.num_tiles = gen_tiles(!background);
 
+  /* Make room for the pieces of split tiles up front, pointers to tiles have to remain valid
+   * while other threads are rendering them. */
+  if (split_num_threads > 0) {
+    state.tiles.reserve(state.num_tiles + split_num_threads * SPLIT_MAX_PIECES_PER_THREAD);
+  }
+
   state.buffer.width = image_w;
   state.buffer.height = image_h;
 
@@ -542,8 +557,14 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
         }
       }
 
-      tile_index = state.render_tiles[logical_device].front();
-      state.render_tiles[logical_device].pop_front();
+      /* Near the end of the render, split the remaining tiles so that there is work left for
+       * the threads that would otherwise be idle until the last tiles are done. */
+      list<int> &tile_list = state.render_tiles[logical_device];
+      while (tile_list.size() < (size_t)split_num_threads && split_tile(tile_list)) {
+      }
+
+      tile_index = tile_list.front();
+      tile_list.pop_front();
       break;
     }
 
@@ -556,6 +577,103 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
   return false;
 }
 
+/* Sample ranges rendered separately can only be added together when all passes accumulate. */
+static bool passes_accumulate(const BufferParams &params)
+{
+  if (params.denoising_data_pass) {
+    return false;
+  }
+  foreach (const Pass &pass, params.passes) {
+    if (pass.type == PASS_CRYPTOMATTE || pass.type == PASS_ADAPTIVE_AUX_BUFFER) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Replace the tile at the front of the list with pieces of it. Tiles are split in half along
+ * each axis until they get too small, then in ranges of samples if enabled.
+ * Returns false when the tile can't be split. */
+bool TileManager::split_tile(list<int> &tile_list)
+{
+  if (tile_list.empty() || state.tiles.size() + 4 > state.tiles.capacity()) {
+    return false;
+  }
+
+  const int index = tile_list.front();
+  const Tile tile = state.tiles[index];
+  const int parent = (tile.parent != -1) ? tile.parent : index;
+  const int num_samples = (tile.num_samples) ? tile.num_samples : state.num_samples;
+
+  vector<Tile> pieces;
+
+  const int num_x = (tile.w >= 2 * SPLIT_MIN_SIZE) ? 2 : 1;
+  const int num_y = (tile.h >= 2 * SPLIT_MIN_SIZE) ? 2 : 1;
+
+  if (num_x * num_y > 1) {
+    for (int j = 0; j < num_y; j++) {
+      for (int i = 0; i < num_x; i++) {
+        const int x = tile.x + (tile.w * i) / num_x;
+        const int y = tile.y + (tile.h * j) / num_y;
+        const int w = tile.x + (tile.w * (i + 1)) / num_x - x;
+        const int h = tile.y + (tile.h * (j + 1)) / num_y - y;
+
+        Tile piece(0, x, y, w, h, tile.device, Tile::RENDER);
+        piece.sample_offset = tile.sample_offset;
+        piece.num_samples = tile.num_samples;
+        pieces.push_back(piece);
+      }
+    }
+  }
+  else if (split_samples && num_samples >= 2 * SPLIT_MIN_SAMPLES && passes_accumulate(params)) {
+    const int half_samples = num_samples / 2;
+
+    Tile piece(0, tile.x, tile.y, tile.w, tile.h, tile.device, Tile::RENDER);
+    piece.sample_offset = tile.sample_offset;
+    piece.num_samples = half_samples;
+    pieces.push_back(piece);
+
+    piece.sample_offset = tile.sample_offset + half_samples;
+    piece.num_samples = num_samples - half_samples;
+    pieces.push_back(piece);
+  }
+  else {
+    return false;
+  }
+
+  tile_list.pop_front();
+
+  if (tile.parent != -1) {
+    /* A piece split again is replaced by its own pieces. */
+    state.tiles[index].state = Tile::DONE;
+    state.tiles[parent].num_pieces += pieces.size() - 1;
+  }
+  else {
+    state.tiles[parent].num_pieces = pieces.size();
+  }
+
+  for (int i = pieces.size() - 1; i >= 0; i--) {
+    Tile &piece = pieces[i];
+    piece.index = state.tiles.size();
+    piece.parent = parent;
+    state.tiles.push_back(piece);
+    tile_list.push_front(piece.index);
+  }
+
+  return true;
+}
+
+/* Returns whether this was the last piece of its parent tile, which is finished now. */
+bool TileManager::finish_piece(const int index)
+{
+  Tile &piece = state.tiles[index];
+  assert(piece.parent != -1);
+
+  piece.state = Tile::DONE;
+
+  return --state.tiles[piece.parent].num_pieces == 0;
+}
+
 bool TileManager::done()
 {
   int end_sample = (range_num_samples == -1) ? num_samples :
@@ -40,13 +40,40 @@ class Tile {
   State state;
   RenderBuffers *buffers;
 
+  /* Tiles split at the end of a render are rendered as pieces. Pieces keep the index of the tile
+   * they are part of, which is finished once all of its pieces are rendered. */
+  int parent;
+  int num_pieces;
+
+  /* Samples to render relative to the tile manager state, all of them when num_samples is zero.
+   * Pieces with a sample offset render into their own buffers, which are added to the buffers of
+   * the parent tile afterwards. */
+  int sample_offset;
+  int num_samples;
+
   Tile()
   {
   }
 
   Tile(int index_, int x_, int y_, int w_, int h_, int device_, State state_ = RENDER)
-      : index(index_), x(x_), y(y_), w(w_), h(h_), device(device_), state(state_), buffers(NULL)
+      : index(index_),
+        x(x_),
+        y(y_),
+        w(w_),
+        h(h_),
+        device(device_),
+        state(state_),
+        buffers(NULL),
+        parent(-1),
+        num_pieces(0),
+        sample_offset(0),
+        num_samples(0)
+  {
+  }
+
+  bool has_own_buffers() const
   {
+    return parent == -1 || sample_offset != 0;
   }
 };
 
@@ -108,6 +135,7 @@ class TileManager {
   bool next();
   bool next_tile(Tile *&tile, int device, uint tile_types);
   bool finish_tile(const int index, const bool need_denoise, bool &delete_tile);
+  bool finish_piece(const int index);
   bool done();
   bool has_tiles();
 
@@ -133,6 +161,16 @@ class TileManager {
   /* Schedule tiles for denoising after they've been rendered. */
   bool schedule_denoising;
 
+  /* ** Tile splitting. ** */
+
+  /* Once fewer tiles than this are left to render, the remaining ones are split into smaller
+   * pieces so that render threads running out of work can help finishing the frame.
+   * Zero disables splitting. */
+  int split_num_threads;
+
+  /* Split tiles too small to be split any further into ranges of samples. */
+  bool split_samples;
+
  protected:
   void set_tiles();
 
@@ -165,6 +203,8 @@ class TileManager {
   /* Generate tile list, return number of tiles. */
   int gen_tiles(bool sliced);
   void gen_render_tiles();
+
+  bool split_tile(list<int> &tile_list);
 };
 
 CCL_NAMESPACE_END
@@ -59,7 +59,10 @@ void DebugFlags::CPU::reset()
 
   bvh_layout = BVH_LAYOUT_AUTO;
 
-  split_kernel = false;
+  split_kernel = (getenv("CYCLES_CPU_SPLIT_KERNEL") != NULL);
+  if (split_kernel) {
+    VLOG(1) << "Using CPU split kernel.";
+  }
 }
 
 DebugFlags::CUDA::CUDA() : adaptive_compile(false), split_kernel(false)
@@ -226,9 +226,22 @@ void MEM_use_memleak_detection(bool enabled);
  * tests. */
 void MEM_enable_fail_on_memleak(void);
 
+/* Switch allocator to fast mode, with less tracking.
+ *
+ * Use in the `main()` function before any allocation is done, or when the guarded allocator was
+ * enabled and all blocks of it are freed again, e.g. in tests. */
+void MEM_use_lockfree_allocator(void);
+
 /* Switch allocator to slower but fully guarded mode. */
 void MEM_use_guarded_allocator(void);
 
+/**
+ * Serve small allocations of the lock-free allocator from size-class pools with per-thread
+ * caches. Blocks remember where they came from, so this can be toggled at any time.
+ * Pooled memory is kept for reuse and not returned to the system.
+ */
+void MEM_use_small_object_pool(bool enabled);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -95,6 +95,35 @@ void aligned_free(void *ptr)
 #endif
 }
 
+void MEM_use_lockfree_allocator(void)
+{
+  MEM_allocN_len = MEM_lockfree_allocN_len;
+  MEM_freeN = MEM_lockfree_freeN;
+  MEM_dupallocN = MEM_lockfree_dupallocN;
+  MEM_reallocN_id = MEM_lockfree_reallocN_id;
+  MEM_recallocN_id = MEM_lockfree_recallocN_id;
+  MEM_callocN = MEM_lockfree_callocN;
+  MEM_calloc_arrayN = MEM_lockfree_calloc_arrayN;
+  MEM_mallocN = MEM_lockfree_mallocN;
+  MEM_malloc_arrayN = MEM_lockfree_malloc_arrayN;
+  MEM_mallocN_aligned = MEM_lockfree_mallocN_aligned;
+  MEM_printmemlist_pydict = MEM_lockfree_printmemlist_pydict;
+  MEM_printmemlist = MEM_lockfree_printmemlist;
+  MEM_callbackmemlist = MEM_lockfree_callbackmemlist;
+  MEM_printmemlist_stats = MEM_lockfree_printmemlist_stats;
+  MEM_set_error_callback = MEM_lockfree_set_error_callback;
+  MEM_consistency_check = MEM_lockfree_consistency_check;
+  MEM_set_memory_debug = MEM_lockfree_set_memory_debug;
+  MEM_get_memory_in_use = MEM_lockfree_get_memory_in_use;
+  MEM_get_memory_blocks_in_use = MEM_lockfree_get_memory_blocks_in_use;
+  MEM_reset_peak_memory = MEM_lockfree_reset_peak_memory;
+  MEM_get_peak_memory = MEM_lockfree_get_peak_memory;
+
+#ifndef NDEBUG
+  MEM_name_ptr = MEM_lockfree_name_ptr;
+#endif
+}
+
 void MEM_use_guarded_allocator(void)
 {
   MEM_allocN_len = MEM_guarded_allocN_len;
@@ -123,3 +152,9 @@ void MEM_use_guarded_allocator(void)
   MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_small_object_pool(bool enabled)
+{
+  /* The guarded allocator has no pool, its functions never look at this. */
+  MEM_lockfree_use_small_object_pool(enabled);
+}
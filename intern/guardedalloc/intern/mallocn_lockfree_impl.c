@@ -20,7 +20,9 @@
  * Memory allocation which keeps track on allocated memory counters
  */
 
+#include <pthread.h>
 #include <stdarg.h>
+#include <stddef.h> /* ptrdiff_t */
 #include <stdlib.h>
 #include <string.h> /* memcpy */
 #include <sys/types.h>
@@ -43,20 +45,31 @@ typedef struct MemHeadAligned {
   size_t len;
 } MemHeadAligned;
 
-static unsigned int totblock = 0;
-static size_t mem_in_use = 0, peak_mem = 0;
+/* Memory in use as published by the threads, see #memory_usage_publish. */
+static size_t mem_in_use_published = 0, peak_mem = 0;
 static bool malloc_debug_memset = false;
+static bool use_small_object_pool = false;
 
 static void (*error_callback)(const char *) = NULL;
 
 enum {
   MEMHEAD_ALIGN_FLAG = 1,
+  MEMHEAD_POOL_FLAG = 2,
 };
 
+#define MEMHEAD_FLAGS ((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_POOL_FLAG))
+
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_POOL(memhead) ((memhead)->len & (size_t)MEMHEAD_POOL_FLAG)
+
+#ifdef _MSC_VER
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#  define MEM_THREAD_LOCAL __thread
+#endif
 
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
@@ -70,6 +83,333 @@ MEM_INLINE void update_maximum(size_t *maximum_value, size_t value)
 #endif
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Per-Thread State
+ *
+ * Block and byte counters are kept per thread, so allocating does not write to a cache line
+ * shared by all threads. Totals are summed over all thread states on demand.
+ *
+ * Thread states are never freed: when a thread exits its state is marked unused and handed to
+ * the next new thread, counters included. Blocks freed by another thread than the one which
+ * allocated them make the counters of a single state meaningless, only their sum is exact.
+ * \{ */
+
+/* Bytes a thread may allocate or free before publishing them to #mem_in_use_published. */
+#define MEM_PUBLISH_THRESHOLD ((size_t)256 * 1024)
+
+/* Size classes of the small object pool, class `i` holds blocks of `(i + 1) * stride` bytes,
+ * including the #MemHead. */
+#define MEM_POOL_CLASS_STRIDE ((size_t)16)
+#define MEM_POOL_CLASS_NUM 32
+#define MEM_POOL_MAX_LEN (MEM_POOL_CLASS_NUM * MEM_POOL_CLASS_STRIDE - sizeof(MemHead))
+/* Blocks of a class are carved from slabs of this size. */
+#define MEM_POOL_SLAB_SIZE ((size_t)64 * 1024)
+/* Number of blocks moved at once between a thread cache and the shared free lists. */
+#define MEM_POOL_BATCH_NUM 64u
+
+typedef struct MemPoolBlock {
+  struct MemPoolBlock *next;
+} MemPoolBlock;
+
+typedef struct MemPoolFreeList {
+  MemPoolBlock *first;
+  unsigned int num;
+} MemPoolFreeList;
+
+typedef struct MemThreadState {
+  struct MemThreadState *next;
+  /* Wrapping counters, their sum over all thread states is the total in use. */
+  size_t mem_in_use;
+  unsigned int totblock;
+  /* Part of #mem_in_use which was added to #mem_in_use_published. */
+  size_t mem_published;
+  bool is_used;
+  MemPoolFreeList pool_cache[MEM_POOL_CLASS_NUM];
+} MemThreadState;
+
+static MemThreadState *thread_states = NULL;
+static pthread_mutex_t thread_states_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t thread_state_key;
+static pthread_once_t thread_state_key_once = PTHREAD_ONCE_INIT;
+static MEM_THREAD_LOCAL MemThreadState *thread_state = NULL;
+
+/* Free blocks shared between threads, and the total size of all slabs. */
+static MemPoolFreeList pool_free[MEM_POOL_CLASS_NUM];
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t pool_reserved = 0;
+
+static void pool_cache_flush(MemThreadState *state);
+
+static void thread_state_release(void *state_v)
+{
+  MemThreadState *state = (MemThreadState *)state_v;
+
+  pool_cache_flush(state);
+
+  pthread_mutex_lock(&thread_states_lock);
+  state->is_used = false;
+  pthread_mutex_unlock(&thread_states_lock);
+
+  thread_state = NULL;
+}
+
+static void thread_state_key_create(void)
+{
+  pthread_key_create(&thread_state_key, thread_state_release);
+}
+
+static MemThreadState *thread_state_ensure_slow(void)
+{
+  MemThreadState *state;
+
+  pthread_once(&thread_state_key_once, thread_state_key_create);
+
+  pthread_mutex_lock(&thread_states_lock);
+  for (state = thread_states; state; state = state->next) {
+    if (!state->is_used) {
+      break;
+    }
+  }
+  if (state == NULL) {
+    /* Own cache line, so threads don't share one when updating their counters. */
+    state = (MemThreadState *)aligned_malloc(sizeof(MemThreadState), 64);
+    if (UNLIKELY(state == NULL)) {
+      pthread_mutex_unlock(&thread_states_lock);
+      abort();
+    }
+    memset(state, 0, sizeof(MemThreadState));
+    state->next = thread_states;
+    thread_states = state;
+  }
+  state->is_used = true;
+  pthread_mutex_unlock(&thread_states_lock);
+
+  /* Only used so #thread_state_release runs when the thread exits. */
+  pthread_setspecific(thread_state_key, state);
+  thread_state = state;
+
+  return state;
+}
+
+MEM_INLINE MemThreadState *thread_state_ensure(void)
+{
+  MemThreadState *state = thread_state;
+  if (UNLIKELY(state == NULL)) {
+    state = thread_state_ensure_slow();
+  }
+  return state;
+}
+
+/**
+ * Publish the memory in use of this thread once it drifted away from what was published by more
+ * than #MEM_PUBLISH_THRESHOLD, in either direction. The peak memory is tracked from the published
+ * value, so it is accurate up to the threshold times the number of threads.
+ */
+MEM_INLINE void memory_usage_publish(MemThreadState *state)
+{
+  /* Wrapping difference, a negative delta shows up as a huge value. */
+  const size_t delta = state->mem_in_use - state->mem_published;
+  if (UNLIKELY(delta >= MEM_PUBLISH_THRESHOLD && (0 - delta) >= MEM_PUBLISH_THRESHOLD)) {
+    state->mem_published = state->mem_in_use;
+    const size_t published = atomic_add_and_fetch_z(&mem_in_use_published, delta);
+    /* The published value is briefly "negative" when one thread frees what another thread
+     * allocated but did not publish yet. */
+    if ((ptrdiff_t)published > 0) {
+      update_maximum(&peak_mem, published);
+    }
+  }
+}
+
+MEM_INLINE void memory_usage_add(MemThreadState *state, size_t len)
+{
+  state->totblock++;
+  state->mem_in_use += len;
+  memory_usage_publish(state);
+}
+
+MEM_INLINE void memory_usage_sub(MemThreadState *state, size_t len)
+{
+  state->totblock--;
+  state->mem_in_use -= len;
+  memory_usage_publish(state);
+}
+
+/**
+ * Sum the counters of all threads. Other threads keep updating their counters without
+ * synchronization, so this is a snapshot which is only exact when they are idle.
+ */
+static void memory_usage_sum(size_t *r_mem_in_use, unsigned int *r_totblock)
+{
+  size_t mem_in_use = 0;
+  unsigned int totblock = 0;
+
+  pthread_mutex_lock(&thread_states_lock);
+  for (MemThreadState *state = thread_states; state; state = state->next) {
+    mem_in_use += state->mem_in_use;
+    totblock += state->totblock;
+  }
+  pthread_mutex_unlock(&thread_states_lock);
+
+  if (r_mem_in_use) {
+    *r_mem_in_use = mem_in_use;
+  }
+  if (r_totblock) {
+    *r_totblock = totblock;
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Small Object Pool
+ *
+ * Optional size-class allocator for blocks up to #MEM_POOL_MAX_LEN bytes. Every thread keeps
+ * a free list per class and only takes the shared lock to exchange batches of blocks, or to
+ * allocate a new slab. Slabs are never returned to the system, freed blocks are kept for reuse.
+ * \{ */
+
+MEM_INLINE unsigned int pool_class_index(size_t len)
+{
+  return (unsigned int)((len + sizeof(MemHead) - 1) / MEM_POOL_CLASS_STRIDE);
+}
+
+MEM_INLINE size_t pool_class_size(unsigned int index)
+{
+  return (index + 1) * MEM_POOL_CLASS_STRIDE;
+}
+
+/* Prepend a chain of blocks to the shared free list of a class. */
+static void pool_free_list_push(unsigned int index,
+                                MemPoolBlock *first,
+                                MemPoolBlock *last,
+                                unsigned int num)
+{
+  pthread_mutex_lock(&pool_lock);
+  last->next = pool_free[index].first;
+  pool_free[index].first = first;
+  pool_free[index].num += num;
+  pthread_mutex_unlock(&pool_lock);
+}
+
+static bool pool_cache_refill(MemPoolFreeList *cache, unsigned int index)
+{
+  pthread_mutex_lock(&pool_lock);
+  MemPoolFreeList *shared = &pool_free[index];
+  if (shared->first) {
+    MemPoolBlock *first = shared->first, *last = first;
+    unsigned int num = 1;
+    while (num < MEM_POOL_BATCH_NUM && last->next) {
+      last = last->next;
+      num++;
+    }
+    shared->first = last->next;
+    shared->num -= num;
+    pthread_mutex_unlock(&pool_lock);
+
+    last->next = cache->first;
+    cache->first = first;
+    cache->num += num;
+    return true;
+  }
+  pthread_mutex_unlock(&pool_lock);
+
+  char *slab = (char *)malloc(MEM_POOL_SLAB_SIZE);
+  if (UNLIKELY(slab == NULL)) {
+    return false;
+  }
+  atomic_add_and_fetch_z(&pool_reserved, MEM_POOL_SLAB_SIZE);
+
+  const size_t block_size = pool_class_size(index);
+  const unsigned int num = (unsigned int)(MEM_POOL_SLAB_SIZE / block_size);
+  for (unsigned int i = num; i--;) {
+    MemPoolBlock *block = (MemPoolBlock *)(slab + i * block_size);
+    block->next = cache->first;
+    cache->first = block;
+  }
+  cache->num += num;
+  return true;
+}
+
+MEM_INLINE MemHead *pool_block_alloc(MemThreadState *state, unsigned int index)
+{
+  MemPoolFreeList *cache = &state->pool_cache[index];
+  if (UNLIKELY(cache->first == NULL)) {
+    if (!pool_cache_refill(cache, index)) {
+      return NULL;
+    }
+  }
+  MemPoolBlock *block = cache->first;
+  cache->first = block->next;
+  cache->num--;
+  return (MemHead *)block;
+}
+
+MEM_INLINE void pool_block_free(MemThreadState *state, MemHead *memh, unsigned int index)
+{
+  MemPoolFreeList *cache = &state->pool_cache[index];
+  MemPoolBlock *block = (MemPoolBlock *)memh;
+  block->next = cache->first;
+  cache->first = block;
+  cache->num++;
+
+  /* Hand a batch back, so a thread which only frees does not hoard blocks. */
+  if (UNLIKELY(cache->num >= 2 * MEM_POOL_BATCH_NUM)) {
+    MemPoolBlock *last = cache->first;
+    for (unsigned int i = 1; i < MEM_POOL_BATCH_NUM; i++) {
+      last = last->next;
+    }
+    MemPoolBlock *first = cache->first;
+    cache->first = last->next;
+    cache->num -= MEM_POOL_BATCH_NUM;
+    pool_free_list_push(index, first, last, MEM_POOL_BATCH_NUM);
+  }
+}
+
+static void pool_cache_flush(MemThreadState *state)
+{
+  for (unsigned int index = 0; index < MEM_POOL_CLASS_NUM; index++) {
+    MemPoolFreeList *cache = &state->pool_cache[index];
+    if (cache->first == NULL) {
+      continue;
+    }
+    MemPoolBlock *last = cache->first;
+    while (last->next) {
+      last = last->next;
+    }
+    pool_free_list_push(index, cache->first, last, cache->num);
+    cache->first = NULL;
+    cache->num = 0;
+  }
+}
+
+/** \} */
+
+/**
+ * Allocate a block with room for \a len bytes after the #MemHead, from the pool when it is enabled
+ * and the block is small enough. The returned head has its length and flags set.
+ */
+MEM_INLINE MemHead *memhead_alloc(MemThreadState *state, size_t len, bool clear)
+{
+  MemHead *memh;
+
+  if (use_small_object_pool && len <= MEM_POOL_MAX_LEN) {
+    memh = pool_block_alloc(state, pool_class_index(len));
+    if (LIKELY(memh)) {
+      if (clear) {
+        memset(memh + 1, 0, len);
+      }
+      memh->len = len | (size_t)MEMHEAD_POOL_FLAG;
+    }
+    return memh;
+  }
+
+  memh = (MemHead *)(clear ? calloc(1, len + sizeof(MemHead)) : malloc(len + sizeof(MemHead)));
+  if (LIKELY(memh)) {
+    memh->len = len;
+  }
+  return memh;
+}
+
 #ifdef __GNUC__
 __attribute__((format(printf, 1, 2)))
 #endif
@@ -92,7 +432,7 @@ print_error(const char *str, ...)
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
   if (vmemh) {
-    return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG));
+    return MEMHEAD_FROM_PTR(vmemh)->len & ~MEMHEAD_FLAGS;
   }
 
   return 0;
@@ -115,8 +455,8 @@ void MEM_lockfree_freeN(void *vmemh)
     return;
   }
 
-  atomic_sub_and_fetch_u(&totblock, 1);
-  atomic_sub_and_fetch_z(&mem_in_use, len);
+  MemThreadState *state = thread_state_ensure();
+  memory_usage_sub(state, len);
 
   if (UNLIKELY(malloc_debug_memset && len)) {
     memset(memh + 1, 255, len);
@@ -125,6 +465,9 @@ void MEM_lockfree_freeN(void *vmemh)
     MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
     aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
   }
+  else if (MEMHEAD_IS_POOL(memh)) {
+    pool_block_free(state, memh, pool_class_index(len));
+  }
   else {
     free(memh);
   }
@@ -230,22 +573,21 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 {
   MemHead *memh;
 
+  MemThreadState *state = thread_state_ensure();
+
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+  memh = memhead_alloc(state, len, true);
 
   if (LIKELY(memh)) {
-    memh->len = len;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    memory_usage_add(state, len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)MEM_lockfree_get_memory_in_use());
   return NULL;
 }
 
@@ -259,7 +601,7 @@ void *MEM_lockfree_calloc_arrayN(size_t len, size_t size, const char *str)
         SIZET_ARG(len),
         SIZET_ARG(size),
         str,
-        (unsigned int)mem_in_use);
+        (unsigned int)MEM_lockfree_get_memory_in_use());
     abort();
     return NULL;
   }
@@ -271,26 +613,25 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 {
   MemHead *memh;
 
+  MemThreadState *state = thread_state_ensure();
+
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)malloc(len + sizeof(MemHead));
+  memh = memhead_alloc(state, len, false);
 
   if (LIKELY(memh)) {
     if (UNLIKELY(malloc_debug_memset && len)) {
       memset(memh + 1, 255, len);
     }
 
-    memh->len = len;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    memory_usage_add(state, len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)MEM_lockfree_get_memory_in_use());
   return NULL;
 }
 
@@ -304,7 +645,7 @@ void *MEM_lockfree_malloc_arrayN(size_t len, size_t size, const char *str)
         SIZET_ARG(len),
         SIZET_ARG(size),
         str,
-        (unsigned int)mem_in_use);
+        (unsigned int)MEM_lockfree_get_memory_in_use());
     abort();
     return NULL;
   }
@@ -352,16 +693,14 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 
     memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
     memh->alignment = (short)alignment;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    memory_usage_add(thread_state_ensure(), len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)MEM_lockfree_get_memory_in_use());
   return NULL;
 }
 
@@ -381,8 +720,14 @@ void MEM_lockfree_callbackmemlist(void (*func)(void *))
 
 void MEM_lockfree_printmemlist_stats(void)
 {
-  printf("\ntotal memory len: %.3f MB\n", (double)mem_in_use / (double)(1024 * 1024));
-  printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)MEM_lockfree_get_memory_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n",
+         (double)MEM_lockfree_get_peak_memory() / (double)(1024 * 1024));
+  if (pool_reserved) {
+    printf("small object pool reserved: %.3f MB\n",
+           (double)pool_reserved / (double)(1024 * 1024));
+  }
   printf(
       "\nFor more detailed per-block statistics run Blender with memory debugging command line "
       "argument.\n");
@@ -408,25 +753,35 @@ void MEM_lockfree_set_memory_debug(void)
   malloc_debug_memset = true;
 }
 
+void MEM_lockfree_use_small_object_pool(bool enabled)
+{
+  use_small_object_pool = enabled;
+}
+
 size_t MEM_lockfree_get_memory_in_use(void)
 {
+  size_t mem_in_use;
+  memory_usage_sum(&mem_in_use, NULL);
   return mem_in_use;
 }
 
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 {
+  unsigned int totblock;
+  memory_usage_sum(NULL, &totblock);
   return totblock;
 }
 
-/* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
-  peak_mem = mem_in_use;
+  peak_mem = MEM_lockfree_get_memory_in_use();
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
 {
-  return peak_mem;
+  /* Unpublished allocations are not in the peak yet, at least include the current total. */
+  const size_t mem_in_use = MEM_lockfree_get_memory_in_use();
+  return mem_in_use > peak_mem ? mem_in_use : peak_mem;
 }
 
 #ifndef NDEBUG
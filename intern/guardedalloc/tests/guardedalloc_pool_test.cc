@@ -0,0 +1,126 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+namespace {
+
+/* Allocate blocks of all small sizes on a number of threads, free them on other threads. */
+void AllocateOnThreads(std::vector<void *> &blocks, const int num_threads, const int per_thread)
+{
+  blocks.resize((size_t)num_threads * per_thread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&blocks, t, per_thread]() {
+      for (int i = 0; i < per_thread; i++) {
+        const size_t len = (size_t)(i % 600);
+        char *mem = (char *)MEM_mallocN(len, __func__);
+        memset(mem, t, len);
+        blocks[(size_t)t * per_thread + i] = mem;
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+void FreeOnThreads(std::vector<void *> &blocks, const int num_threads)
+{
+  const size_t per_thread = blocks.size() / num_threads;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    /* Free blocks allocated by the next thread. */
+    const size_t start = ((t + 1) % num_threads) * per_thread;
+    threads.emplace_back([&blocks, start, per_thread]() {
+      for (size_t i = start; i < start + per_thread; i++) {
+        MEM_freeN(blocks[i]);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  blocks.clear();
+}
+
+void CheckCountersAcrossThreads()
+{
+  const unsigned int blocks_before = MEM_get_memory_blocks_in_use();
+  const size_t mem_before = MEM_get_memory_in_use();
+
+  std::vector<void *> blocks;
+  AllocateOnThreads(blocks, 4, 5000);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_before + 4 * 5000);
+  EXPECT_GT(MEM_get_memory_in_use(), mem_before);
+  EXPECT_GE(MEM_get_peak_memory(), MEM_get_memory_in_use());
+
+  FreeOnThreads(blocks, 4);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_before);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_before);
+}
+
+/* Tests switch to the lock-free allocator, restore the guarded one the test main enables so
+ * other tests in the same executable keep their leak detection. */
+class guardedalloc_lockfree : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    MEM_use_lockfree_allocator();
+  }
+
+  void TearDown() override
+  {
+    MEM_use_small_object_pool(false);
+    MEM_use_guarded_allocator();
+  }
+};
+
+}  // namespace
+
+TEST_F(guardedalloc_lockfree, LockfreeCountersAcrossThreads)
+{
+  CheckCountersAcrossThreads();
+}
+
+TEST_F(guardedalloc_lockfree, SmallObjectPoolCountersAcrossThreads)
+{
+  MEM_use_small_object_pool(true);
+  CheckCountersAcrossThreads();
+}
+
+TEST_F(guardedalloc_lockfree, SmallObjectPoolReallocAndToggle)
+{
+  /* Allocated outside of the pool, freed while it is enabled. */
+  char *outside = (char *)MEM_callocN(24, __func__);
+
+  MEM_use_small_object_pool(true);
+  char *mem = (char *)MEM_callocN(10, __func__);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(mem[i], 0);
+    mem[i] = (char)i;
+  }
+  EXPECT_EQ(MEM_allocN_len(mem), 12);
+  EXPECT_EQ((size_t)mem % sizeof(void *), 0);
+
+  mem = (char *)MEM_reallocN(mem, 1000);
+  EXPECT_EQ(MEM_allocN_len(mem), 1000);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(mem[i], (char)i);
+  }
+  mem = (char *)MEM_reallocN(mem, 40);
+  EXPECT_EQ(MEM_allocN_len(mem), 40);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(mem[i], (char)i);
+  }
+  MEM_freeN(outside);
+  MEM_use_small_object_pool(false);
+
+  /* Allocated in the pool, freed while it is disabled. */
+  MEM_freeN(mem);
+}
@@ -0,0 +1,107 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#define NUM_RUN_AVERAGED 10
+
+/* Number of live blocks per thread, and allocations per thread and run. */
+#define NUM_SLOTS 4096
+#define NUM_ALLOCS (1 << 20)
+
+static unsigned int gen_pseudo_random_number(unsigned int num)
+{
+  num += ~(num << 16);
+  num ^= (num >> 5);
+  num += (num << 3);
+  num ^= (num >> 13);
+  num += ~(num << 9);
+  num ^= (num >> 17);
+  return num;
+}
+
+/* Replace random blocks of a working set, small blocks are much more common than large ones. */
+static void malloc_heavy_thread_func(const int thread_index, const size_t max_len)
+{
+  std::vector<void *> slots(NUM_SLOTS, nullptr);
+  unsigned int seed = (unsigned int)thread_index * 0x9e3779b9u + 1;
+
+  for (int i = 0; i < NUM_ALLOCS; i++) {
+    seed = gen_pseudo_random_number(seed);
+    void *&slot = slots[seed % NUM_SLOTS];
+    if (slot) {
+      MEM_freeN(slot);
+    }
+    const size_t len = ((seed >> 12) % max_len) >> ((seed >> 24) % 4);
+    slot = MEM_mallocN(len, __func__);
+    if (len) {
+      *(char *)slot = (char)i;
+    }
+  }
+  for (void *slot : slots) {
+    if (slot) {
+      MEM_freeN(slot);
+    }
+  }
+}
+
+static void malloc_heavy_test(const char *id, const int num_threads, const size_t max_len)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  /* The test main enables the guarded allocator, measure the one used by default. */
+  MEM_use_lockfree_allocator();
+
+  const bool use_pool_modes[] = {false, true};
+  for (const bool use_pool : use_pool_modes) {
+    MEM_use_small_object_pool(use_pool);
+
+    double averaged_timing = 0.0;
+    for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+      const auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back(malloc_heavy_thread_func, t, max_len);
+      }
+      for (std::thread &thread : threads) {
+        thread.join();
+      }
+      averaged_timing +=
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    printf("\t%s: done in %fs on average over %d runs (%.1fM allocations/s)\n",
+           use_pool ? "Small object pool" : "System malloc",
+           averaged_timing / NUM_RUN_AVERAGED,
+           NUM_RUN_AVERAGED,
+           (double)NUM_ALLOCS * num_threads * NUM_RUN_AVERAGED / averaged_timing * 1e-6);
+  }
+  MEM_use_small_object_pool(false);
+
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  MEM_use_guarded_allocator();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(guardedalloc, MallocHeavySingleThread)
+{
+  malloc_heavy_test("Malloc heavy - Single thread - up to 256 bytes", 1, 256);
+}
+
+TEST(guardedalloc, MallocHeavyThreaded)
+{
+  const int num_threads = (int)std::max(std::thread::hardware_concurrency(), 2u);
+  malloc_heavy_test("Malloc heavy - Threaded - up to 256 bytes", num_threads, 256);
+}
+
+TEST(guardedalloc, MallocHeavyThreadedMixed)
+{
+  const int num_threads = (int)std::max(std::thread::hardware_concurrency(), 2u);
+  malloc_heavy_test("Malloc heavy - Threaded - up to 4096 bytes", num_threads, 4096);
+}
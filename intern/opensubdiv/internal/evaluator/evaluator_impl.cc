@@ -32,6 +32,9 @@
 #include <opensubdiv/osd/cpuPatchTable.h>
 #include <opensubdiv/osd/cpuVertexBuffer.h>
 #include <opensubdiv/osd/mesh.h>
+#ifdef OPENSUBDIV_HAS_TBB
+#  include <opensubdiv/osd/tbbEvaluator.h>
+#endif
 #include <opensubdiv/osd/types.h>
 #include <opensubdiv/version.h>
 
@@ -52,6 +55,9 @@ using OpenSubdiv::Osd::CpuEvaluator;
 using OpenSubdiv::Osd::CpuPatchTable;
 using OpenSubdiv::Osd::CpuVertexBuffer;
 using OpenSubdiv::Osd::PatchCoord;
+#ifdef OPENSUBDIV_HAS_TBB
+using OpenSubdiv::Osd::TbbEvaluator;
+#endif
 
 namespace blender {
 namespace opensubdiv {
@@ -183,6 +189,44 @@ class ConstPatchCoordWrapperBuffer : public RawDataWrapperVertexBuffer<const Pat
   }
 };
 
+// Evaluate stencils of all refined vertices.
+//
+// Goes through the evaluator of the output, except for the CPU one: stencils are evaluated for
+// all the refined vertices at once, which benefits from threading. Patches are still evaluated
+// with the regular CPU evaluator, they are only evaluated for a few coordinates at a time from
+// code which is already threaded.
+template<typename EVALUATOR,
+         typename SRC_BUFFER,
+         typename DST_BUFFER,
+         typename STENCIL_TABLE,
+         typename DEVICE_CONTEXT>
+bool evalStencils(SRC_BUFFER *src_buffer,
+                  const BufferDescriptor &src_desc,
+                  DST_BUFFER *dst_buffer,
+                  const BufferDescriptor &dst_desc,
+                  const STENCIL_TABLE *stencil_table,
+                  const EVALUATOR *eval_instance,
+                  DEVICE_CONTEXT *device_context)
+{
+  return EVALUATOR::EvalStencils(
+      src_buffer, src_desc, dst_buffer, dst_desc, stencil_table, eval_instance, device_context);
+}
+
+#ifdef OPENSUBDIV_HAS_TBB
+template<typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE, typename DEVICE_CONTEXT>
+bool evalStencils(SRC_BUFFER *src_buffer,
+                  const BufferDescriptor &src_desc,
+                  DST_BUFFER *dst_buffer,
+                  const BufferDescriptor &dst_desc,
+                  const STENCIL_TABLE *stencil_table,
+                  const CpuEvaluator * /*eval_instance*/,
+                  DEVICE_CONTEXT *device_context)
+{
+  return TbbEvaluator::EvalStencils(
+      src_buffer, src_desc, dst_buffer, dst_desc, stencil_table, NULL, device_context);
+}
+#endif
+
 template<typename EVAL_VERTEX_BUFFER,
          typename STENCIL_TABLE,
          typename PATCH_TABLE,
@@ -234,13 +278,13 @@ class FaceVaryingVolatileEval {
         evaluator_cache_, src_face_varying_desc_, dst_face_varying_desc, device_context_);
     // in and out points to same buffer so output is put directly after coarse vertices, needed in
     // adaptive mode
-    EVALUATOR::EvalStencils(src_face_varying_data_,
-                            src_face_varying_desc_,
-                            src_face_varying_data_,
-                            dst_face_varying_desc,
-                            face_varying_stencils_,
-                            eval_instance,
-                            device_context_);
+    evalStencils(src_face_varying_data_,
+                 src_face_varying_desc_,
+                 src_face_varying_data_,
+                 dst_face_varying_desc,
+                 face_varying_stencils_,
+                 eval_instance,
+                 device_context_);
   }
 
   // NOTE: face_varying must point to a memory of at least float[2]*num_patch_coords.
@@ -406,26 +450,26 @@ class VolatileEvalOutput {
     dst_desc.offset += num_coarse_vertices_ * src_desc_.stride;
     const EVALUATOR *eval_instance = OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(
         evaluator_cache_, src_desc_, dst_desc, device_context_);
-    EVALUATOR::EvalStencils(src_data_,
-                            src_desc_,
-                            src_data_,
-                            dst_desc,
-                            vertex_stencils_,
-                            eval_instance,
-                            device_context_);
+    evalStencils(src_data_,
+                 src_desc_,
+                 src_data_,
+                 dst_desc,
+                 vertex_stencils_,
+                 eval_instance,
+                 device_context_);
     // Evaluate varying data.
     if (hasVaryingData()) {
       BufferDescriptor dst_varying_desc = src_varying_desc_;
       dst_varying_desc.offset += num_coarse_vertices_ * src_varying_desc_.stride;
       eval_instance = OpenSubdiv::Osd::GetEvaluator<EVALUATOR>(
           evaluator_cache_, src_varying_desc_, dst_varying_desc, device_context_);
-      EVALUATOR::EvalStencils(src_varying_data_,
-                              src_varying_desc_,
-                              src_varying_data_,
-                              dst_varying_desc,
-                              varying_stencils_,
-                              eval_instance,
-                              device_context_);
+      evalStencils(src_varying_data_,
+                   src_varying_desc_,
+                   src_varying_data_,
+                   dst_varying_desc,
+                   varying_stencils_,
+                   eval_instance,
+                   device_context_);
     }
     // Evaluate face-varying data.
     if (hasFaceVaryingData()) {
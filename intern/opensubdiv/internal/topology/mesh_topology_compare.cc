@@ -22,6 +22,12 @@
 #include <cstring>
 #include <opensubdiv/sdc/crease.h>
 
+#ifdef OPENSUBDIV_HAS_TBB
+#  include <atomic>
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#endif
+
 #include "internal/base/type.h"
 
 #include "opensubdiv_converter_capi.h"
@@ -85,6 +91,22 @@ bool isEqualGeometryEdge(const MeshTopology &mesh_topology, const OpenSubdiv_Con
 
 // Faces.
 
+bool isEqualGeometryFaceVertices(const MeshTopology &mesh_topology,
+                                 const OpenSubdiv_Converter *converter,
+                                 const int face_index,
+                                 vector<int> &vertices_of_face)
+{
+  int num_face_vertices = converter->getNumFaceVertices(converter, face_index);
+  if (mesh_topology.getNumFaceVertices(face_index) != num_face_vertices) {
+    return false;
+  }
+
+  vertices_of_face.resize(num_face_vertices);
+  converter->getFaceVertices(converter, face_index, vertices_of_face.data());
+
+  return mesh_topology.isFaceVertexIndicesEqual(face_index, vertices_of_face);
+}
+
 bool isEqualGeometryFace(const MeshTopology &mesh_topology, const OpenSubdiv_Converter *converter)
 {
   const int num_requested_faces = converter->getNumFaces(converter);
@@ -92,22 +114,36 @@ bool isEqualGeometryFace(const MeshTopology &mesh_topology, const OpenSubdiv_Con
     return false;
   }
 
+#ifdef OPENSUBDIV_HAS_TBB
+  // This comparison happens on every update of a subdivided mesh, even when only vertex
+  // positions changed, so spread it over all threads.
+  std::atomic<bool> is_equal(true);
+  tbb::parallel_for(tbb::blocked_range<int>(0, num_requested_faces, 1024),
+                    [&](const tbb::blocked_range<int> &range) {
+                      vector<int> vertices_of_face;
+                      for (int face_index = range.begin(); face_index != range.end();
+                           ++face_index) {
+                        if (!is_equal.load(std::memory_order_relaxed)) {
+                          return;
+                        }
+                        if (!isEqualGeometryFaceVertices(
+                                mesh_topology, converter, face_index, vertices_of_face)) {
+                          is_equal = false;
+                          return;
+                        }
+                      }
+                    });
+  return is_equal;
+#else
   vector<int> vertices_of_face;
   for (int face_index = 0; face_index < num_requested_faces; ++face_index) {
-    int num_face_vertices = converter->getNumFaceVertices(converter, face_index);
-    if (mesh_topology.getNumFaceVertices(face_index) != num_face_vertices) {
-      return false;
-    }
-
-    vertices_of_face.resize(num_face_vertices);
-    converter->getFaceVertices(converter, face_index, vertices_of_face.data());
-
-    if (!mesh_topology.isFaceVertexIndicesEqual(face_index, vertices_of_face)) {
+    if (!isEqualGeometryFaceVertices(mesh_topology, converter, face_index, vertices_of_face)) {
       return false;
     }
   }
 
   return true;
+#endif
 }
 
 // Geometry comparison entry point.
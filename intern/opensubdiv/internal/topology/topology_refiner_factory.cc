@@ -27,6 +27,11 @@
 
 #include <opensubdiv/far/topologyRefinerFactory.h>
 
+#ifdef OPENSUBDIV_HAS_TBB
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#endif
+
 #include "internal/base/type.h"
 #include "internal/base/type_convert.h"
 #include "internal/topology/mesh_topology.h"
@@ -131,14 +136,30 @@ inline bool TopologyRefinerFactory<TopologyRefinerData>::assignComponentTopology
   const bool full_topology_specified = converter->specifiesFullTopology(converter);
 
   // Vertices of face.
+  //
+  // NOTE: Storage of both refiner and base mesh topology is allocated at this point, and
+  // every face writes to its own part of it, so faces can be handled from multiple threads.
   const int num_faces = converter->getNumFaces(converter);
-  for (int face_index = 0; face_index < num_faces; ++face_index) {
+  auto assign_face_vertices = [&](const int face_index) {
     IndexArray dst_face_verts = getBaseFaceVertices(refiner, face_index);
     converter->getFaceVertices(converter, face_index, &dst_face_verts[0]);
 
     base_mesh_topology->setFaceVertexIndices(
         face_index, dst_face_verts.size(), &dst_face_verts[0]);
+  };
+#ifdef OPENSUBDIV_HAS_TBB
+  tbb::parallel_for(tbb::blocked_range<int>(0, num_faces, 1024),
+                    [&](const tbb::blocked_range<int> &range) {
+                      for (int face_index = range.begin(); face_index != range.end();
+                           ++face_index) {
+                        assign_face_vertices(face_index);
+                      }
+                    });
+#else
+  for (int face_index = 0; face_index < num_faces; ++face_index) {
+    assign_face_vertices(face_index);
   }
+#endif
 
   // If converter does not provide full topology, we are done.
   //
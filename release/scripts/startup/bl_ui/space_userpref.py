@@ -2188,6 +2188,8 @@ class USERPREF_PT_experimental_new_features(ExperimentalPanel, Panel):
                 ({"property": "use_sculpt_vertex_colors"}, "T71947"),
                 ({"property": "use_switch_object_operator"}, "T80402"),
                 ({"property": "use_sculpt_tools_tilt"}, "T00000"),
+                ({"property": "use_undo_id_reuse"}, None),
+                ({"property": "use_undo_compress"}, None),
             ),
         )
 
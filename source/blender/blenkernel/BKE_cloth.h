@@ -46,6 +46,10 @@ struct Scene;
  * represented by a float, given its precision. */
 #define ALMOST_ZERO FLT_EPSILON
 
+/* Extra inflation of the self collision tree, relative to the self collision distance.
+ * Self collision overlaps are reused while no vertex moved further than this. */
+#define CLOTH_SELFCOLL_OVERLAP_MARGIN 0.1f
+
 /* Bits to or into the ClothVertex.flags. */
 typedef enum eClothVertexFlag {
   CLOTH_VERT_FLAG_PINNED = (1 << 0),
@@ -66,6 +70,11 @@ typedef struct ClothSolverResult {
   int max_iterations, min_iterations;
   float avg_iterations;
   float max_error, min_error, avg_error;
+
+  /* Time spent in collision detection and response, in seconds, summed over substeps. */
+  float collision_broadphase_time, collision_narrowphase_time, collision_response_time;
+  /* Substeps which reused the self collision overlaps of an earlier substep. */
+  int self_overlap_reuse_count;
 } ClothSolverResult;
 
 /**
@@ -96,6 +105,11 @@ typedef struct Cloth {
   float average_acceleration[3];  /* Moving average of overall acceleration. */
   struct MEdge *edges;            /* Used for hair collisions. */
   struct EdgeSet *sew_edge_graph; /* Sewing edges represented using a GHash */
+
+  /* Self collision overlaps reused between steps, and the positions they were found at. */
+  struct BVHTreeOverlap *self_overlap;
+  unsigned int self_overlap_num;
+  float (*self_overlap_co)[3];
 } Cloth;
 
 /**
@@ -231,6 +245,9 @@ int cloth_bvh_collision(struct Depsgraph *depsgraph,
                         float step,
                         float dt);
 
+// needed for cloth.c
+void cloth_free_self_overlap_cache(struct Cloth *cloth);
+
 ////////////////////////////////////////////////
 
 /////////////////////////////////////////////////
@@ -51,6 +51,7 @@ struct GSet;
 struct ImBuf;
 struct Library;
 struct MainLock;
+struct UniqueName_Map;
 
 /* Blender thumbnail, as written on file (width, height, and data as char RGBA). */
 /* We pack pixel data after that struct. */
@@ -93,6 +94,11 @@ typedef struct Main {
   char recovered;                  /* indicate the main->name (file) is the recovered one */
   /** All current ID's exist in the last memfile undo step. */
   char is_memfile_undo_written;
+  /**
+   * Some ID data may have been changed without tagging it since the last memfile undo step,
+   * e.g. by edit-mode or sculpt-mode undo, so unchanged IDs can't be detected from their tags.
+   */
+  char is_memfile_undo_untagged_change;
   /**
    * An ID needs its data to be flushed back.
    * use "needs_flush_to_id" in edit data to flag data which needs updating.
@@ -161,6 +167,12 @@ typedef struct Main {
    */
   struct MainIDRelations *relations;
 
+  /**
+   * Index of local ID names, used to generate unique names, see `BKE_main_namemap.h`.
+   * Built on demand, can be NULL.
+   */
+  struct UniqueName_Map *name_map;
+
   struct MainLock *lock;
 } Main;
 
@@ -0,0 +1,58 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * API to manage the index of local ID names stored in a Main data-base, used to generate unique
+ * ID names without having to go over the whole list of IDs of a given type.
+ *
+ * \note The index of a type is built on demand, and kept up to date by the ID management code
+ * (#BKE_id_new_name_validate, ID freeing...). Code moving IDs between Mains or modifying their
+ * names without going through that API must call #BKE_main_namemap_clear.
+ *
+ * \section Function Names
+ *
+ * - `BKE_main_namemap_` Should be used for functions in that file.
+ */
+
+#include "BLI_compiler_attrs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ID;
+struct Main;
+struct UniqueName_Map;
+
+void BKE_main_namemap_destroy(struct UniqueName_Map **r_name_map) ATTR_NONNULL();
+void BKE_main_namemap_clear(struct Main *bmain) ATTR_NONNULL();
+
+bool BKE_main_namemap_get_name(struct Main *bmain,
+                               struct ID *id,
+                               char *name,
+                               struct ID **r_id_sorting_hint) ATTR_NONNULL();
+void BKE_main_namemap_remove_id(struct Main *bmain, struct ID *id) ATTR_NONNULL();
+struct ID *BKE_main_namemap_find_name(struct Main *bmain, const short id_type, const char *name)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+
+bool BKE_main_namemap_validate(struct Main *bmain) ATTR_NONNULL();
+
+#ifdef __cplusplus
+}
+#endif
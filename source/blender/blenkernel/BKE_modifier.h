@@ -517,6 +517,27 @@ struct Mesh *BKE_modifier_modify_mesh(ModifierData *md,
                                       const struct ModifierEvalContext *ctx,
                                       struct Mesh *me);
 
+/* Result cache, see modifier_result_cache.c */
+
+typedef struct ModifierResultCacheStats {
+  size_t memory_used;
+  size_t memory_limit;
+  int entries;
+  int hits;
+  int misses;
+  int evictions;
+} ModifierResultCacheStats;
+
+struct Mesh *BKE_modifier_modify_mesh_cached(ModifierData *md,
+                                             const struct ModifierEvalContext *ctx,
+                                             struct Mesh *me);
+void BKE_modifier_result_cache_init(void);
+void BKE_modifier_result_cache_exit(void);
+void BKE_modifier_result_cache_clear(void);
+void BKE_modifier_result_cache_remove(const ModifierData *md);
+void BKE_modifier_result_cache_limit_set(size_t memory_limit);
+void BKE_modifier_result_cache_stats_get(ModifierResultCacheStats *r_stats);
+
 void BKE_modifier_deform_verts(ModifierData *md,
                                const struct ModifierEvalContext *ctx,
                                struct Mesh *me,
@@ -60,6 +60,7 @@ struct ModifierData;
 struct Object;
 struct RNG;
 struct Scene;
+struct SPHNeighborGrid;
 
 #define PARTICLE_COLLISION_MAX_COLLISIONS 10
 
@@ -432,6 +433,7 @@ void psys_apply_child_modifiers(struct ParticleThreadContext *ctx,
 void psys_sph_init(struct ParticleSimulationData *sim, struct SPHData *sphdata);
 void psys_sph_finalize(struct SPHData *sphdata);
 void psys_sph_density(struct BVHTree *tree, struct SPHData *data, float co[3], float vars[2]);
+void psys_sph_grid_free(struct SPHNeighborGrid *grid);
 
 /* for anim.c */
 void psys_get_dupli_texture(struct ParticleSystem *psys,
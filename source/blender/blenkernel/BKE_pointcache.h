@@ -79,6 +79,7 @@ extern "C" {
 #define PTCACHE_READ_OLD 3
 
 /* Structs */
+struct BLI_mmap_file;
 struct ClothModifierData;
 struct FluidModifierData;
 struct ListBase;
@@ -106,6 +107,9 @@ typedef struct PTCacheData {
 
 typedef struct PTCacheFile {
   FILE *fp;
+  /* Files opened for reading are mapped in memory when possible, `fp` is NULL then. */
+  struct BLI_mmap_file *mmap_file;
+  size_t mmap_offset;
 
   int frame, old_format;
   unsigned int totpoint, type;
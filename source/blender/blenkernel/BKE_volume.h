@@ -36,6 +36,8 @@ struct VolumeGridVector;
 /* Module */
 
 void BKE_volumes_init(void);
+void BKE_volumes_exit(void);
+void BKE_volumes_prefetch_clear(void);
 
 /* Datablock Management */
 
@@ -119,9 +121,28 @@ VolumeGridType BKE_volume_grid_type(const struct VolumeGrid *grid);
 int BKE_volume_grid_channels(const struct VolumeGrid *grid);
 void BKE_volume_grid_transform_matrix(const struct VolumeGrid *grid, float mat[4][4]);
 
-/* Bounds */
+/* Bounds
+ *
+ * Active voxel bounds, computed from the tree when the grid is loaded, and from the
+ * bounding box stored in the file metadata otherwise, if there is one. */
 bool BKE_volume_grid_bounds(const struct VolumeGrid *grid, float min[3], float max[3]);
 
+/* File Cache Statistics
+ *
+ * Counts of grid trees requested since startup or the last reset. */
+
+typedef struct VolumeFileCacheStats {
+  /* Trees that were already in the file cache, including prefetched frames. */
+  int hits;
+  /* Trees that had to be read from file when requested. */
+  int misses;
+  /* Trees read in advance on a background thread, for upcoming frames of sequences. */
+  int prefetched;
+} VolumeFileCacheStats;
+
+void BKE_volume_file_cache_stats(VolumeFileCacheStats *r_stats);
+void BKE_volume_file_cache_stats_reset(void);
+
 /* Volume Editing
  *
  * These are intended for modifiers to use on evaluated datablocks.
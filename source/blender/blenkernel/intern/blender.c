@@ -49,12 +49,14 @@
 #include "BKE_image.h"
 #include "BKE_layer.h"
 #include "BKE_main.h"
+#include "BKE_modifier.h"
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
 #include "BKE_sequencer.h"
 #include "BKE_studiolight.h"
+#include "BKE_volume.h"
 
 #include "DEG_depsgraph.h"
 
@@ -90,6 +92,8 @@ void BKE_blender_free(void)
   IMB_exit();
   BKE_cachefiles_exit();
   BKE_images_exit();
+  BKE_volumes_exit();
+  BKE_modifier_result_cache_exit();
   DEG_free_node_types();
 
   BKE_brush_system_exit();
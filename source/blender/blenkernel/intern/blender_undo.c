@@ -34,9 +34,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "CLG_log.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BLI_path_util.h"
 #include "BLI_string.h"
@@ -55,6 +58,10 @@
 
 #include "DEG_depsgraph.h"
 
+#include "PIL_time.h"
+
+static CLG_LogRef LOG = {"bke.memfile_undo"};
+
 /* -------------------------------------------------------------------- */
 /** \name Global Undo
  * \{ */
@@ -127,11 +134,26 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
     if (prevfile) {
       BLO_memfile_clear_future(prevfile);
     }
-    /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
+    /* Unchanged IDs can only be skipped when all changes since the previous step are tagged. */
+    const bool use_id_reuse = USER_EXPERIMENTAL_TEST(&U, use_undo_id_reuse) &&
+                              prevfile != NULL && bmain->is_memfile_undo_written &&
+                              !bmain->is_memfile_undo_untagged_change;
+    const double time_start = PIL_check_seconds_timer();
+    /* success = */ /* UNUSED */ BLO_write_file_mem(
+        bmain, prevfile, &mfu->memfile, G.fileflags, use_id_reuse);
     mfu->undo_size = mfu->memfile.size;
+
+    CLOG_INFO(&LOG,
+              1,
+              "time=%.3fms, size=%zu, size_total=%zu, ids_reused=%d",
+              (PIL_check_seconds_timer() - time_start) * 1000.0,
+              mfu->memfile.size,
+              mfu->memfile.size_total,
+              mfu->memfile.id_reused_num);
   }
 
   bmain->is_memfile_undo_written = true;
+  bmain->is_memfile_undo_untagged_change = false;
 
   return mfu;
 }
@@ -52,10 +52,13 @@
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_main_namemap.h"
+#include "BKE_modifier.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
 #include "BKE_studiolight.h"
+#include "BKE_volume.h"
 #include "BKE_workspace.h"
 
 #include "BLO_readfile.h"
@@ -200,6 +203,8 @@ static void setup_app_data(bContext *C,
     SWAP(ListBase, bmain->wm, bfd->main->wm);
     SWAP(ListBase, bmain->workspaces, bfd->main->workspaces);
     SWAP(ListBase, bmain->screens, bfd->main->screens);
+    BKE_main_namemap_clear(bmain);
+    BKE_main_namemap_clear(bfd->main);
 
     /* In case of actual new file reading without loading UI, we need to regenerate the session
      * uuid of the UI-related datablocks we are keeping from previous session, otherwise their uuid
@@ -275,6 +280,12 @@ static void setup_app_data(bContext *C,
     }
   }
 
+  if (mode == LOAD_UNDO) {
+    /* Render engines may keep a depsgraph pointing to the data-blocks that undo replaces, it has
+     * to be freed while they still exist. */
+    RE_FreeAllPersistentDepsgraphs();
+  }
+
   /* free G_MAIN Main database */
   //  CTX_wm_manager_set(C, NULL);
   BKE_blender_globals_clear();
@@ -386,6 +397,9 @@ static void setup_app_data(bContext *C,
   if (mode != LOAD_UNDO) {
     /* TODO(sergey): Can this be also move above? */
     RE_FreeAllPersistentData();
+    /* Undo keeps the modifiers of unchanged objects, a new file never uses the old results. */
+    BKE_modifier_result_cache_clear();
+    BKE_volumes_prefetch_clear();
   }
 
   if (mode == LOAD_UNDO) {
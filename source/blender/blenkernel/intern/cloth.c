@@ -294,6 +294,10 @@ static int do_step_cloth(
   /* Support for dynamic vertex groups, changing from frame to frame */
   cloth_apply_vgroup(clmd, result);
 
+  /* Self collision overlaps are filtered with the vertex flags and the sewing settings, which may
+   * have changed since the last frame. */
+  cloth_free_self_overlap_cache(cloth);
+
   if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_DYNAMIC_BASEMESH) ||
       (clmd->sim_parms->vgroup_shrink > 0) || (clmd->sim_parms->shrink_min != 0.0f)) {
     cloth_update_spring_lengths(clmd, result);
@@ -476,6 +480,8 @@ void cloth_free_modifier(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhselftree);
     }
 
+    cloth_free_self_overlap_cache(cloth);
+
     /* we save our faces for collision objects */
     if (cloth->tri) {
       MEM_freeN(cloth->tri);
@@ -558,6 +564,8 @@ void cloth_free_modifier_extern(ClothModifierData *clmd)
       BLI_bvhtree_free(cloth->bvhselftree);
     }
 
+    cloth_free_self_overlap_cache(cloth);
+
     /* we save our faces for collision objects */
     if (cloth->tri) {
       MEM_freeN(cloth->tri);
@@ -826,7 +834,9 @@ static bool cloth_from_object(
   }
 
   clmd->clothObject->bvhtree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->epsilon);
-  clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->selfepsilon);
+  /* Inflated further than the self collision distance, so overlaps can be reused. */
+  clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(
+      clmd, clmd->coll_parms->selfepsilon * (1.0f + CLOTH_SELFCOLL_OVERLAP_MARGIN));
 
   return true;
 }
@@ -35,10 +35,13 @@
 #include "BLI_edgehash.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "PIL_time.h"
+
 #include "BKE_cloth.h"
 #include "BKE_collection.h"
 #include "BKE_effect.h"
@@ -74,6 +77,31 @@ typedef struct SelfColDetectData {
   bool collided;
 } SelfColDetectData;
 
+/* Colors available to group collision pairs, pairs which don't fit go to an extra group.
+ * Dense self collisions easily have over a hundred pairs sharing a vertex. */
+#define COLLPAIR_COLOR_WORDS 4
+#define COLLPAIR_COLORS_NUM (COLLPAIR_COLOR_WORDS * 64)
+
+/**
+ * Active collision pairs grouped by color, pairs of the same color don't share any cloth vertex
+ * so they can be resolved in parallel. The last group holds the remaining pairs, which are
+ * resolved serially.
+ */
+typedef struct CollPairColoring {
+  uint *pairs;
+  uint color_offsets[COLLPAIR_COLORS_NUM + 2];
+} CollPairColoring;
+
+typedef struct ColResponseData {
+  ClothModifierData *clmd;
+  CollisionModifierData *collmd;
+  Object *collob;
+  const CollPair *collisions;
+  const uint *pairs;
+  float dt;
+  bool result;
+} ColResponseData;
+
 /***********************************
  * Collision modifier code start
  ***********************************/
@@ -670,14 +698,14 @@ static void cloth_collision_impulse_vert(const float clamp_sq,
   vert->impulse_count++;
 }
 
-static int cloth_collision_response_static(ClothModifierData *clmd,
-                                           CollisionModifierData *collmd,
-                                           Object *collob,
-                                           CollPair *collpair,
-                                           uint collision_count,
-                                           const float dt)
+/* Resolve a single cloth-object collision pair, only writes to the cloth vertices of the pair. */
+static bool cloth_collision_response_pair(ClothModifierData *clmd,
+                                          CollisionModifierData *collmd,
+                                          Object *collob,
+                                          const CollPair *collpair,
+                                          const float dt)
 {
-  int result = 0;
+  bool result = false;
   Cloth *cloth = clmd->clothObject;
   const float clamp_sq = square_f(clmd->coll_parms->clamp * dt);
   const float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
@@ -685,259 +713,265 @@ static int cloth_collision_response_static(ClothModifierData *clmd,
   const float min_distance = (clmd->coll_parms->epsilon + epsilon2) * (8.0f / 9.0f);
 
   const bool is_hair = (clmd->hairdata != NULL);
-  for (int i = 0; i < collision_count; i++, collpair++) {
-    float i1[3], i2[3], i3[3];
-    float w1, w2, w3, u1, u2, u3;
-    float v1[3], v2[3], relativeVelocity[3];
-    zero_v3(i1);
-    zero_v3(i2);
-    zero_v3(i3);
-
-    /* Only handle static collisions here. */
-    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
-      continue;
-    }
 
-    /* Compute barycentric coordinates and relative "velocity" for both collision points. */
-    if (is_hair) {
-      w2 = line_point_factor_v3(
-          collpair->pa, cloth->verts[collpair->ap1].tx, cloth->verts[collpair->ap2].tx);
+  float i1[3], i2[3], i3[3];
+  float w1, w2, w3, u1, u2, u3;
+  float v1[3], v2[3], relativeVelocity[3];
+  zero_v3(i1);
+  zero_v3(i2);
+  zero_v3(i3);
 
-      w1 = 1.0f - w2;
+  /* Compute barycentric coordinates and relative "velocity" for both collision points. */
+  if (is_hair) {
+    w2 = line_point_factor_v3(
+        collpair->pa, cloth->verts[collpair->ap1].tx, cloth->verts[collpair->ap2].tx);
 
-      interp_v3_v3v3(v1, cloth->verts[collpair->ap1].tv, cloth->verts[collpair->ap2].tv, w2);
-    }
-    else {
-      collision_compute_barycentric(collpair->pa,
-                                    cloth->verts[collpair->ap1].tx,
-                                    cloth->verts[collpair->ap2].tx,
-                                    cloth->verts[collpair->ap3].tx,
-                                    &w1,
-                                    &w2,
-                                    &w3);
-
-      collision_interpolateOnTriangle(v1,
-                                      cloth->verts[collpair->ap1].tv,
-                                      cloth->verts[collpair->ap2].tv,
-                                      cloth->verts[collpair->ap3].tv,
-                                      w1,
-                                      w2,
-                                      w3);
-    }
+    w1 = 1.0f - w2;
 
-    collision_compute_barycentric(collpair->pb,
-                                  collmd->current_xnew[collpair->bp1].co,
-                                  collmd->current_xnew[collpair->bp2].co,
-                                  collmd->current_xnew[collpair->bp3].co,
-                                  &u1,
-                                  &u2,
-                                  &u3);
-
-    collision_interpolateOnTriangle(v2,
-                                    collmd->current_v[collpair->bp1].co,
-                                    collmd->current_v[collpair->bp2].co,
-                                    collmd->current_v[collpair->bp3].co,
-                                    u1,
-                                    u2,
-                                    u3);
-
-    sub_v3_v3v3(relativeVelocity, v2, v1);
-
-    /* Calculate the normal component of the relative velocity
-     * (actually only the magnitude - the direction is stored in 'normal'). */
-    const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
-    const float d = min_distance - collpair->distance;
-
-    /* If magrelVel < 0 the edges are approaching each other. */
-    if (magrelVel > 0.0f) {
-      /* Calculate Impulse magnitude to stop all motion in normal direction. */
-      float magtangent = 0, repulse = 0;
-      double impulse = 0.0;
-      float vrel_t_pre[3];
-      float temp[3];
-
-      /* Calculate tangential velocity. */
-      copy_v3_v3(temp, collpair->normal);
-      mul_v3_fl(temp, magrelVel);
-      sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
-
-      /* Decrease in magnitude of relative tangential velocity due to coulomb friction
-       * in original formula "magrelVel" should be the
-       * "change of relative velocity in normal direction". */
-      magtangent = min_ff(collob->pd->pdef_cfrict * 0.01f * magrelVel, len_v3(vrel_t_pre));
-
-      /* Apply friction impulse. */
-      if (magtangent > ALMOST_ZERO) {
-        normalize_v3(vrel_t_pre);
-
-        impulse = magtangent / 1.5;
-
-        VECADDMUL(i1, vrel_t_pre, (double)w1 * impulse);
-        VECADDMUL(i2, vrel_t_pre, (double)w2 * impulse);
-
-        if (!is_hair) {
-          VECADDMUL(i3, vrel_t_pre, (double)w3 * impulse);
-        }
-      }
+    interp_v3_v3v3(v1, cloth->verts[collpair->ap1].tv, cloth->verts[collpair->ap2].tv, w2);
+  }
+  else {
+    collision_compute_barycentric(collpair->pa,
+                                  cloth->verts[collpair->ap1].tx,
+                                  cloth->verts[collpair->ap2].tx,
+                                  cloth->verts[collpair->ap3].tx,
+                                  &w1,
+                                  &w2,
+                                  &w3);
 
-      /* Apply velocity stopping impulse. */
-      impulse = magrelVel / 1.5f;
+    collision_interpolateOnTriangle(v1,
+                                    cloth->verts[collpair->ap1].tv,
+                                    cloth->verts[collpair->ap2].tv,
+                                    cloth->verts[collpair->ap3].tv,
+                                    w1,
+                                    w2,
+                                    w3);
+  }
 
-      VECADDMUL(i1, collpair->normal, (double)w1 * impulse);
-      VECADDMUL(i2, collpair->normal, (double)w2 * impulse);
-      if (!is_hair) {
-        VECADDMUL(i3, collpair->normal, (double)w3 * impulse);
-      }
+  collision_compute_barycentric(collpair->pb,
+                                collmd->current_xnew[collpair->bp1].co,
+                                collmd->current_xnew[collpair->bp2].co,
+                                collmd->current_xnew[collpair->bp3].co,
+                                &u1,
+                                &u2,
+                                &u3);
+
+  collision_interpolateOnTriangle(v2,
+                                  collmd->current_v[collpair->bp1].co,
+                                  collmd->current_v[collpair->bp2].co,
+                                  collmd->current_v[collpair->bp3].co,
+                                  u1,
+                                  u2,
+                                  u3);
 
-      if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
-        repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+  sub_v3_v3v3(relativeVelocity, v2, v1);
 
-        /* Stay on the safe side and clamp repulse. */
-        if (impulse > ALMOST_ZERO) {
-          repulse = min_ff(repulse, 5.0f * impulse);
-        }
+  /* Calculate the normal component of the relative velocity
+   * (actually only the magnitude - the direction is stored in 'normal'). */
+  const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+  const float d = min_distance - collpair->distance;
 
-        repulse = max_ff(impulse, repulse);
+  /* If magrelVel < 0 the edges are approaching each other. */
+  if (magrelVel > 0.0f) {
+    /* Calculate Impulse magnitude to stop all motion in normal direction. */
+    float magtangent = 0, repulse = 0;
+    double impulse = 0.0;
+    float vrel_t_pre[3];
+    float temp[3];
 
-        impulse = repulse / 1.5f;
+    /* Calculate tangential velocity. */
+    copy_v3_v3(temp, collpair->normal);
+    mul_v3_fl(temp, magrelVel);
+    sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
 
-        VECADDMUL(i1, collpair->normal, impulse);
-        VECADDMUL(i2, collpair->normal, impulse);
-        if (!is_hair) {
-          VECADDMUL(i3, collpair->normal, impulse);
-        }
+    /* Decrease in magnitude of relative tangential velocity due to coulomb friction
+     * in original formula "magrelVel" should be the
+     * "change of relative velocity in normal direction". */
+    magtangent = min_ff(collob->pd->pdef_cfrict * 0.01f * magrelVel, len_v3(vrel_t_pre));
+
+    /* Apply friction impulse. */
+    if (magtangent > ALMOST_ZERO) {
+      normalize_v3(vrel_t_pre);
+
+      impulse = magtangent / 1.5;
+
+      VECADDMUL(i1, vrel_t_pre, (double)w1 * impulse);
+      VECADDMUL(i2, vrel_t_pre, (double)w2 * impulse);
+
+      if (!is_hair) {
+        VECADDMUL(i3, vrel_t_pre, (double)w3 * impulse);
       }
+    }
+
+    /* Apply velocity stopping impulse. */
+    impulse = magrelVel / 1.5f;
 
-      result = 1;
+    VECADDMUL(i1, collpair->normal, (double)w1 * impulse);
+    VECADDMUL(i2, collpair->normal, (double)w2 * impulse);
+    if (!is_hair) {
+      VECADDMUL(i3, collpair->normal, (double)w3 * impulse);
     }
-    else if (d > ALMOST_ZERO) {
+
+    if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
+      repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+
       /* Stay on the safe side and clamp repulse. */
-      float repulse = d / time_multiplier;
-      float impulse = repulse / 4.5f;
+      if (impulse > ALMOST_ZERO) {
+        repulse = min_ff(repulse, 5.0f * impulse);
+      }
 
-      VECADDMUL(i1, collpair->normal, w1 * impulse);
-      VECADDMUL(i2, collpair->normal, w2 * impulse);
+      repulse = max_ff(impulse, repulse);
 
+      impulse = repulse / 1.5f;
+
+      VECADDMUL(i1, collpair->normal, impulse);
+      VECADDMUL(i2, collpair->normal, impulse);
       if (!is_hair) {
-        VECADDMUL(i3, collpair->normal, w3 * impulse);
+        VECADDMUL(i3, collpair->normal, impulse);
       }
+    }
+
+    result = true;
+  }
+  else if (d > ALMOST_ZERO) {
+    /* Stay on the safe side and clamp repulse. */
+    float repulse = d / time_multiplier;
+    float impulse = repulse / 4.5f;
 
-      result = 1;
+    VECADDMUL(i1, collpair->normal, w1 * impulse);
+    VECADDMUL(i2, collpair->normal, w2 * impulse);
+
+    if (!is_hair) {
+      VECADDMUL(i3, collpair->normal, w3 * impulse);
     }
 
-    if (result) {
-      cloth_collision_impulse_vert(clamp_sq, i1, &cloth->verts[collpair->ap1]);
-      cloth_collision_impulse_vert(clamp_sq, i2, &cloth->verts[collpair->ap2]);
-      if (!is_hair) {
-        cloth_collision_impulse_vert(clamp_sq, i3, &cloth->verts[collpair->ap3]);
-      }
+    result = true;
+  }
+
+  if (result) {
+    cloth_collision_impulse_vert(clamp_sq, i1, &cloth->verts[collpair->ap1]);
+    cloth_collision_impulse_vert(clamp_sq, i2, &cloth->verts[collpair->ap2]);
+    if (!is_hair) {
+      cloth_collision_impulse_vert(clamp_sq, i3, &cloth->verts[collpair->ap3]);
     }
   }
 
   return result;
 }
 
-static int cloth_selfcollision_response_static(ClothModifierData *clmd,
-                                               CollPair *collpair,
-                                               uint collision_count,
-                                               const float dt)
+/* Resolve a single self collision pair, only writes to the vertices of the pair. */
+static bool cloth_selfcollision_response_pair(ClothModifierData *clmd,
+                                              const CollPair *collpair,
+                                              const float dt)
 {
-  int result = 0;
+  bool result = false;
   Cloth *cloth = clmd->clothObject;
   const float clamp_sq = square_f(clmd->coll_parms->self_clamp * dt);
   const float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
   const float min_distance = (2.0f * clmd->coll_parms->selfepsilon) * (8.0f / 9.0f);
 
-  for (int i = 0; i < collision_count; i++, collpair++) {
-    float ia[3][3] = {{0.0f}};
-    float ib[3][3] = {{0.0f}};
-    float w1, w2, w3, u1, u2, u3;
-    float v1[3], v2[3], relativeVelocity[3];
+  float ia[3][3] = {{0.0f}};
+  float ib[3][3] = {{0.0f}};
+  float w1, w2, w3, u1, u2, u3;
+  float v1[3], v2[3], relativeVelocity[3];
 
-    /* Only handle static collisions here. */
-    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
-      continue;
+  /* Compute barycentric coordinates for both collision points. */
+  collision_compute_barycentric(collpair->pa,
+                                cloth->verts[collpair->ap1].tx,
+                                cloth->verts[collpair->ap2].tx,
+                                cloth->verts[collpair->ap3].tx,
+                                &w1,
+                                &w2,
+                                &w3);
+
+  collision_compute_barycentric(collpair->pb,
+                                cloth->verts[collpair->bp1].tx,
+                                cloth->verts[collpair->bp2].tx,
+                                cloth->verts[collpair->bp3].tx,
+                                &u1,
+                                &u2,
+                                &u3);
+
+  /* Calculate relative "velocity". */
+  collision_interpolateOnTriangle(v1,
+                                  cloth->verts[collpair->ap1].tv,
+                                  cloth->verts[collpair->ap2].tv,
+                                  cloth->verts[collpair->ap3].tv,
+                                  w1,
+                                  w2,
+                                  w3);
+
+  collision_interpolateOnTriangle(v2,
+                                  cloth->verts[collpair->bp1].tv,
+                                  cloth->verts[collpair->bp2].tv,
+                                  cloth->verts[collpair->bp3].tv,
+                                  u1,
+                                  u2,
+                                  u3);
+
+  sub_v3_v3v3(relativeVelocity, v2, v1);
+
+  /* Calculate the normal component of the relative velocity
+   * (actually only the magnitude - the direction is stored in 'normal'). */
+  const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+  const float d = min_distance - collpair->distance;
+
+  /* TODO: Impulses should be weighed by mass as this is self col,
+   * this has to be done after mass distribution is implemented. */
+
+  /* If magrelVel < 0 the edges are approaching each other. */
+  if (magrelVel > 0.0f) {
+    /* Calculate Impulse magnitude to stop all motion in normal direction. */
+    float magtangent = 0, repulse = 0;
+    double impulse = 0.0;
+    float vrel_t_pre[3];
+    float temp[3];
+
+    /* Calculate tangential velocity. */
+    copy_v3_v3(temp, collpair->normal);
+    mul_v3_fl(temp, magrelVel);
+    sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
+
+    /* Decrease in magnitude of relative tangential velocity due to coulomb friction
+     * in original formula "magrelVel" should be the
+     * "change of relative velocity in normal direction". */
+    magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
+
+    /* Apply friction impulse. */
+    if (magtangent > ALMOST_ZERO) {
+      normalize_v3(vrel_t_pre);
+
+      impulse = magtangent / 1.5;
+
+      VECADDMUL(ia[0], vrel_t_pre, (double)w1 * impulse);
+      VECADDMUL(ia[1], vrel_t_pre, (double)w2 * impulse);
+      VECADDMUL(ia[2], vrel_t_pre, (double)w3 * impulse);
+
+      VECADDMUL(ib[0], vrel_t_pre, (double)u1 * -impulse);
+      VECADDMUL(ib[1], vrel_t_pre, (double)u2 * -impulse);
+      VECADDMUL(ib[2], vrel_t_pre, (double)u3 * -impulse);
     }
 
-    /* Compute barycentric coordinates for both collision points. */
-    collision_compute_barycentric(collpair->pa,
-                                  cloth->verts[collpair->ap1].tx,
-                                  cloth->verts[collpair->ap2].tx,
-                                  cloth->verts[collpair->ap3].tx,
-                                  &w1,
-                                  &w2,
-                                  &w3);
+    /* Apply velocity stopping impulse. */
+    impulse = magrelVel / 3.0f;
 
-    collision_compute_barycentric(collpair->pb,
-                                  cloth->verts[collpair->bp1].tx,
-                                  cloth->verts[collpair->bp2].tx,
-                                  cloth->verts[collpair->bp3].tx,
-                                  &u1,
-                                  &u2,
-                                  &u3);
+    VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, (double)w3 * impulse);
 
-    /* Calculate relative "velocity". */
-    collision_interpolateOnTriangle(v1,
-                                    cloth->verts[collpair->ap1].tv,
-                                    cloth->verts[collpair->ap2].tv,
-                                    cloth->verts[collpair->ap3].tv,
-                                    w1,
-                                    w2,
-                                    w3);
+    VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
+    VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
+    VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
 
-    collision_interpolateOnTriangle(v2,
-                                    cloth->verts[collpair->bp1].tv,
-                                    cloth->verts[collpair->bp2].tv,
-                                    cloth->verts[collpair->bp3].tv,
-                                    u1,
-                                    u2,
-                                    u3);
-
-    sub_v3_v3v3(relativeVelocity, v2, v1);
-
-    /* Calculate the normal component of the relative velocity
-     * (actually only the magnitude - the direction is stored in 'normal'). */
-    const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
-    const float d = min_distance - collpair->distance;
-
-    /* TODO: Impulses should be weighed by mass as this is self col,
-     * this has to be done after mass distribution is implemented. */
-
-    /* If magrelVel < 0 the edges are approaching each other. */
-    if (magrelVel > 0.0f) {
-      /* Calculate Impulse magnitude to stop all motion in normal direction. */
-      float magtangent = 0, repulse = 0;
-      double impulse = 0.0;
-      float vrel_t_pre[3];
-      float temp[3];
-
-      /* Calculate tangential velocity. */
-      copy_v3_v3(temp, collpair->normal);
-      mul_v3_fl(temp, magrelVel);
-      sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
-
-      /* Decrease in magnitude of relative tangential velocity due to coulomb friction
-       * in original formula "magrelVel" should be the
-       * "change of relative velocity in normal direction". */
-      magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
-
-      /* Apply friction impulse. */
-      if (magtangent > ALMOST_ZERO) {
-        normalize_v3(vrel_t_pre);
-
-        impulse = magtangent / 1.5;
-
-        VECADDMUL(ia[0], vrel_t_pre, (double)w1 * impulse);
-        VECADDMUL(ia[1], vrel_t_pre, (double)w2 * impulse);
-        VECADDMUL(ia[2], vrel_t_pre, (double)w3 * impulse);
-
-        VECADDMUL(ib[0], vrel_t_pre, (double)u1 * -impulse);
-        VECADDMUL(ib[1], vrel_t_pre, (double)u2 * -impulse);
-        VECADDMUL(ib[2], vrel_t_pre, (double)u3 * -impulse);
+    if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
+      repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+
+      if (impulse > ALMOST_ZERO) {
+        repulse = min_ff(repulse, 5.0 * impulse);
       }
 
-      /* Apply velocity stopping impulse. */
-      impulse = magrelVel / 3.0f;
+      repulse = max_ff(impulse, repulse);
+      impulse = repulse / 1.5f;
 
       VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
       VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
@@ -946,61 +980,228 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd,
       VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
       VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
       VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
+    }
 
-      if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
-        repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+    result = true;
+  }
+  else if (d > ALMOST_ZERO) {
+    /* Stay on the safe side and clamp repulse. */
+    float repulse = d * 1.0f / time_multiplier;
+    float impulse = repulse / 9.0f;
 
-        if (impulse > ALMOST_ZERO) {
-          repulse = min_ff(repulse, 5.0 * impulse);
-        }
+    VECADDMUL(ia[0], collpair->normal, w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, w3 * impulse);
 
-        repulse = max_ff(impulse, repulse);
-        impulse = repulse / 1.5f;
+    VECADDMUL(ib[0], collpair->normal, u1 * -impulse);
+    VECADDMUL(ib[1], collpair->normal, u2 * -impulse);
+    VECADDMUL(ib[2], collpair->normal, u3 * -impulse);
 
-        VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
-        VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
-        VECADDMUL(ia[2], collpair->normal, (double)w3 * impulse);
+    result = true;
+  }
 
-        VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
-        VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
-        VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
-      }
+  if (result) {
+    cloth_collision_impulse_vert(clamp_sq, ia[0], &cloth->verts[collpair->ap1]);
+    cloth_collision_impulse_vert(clamp_sq, ia[1], &cloth->verts[collpair->ap2]);
+    cloth_collision_impulse_vert(clamp_sq, ia[2], &cloth->verts[collpair->ap3]);
 
-      result = 1;
+    cloth_collision_impulse_vert(clamp_sq, ib[0], &cloth->verts[collpair->bp1]);
+    cloth_collision_impulse_vert(clamp_sq, ib[1], &cloth->verts[collpair->bp2]);
+    cloth_collision_impulse_vert(clamp_sq, ib[2], &cloth->verts[collpair->bp3]);
+  }
+
+  return result;
+}
+
+#ifdef __GNUC__
+#  pragma GCC diagnostic pop
+#endif
+
+static int collpair_cloth_verts(const CollPair *collpair,
+                                bool is_hair,
+                                bool is_self,
+                                uint r_verts[6])
+{
+  int verts_num = 0;
+  r_verts[verts_num++] = collpair->ap1;
+  r_verts[verts_num++] = collpair->ap2;
+  if (!is_hair) {
+    r_verts[verts_num++] = collpair->ap3;
+  }
+  if (is_self) {
+    r_verts[verts_num++] = collpair->bp1;
+    r_verts[verts_num++] = collpair->bp2;
+    r_verts[verts_num++] = collpair->bp3;
+  }
+  return verts_num;
+}
+
+/**
+ * Greedy coloring of the active collision pairs, each pair takes the first color not used by
+ * any pair sharing one of its cloth vertices.
+ */
+static void collpair_coloring_create(const Cloth *cloth,
+                                     const CollPair *collisions,
+                                     uint collision_count,
+                                     bool is_hair,
+                                     bool is_self,
+                                     CollPairColoring *r_coloring)
+{
+  uint64_t(*vert_colors)[COLLPAIR_COLOR_WORDS] = MEM_calloc_arrayN(
+      cloth->mvert_num, sizeof(*vert_colors), __func__);
+  ushort *pair_colors = MEM_malloc_arrayN(collision_count, sizeof(*pair_colors), __func__);
+  uint *color_offsets = r_coloring->color_offsets;
+
+  memset(color_offsets, 0, sizeof(r_coloring->color_offsets));
+
+  for (uint i = 0; i < collision_count; i++) {
+    if (collisions[i].flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
+      continue;
     }
-    else if (d > ALMOST_ZERO) {
-      /* Stay on the safe side and clamp repulse. */
-      float repulse = d * 1.0f / time_multiplier;
-      float impulse = repulse / 9.0f;
 
-      VECADDMUL(ia[0], collpair->normal, w1 * impulse);
-      VECADDMUL(ia[1], collpair->normal, w2 * impulse);
-      VECADDMUL(ia[2], collpair->normal, w3 * impulse);
+    uint verts[6];
+    const int verts_num = collpair_cloth_verts(&collisions[i], is_hair, is_self, verts);
+
+    uint color = COLLPAIR_COLORS_NUM;
+    for (int word = 0; word < COLLPAIR_COLOR_WORDS; word++) {
+      uint64_t used = 0;
+      for (int j = 0; j < verts_num; j++) {
+        used |= vert_colors[verts[j]][word];
+      }
+      if (~used) {
+        const uint bit = bitscan_forward_uint64(~used);
+        for (int j = 0; j < verts_num; j++) {
+          vert_colors[verts[j]][word] |= (uint64_t)1 << bit;
+        }
+        color = (uint)word * 64 + bit;
+        break;
+      }
+    }
+
+    pair_colors[i] = (ushort)color;
+    color_offsets[color + 1]++;
+  }
+
+  for (int color = 0; color <= COLLPAIR_COLORS_NUM; color++) {
+    color_offsets[color + 1] += color_offsets[color];
+  }
 
-      VECADDMUL(ib[0], collpair->normal, u1 * -impulse);
-      VECADDMUL(ib[1], collpair->normal, u2 * -impulse);
-      VECADDMUL(ib[2], collpair->normal, u3 * -impulse);
+  uint pairs_num = color_offsets[COLLPAIR_COLORS_NUM + 1];
+  r_coloring->pairs = MEM_malloc_arrayN(max_ii(pairs_num, 1), sizeof(uint), __func__);
 
-      result = 1;
+  uint color_fill[COLLPAIR_COLORS_NUM + 1];
+  memcpy(color_fill, color_offsets, sizeof(color_fill));
+  for (uint i = 0; i < collision_count; i++) {
+    if (!(collisions[i].flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE))) {
+      r_coloring->pairs[color_fill[pair_colors[i]]++] = i;
     }
+  }
 
-    if (result) {
-      cloth_collision_impulse_vert(clamp_sq, ia[0], &cloth->verts[collpair->ap1]);
-      cloth_collision_impulse_vert(clamp_sq, ia[1], &cloth->verts[collpair->ap2]);
-      cloth_collision_impulse_vert(clamp_sq, ia[2], &cloth->verts[collpair->ap3]);
+  MEM_freeN(vert_colors);
+  MEM_freeN(pair_colors);
+}
+
+static void collpair_coloring_free(CollPairColoring *coloring)
+{
+  MEM_SAFE_FREE(coloring->pairs);
+}
+
+static void cloth_collision_response_cb(void *__restrict userdata,
+                                        const int index,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  ColResponseData *data = (ColResponseData *)userdata;
+  const CollPair *collpair = &data->collisions[data->pairs[index]];
+
+  if (cloth_collision_response_pair(data->clmd, data->collmd, data->collob, collpair, data->dt)) {
+    bool *result = (bool *)tls->userdata_chunk;
+    *result = true;
+  }
+}
+
+static void cloth_selfcollision_response_cb(void *__restrict userdata,
+                                            const int index,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  ColResponseData *data = (ColResponseData *)userdata;
+  const CollPair *collpair = &data->collisions[data->pairs[index]];
+
+  if (cloth_selfcollision_response_pair(data->clmd, collpair, data->dt)) {
+    bool *result = (bool *)tls->userdata_chunk;
+    *result = true;
+  }
+}
 
-      cloth_collision_impulse_vert(clamp_sq, ib[0], &cloth->verts[collpair->bp1]);
-      cloth_collision_impulse_vert(clamp_sq, ib[1], &cloth->verts[collpair->bp2]);
-      cloth_collision_impulse_vert(clamp_sq, ib[2], &cloth->verts[collpair->bp3]);
+static void collpair_result_reduce(const void *__restrict UNUSED(userdata),
+                                   void *__restrict chunk_join,
+                                   void *__restrict chunk)
+{
+  *(bool *)chunk_join |= *(bool *)chunk;
+}
+
+/* Resolve the pairs one color after the other, pairs of the same color in parallel. */
+static bool collpair_coloring_resolve(ColResponseData *data,
+                                      const CollPairColoring *coloring,
+                                      TaskParallelRangeFunc func)
+{
+  data->pairs = coloring->pairs;
+  data->result = false;
+
+  for (int color = 0; color <= COLLPAIR_COLORS_NUM; color++) {
+    const uint start = coloring->color_offsets[color];
+    const uint end = coloring->color_offsets[color + 1];
+    if (start == end) {
+      continue;
     }
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (color < COLLPAIR_COLORS_NUM) && (end - start > 64);
+    settings.min_iter_per_thread = 64;
+    /* Each thread sets its own result, joined once the color is done. */
+    bool color_result = false;
+    settings.userdata_chunk = &color_result;
+    settings.userdata_chunk_size = sizeof(color_result);
+    settings.func_reduce = collpair_result_reduce;
+    BLI_task_parallel_range((int)start, (int)end, data, func, &settings);
+
+    data->result |= color_result;
   }
 
-  return result;
+  return data->result;
 }
 
-#ifdef __GNUC__
-#  pragma GCC diagnostic pop
-#endif
+static int cloth_collision_response_static(ClothModifierData *clmd,
+                                           CollisionModifierData *collmd,
+                                           Object *collob,
+                                           const CollPair *collisions,
+                                           const CollPairColoring *coloring,
+                                           const float dt)
+{
+  ColResponseData data = {
+      .clmd = clmd,
+      .collmd = collmd,
+      .collob = collob,
+      .collisions = collisions,
+      .dt = dt,
+  };
+
+  return collpair_coloring_resolve(&data, coloring, cloth_collision_response_cb);
+}
+
+static int cloth_selfcollision_response_static(ClothModifierData *clmd,
+                                               const CollPair *collisions,
+                                               const CollPairColoring *coloring,
+                                               const float dt)
+{
+  ColResponseData data = {
+      .clmd = clmd,
+      .collisions = collisions,
+      .dt = dt,
+  };
+
+  return collpair_coloring_resolve(&data, coloring, cloth_selfcollision_response_cb);
+}
 
 static void cloth_collision(void *__restrict userdata,
                             const int index,
@@ -1417,7 +1618,7 @@ static bool cloth_bvh_selfcollisions_nearcheck(ClothModifierData *clmd,
 static int cloth_bvh_objcollisions_resolve(ClothModifierData *clmd,
                                            Object **collobjs,
                                            CollPair **collisions,
-                                           uint *collision_counts,
+                                           const CollPairColoring *colorings,
                                            const uint numcollobj,
                                            const float dt)
 {
@@ -1440,9 +1641,9 @@ static int cloth_bvh_objcollisions_resolve(ClothModifierData *clmd,
       CollisionModifierData *collmd = (CollisionModifierData *)BKE_modifiers_findby_type(
           collob, eModifierType_Collision);
 
-      if (collmd->bvhtree) {
+      if (collmd->bvhtree && collisions[i]) {
         result += cloth_collision_response_static(
-            clmd, collmd, collob, collisions[i], collision_counts[i], dt);
+            clmd, collmd, collob, collisions[i], &colorings[i], dt);
       }
     }
 
@@ -1468,8 +1669,8 @@ static int cloth_bvh_objcollisions_resolve(ClothModifierData *clmd,
 }
 
 static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
-                                            CollPair *collisions,
-                                            int collision_count,
+                                            const CollPair *collisions,
+                                            const CollPairColoring *coloring,
                                             const float dt)
 {
   Cloth *cloth = clmd->clothObject;
@@ -1484,7 +1685,7 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
   for (j = 0; j < 2; j++) {
     result = 0;
 
-    result += cloth_selfcollision_response_static(clmd, collisions, collision_count, dt);
+    result += cloth_selfcollision_response_static(clmd, collisions, coloring, dt);
 
     /* Apply impulses in parallel. */
     if (result) {
@@ -1527,6 +1728,75 @@ static bool cloth_bvh_self_overlap_cb(void *userdata, int index_a, int index_b,
   return false;
 }
 
+/* Add the time passed since time_prev to r_time if set, returns the current time. */
+static double cloth_collision_time_add(float *r_time, double time_prev)
+{
+  const double time = PIL_check_seconds_timer();
+  if (r_time) {
+    *r_time += (float)(time - time_prev);
+  }
+  return time;
+}
+
+/**
+ * Self collision overlaps are kept in the cloth and reused by later steps, as long as no vertex
+ * moved further than the margin the self collision tree is inflated with
+ * (see #CLOTH_SELFCOLL_OVERLAP_MARGIN). The bounds of every triangle then stay inside the bounds
+ * the overlaps were found with, so no overlap can be missed. The cache is cleared on every frame,
+ * since the overlaps also depend on the vertex flags set from the vertex groups.
+ */
+static bool cloth_self_overlap_cache_is_valid(const ClothModifierData *clmd)
+{
+  const Cloth *cloth = clmd->clothObject;
+
+  if (cloth->self_overlap_co == NULL) {
+    return false;
+  }
+
+  const float margin = BLI_bvhtree_get_epsilon(cloth->bvhselftree) -
+                       clmd->coll_parms->selfepsilon;
+  if (margin <= 0.0f) {
+    return false;
+  }
+
+  const float margin_sq = square_f(margin);
+  for (uint i = 0; i < cloth->mvert_num; i++) {
+    if (len_squared_v3v3(cloth->verts[i].tx, cloth->self_overlap_co[i]) > margin_sq) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void cloth_self_overlap_cache_update(ClothModifierData *clmd)
+{
+  Cloth *cloth = clmd->clothObject;
+
+  bvhtree_update_from_cloth(clmd, false, true);
+
+  MEM_SAFE_FREE(cloth->self_overlap);
+  cloth->self_overlap = BLI_bvhtree_overlap(cloth->bvhselftree,
+                                            cloth->bvhselftree,
+                                            &cloth->self_overlap_num,
+                                            cloth_bvh_self_overlap_cb,
+                                            clmd);
+
+  if (cloth->self_overlap_co == NULL) {
+    cloth->self_overlap_co = MEM_malloc_arrayN(
+        cloth->mvert_num, sizeof(*cloth->self_overlap_co), __func__);
+  }
+  for (uint i = 0; i < cloth->mvert_num; i++) {
+    copy_v3_v3(cloth->self_overlap_co[i], cloth->verts[i].tx);
+  }
+}
+
+void cloth_free_self_overlap_cache(Cloth *cloth)
+{
+  MEM_SAFE_FREE(cloth->self_overlap);
+  MEM_SAFE_FREE(cloth->self_overlap_co);
+  cloth->self_overlap_num = 0;
+}
+
 int cloth_bvh_collision(
     Depsgraph *depsgraph, Object *ob, ClothModifierData *clmd, float step, float dt)
 {
@@ -1542,11 +1812,16 @@ int cloth_bvh_collision(
   BVHTreeOverlap **overlap_obj = NULL;
   uint coll_count_self = 0;
   BVHTreeOverlap *overlap_self = NULL;
+  ClothSolverResult *sres = clmd->solver_result;
+  const bool is_hair = (clmd->hairdata != NULL);
+  double time_start, time_phase;
 
   if ((clmd->sim_parms->flags & CLOTH_SIMSETTINGS_FLAG_COLLOBJ) || cloth_bvh == NULL) {
     return 0;
   }
 
+  time_start = PIL_check_seconds_timer();
+
   verts = cloth->verts;
   mvert_num = cloth->mvert_num;
 
@@ -1554,8 +1829,6 @@ int cloth_bvh_collision(
     bvhtree_update_from_cloth(clmd, false, false);
 
     /* Enable self collision if this is a hair sim */
-    const bool is_hair = (clmd->hairdata != NULL);
-
     collobjs = BKE_collision_objects_create(depsgraph,
                                             is_hair ? NULL : ob,
                                             clmd->coll_parms->group,
@@ -1584,22 +1857,35 @@ int cloth_bvh_collision(
     }
   }
 
-  if (clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) {
-    bvhtree_update_from_cloth(clmd, false, true);
+  if ((clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_SELF) && cloth->bvhselftree) {
+    if (cloth_self_overlap_cache_is_valid(clmd)) {
+      if (sres) {
+        sres->self_overlap_reuse_count++;
+      }
+    }
+    else {
+      cloth_self_overlap_cache_update(clmd);
+    }
 
-    overlap_self = BLI_bvhtree_overlap(
-        cloth->bvhselftree, cloth->bvhselftree, &coll_count_self, cloth_bvh_self_overlap_cb, clmd);
+    /* Owned by the cloth. */
+    overlap_self = cloth->self_overlap;
+    coll_count_self = cloth->self_overlap_num;
   }
 
+  time_phase = cloth_collision_time_add(sres ? &sres->collision_broadphase_time : NULL,
+                                        time_start);
+
   do {
     ret2 = 0;
 
     /* Object collisions. */
     if ((clmd->coll_parms->flags & CLOTH_COLLSETTINGS_FLAG_ENABLED) && collobjs) {
       CollPair **collisions;
+      CollPairColoring *colorings;
       bool collided = false;
 
       collisions = MEM_callocN(sizeof(CollPair *) * numcollobj, "CollPair");
+      colorings = MEM_callocN(sizeof(*colorings) * numcollobj, "CollPairColoring");
 
       for (i = 0; i < numcollobj; i++) {
         Object *collob = collobjs[i];
@@ -1623,17 +1909,34 @@ int cloth_bvh_collision(
         }
       }
 
+      if (collided) {
+        for (i = 0; i < numcollobj; i++) {
+          if (collisions[i]) {
+            collpair_coloring_create(
+                cloth, collisions[i], coll_counts_obj[i], is_hair, false, &colorings[i]);
+          }
+        }
+      }
+
+      time_phase = cloth_collision_time_add(sres ? &sres->collision_narrowphase_time : NULL,
+                                            time_phase);
+
       if (collided) {
         ret += cloth_bvh_objcollisions_resolve(
-            clmd, collobjs, collisions, coll_counts_obj, numcollobj, dt);
+            clmd, collobjs, collisions, colorings, numcollobj, dt);
         ret2 += ret;
+
+        time_phase = cloth_collision_time_add(sres ? &sres->collision_response_time : NULL,
+                                              time_phase);
       }
 
       for (i = 0; i < numcollobj; i++) {
         MEM_SAFE_FREE(collisions[i]);
+        collpair_coloring_free(&colorings[i]);
       }
 
       MEM_freeN(collisions);
+      MEM_freeN(colorings);
     }
 
     /* Self collisions. */
@@ -1648,10 +1951,22 @@ int cloth_bvh_collision(
           collisions = (CollPair *)MEM_mallocN(sizeof(CollPair) * coll_count_self,
                                                "collision array");
 
-          if (cloth_bvh_selfcollisions_nearcheck(
-                  clmd, collisions, coll_count_self, overlap_self)) {
-            ret += cloth_bvh_selfcollisions_resolve(clmd, collisions, coll_count_self, dt);
+          const bool collided = cloth_bvh_selfcollisions_nearcheck(
+              clmd, collisions, coll_count_self, overlap_self);
+
+          CollPairColoring coloring = {NULL};
+          if (collided) {
+            collpair_coloring_create(cloth, collisions, coll_count_self, false, true, &coloring);
+          }
+
+          time_phase = cloth_collision_time_add(
+              sres ? &sres->collision_narrowphase_time : NULL, time_phase);
+
+          if (collided) {
+            ret += cloth_bvh_selfcollisions_resolve(clmd, collisions, &coloring, dt);
             ret2 += ret;
+
+            collpair_coloring_free(&coloring);
           }
         }
       }
@@ -1672,6 +1987,9 @@ int cloth_bvh_collision(
       }
     }
 
+    time_phase = cloth_collision_time_add(sres ? &sres->collision_response_time : NULL,
+                                          time_phase);
+
     rounds++;
   } while (ret2 && (clmd->coll_parms->loop_count > rounds));
 
@@ -1685,8 +2003,6 @@ int cloth_bvh_collision(
 
   MEM_SAFE_FREE(coll_counts_obj);
 
-  MEM_SAFE_FREE(overlap_self);
-
   BKE_collision_objects_free(collobjs);
 
   return MIN2(ret, 1);
@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "DNA_ID.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_main_namemap.h"
+
+namespace blender::bke::tests {
+
+class LibIDMainUniqueNameTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    bmain = BKE_main_new();
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  ID *add_object(const char *name)
+  {
+    return static_cast<ID *>(BKE_id_new(bmain, ID_OB, name));
+  }
+
+  bool is_sorted()
+  {
+    LISTBASE_FOREACH (ID *, id, &bmain->objects) {
+      const ID *id_next = static_cast<const ID *>(id->next);
+      if (id_next != nullptr && BLI_strcasecmp(id->name, id_next->name) > 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+TEST_F(LibIDMainUniqueNameTest, Duplicates)
+{
+  ID *id_a = add_object("Cube");
+  ID *id_b = add_object("Cube");
+  ID *id_c = add_object("Cube");
+  EXPECT_STREQ(id_a->name + 2, "Cube");
+  EXPECT_STREQ(id_b->name + 2, "Cube.001");
+  EXPECT_STREQ(id_c->name + 2, "Cube.002");
+
+  /* The smallest unused number is used again. */
+  BKE_id_free(bmain, id_b);
+  ID *id_d = add_object("Cube.002");
+  EXPECT_STREQ(id_d->name + 2, "Cube.001");
+
+  /* Differently formatted numbers are not the same names. */
+  ID *id_e = add_object("Cube.2");
+  EXPECT_STREQ(id_e->name + 2, "Cube.2");
+  ID *id_f = add_object("Cube.2");
+  EXPECT_STREQ(id_f->name + 2, "Cube.003");
+
+  EXPECT_TRUE(is_sorted());
+  EXPECT_TRUE(BKE_main_namemap_validate(bmain));
+}
+
+TEST_F(LibIDMainUniqueNameTest, RenameAndFind)
+{
+  ID *id_a = add_object("Cube");
+  ID *id_b = add_object("Sphere");
+
+  BKE_libblock_rename(bmain, id_b, "Cube");
+  EXPECT_STREQ(id_b->name + 2, "Cube.001");
+  BKE_libblock_rename(bmain, id_a, "Plane");
+  EXPECT_STREQ(id_a->name + 2, "Plane");
+
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_OB, "Plane"), id_a);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_OB, "Cube.001"), id_b);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_OB, "Cube"), nullptr);
+
+  /* The name is now available again. */
+  ID *id_c = add_object("Cube");
+  EXPECT_STREQ(id_c->name + 2, "Cube");
+
+  /* Set directly, the index is re-built from the new names. */
+  BLI_strncpy(id_c->name + 2, "Plane", sizeof(id_c->name) - 2);
+  BLI_libblock_ensure_unique_name(bmain, id_c->name);
+  EXPECT_STRNE(id_a->name + 2, id_c->name + 2);
+
+  EXPECT_TRUE(is_sorted());
+  EXPECT_TRUE(BKE_main_namemap_validate(bmain));
+}
+
+TEST_F(LibIDMainUniqueNameTest, LongNames)
+{
+  char name[MAX_ID_NAME - 2];
+  memset(name, 'a', sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+
+  /* There is no room for a number, the name is truncated first. */
+  ID *id_a = add_object(name);
+  ID *id_b = add_object(name);
+  ID *id_c = add_object(name);
+  EXPECT_STREQ(id_a->name + 2, name);
+  EXPECT_EQ(strlen(id_b->name + 2), sizeof(name) - 5);
+  EXPECT_TRUE(STREQLEN(id_b->name + 2, id_c->name + 2, sizeof(name) - 5));
+  EXPECT_STREQ(id_c->name + 2 + sizeof(name) - 5, ".001");
+  EXPECT_TRUE(BKE_main_namemap_validate(bmain));
+}
+
+/* Swapping names in place (as done when resyncing overrides) must re-register both IDs. */
+TEST_F(LibIDMainUniqueNameTest, SwapNames)
+{
+  ID *id_a = add_object("A");
+  ID *id_b = add_object("B");
+
+  add_object("C");
+  BKE_libblock_swap_names(bmain, id_a, id_b);
+
+  EXPECT_STREQ(id_a->name + 2, "B");
+  EXPECT_STREQ(id_b->name + 2, "A");
+  EXPECT_EQ(BKE_main_namemap_find_name(bmain, ID_OB, "A"), id_b);
+  EXPECT_EQ(BKE_main_namemap_find_name(bmain, ID_OB, "B"), id_a);
+  EXPECT_TRUE(is_sorted());
+  EXPECT_TRUE(BKE_main_namemap_validate(bmain));
+
+  /* Both names are still taken. */
+  ID *id_c = add_object("A");
+  EXPECT_STREQ(id_c->name + 2, "A.001");
+}
+
+/* Creating many IDs with a same base name used to be quadratic. */
+TEST_F(LibIDMainUniqueNameTest, ManyIDs)
+{
+  const int ids_num = 20000;
+
+  ID *id_last = nullptr;
+  for (int i = 0; i < ids_num; i++) {
+    id_last = add_object("Object");
+  }
+
+  EXPECT_STREQ(id_last->name + 2, "Object.19999");
+  EXPECT_NE(BKE_libblock_find_name(bmain, ID_OB, "Object.10000"), nullptr);
+  EXPECT_TRUE(is_sorted());
+  EXPECT_TRUE(BKE_main_namemap_validate(bmain));
+}
+
+}  // namespace blender::bke::tests
@@ -755,17 +755,12 @@ bool BKE_lib_override_library_resync(Main *bmain, Scene *scene, ViewLayer *view_
         ID *id_override_old = BLI_ghash_lookup(linkedref_to_old_override, id);
 
         if (id_override_old != NULL) {
-          /* Swap  the names between old override ID and new one. */
-          char id_name_buf[MAX_ID_NAME];
-          memcpy(id_name_buf, id_override_old->name, sizeof(id_name_buf));
-          memcpy(id_override_old->name, id_override_new->name, sizeof(id_override_old->name));
-          memcpy(id_override_new->name, id_name_buf, sizeof(id_override_new->name));
-          /* Note that this is very efficient way to keep BMain IDs ordered as expected after
-           * swapping their names.
+          /* Swap the names between old override ID and new one. This also swaps their links,
+           * which is very efficient way to keep BMain IDs ordered as expected.
            * However, one has to be very careful with this when iterating over the listbase at the
            * same time. Here it works because we only execute this code when we are in the linked
            * IDs, which are always *after* all local ones, and we only affect local IDs. */
-          BLI_listbase_swaplinks(lb, id_override_old, id_override_new);
+          BKE_libblock_swap_names(bmain, id_override_old, id_override_new);
 
           /* Remap the whole local IDs to use the new override. */
           BKE_libblock_remap(
@@ -868,18 +863,19 @@ void BKE_lib_override_library_delete(Main *bmain, ID *id_root)
    * linked reference ones to be overridden again. */
   BKE_lib_override_library_override_group_tag(bmain, id_root, LIB_TAG_DOIT, true);
 
+  /* Remap the whole local IDs to use the linked data. */
+  GHash *override_to_reference_ids = BLI_ghash_ptr_new(__func__);
   ID *id;
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
     if (id->tag & LIB_TAG_DOIT) {
       if (ID_IS_OVERRIDE_LIBRARY_REAL(id)) {
-        ID *id_override_reference = id->override_library->reference;
-
-        /* Remap the whole local IDs to use the linked data. */
-        BKE_libblock_remap(bmain, id, id_override_reference, ID_REMAP_SKIP_INDIRECT_USAGE);
+        BLI_ghash_insert(override_to_reference_ids, id, id->override_library->reference);
       }
     }
   }
   FOREACH_MAIN_ID_END;
+  BKE_libblock_remap_multiple(bmain, override_to_reference_ids, ID_REMAP_SKIP_INDIRECT_USAGE);
+  BLI_ghash_free(override_to_reference_ids, NULL, NULL);
 
   /* Delete the override IDs. */
   FOREACH_MAIN_ID_BEGIN (bmain, id) {
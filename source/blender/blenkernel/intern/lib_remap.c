@@ -22,13 +22,19 @@
 
 #include "CLG_log.h"
 
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_utildefines.h"
 
+#include "DNA_node_types.h"
 #include "DNA_object_types.h"
 
 #include "BKE_armature.h"
 #include "BKE_collection.h"
 #include "BKE_curve.h"
+#include "BKE_idtype.h"
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
@@ -90,18 +96,21 @@ enum {
   ID_REMAP_IS_USER_ONE_SKIPPED = 1 << 1, /* There was some skipped 'user_one' usages of old_id. */
 };
 
-static int foreach_libblock_remap_callback(LibraryIDLinkCallbackData *cb_data)
+/** Data shared by all the pairs remapped in a single traversal of Main. */
+typedef struct IDRemapMultiple {
+  /** Map old ID -> #IDRemap of that ID. */
+  GHash *id_remaps;
+  /** The ID in which we are replacing usages. */
+  ID *id_owner;
+} IDRemapMultiple;
+
+static void foreach_libblock_remap_callback_apply(LibraryIDLinkCallbackData *cb_data,
+                                                  IDRemap *id_remap_data)
 {
   const int cb_flag = cb_data->cb_flag;
-
-  if (cb_flag & IDWALK_CB_EMBEDDED) {
-    return IDWALK_RET_NOP;
-  }
-
   ID *id_owner = cb_data->id_owner;
   ID *id_self = cb_data->id_self;
   ID **id_p = cb_data->id_pointer;
-  IDRemap *id_remap_data = cb_data->user_data;
   ID *old_id = id_remap_data->old_id;
   ID *new_id = id_remap_data->new_id;
 
@@ -233,6 +242,33 @@ static int foreach_libblock_remap_callback(LibraryIDLinkCallbackData *cb_data)
       }
     }
   }
+}
+
+static int foreach_libblock_remap_callback(LibraryIDLinkCallbackData *cb_data)
+{
+  if (cb_data->cb_flag & IDWALK_CB_EMBEDDED) {
+    return IDWALK_RET_NOP;
+  }
+
+  foreach_libblock_remap_callback_apply(cb_data, cb_data->user_data);
+
+  return IDWALK_RET_NOP;
+}
+
+static int foreach_libblock_remap_multiple_callback(LibraryIDLinkCallbackData *cb_data)
+{
+  ID *id = *cb_data->id_pointer;
+
+  if ((cb_data->cb_flag & IDWALK_CB_EMBEDDED) || id == NULL) {
+    return IDWALK_RET_NOP;
+  }
+
+  IDRemapMultiple *id_remap_multiple = cb_data->user_data;
+  IDRemap *id_remap_data = BLI_ghash_lookup(id_remap_multiple->id_remaps, id);
+  if (id_remap_data != NULL) {
+    id_remap_data->id_owner = id_remap_multiple->id_owner;
+    foreach_libblock_remap_callback_apply(cb_data, id_remap_data);
+  }
 
   return IDWALK_RET_NOP;
 }
@@ -345,6 +381,46 @@ static void libblock_remap_data_postprocess_nodetree_update(Main *bmain, ID *new
   ntreeUpdateAllUsers(bmain, new_id);
 }
 
+static void libblock_remap_data_update_tags(IDRemap *id_remap_data)
+{
+  ID *old_id = id_remap_data->old_id;
+  ID *new_id = id_remap_data->new_id;
+
+  /* XXX We may not want to always 'transfer' fake-user from old to new id...
+   *     Think for now it's desired behavior though,
+   *     we can always add an option (flag) to control this later if needed. */
+  if (old_id && (old_id->flag & LIB_FAKEUSER)) {
+    id_fake_user_clear(old_id);
+    id_fake_user_set(new_id);
+  }
+
+  id_us_clear_real(old_id);
+
+  if (new_id && (new_id->tag & LIB_TAG_INDIRECT) &&
+      (id_remap_data->status & ID_REMAP_IS_LINKED_DIRECT)) {
+    new_id->tag &= ~LIB_TAG_INDIRECT;
+    new_id->flag &= ~LIB_INDIRECT_WEAK_LINK;
+    new_id->tag |= LIB_TAG_EXTERN;
+  }
+}
+
+static void libblock_remap_data_init(IDRemap *r_id_remap_data,
+                                     Main *bmain,
+                                     ID *old_id,
+                                     ID *new_id,
+                                     const short remap_flags)
+{
+  r_id_remap_data->bmain = bmain;
+  r_id_remap_data->old_id = old_id;
+  r_id_remap_data->new_id = new_id;
+  r_id_remap_data->id_owner = NULL;
+  r_id_remap_data->flag = remap_flags;
+  r_id_remap_data->status = 0;
+  r_id_remap_data->skipped_direct = 0;
+  r_id_remap_data->skipped_indirect = 0;
+  r_id_remap_data->skipped_refcounted = 0;
+}
+
 /**
  * Execute the 'data' part of the remapping (that is, all ID pointers from other ID data-blocks).
  *
@@ -379,15 +455,7 @@ static void libblock_remap_data(
   if (r_id_remap_data == NULL) {
     r_id_remap_data = &id_remap_data;
   }
-  r_id_remap_data->bmain = bmain;
-  r_id_remap_data->old_id = old_id;
-  r_id_remap_data->new_id = new_id;
-  r_id_remap_data->id_owner = NULL;
-  r_id_remap_data->flag = remap_flags;
-  r_id_remap_data->status = 0;
-  r_id_remap_data->skipped_direct = 0;
-  r_id_remap_data->skipped_indirect = 0;
-  r_id_remap_data->skipped_refcounted = 0;
+  libblock_remap_data_init(r_id_remap_data, bmain, old_id, new_id, remap_flags);
 
   if (id) {
 #ifdef DEBUG_PRINT
@@ -421,22 +489,7 @@ static void libblock_remap_data(
     FOREACH_MAIN_ID_END;
   }
 
-  /* XXX We may not want to always 'transfer' fake-user from old to new id...
-   *     Think for now it's desired behavior though,
-   *     we can always add an option (flag) to control this later if needed. */
-  if (old_id && (old_id->flag & LIB_FAKEUSER)) {
-    id_fake_user_clear(old_id);
-    id_fake_user_set(new_id);
-  }
-
-  id_us_clear_real(old_id);
-
-  if (new_id && (new_id->tag & LIB_TAG_INDIRECT) &&
-      (r_id_remap_data->status & ID_REMAP_IS_LINKED_DIRECT)) {
-    new_id->tag &= ~LIB_TAG_INDIRECT;
-    new_id->flag &= ~LIB_INDIRECT_WEAK_LINK;
-    new_id->tag |= LIB_TAG_EXTERN;
-  }
+  libblock_remap_data_update_tags(r_id_remap_data);
 
 #ifdef DEBUG_PRINT
   printf("%s: %d occurrences skipped (%d direct and %d indirect ones)\n",
@@ -448,21 +501,15 @@ static void libblock_remap_data(
 }
 
 /**
- * Replace all references in given Main to \a old_id by \a new_id
- * (if \a new_id is NULL, it unlinks \a old_id).
+ * Update the remapped \a old_id itself (user count, linked status...) and the editors
+ * references to it, once all of its usages in Main have been processed.
  */
-void BKE_libblock_remap_locked(Main *bmain, void *old_idv, void *new_idv, const short remap_flags)
+static void libblock_remap_old_id_update(IDRemap *id_remap_data)
 {
-  IDRemap id_remap_data;
-  ID *old_id = old_idv;
-  ID *new_id = new_idv;
-  int skipped_direct, skipped_refcounted;
-
-  BLI_assert(old_id != NULL);
-  BLI_assert((new_id == NULL) || GS(old_id->name) == GS(new_id->name));
-  BLI_assert(old_id != new_id);
-
-  libblock_remap_data(bmain, NULL, old_id, new_id, remap_flags, &id_remap_data);
+  ID *old_id = id_remap_data->old_id;
+  ID *new_id = id_remap_data->new_id;
+  const int skipped_direct = id_remap_data->skipped_direct;
+  const int skipped_refcounted = id_remap_data->skipped_refcounted;
 
   if (free_notifier_reference_cb) {
     free_notifier_reference_cb(old_id);
@@ -475,14 +522,11 @@ void BKE_libblock_remap_locked(Main *bmain, void *old_idv, void *new_idv, const
     remap_editor_id_reference_cb(old_id, new_id);
   }
 
-  skipped_direct = id_remap_data.skipped_direct;
-  skipped_refcounted = id_remap_data.skipped_refcounted;
-
   /* If old_id was used by some ugly 'user_one' stuff (like Image or Clip editors...), and user
    * count has actually been incremented for that, we have to decrease once more its user count...
    * unless we had to skip some 'user_one' cases. */
   if ((old_id->tag & LIB_TAG_EXTRAUSER_SET) &&
-      !(id_remap_data.status & ID_REMAP_IS_USER_ONE_SKIPPED)) {
+      !(id_remap_data->status & ID_REMAP_IS_USER_ONE_SKIPPED)) {
     id_us_clear_real(old_id);
   }
 
@@ -505,6 +549,25 @@ void BKE_libblock_remap_locked(Main *bmain, void *old_idv, void *new_idv, const
       old_id->tag |= LIB_TAG_INDIRECT;
     }
   }
+}
+
+/**
+ * Replace all references in given Main to \a old_id by \a new_id
+ * (if \a new_id is NULL, it unlinks \a old_id).
+ */
+void BKE_libblock_remap_locked(Main *bmain, void *old_idv, void *new_idv, const short remap_flags)
+{
+  IDRemap id_remap_data;
+  ID *old_id = old_idv;
+  ID *new_id = new_idv;
+
+  BLI_assert(old_id != NULL);
+  BLI_assert((new_id == NULL) || GS(old_id->name) == GS(new_id->name));
+  BLI_assert(old_id != new_id);
+
+  libblock_remap_data(bmain, NULL, old_id, new_id, remap_flags, &id_remap_data);
+
+  libblock_remap_old_id_update(&id_remap_data);
 
   /* Some after-process updates.
    * This is a bit ugly, but cannot see a way to avoid it.
@@ -554,6 +617,199 @@ void BKE_libblock_remap(Main *bmain, void *old_idv, void *new_idv, const short r
   BKE_main_unlock(bmain);
 }
 
+/* Update all nodes using one of the new IDs (or no ID at all when some old IDs were unlinked),
+ * same as #ntreeUpdateAllUsers but for all remapped IDs at once. */
+static void libblock_remap_data_postprocess_nodetree_update_multiple(Main *bmain,
+                                                                     GSet *new_ids,
+                                                                     const bool has_unlinked)
+{
+  FOREACH_NODETREE_BEGIN (bmain, ntree, owner_id) {
+    bool need_update = false;
+
+    LISTBASE_FOREACH (bNode *, node, &ntree->nodes) {
+      if ((node->id == NULL) ? has_unlinked : BLI_gset_haskey(new_ids, node->id)) {
+        if (node->typeinfo->group_update_func) {
+          node->typeinfo->group_update_func(ntree, node);
+        }
+
+        need_update = true;
+      }
+    }
+
+    if (need_update) {
+      ntreeUpdateTree(NULL, ntree);
+    }
+  }
+  FOREACH_NODETREE_END;
+}
+
+/**
+ * Same as #BKE_libblock_remap_locked, but for many IDs at once: \a old_to_new_ids maps old IDs
+ * to their new ID (or NULL to unlink them), all usages of all old IDs in \a bmain are remapped
+ * in a single loop over the Main database, instead of one loop for each old ID.
+ *
+ * \note New IDs are not remapped themselves, i.e. an ID cannot be both a new ID and an old ID
+ * of the same mapping.
+ */
+void BKE_libblock_remap_multiple_locked(Main *bmain,
+                                        GHash *old_to_new_ids,
+                                        const short remap_flags)
+{
+  const int remap_num = (int)BLI_ghash_len(old_to_new_ids);
+  if (remap_num == 0) {
+    return;
+  }
+
+  const int foreach_id_flags = (remap_flags & ID_REMAP_NO_INDIRECT_PROXY_DATA_USAGE) != 0 ?
+                                   IDWALK_NO_INDIRECT_PROXY_DATA_USAGE :
+                                   IDWALK_NOP;
+  IDRemap *id_remaps = MEM_mallocN(sizeof(*id_remaps) * (size_t)remap_num, __func__);
+  IDRemapMultiple id_remap_multiple = {
+      .id_remaps = BLI_ghash_ptr_new_ex(__func__, (uint)remap_num),
+      .id_owner = NULL,
+  };
+  GSet *new_ids = BLI_gset_ptr_new_ex(__func__, (uint)remap_num);
+  bool used_types[INDEX_ID_MAX] = {false};
+  short types[INDEX_ID_MAX];
+  int types_num = 0;
+  bool has_unlinked = false;
+  bool has_objects = false, has_unlinked_objects = false;
+  bool has_collections = false, has_unlinked_collections = false;
+  bool has_remapped_collections = false;
+  bool has_obdata = false;
+
+  GHashIterator gh_iter;
+  int i = 0;
+  GHASH_ITER_INDEX (gh_iter, old_to_new_ids, i) {
+    ID *old_id = BLI_ghashIterator_getKey(&gh_iter);
+    ID *new_id = BLI_ghashIterator_getValue(&gh_iter);
+
+    BLI_assert((new_id == NULL) || GS(old_id->name) == GS(new_id->name));
+    BLI_assert(old_id != new_id);
+    BLI_assert(new_id == NULL || !BLI_ghash_haskey(old_to_new_ids, new_id));
+
+    libblock_remap_data_init(&id_remaps[i], bmain, old_id, new_id, remap_flags);
+    BLI_ghash_insert(id_remap_multiple.id_remaps, old_id, &id_remaps[i]);
+
+    if (new_id != NULL) {
+      BLI_gset_add(new_ids, new_id);
+    }
+    else {
+      has_unlinked = true;
+    }
+
+    const short id_type = GS(old_id->name);
+    const int id_type_index = BKE_idtype_idcode_to_index(id_type);
+    if (!used_types[id_type_index]) {
+      used_types[id_type_index] = true;
+      types[types_num++] = id_type;
+    }
+    switch (id_type) {
+      case ID_OB:
+        has_objects = true;
+        has_unlinked_objects |= (new_id == NULL);
+        break;
+      case ID_GR:
+        has_collections = true;
+        has_unlinked_collections |= (new_id == NULL);
+        has_remapped_collections |= (new_id != NULL);
+        break;
+      case ID_ME:
+      case ID_CU:
+      case ID_MB:
+      case ID_HA:
+      case ID_PT:
+      case ID_VO:
+        /* Only affects us in case obdata was relinked (changed). */
+        has_obdata |= (new_id != NULL);
+        break;
+      default:
+        break;
+    }
+  }
+
+  ID *id_curr;
+  FOREACH_MAIN_ID_BEGIN (bmain, id_curr) {
+    bool can_use = false;
+    for (int j = 0; j < types_num && !can_use; j++) {
+      can_use = BKE_library_id_can_use_idtype(id_curr, types[j]);
+    }
+    if (!can_use) {
+      continue;
+    }
+
+    id_remap_multiple.id_owner = id_curr;
+    if (GS(id_curr->name) == ID_OB && ((Object *)id_curr)->data != NULL) {
+      IDRemap *id_remap_data = BLI_ghash_lookup(id_remap_multiple.id_remaps,
+                                                ((Object *)id_curr)->data);
+      if (id_remap_data != NULL) {
+        id_remap_data->id_owner = id_curr;
+        libblock_remap_data_preprocess(id_remap_data);
+      }
+    }
+    BKE_library_foreach_ID_link(NULL,
+                                id_curr,
+                                foreach_libblock_remap_multiple_callback,
+                                &id_remap_multiple,
+                                foreach_id_flags);
+  }
+  FOREACH_MAIN_ID_END;
+
+  for (i = 0; i < remap_num; i++) {
+    libblock_remap_data_update_tags(&id_remaps[i]);
+    libblock_remap_old_id_update(&id_remaps[i]);
+  }
+
+  /* Same after-process updates as in #BKE_libblock_remap_locked, done once for all IDs. */
+  if (has_unlinked_objects) {
+    BKE_collections_object_remove_nulls(bmain);
+  }
+  if (has_unlinked_collections) {
+    BKE_collections_child_remove_nulls(bmain, NULL);
+  }
+  if (has_remapped_collections) {
+    BKE_main_collections_parent_relations_rebuild(bmain);
+  }
+  if (has_objects || has_collections) {
+    BKE_main_collection_sync_remap(bmain);
+  }
+  if (has_objects) {
+    for (Object *ob = bmain->objects.first; ob != NULL; ob = ob->id.next) {
+      if (ob->type == OB_MBALL && BKE_mball_is_basis(ob)) {
+        DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
+      }
+    }
+  }
+  if (has_obdata) {
+    for (Object *ob = bmain->objects.first; ob; ob = ob->id.next) {
+      if (ob->data != NULL && BLI_gset_haskey(new_ids, ob->data)) {
+        libblock_remap_data_postprocess_obdata_relink(bmain, ob, ob->data);
+      }
+    }
+  }
+
+  /* See #BKE_libblock_remap_locked about unlocking here. */
+  BKE_main_unlock(bmain);
+  libblock_remap_data_postprocess_nodetree_update_multiple(bmain, new_ids, has_unlinked);
+  BKE_main_lock(bmain);
+
+  /* Full rebuild of DEG! */
+  DEG_relations_tag_update(bmain);
+
+  BLI_gset_free(new_ids, NULL);
+  BLI_ghash_free(id_remap_multiple.id_remaps, NULL, NULL);
+  MEM_freeN(id_remaps);
+}
+
+void BKE_libblock_remap_multiple(Main *bmain, GHash *old_to_new_ids, const short remap_flags)
+{
+  BKE_main_lock(bmain);
+
+  BKE_libblock_remap_multiple_locked(bmain, old_to_new_ids, remap_flags);
+
+  BKE_main_unlock(bmain);
+}
+
 /**
  * Unlink given \a id from given \a bmain
  * (does not touch to indirect, i.e. library, usages of the ID).
@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_lib_remap.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+namespace blender::bke::tests {
+
+class LibRemapMultipleTest : public testing::Test {
+ protected:
+  static const int ids_num = 4;
+
+  Main *bmain = nullptr;
+  Object *objects[ids_num];
+  Mesh *meshes_old[ids_num];
+  Mesh *meshes_new[ids_num];
+
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    bmain = BKE_main_new();
+    for (int i = 0; i < ids_num; i++) {
+      meshes_old[i] = BKE_mesh_add(bmain, "MeshOld");
+      meshes_new[i] = BKE_mesh_add(bmain, "MeshNew");
+      objects[i] = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+      /* The user of the old mesh, new ones keep their initial user. */
+      objects[i]->data = meshes_old[i];
+    }
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+};
+
+TEST_F(LibRemapMultipleTest, Remap)
+{
+  GHash *old_to_new_ids = BLI_ghash_ptr_new(__func__);
+  for (int i = 0; i < ids_num - 1; i++) {
+    BLI_ghash_insert(old_to_new_ids, meshes_old[i], meshes_new[i]);
+  }
+  BKE_libblock_remap_multiple(bmain, old_to_new_ids, ID_REMAP_SKIP_INDIRECT_USAGE);
+  BLI_ghash_free(old_to_new_ids, nullptr, nullptr);
+
+  for (int i = 0; i < ids_num - 1; i++) {
+    EXPECT_EQ(objects[i]->data, meshes_new[i]);
+    EXPECT_EQ(meshes_old[i]->id.us, 0);
+    EXPECT_EQ(meshes_new[i]->id.us, 2);
+  }
+  /* Not in the mapping, left untouched. */
+  EXPECT_EQ(objects[ids_num - 1]->data, meshes_old[ids_num - 1]);
+  EXPECT_EQ(meshes_old[ids_num - 1]->id.us, 1);
+}
+
+TEST_F(LibRemapMultipleTest, Unlink)
+{
+  /* Objects cannot have no data, their usages are only flagged by default. */
+  BKE_main_id_tag_all(bmain, LIB_TAG_DOIT, false);
+  GHash *old_to_new_ids = BLI_ghash_ptr_new(__func__);
+  BLI_ghash_insert(old_to_new_ids, meshes_old[0], nullptr);
+  BLI_ghash_insert(old_to_new_ids, meshes_old[1], nullptr);
+  BKE_libblock_remap_multiple(bmain, old_to_new_ids, ID_REMAP_FLAG_NEVER_NULL_USAGE);
+  BLI_ghash_free(old_to_new_ids, nullptr, nullptr);
+
+  EXPECT_EQ(objects[0]->data, meshes_old[0]);
+  EXPECT_EQ(objects[1]->data, meshes_old[1]);
+  EXPECT_TRUE(objects[0]->id.tag & LIB_TAG_DOIT);
+  EXPECT_TRUE(objects[1]->id.tag & LIB_TAG_DOIT);
+  EXPECT_FALSE(objects[2]->id.tag & LIB_TAG_DOIT);
+
+  /* Batch deletion of the tagged objects and meshes. */
+  meshes_old[0]->id.tag |= LIB_TAG_DOIT;
+  meshes_old[1]->id.tag |= LIB_TAG_DOIT;
+  BKE_id_multi_tagged_delete(bmain);
+  EXPECT_EQ(BLI_listbase_count(&bmain->objects), ids_num - 2);
+  EXPECT_EQ(BLI_listbase_count(&bmain->meshes), ids_num * 2 - 2);
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,415 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_ghash.h"
+#include "BLI_math_base.h"
+#include "BLI_math_bits.h"
+#include "BLI_listbase.h"
+#include "BLI_mempool.h"
+#include "BLI_string.h"
+#include "BLI_string_utf8.h"
+#include "BLI_string_utils.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_ID.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_main_namemap.h" /* own include */
+
+/** \file
+ * \ingroup bke
+ *
+ * Index of the local ID names of a Main, used to find unique names in constant time.
+ */
+
+/* Note: this code assumes and ensures that the suffix number can never go beyond 1 billion. */
+#define MAX_NUMBER 1000000000
+/* We do not want to get "name.000", so minimal number is 1. */
+#define MIN_NUMBER 1
+/* The maximum value up to which we search for the actual smallest unused number. Beyond that
+ * value, we will only use the first biggest unused number, without trying to 'fill the gaps'
+ * in-between already used numbers... */
+#define MAX_NUMBERS_IN_USE 1024
+
+/* -------------------------------------------------------------------- */
+/** \name Name Map Storage
+ *
+ * Only local IDs are indexed, linked ones already have a unique name in their library.
+ * \{ */
+
+typedef struct UniqueName_Entry {
+  char name[MAX_ID_NAME - 2];
+  struct ID *id;
+} UniqueName_Entry;
+
+/** Numbers used by all the names sharing a same base name (e.g. "Cube", "Cube.001"...). */
+typedef struct UniqueName_Base {
+  char name[MAX_ID_NAME - 2];
+  /** Numbers in [0 .. MAX_NUMBERS_IN_USE - 1] currently in use. */
+  BLI_bitmap numbers_in_use[_BITMAP_NUM_BLOCKS(MAX_NUMBERS_IN_USE)];
+  /** Biggest number used so far, it is not lowered when names get removed. */
+  int max_number;
+} UniqueName_Base;
+
+typedef struct UniqueName_TypeMap {
+  /** #UniqueName_Entry.name -> #UniqueName_Entry. */
+  GHash *names;
+  /** #ID -> #UniqueName_Entry. */
+  GHash *ids;
+  /** #UniqueName_Base.name -> #UniqueName_Base. */
+  GHash *base_names;
+
+  BLI_mempool *entry_pool;
+  BLI_mempool *base_pool;
+} UniqueName_TypeMap;
+
+/**
+ * Opaque structure, external API users only see this.
+ */
+struct UniqueName_Map {
+  UniqueName_TypeMap *type_maps[INDEX_ID_MAX];
+};
+
+static UniqueName_Base *namemap_base_ensure(UniqueName_TypeMap *type_map, const char *base_name)
+{
+  void **key_p, **val_p;
+  if (BLI_ghash_ensure_p_ex(type_map->base_names, base_name, &key_p, &val_p)) {
+    return *val_p;
+  }
+
+  UniqueName_Base *base = BLI_mempool_calloc(type_map->base_pool);
+  BLI_strncpy(base->name, base_name, sizeof(base->name));
+  /* Given key is only valid during that call, use the storage of the base instead. */
+  *key_p = base->name;
+  *val_p = base;
+  return base;
+}
+
+static void namemap_base_number_add(UniqueName_Base *base, const int number)
+{
+  if (number < MAX_NUMBERS_IN_USE) {
+    BLI_BITMAP_ENABLE(base->numbers_in_use, number);
+  }
+  base->max_number = max_ii(base->max_number, number);
+}
+
+/**
+ * \return The smallest unused number of \a base if there is one below #MAX_NUMBERS_IN_USE,
+ * otherwise the first number above all used ones.
+ */
+static int namemap_base_number_unused(const UniqueName_Base *base)
+{
+  for (int block = 0; block < _BITMAP_NUM_BLOCKS(MAX_NUMBERS_IN_USE); block++) {
+    BLI_bitmap used = base->numbers_in_use[block];
+    if (block == 0) {
+      /* Ignore numbers below MIN_NUMBER. */
+      used |= (1u << MIN_NUMBER) - 1;
+    }
+    if (used != UINT_MAX) {
+      const int number = (block << _BITMAP_POWER) + (int)bitscan_forward_uint(~used);
+      if (number < MAX_NUMBERS_IN_USE) {
+        return number;
+      }
+    }
+  }
+  return base->max_number + 1;
+}
+
+static void namemap_add(UniqueName_TypeMap *type_map, ID *id, const char *name)
+{
+  UniqueName_Entry *entry = BLI_mempool_alloc(type_map->entry_pool);
+  BLI_strncpy(entry->name, name, sizeof(entry->name));
+  entry->id = id;
+  BLI_ghash_insert(type_map->names, entry->name, entry);
+  BLI_ghash_insert(type_map->ids, id, entry);
+
+  char base_name[MAX_ID_NAME - 2];
+  int number;
+  BLI_split_name_num(base_name, &number, name, '.');
+  namemap_base_number_add(namemap_base_ensure(type_map, base_name), min_ii(number, MAX_NUMBER));
+}
+
+static void namemap_remove(UniqueName_TypeMap *type_map, ID *id)
+{
+  UniqueName_Entry *entry = BLI_ghash_popkey(type_map->ids, id, NULL);
+  if (entry == NULL) {
+    return;
+  }
+  BLI_ghash_remove(type_map->names, entry->name, NULL, NULL);
+
+  char base_name[MAX_ID_NAME - 2];
+  int number;
+  BLI_split_name_num(base_name, &number, entry->name, '.');
+  UniqueName_Base *base = BLI_ghash_lookup(type_map->base_names, base_name);
+  if (base != NULL && number < MAX_NUMBERS_IN_USE) {
+    BLI_BITMAP_DISABLE(base->numbers_in_use, number);
+  }
+
+  BLI_mempool_free(type_map->entry_pool, entry);
+}
+
+static void namemap_type_free(UniqueName_TypeMap *type_map)
+{
+  BLI_ghash_free(type_map->names, NULL, NULL);
+  BLI_ghash_free(type_map->ids, NULL, NULL);
+  BLI_ghash_free(type_map->base_names, NULL, NULL);
+  BLI_mempool_destroy(type_map->entry_pool);
+  BLI_mempool_destroy(type_map->base_pool);
+  MEM_freeN(type_map);
+}
+
+/**
+ * \param id_skip: ID not added when building the index, since its name is being changed.
+ */
+static UniqueName_TypeMap *namemap_type_ensure(Main *bmain, const short id_type, ID *id_skip)
+{
+  if (bmain->name_map == NULL) {
+    bmain->name_map = MEM_callocN(sizeof(*bmain->name_map), __func__);
+  }
+
+  UniqueName_TypeMap **type_map_p =
+      &bmain->name_map->type_maps[BKE_idtype_idcode_to_index(id_type)];
+  if (*type_map_p != NULL) {
+    return *type_map_p;
+  }
+
+  ListBase *lb = which_libbase(bmain, id_type);
+  const uint reserve = (uint)BLI_listbase_count(lb);
+
+  UniqueName_TypeMap *type_map = MEM_mallocN(sizeof(*type_map), __func__);
+  type_map->names = BLI_ghash_str_new_ex(__func__, reserve);
+  type_map->ids = BLI_ghash_ptr_new_ex(__func__, reserve);
+  type_map->base_names = BLI_ghash_str_new(__func__);
+  type_map->entry_pool = BLI_mempool_create(sizeof(UniqueName_Entry), 0, 512, BLI_MEMPOOL_NOP);
+  type_map->base_pool = BLI_mempool_create(sizeof(UniqueName_Base), 0, 64, BLI_MEMPOOL_NOP);
+
+  LISTBASE_FOREACH (ID *, id, lb) {
+    /* Names should be unique, but do not rely on it: the first ID using a name is indexed. */
+    if (id != id_skip && !ID_IS_LINKED(id) && !BLI_ghash_haskey(type_map->names, id->name + 2)) {
+      namemap_add(type_map, id, id->name + 2);
+    }
+  }
+
+  *type_map_p = type_map;
+  return type_map;
+}
+
+void BKE_main_namemap_destroy(struct UniqueName_Map **r_name_map)
+{
+  if (*r_name_map == NULL) {
+    return;
+  }
+  for (int i = 0; i < INDEX_ID_MAX; i++) {
+    if ((*r_name_map)->type_maps[i] != NULL) {
+      namemap_type_free((*r_name_map)->type_maps[i]);
+    }
+  }
+  MEM_SAFE_FREE(*r_name_map);
+}
+
+/**
+ * Discard the whole index, it will be re-built from the ID lists when needed.
+ */
+void BKE_main_namemap_clear(Main *bmain)
+{
+  BKE_main_namemap_destroy(&bmain->name_map);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Unique Names
+ * \{ */
+
+/**
+ * Helper building final ID name from given base_name and number.
+ *
+ * If everything goes well and we do generate a valid final ID name in given name, we return
+ * true. In case the final name would overflow the allowed ID name length, or given number is
+ * bigger than maximum allowed value, we truncate further the base_name (and given name, which is
+ * assumed to have the same 'base_name' part), and return false.
+ */
+static bool id_name_final_build(char *name, char *base_name, size_t base_name_len, int number)
+{
+  char number_str[11]; /* Dot + nine digits + NULL terminator. */
+  size_t number_str_len = BLI_snprintf_rlen(number_str, ARRAY_SIZE(number_str), ".%.3d", number);
+
+  /* If the number would lead to an overflow of the maximum ID name length, we need to truncate
+   * the base name part and do all the number checks again. */
+  if (base_name_len + number_str_len >= MAX_ID_NAME - 2 || number >= MAX_NUMBER) {
+    if (base_name_len + number_str_len >= MAX_ID_NAME - 2) {
+      base_name_len = MAX_ID_NAME - 2 - number_str_len - 1;
+    }
+    else {
+      base_name_len--;
+    }
+    base_name[base_name_len] = '\0';
+
+    /* Code above may have generated invalid utf-8 string, due to raw truncation.
+     * Ensure we get a valid one now. */
+    base_name_len -= (size_t)BLI_utf8_invalid_strip(base_name, base_name_len);
+
+    /* Also truncate orig name, and start the whole check again. */
+    name[base_name_len] = '\0';
+    return false;
+  }
+
+  /* We have our final number, we can put it in name and exit the function. */
+  BLI_strncpy(name + base_name_len, number_str, number_str_len + 1);
+  return true;
+}
+
+/**
+ * Check to see if an ID name is already used by another local ID, and find a new one if so.
+ * The final name is registered for \a id, which must be in its Main list already.
+ *
+ * \param r_id_sorting_hint: Set to an ID sorted right before the new name, when known.
+ * \return true if a new name was created (returned in name).
+ */
+bool BKE_main_namemap_get_name(Main *bmain, ID *id, char *name, ID **r_id_sorting_hint)
+{
+  BLI_assert(strlen(name) < MAX_ID_NAME - 2);
+
+  UniqueName_TypeMap *type_map = namemap_type_ensure(bmain, GS(id->name), id);
+  namemap_remove(type_map, id);
+
+  *r_id_sorting_hint = NULL;
+  bool is_name_changed = false;
+
+  while (BLI_ghash_haskey(type_map->names, name)) {
+    /* Get the name and number parts ("name.number"). */
+    char base_name[MAX_ID_NAME - 2];
+    int number;
+    size_t base_name_len = BLI_split_name_num(base_name, &number, name, '.');
+
+    /* In case we get an insane initial number suffix in given name. */
+    if (number >= MAX_NUMBER || number < MIN_NUMBER) {
+      number = MIN_NUMBER;
+    }
+
+    UniqueName_Base *base = namemap_base_ensure(type_map, base_name);
+    const int number_unused = namemap_base_number_unused(base);
+    number = (number_unused < MAX_NUMBERS_IN_USE) ? number_unused : max_ii(number, number_unused);
+
+    /* We know for sure that name will be changed. */
+    is_name_changed = true;
+
+    /* If id_name_final_build helper returns false, it had to truncate further given name, hence
+     * we have to go over the whole check again. */
+    if (!id_name_final_build(name, base_name, base_name_len, number)) {
+      continue;
+    }
+
+    /* The new name can still be used with a differently formatted number (e.g. "name.1"),
+     * in which case the next unused number is tried. */
+    if (BLI_ghash_haskey(type_map->names, name)) {
+      namemap_base_number_add(base, number);
+      continue;
+    }
+
+    /* Names of a same base are typically sorted by number. */
+    char name_prev[MAX_ID_NAME - 2];
+    if (number > MIN_NUMBER) {
+      BLI_snprintf(name_prev, sizeof(name_prev), "%s.%.3d", base_name, number - 1);
+    }
+    else {
+      BLI_strncpy(name_prev, base_name, sizeof(name_prev));
+    }
+    UniqueName_Entry *entry_prev = BLI_ghash_lookup(type_map->names, name_prev);
+    if (entry_prev != NULL) {
+      *r_id_sorting_hint = entry_prev->id;
+    }
+  }
+
+  namemap_add(type_map, id, name);
+  return is_name_changed;
+}
+
+/**
+ * Remove \a id from the index, it must be called when removing a local ID from its Main.
+ */
+void BKE_main_namemap_remove_id(Main *bmain, ID *id)
+{
+  if (bmain->name_map == NULL) {
+    return;
+  }
+  UniqueName_TypeMap *type_map =
+      bmain->name_map->type_maps[BKE_idtype_idcode_to_index(GS(id->name))];
+  if (type_map != NULL) {
+    namemap_remove(type_map, id);
+  }
+}
+
+/**
+ * \return The local ID of given type using given name, if any.
+ */
+ID *BKE_main_namemap_find_name(Main *bmain, const short id_type, const char *name)
+{
+  UniqueName_TypeMap *type_map = namemap_type_ensure(bmain, id_type, NULL);
+  UniqueName_Entry *entry = BLI_ghash_lookup(type_map->names, name);
+  /* Do not trust entries of IDs renamed without updating the index. */
+  if (entry != NULL && STREQ(entry->id->name + 2, name)) {
+    return entry->id;
+  }
+  return NULL;
+}
+
+/**
+ * Check that the existing indices match the local IDs of \a bmain, for debugging and tests.
+ */
+bool BKE_main_namemap_validate(Main *bmain)
+{
+  if (bmain->name_map == NULL) {
+    return true;
+  }
+
+  bool is_valid = true;
+  for (int i = 0; i < INDEX_ID_MAX; i++) {
+    UniqueName_TypeMap *type_map = bmain->name_map->type_maps[i];
+    if (type_map == NULL) {
+      continue;
+    }
+
+    uint local_ids_num = 0;
+    ListBase *lb = which_libbase(bmain, BKE_idtype_idcode_from_index(i));
+    LISTBASE_FOREACH (ID *, id, lb) {
+      if (ID_IS_LINKED(id)) {
+        continue;
+      }
+      local_ids_num++;
+      UniqueName_Entry *entry = BLI_ghash_lookup(type_map->ids, id);
+      if (entry == NULL || !STREQ(entry->name, id->name + 2) ||
+          BLI_ghash_lookup(type_map->names, entry->name) != entry) {
+        is_valid = false;
+      }
+    }
+    if (BLI_ghash_len(type_map->ids) != local_ids_num ||
+        BLI_ghash_len(type_map->names) != local_ids_num) {
+      is_valid = false;
+    }
+  }
+  return is_valid;
+}
+
+/** \} */
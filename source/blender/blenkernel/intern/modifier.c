@@ -107,6 +107,8 @@ void BKE_modifier_init(void)
   virtualModifierCommonData.cmd.modifier.mode |= eModifierMode_Virtual;
   virtualModifierCommonData.lmd.modifier.mode |= eModifierMode_Virtual;
   virtualModifierCommonData.smd.modifier.mode |= eModifierMode_Virtual;
+
+  BKE_modifier_result_cache_init();
 }
 
 const ModifierTypeInfo *BKE_modifier_get_info(ModifierType type)
@@ -182,6 +184,8 @@ void BKE_modifier_free_ex(ModifierData *md, const int flag)
     if (mti->foreachIDLink) {
       mti->foreachIDLink(md, NULL, modifier_free_data_id_us_cb, NULL);
     }
+    /* Modifier is deleted by the user, evaluated copies share its session UUID. */
+    BKE_modifier_result_cache_remove(md);
   }
 
   if (mti->freeData) {
@@ -0,0 +1,469 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * Cache of modifier results, shared by all evaluations of the same modifier.
+ *
+ * Modifiers with #eModifierFlag_UseResultCache store a copy of the mesh they produced,
+ * together with a hash of their input mesh and of their settings. As long as both hashes
+ * match on the next evaluation the copy is returned instead of running the modifier again,
+ * so changing a setting of a modifier only re-evaluates that modifier and the ones after it.
+ *
+ * Entries are keyed by the session UUID of the modifier, which is shared between the original
+ * and its evaluated copies. The least recently used entries are freed when the total memory
+ * of the cached meshes exceeds the limit.
+ *
+ * Entries are also freed along with their modifier or original object, and all of them when a
+ * file is loaded. Memfile undo keeps them: unchanged objects keep their modifiers and the hashes
+ * still tell whether a result can be used.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_listbase.h"
+#include "BLI_session_uuid.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+
+#include "DEG_depsgraph_query.h"
+
+#define MODIFIER_RESULT_CACHE_DEFAULT_LIMIT ((size_t)256 * 1024 * 1024)
+
+typedef struct ModifierResultCacheEntry {
+  struct ModifierResultCacheEntry *next, *prev;
+
+  SessionUUID session_uuid;
+
+  /* Hashes and element counts of the input, counts are compared too to make
+   * hash collisions between different meshes even less likely. */
+  uint input_hash;
+  uint settings_hash;
+  int input_totvert, input_totedge, input_totloop, input_totpoly;
+
+  struct Mesh *result;
+  size_t result_mem;
+} ModifierResultCacheEntry;
+
+static struct {
+  /* Entries ordered from least to most recently used. */
+  ListBase entries;
+  /* SessionUUID -> ModifierResultCacheEntry. */
+  GHash *entries_map;
+  ThreadMutex mutex;
+  bool mutex_initialized;
+
+  size_t memory_limit;
+  size_t memory_used;
+
+  int hits;
+  int misses;
+  int evictions;
+} g_result_cache = {
+    .memory_limit = MODIFIER_RESULT_CACHE_DEFAULT_LIMIT,
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Hashing
+ * \{ */
+
+static void hash_customdata(BLI_HashMurmur2A *mm2, const CustomData *data, int totelem)
+{
+  BLI_hash_mm2a_add_int(mm2, data->totlayer);
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    BLI_hash_mm2a_add_int(mm2, layer->type);
+    BLI_hash_mm2a_add_int(mm2, layer->flag);
+    BLI_hash_mm2a_add_int(mm2, layer->active);
+    BLI_hash_mm2a_add_int(mm2, layer->active_rnd);
+    BLI_hash_mm2a_add(mm2, (const uchar *)layer->name, strlen(layer->name));
+
+    if (layer->data == NULL) {
+      continue;
+    }
+    if (layer->type == CD_MDEFORMVERT) {
+      /* Weights are stored outside of the layer. */
+      const MDeformVert *dvert = layer->data;
+      for (int j = 0; j < totelem; j++) {
+        BLI_hash_mm2a_add_int(mm2, dvert[j].totweight);
+        if (dvert[j].dw) {
+          BLI_hash_mm2a_add(
+              mm2, (const uchar *)dvert[j].dw, sizeof(*dvert[j].dw) * (size_t)dvert[j].totweight);
+        }
+      }
+    }
+    else {
+      BLI_hash_mm2a_add(
+          mm2, (const uchar *)layer->data, (size_t)CustomData_sizeof(layer->type) * totelem);
+    }
+  }
+}
+
+static uint hash_input_mesh(const Object *ob, const Mesh *mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totcol);
+  BLI_hash_mm2a_add_int(&mm2, mesh->flag);
+  BLI_hash_mm2a_add_int(&mm2, mesh->cd_flag);
+  BLI_hash_mm2a_add(&mm2, (const uchar *)&mesh->smoothresh, sizeof(mesh->smoothresh));
+  /* Normals may be stale, in which case they are recomputed by the modifier. */
+  BLI_hash_mm2a_add_int(&mm2, mesh->runtime.cd_dirty_vert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->runtime.cd_dirty_poly);
+  BLI_hash_mm2a_add_int(&mm2, mesh->runtime.cd_dirty_loop);
+
+  hash_customdata(&mm2, &mesh->vdata, mesh->totvert);
+  hash_customdata(&mm2, &mesh->edata, mesh->totedge);
+  hash_customdata(&mm2, &mesh->ldata, mesh->totloop);
+  hash_customdata(&mm2, &mesh->pdata, mesh->totpoly);
+
+  /* Vertex groups are looked up by name on the object. */
+  LISTBASE_FOREACH (const bDeformGroup *, dg, &ob->defbase) {
+    BLI_hash_mm2a_add(&mm2, (const uchar *)dg->name, strlen(dg->name));
+  }
+
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+static uint hash_modifier_settings(ModifierData *md, const ModifierEvalContext *ctx)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+  const struct SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(sdna, mti->structName);
+
+  /* Leave out the generic modifier data, it only holds UI and bookkeeping state,
+   * evaluation flags are taken from the context. */
+  void *md_settings = MEM_dupallocN(md);
+  memset(md_settings, 0, sizeof(ModifierData));
+  uint hash = DNA_struct_hash_values(sdna, struct_nr, md_settings, (uint)md->type);
+  MEM_freeN(md_settings);
+
+  const Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
+  const int simplify[4] = {
+      ctx->flag,
+      (scene->r.mode & R_SIMPLIFY) != 0,
+      scene->r.simplify_subsurf,
+      scene->r.simplify_subsurf_render,
+  };
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, hash);
+  BLI_hash_mm2a_add(&mm2, (const uchar *)simplify, sizeof(simplify));
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Storage
+ * \{ */
+
+static void result_cache_lock(void)
+{
+  /* Evaluation of different objects can run in parallel. */
+  BLI_assert(g_result_cache.mutex_initialized);
+  BLI_mutex_lock(&g_result_cache.mutex);
+}
+
+static void result_cache_unlock(void)
+{
+  BLI_mutex_unlock(&g_result_cache.mutex);
+}
+
+static size_t customdata_memory_size(const CustomData *data, int totelem)
+{
+  size_t mem = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    mem += (size_t)CustomData_sizeof(data->layers[i].type) * totelem;
+  }
+  return mem;
+}
+
+static size_t mesh_memory_size(const Mesh *mesh)
+{
+  size_t mem = sizeof(Mesh) + customdata_memory_size(&mesh->vdata, mesh->totvert) +
+               customdata_memory_size(&mesh->edata, mesh->totedge) +
+               customdata_memory_size(&mesh->ldata, mesh->totloop) +
+               customdata_memory_size(&mesh->pdata, mesh->totpoly);
+
+  /* Vertex group weights are allocated separately from the layer. */
+  const MDeformVert *dvert = CustomData_get_layer(&mesh->vdata, CD_MDEFORMVERT);
+  if (dvert != NULL) {
+    for (int i = 0; i < mesh->totvert; i++) {
+      mem += sizeof(MDeformWeight) * (size_t)dvert[i].totweight;
+    }
+  }
+  return mem;
+}
+
+/* Caller must hold the lock. */
+static void result_cache_entry_remove(ModifierResultCacheEntry *entry)
+{
+  BLI_ghash_remove(g_result_cache.entries_map, &entry->session_uuid, NULL, NULL);
+  BLI_remlink(&g_result_cache.entries, entry);
+  g_result_cache.memory_used -= entry->result_mem;
+  BKE_id_free(NULL, entry->result);
+  MEM_freeN(entry);
+}
+
+/* Caller must hold the lock. */
+static void result_cache_enforce_limit(void)
+{
+  while (g_result_cache.memory_used > g_result_cache.memory_limit &&
+         g_result_cache.entries.first) {
+    result_cache_entry_remove(g_result_cache.entries.first);
+    g_result_cache.evictions++;
+  }
+}
+
+static void foreach_id_check_cb(void *user_data,
+                                Object *UNUSED(ob),
+                                ID **idpoin,
+                                int UNUSED(cb_flag))
+{
+  bool *r_uses_ids = user_data;
+  if (*idpoin != NULL) {
+    *r_uses_ids = true;
+  }
+}
+
+static void foreach_tex_check_cb(void *user_data,
+                                 Object *UNUSED(ob),
+                                 ModifierData *UNUSED(md),
+                                 const char *UNUSED(propname))
+{
+  bool *r_uses_ids = user_data;
+  *r_uses_ids = true;
+}
+
+/**
+ * Results can only be reused when they depend on nothing but the input mesh and the
+ * modifier's own settings. Modifiers referencing other data-blocks (objects, textures,
+ * node groups...) or depending on time are never cached.
+ */
+static bool result_cache_is_supported(ModifierData *md,
+                                      const ModifierEvalContext *ctx,
+                                      const Mesh *mesh)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+  if ((md->flag & eModifierFlag_UseResultCache) == 0) {
+    return false;
+  }
+  if (mti->type != eModifierTypeType_Constructive) {
+    return false;
+  }
+  if (ctx->flag & MOD_APPLY_ORCO) {
+    return false;
+  }
+  if (md->type == eModifierType_Multires) {
+    return false;
+  }
+  if (mesh->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return false;
+  }
+  /* Displacement data is stored outside of the layer and not hashed. */
+  if (CustomData_has_layer(&mesh->ldata, CD_MDISPS) ||
+      CustomData_has_layer(&mesh->ldata, CD_GRID_PAINT_MASK)) {
+    return false;
+  }
+  if (BKE_modifier_depends_ontime(md)) {
+    return false;
+  }
+
+  bool uses_ids = false;
+  if (mti->foreachIDLink) {
+    mti->foreachIDLink(md, ctx->object, foreach_id_check_cb, &uses_ids);
+  }
+  if (mti->foreachTexLink) {
+    mti->foreachTexLink(md, ctx->object, foreach_tex_check_cb, &uses_ids);
+  }
+  return !uses_ids;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+/**
+ * Same as #BKE_modifier_modify_mesh, but returns a copy of the cached result when the modifier
+ * uses the result cache and neither \a me nor the modifier settings changed since the last
+ * evaluation.
+ */
+struct Mesh *BKE_modifier_modify_mesh_cached(ModifierData *md,
+                                             const ModifierEvalContext *ctx,
+                                             struct Mesh *me)
+{
+  if (!result_cache_is_supported(md, ctx, me)) {
+    return BKE_modifier_modify_mesh(md, ctx, me);
+  }
+
+  const uint input_hash = hash_input_mesh(ctx->object, me);
+  const uint settings_hash = hash_modifier_settings(md, ctx);
+
+  result_cache_lock();
+  ModifierResultCacheEntry *entry = BLI_ghash_lookup(g_result_cache.entries_map,
+                                                     &md->session_uuid);
+  if (entry != NULL && entry->input_hash == input_hash &&
+      entry->settings_hash == settings_hash && entry->input_totvert == me->totvert &&
+      entry->input_totedge == me->totedge && entry->input_totloop == me->totloop &&
+      entry->input_totpoly == me->totpoly) {
+    Mesh *result = BKE_mesh_copy_for_eval(entry->result, false);
+    BLI_remlink(&g_result_cache.entries, entry);
+    BLI_addtail(&g_result_cache.entries, entry);
+    g_result_cache.hits++;
+    result_cache_unlock();
+    return result;
+  }
+  g_result_cache.misses++;
+  result_cache_unlock();
+
+  Mesh *result = BKE_modifier_modify_mesh(md, ctx, me);
+  if (result == NULL) {
+    return result;
+  }
+
+  Mesh *result_copy = BKE_mesh_copy_for_eval(result, false);
+  const size_t result_mem = mesh_memory_size(result_copy);
+  if (result_mem > g_result_cache.memory_limit) {
+    BKE_id_free(NULL, result_copy);
+    return result;
+  }
+
+  result_cache_lock();
+  entry = BLI_ghash_lookup(g_result_cache.entries_map, &md->session_uuid);
+  if (entry != NULL) {
+    result_cache_entry_remove(entry);
+  }
+  entry = MEM_callocN(sizeof(*entry), __func__);
+  entry->session_uuid = md->session_uuid;
+  entry->input_hash = input_hash;
+  entry->settings_hash = settings_hash;
+  entry->input_totvert = me->totvert;
+  entry->input_totedge = me->totedge;
+  entry->input_totloop = me->totloop;
+  entry->input_totpoly = me->totpoly;
+  entry->result = result_copy;
+  entry->result_mem = result_mem;
+  BLI_addtail(&g_result_cache.entries, entry);
+  BLI_ghash_insert(g_result_cache.entries_map, &entry->session_uuid, entry);
+  g_result_cache.memory_used += result_mem;
+  result_cache_enforce_limit();
+  result_cache_unlock();
+
+  return result;
+}
+
+void BKE_modifier_result_cache_init(void)
+{
+  BLI_assert(!g_result_cache.mutex_initialized);
+  BLI_mutex_init(&g_result_cache.mutex);
+  g_result_cache.entries_map = BLI_ghash_new(
+      BLI_session_uuid_ghash_hash, BLI_session_uuid_ghash_compare, __func__);
+  g_result_cache.mutex_initialized = true;
+}
+
+void BKE_modifier_result_cache_limit_set(size_t memory_limit)
+{
+  result_cache_lock();
+  g_result_cache.memory_limit = memory_limit;
+  result_cache_enforce_limit();
+  result_cache_unlock();
+}
+
+void BKE_modifier_result_cache_stats_get(ModifierResultCacheStats *r_stats)
+{
+  result_cache_lock();
+  r_stats->memory_used = g_result_cache.memory_used;
+  r_stats->memory_limit = g_result_cache.memory_limit;
+  r_stats->entries = BLI_ghash_len(g_result_cache.entries_map);
+  r_stats->hits = g_result_cache.hits;
+  r_stats->misses = g_result_cache.misses;
+  r_stats->evictions = g_result_cache.evictions;
+  result_cache_unlock();
+}
+
+/**
+ * Free the cached result of \a md, called when the modifier is deleted since its
+ * session UUID will never be looked up again.
+ */
+void BKE_modifier_result_cache_remove(const ModifierData *md)
+{
+  if (!g_result_cache.mutex_initialized) {
+    return;
+  }
+  result_cache_lock();
+  ModifierResultCacheEntry *entry = BLI_ghash_lookup(g_result_cache.entries_map,
+                                                     &md->session_uuid);
+  if (entry != NULL) {
+    result_cache_entry_remove(entry);
+  }
+  result_cache_unlock();
+}
+
+/**
+ * Free all cached results, called when loading a file since none of its modifiers can match the
+ * session UUIDs of the previous one.
+ */
+void BKE_modifier_result_cache_clear(void)
+{
+  result_cache_lock();
+  while (g_result_cache.entries.first) {
+    result_cache_entry_remove(g_result_cache.entries.first);
+  }
+  g_result_cache.hits = 0;
+  g_result_cache.misses = 0;
+  g_result_cache.evictions = 0;
+  result_cache_unlock();
+}
+
+void BKE_modifier_result_cache_exit(void)
+{
+  if (!g_result_cache.mutex_initialized) {
+    return;
+  }
+  BKE_modifier_result_cache_clear();
+  BLI_ghash_free(g_result_cache.entries_map, NULL, NULL);
+  g_result_cache.entries_map = NULL;
+  BLI_mutex_end(&g_result_cache.mutex);
+  g_result_cache.mutex_initialized = false;
+}
+
+/** \} */
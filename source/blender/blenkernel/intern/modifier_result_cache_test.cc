@@ -0,0 +1,209 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+
+#include "DNA_curveprofile_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_blender.h"
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "IMB_imbuf.h"
+
+namespace blender::bke::tests {
+
+class ModifierResultCacheTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Object *ob = nullptr;
+  BevelModifierData *bmd = nullptr;
+  Depsgraph *depsgraph = nullptr;
+
+  static void SetUpTestCase()
+  {
+    /* Minimal code to make building and evaluating a depsgraph not crash, see main() in
+     * creator.c. */
+    CLG_init();
+    BLI_threadapi_init();
+    DNA_sdna_current_init();
+    BKE_blender_globals_init();
+    BKE_idtype_init();
+    IMB_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_blender_globals_clear();
+    IMB_exit();
+    BKE_modifier_result_cache_exit();
+    DEG_free_node_types();
+    DNA_sdna_current_free();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    ob = BKE_object_add(bmain, view_layer, OB_MESH, "Object");
+    mesh_fill_quad(static_cast<Mesh *>(ob->data));
+
+    bmd = reinterpret_cast<BevelModifierData *>(BKE_modifier_new(eModifierType_Bevel));
+    bmd->modifier.flag |= eModifierFlag_UseResultCache;
+    BLI_addtail(&ob->modifiers, bmd);
+
+    BKE_modifier_result_cache_clear();
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  void TearDown() override
+  {
+    if (depsgraph != nullptr) {
+      DEG_graph_free(depsgraph);
+    }
+    BKE_main_free(bmain);
+  }
+
+  static void mesh_fill_quad(Mesh *mesh)
+  {
+    const float co[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    mesh->totvert = mesh->totedge = mesh->totloop = 4;
+    mesh->totpoly = 1;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_CALLOC, nullptr, mesh->totedge);
+    CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+    CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int i = 0; i < 4; i++) {
+      copy_v3_v3(mesh->mvert[i].co, co[i]);
+      mesh->medge[i].v1 = i;
+      mesh->medge[i].v2 = (i + 1) % 4;
+      mesh->mloop[i].v = i;
+      mesh->mloop[i].e = i;
+    }
+    mesh->mpoly[0].loopstart = 0;
+    mesh->mpoly[0].totloop = 4;
+    BKE_mesh_calc_normals(mesh);
+  }
+
+  void evaluate(ID *id)
+  {
+    DEG_id_tag_update_ex(bmain, id, ID_RECALC_GEOMETRY);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  ModifierResultCacheStats stats_get()
+  {
+    ModifierResultCacheStats stats;
+    BKE_modifier_result_cache_stats_get(&stats);
+    return stats;
+  }
+};
+
+TEST_F(ModifierResultCacheTest, HitWhenUnchanged)
+{
+  EXPECT_EQ(stats_get().misses, 1);
+  EXPECT_EQ(stats_get().hits, 0);
+  EXPECT_EQ(stats_get().entries, 1);
+  EXPECT_GT(stats_get().memory_used, sizeof(Mesh));
+
+  evaluate(&ob->id);
+  EXPECT_EQ(stats_get().misses, 1);
+  EXPECT_EQ(stats_get().hits, 1);
+}
+
+TEST_F(ModifierResultCacheTest, MissOnSettingsChange)
+{
+  bmd->value *= 2.0f;
+  evaluate(&ob->id);
+  EXPECT_EQ(stats_get().misses, 2);
+  EXPECT_EQ(stats_get().hits, 0);
+  EXPECT_EQ(stats_get().entries, 1);
+}
+
+TEST_F(ModifierResultCacheTest, MissOnCustomProfileChange)
+{
+  /* Only stored behind a pointer of the modifier settings. */
+  ASSERT_NE(bmd->custom_profile, nullptr);
+  ASSERT_GT(bmd->custom_profile->path_len, 1);
+  bmd->custom_profile->path[1].y += 0.25f;
+  evaluate(&ob->id);
+  EXPECT_EQ(stats_get().misses, 2);
+  EXPECT_EQ(stats_get().hits, 0);
+}
+
+TEST_F(ModifierResultCacheTest, MissOnInputChange)
+{
+  Mesh *mesh = static_cast<Mesh *>(ob->data);
+  mesh->mvert[2].co[2] = 1.0f;
+  evaluate(&mesh->id);
+  EXPECT_EQ(stats_get().misses, 2);
+  EXPECT_EQ(stats_get().hits, 0);
+}
+
+TEST_F(ModifierResultCacheTest, FreeOnModifierRemove)
+{
+  BLI_remlink(&ob->modifiers, bmd);
+  BKE_modifier_free(&bmd->modifier);
+  EXPECT_EQ(stats_get().entries, 0);
+  EXPECT_EQ(stats_get().memory_used, 0);
+}
+
+TEST_F(ModifierResultCacheTest, FreeOnObjectDelete)
+{
+  /* Freeing the evaluated copies keeps the result of the original. */
+  DEG_graph_free(depsgraph);
+  depsgraph = nullptr;
+  EXPECT_EQ(stats_get().entries, 1);
+
+  BKE_id_delete(bmain, ob);
+  EXPECT_EQ(stats_get().entries, 0);
+}
+
+}  // namespace blender::bke::tests
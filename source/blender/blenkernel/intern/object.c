@@ -282,6 +282,13 @@ static void object_free_data(ID *id)
 
   DRW_drawdata_free((ID *)ob);
 
+  /* Cached results are shared with the evaluated copies, only free them with the original. */
+  if ((ob->id.tag & LIB_TAG_COPIED_ON_WRITE) == 0) {
+    LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+      BKE_modifier_result_cache_remove(md);
+    }
+  }
+
   /* BKE_<id>_free shall never touch to ID->us. Never ever. */
   BKE_object_free_modifiers(ob, LIB_ID_CREATE_NO_USER_REFCOUNT);
   BKE_object_free_shaderfx(ob, LIB_ID_CREATE_NO_USER_REFCOUNT);
@@ -1530,7 +1537,7 @@ ParticleSystem *BKE_object_copy_particlesystem(ParticleSystem *psys, const int f
   psysn->pdd = NULL;
   psysn->effectors = NULL;
   psysn->tree = NULL;
-  psysn->bvhtree = NULL;
+  psysn->sph_grid = NULL;
   psysn->batch_cache = NULL;
 
   BLI_listbase_clear(&psysn->pathcachebufs);
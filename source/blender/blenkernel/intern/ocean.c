@@ -419,8 +419,27 @@ typedef struct OceanSimulateData {
   float t;
   float scale;
   float chop_amount;
+
+  /* Inputs and outputs of the enabled FFTs, and a constant added to their result. */
+  fftw_complex *fft_in[8];
+  double *fft_out[8];
+  double fft_offset[8];
+  int fft_num;
 } OceanSimulateData;
 
+/* Multiplication of a complex by a real number, stored in `res`. */
+static void ocean_fft_input_mul_f(fftw_complex res, const fftw_complex mul_param, float f)
+{
+  fftw_complex tmp;
+  mul_complex_f(tmp, mul_param, f);
+  init_complex(res, real_c(tmp), image_c(tmp));
+}
+
+/**
+ * Compute a new htilda for the row \a i of the spectrum, and all the FFT inputs depending on it,
+ * such that the whole spectrum is processed in a single parallel loop and the FFT tasks
+ * only have to execute their plan.
+ */
 static void ocean_compute_htilda(void *__restrict userdata,
                                  const int i,
                                  const TaskParallelTLS *__restrict UNUSED(tls))
@@ -428,232 +447,136 @@ static void ocean_compute_htilda(void *__restrict userdata,
   OceanSimulateData *osd = userdata;
   const Ocean *o = osd->o;
   const float scale = osd->scale;
+  const float chop_amount = osd->chop_amount;
   const float t = osd->t;
 
+  /* Constant factors of the chop and jacobian inputs. */
+  fftw_complex chop_param;
+  fftw_complex jacobian_param;
+  fftw_complex minus_i;
+  init_complex(minus_i, 0.0, -1.0);
+  init_complex(chop_param, -scale, 0);
+  mul_complex_f(chop_param, chop_param, chop_amount);
+  mul_complex_c(chop_param, chop_param, minus_i);
+  /* init_complex(jacobian_param, -scale, 0); */
+  init_complex(jacobian_param, -1, 0);
+  mul_complex_f(jacobian_param, jacobian_param, chop_amount);
+
   int j;
 
   /* Note the <= _N/2 here, see the FFTW documentation
    * about the mechanics of the complex->real fft storage. */
   for (j = 0; j <= o->_N / 2; j++) {
+    const int index = i * (1 + o->_N / 2) + j;
+    const float k = o->_k[index];
     fftw_complex exp_param1;
     fftw_complex exp_param2;
     fftw_complex conj_param;
 
-    init_complex(exp_param1, 0.0, omega(o->_k[i * (1 + o->_N / 2) + j], o->_depth) * t);
-    init_complex(exp_param2, 0.0, -omega(o->_k[i * (1 + o->_N / 2) + j], o->_depth) * t);
-    exp_complex(exp_param1, exp_param1);
-    exp_complex(exp_param2, exp_param2);
+    /* exp(-i * omega * t) is the conjugate of exp(i * omega * t),
+     * only compute the trigonometric functions once. */
+    const float omega_t = o->_omega[index] * t;
+    const float cos_omega_t = cosf(omega_t);
+    const float sin_omega_t = sinf(omega_t);
+    init_complex(exp_param1, cos_omega_t, sin_omega_t);
+    init_complex(exp_param2, cos_omega_t, -sin_omega_t);
     conj_complex(conj_param, o->_h0_minus[i * o->_N + j]);
 
     mul_complex_c(exp_param1, o->_h0[i * o->_N + j], exp_param1);
     mul_complex_c(exp_param2, conj_param, exp_param2);
 
-    add_comlex_c(o->_htilda[i * (1 + o->_N / 2) + j], exp_param1, exp_param2);
-    mul_complex_f(o->_fft_in[i * (1 + o->_N / 2) + j], o->_htilda[i * (1 + o->_N / 2) + j], scale);
-  }
-}
+    add_comlex_c(o->_htilda[index], exp_param1, exp_param2);
+    mul_complex_f(o->_fft_in[index], o->_htilda[index], scale);
 
-static void ocean_compute_displacement_y(TaskPool *__restrict pool, void *UNUSED(taskdata))
-{
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
-  const Ocean *o = osd->o;
-
-  fftw_execute(o->_disp_y_plan);
-}
-
-static void ocean_compute_displacement_x(TaskPool *__restrict pool, void *UNUSED(taskdata))
-{
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
-  const Ocean *o = osd->o;
-  const float scale = osd->scale;
-  const float chop_amount = osd->chop_amount;
-  int i, j;
-
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
+    if (o->_do_chop) {
       fftw_complex mul_param;
-      fftw_complex minus_i;
-
-      init_complex(minus_i, 0.0, -1.0);
-      init_complex(mul_param, -scale, 0);
-      mul_complex_f(mul_param, mul_param, chop_amount);
-      mul_complex_c(mul_param, mul_param, minus_i);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param,
-                    mul_param,
-                    ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-                         0.0f :
-                         o->_kx[i] / o->_k[i * (1 + o->_N / 2) + j]));
-      init_complex(o->_fft_in_x[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
+      mul_complex_c(mul_param, chop_param, o->_htilda[index]);
+      ocean_fft_input_mul_f(o->_fft_in_x[index], mul_param, (k == 0.0f) ? 0.0f : o->_kx[i] / k);
+      ocean_fft_input_mul_f(o->_fft_in_z[index], mul_param, (k == 0.0f) ? 0.0f : o->_kz[j] / k);
     }
-  }
-  fftw_execute(o->_disp_x_plan);
-}
 
-static void ocean_compute_displacement_z(TaskPool *__restrict pool, void *UNUSED(taskdata))
-{
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
-  const Ocean *o = osd->o;
-  const float scale = osd->scale;
-  const float chop_amount = osd->chop_amount;
-  int i, j;
-
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
+    if (o->_do_jacobian) {
       fftw_complex mul_param;
-      fftw_complex minus_i;
-
-      init_complex(minus_i, 0.0, -1.0);
-      init_complex(mul_param, -scale, 0);
-      mul_complex_f(mul_param, mul_param, chop_amount);
-      mul_complex_c(mul_param, mul_param, minus_i);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param,
-                    mul_param,
-                    ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-                         0.0f :
-                         o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
-      init_complex(o->_fft_in_z[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
+      mul_complex_c(mul_param, jacobian_param, o->_htilda[index]);
+      ocean_fft_input_mul_f(
+          o->_fft_in_jxx[index], mul_param, (k == 0.0f) ? 0.0f : o->_kx[i] * o->_kx[i] / k);
+      ocean_fft_input_mul_f(
+          o->_fft_in_jzz[index], mul_param, (k == 0.0f) ? 0.0f : o->_kz[j] * o->_kz[j] / k);
+      ocean_fft_input_mul_f(
+          o->_fft_in_jxz[index], mul_param, (k == 0.0f) ? 0.0f : o->_kx[i] * o->_kz[j] / k);
     }
-  }
-  fftw_execute(o->_disp_z_plan);
-}
-
-static void ocean_compute_jacobian_jxx(TaskPool *__restrict pool, void *UNUSED(taskdata))
-{
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
-  const Ocean *o = osd->o;
-  const float chop_amount = osd->chop_amount;
-  int i, j;
 
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
+    if (o->_do_normals) {
       fftw_complex mul_param;
-
-      /* init_complex(mul_param, -scale, 0); */
-      init_complex(mul_param, -1, 0);
-
-      mul_complex_f(mul_param, mul_param, chop_amount);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param,
-                    mul_param,
-                    ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-                         0.0f :
-                         o->_kx[i] * o->_kx[i] / o->_k[i * (1 + o->_N / 2) + j]));
-      init_complex(o->_fft_in_jxx[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-    }
-  }
-  fftw_execute(o->_Jxx_plan);
-
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j < o->_N; j++) {
-      o->_Jxx[i * o->_N + j] += 1.0;
+      mul_complex_c(mul_param, minus_i, o->_htilda[index]);
+      ocean_fft_input_mul_f(o->_fft_in_nx[index], mul_param, o->_kx[i]);
+      ocean_fft_input_mul_f(o->_fft_in_nz[index], mul_param, o->_kz[i]);
     }
   }
 }
 
-static void ocean_compute_jacobian_jzz(TaskPool *__restrict pool, void *UNUSED(taskdata))
-{
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
-  const Ocean *o = osd->o;
-  const float chop_amount = osd->chop_amount;
-  int i, j;
-
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
-      fftw_complex mul_param;
-
-      /* init_complex(mul_param, -scale, 0); */
-      init_complex(mul_param, -1, 0);
-
-      mul_complex_f(mul_param, mul_param, chop_amount);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param,
-                    mul_param,
-                    ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-                         0.0f :
-                         o->_kz[j] * o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
-      init_complex(o->_fft_in_jzz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-    }
-  }
-  fftw_execute(o->_Jzz_plan);
-
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j < o->_N; j++) {
-      o->_Jzz[i * o->_N + j] += 1.0;
-    }
-  }
-}
+/* Number of columns transformed at once, so that they share cache lines. */
+#  define OCEAN_FFT_COLUMNS 4
 
-static void ocean_compute_jacobian_jxz(TaskPool *__restrict pool, void *UNUSED(taskdata))
+/**
+ * Inverse transform along the first dimension, in place, for a block of #OCEAN_FFT_COLUMNS
+ * columns of all the FFT inputs.
+ */
+static void ocean_compute_fft_columns(void *__restrict userdata,
+                                      const int block,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
+  OceanSimulateData *osd = userdata;
   const Ocean *o = osd->o;
-  const float chop_amount = osd->chop_amount;
-  int i, j;
+  const int columns_num = 1 + o->_N / 2;
+  const int column = block * OCEAN_FFT_COLUMNS;
+  const fftw_plan plan = (column + OCEAN_FFT_COLUMNS <= columns_num) ?
+                             o->_columns_plan :
+                             o->_columns_remainder_plan;
 
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
-      fftw_complex mul_param;
-
-      /* init_complex(mul_param, -scale, 0); */
-      init_complex(mul_param, -1, 0);
-
-      mul_complex_f(mul_param, mul_param, chop_amount);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param,
-                    mul_param,
-                    ((o->_k[i * (1 + o->_N / 2) + j] == 0.0f) ?
-                         0.0f :
-                         o->_kx[i] * o->_kz[j] / o->_k[i * (1 + o->_N / 2) + j]));
-      init_complex(o->_fft_in_jxz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-    }
+  for (int i = 0; i < osd->fft_num; i++) {
+    fftw_complex *in = osd->fft_in[i] + column;
+    fftw_execute_dft(plan, in, in);
   }
-  fftw_execute(o->_Jxz_plan);
 }
 
-static void ocean_compute_normal_x(TaskPool *__restrict pool, void *UNUSED(taskdata))
+/**
+ * Complex to real transform along the second dimension, for the row \a i of all the FFT inputs,
+ * which gives the final result.
+ */
+static void ocean_compute_fft_row(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
+  OceanSimulateData *osd = userdata;
   const Ocean *o = osd->o;
-  int i, j;
 
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
-      fftw_complex mul_param;
+  for (int fft = 0; fft < osd->fft_num; fft++) {
+    double *out = osd->fft_out[fft] + i * o->_N;
+    fftw_execute_dft_c2r(o->_row_plan, osd->fft_in[fft] + i * (1 + o->_N / 2), out);
 
-      init_complex(mul_param, 0.0, -1.0);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param, mul_param, o->_kx[i]);
-      init_complex(o->_fft_in_nx[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
+    if (osd->fft_offset[fft] != 0.0) {
+      for (int j = 0; j < o->_N; j++) {
+        out[j] += osd->fft_offset[fft];
+      }
     }
   }
-  fftw_execute(o->_N_x_plan);
 }
 
-static void ocean_compute_normal_z(TaskPool *__restrict pool, void *UNUSED(taskdata))
+static void ocean_simulate_fft_add(OceanSimulateData *osd,
+                                   fftw_complex *in,
+                                   double *out,
+                                   const double offset)
 {
-  OceanSimulateData *osd = BLI_task_pool_user_data(pool);
-  const Ocean *o = osd->o;
-  int i, j;
-
-  for (i = 0; i < o->_M; i++) {
-    for (j = 0; j <= o->_N / 2; j++) {
-      fftw_complex mul_param;
-
-      init_complex(mul_param, 0.0, -1.0);
-      mul_complex_c(mul_param, mul_param, o->_htilda[i * (1 + o->_N / 2) + j]);
-      mul_complex_f(mul_param, mul_param, o->_kz[i]);
-      init_complex(o->_fft_in_nz[i * (1 + o->_N / 2) + j], real_c(mul_param), image_c(mul_param));
-    }
-  }
-  fftw_execute(o->_N_z_plan);
+  BLI_assert(osd->fft_num < ARRAY_SIZE(osd->fft_in));
+  osd->fft_in[osd->fft_num] = in;
+  osd->fft_out[osd->fft_num] = out;
+  osd->fft_offset[osd->fft_num] = offset;
+  osd->fft_num++;
 }
 
 void BKE_ocean_simulate(struct Ocean *o, float t, float scale, float chop_amount)
 {
-  TaskPool *pool;
-
   OceanSimulateData osd;
 
   scale *= o->normalize_factor;
@@ -662,50 +585,53 @@ void BKE_ocean_simulate(struct Ocean *o, float t, float scale, float chop_amount
   osd.t = t;
   osd.scale = scale;
   osd.chop_amount = chop_amount;
-
-  pool = BLI_task_pool_create(&osd, TASK_PRIORITY_HIGH);
+  osd.fft_num = 0;
 
   BLI_rw_mutex_lock(&o->oceanmutex, THREAD_LOCK_WRITE);
 
   /* Note about multi-threading here: we have to run a first set of computations (htilda one)
    * before we can run all others, since they all depend on it.
-   * So we make a first parallelized forloop run for htilda,
-   * and then pack all other computations into a set of parallel tasks.
-   * This is not optimal in all cases,
-   * but remains reasonably simple and should be OK most of the time. */
+   * So we make a first parallelized forloop run for htilda and all the FFT inputs depending on
+   * it. The 2D FFTs are then computed as 1D transforms of all their columns, followed by 1D
+   * transforms of all their rows, each in a parallelized forloop as well. This way all steps
+   * scale with the number of threads, whichever outputs are enabled. */
 
-  /* compute a new htilda */
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (o->_M > 16);
+
+  /* compute a new htilda */
   BLI_task_parallel_range(0, o->_M, &osd, ocean_compute_htilda, &settings);
 
   if (o->_do_disp_y) {
-    BLI_task_pool_push(pool, ocean_compute_displacement_y, NULL, false, NULL);
+    ocean_simulate_fft_add(&osd, o->_fft_in, o->_disp_y, 0.0);
   }
 
   if (o->_do_chop) {
-    BLI_task_pool_push(pool, ocean_compute_displacement_x, NULL, false, NULL);
-    BLI_task_pool_push(pool, ocean_compute_displacement_z, NULL, false, NULL);
+    ocean_simulate_fft_add(&osd, o->_fft_in_x, o->_disp_x, 0.0);
+    ocean_simulate_fft_add(&osd, o->_fft_in_z, o->_disp_z, 0.0);
   }
 
   if (o->_do_jacobian) {
-    BLI_task_pool_push(pool, ocean_compute_jacobian_jxx, NULL, false, NULL);
-    BLI_task_pool_push(pool, ocean_compute_jacobian_jzz, NULL, false, NULL);
-    BLI_task_pool_push(pool, ocean_compute_jacobian_jxz, NULL, false, NULL);
+    ocean_simulate_fft_add(&osd, o->_fft_in_jxx, o->_Jxx, 1.0);
+    ocean_simulate_fft_add(&osd, o->_fft_in_jzz, o->_Jzz, 1.0);
+    ocean_simulate_fft_add(&osd, o->_fft_in_jxz, o->_Jxz, 0.0);
   }
 
   if (o->_do_normals) {
-    BLI_task_pool_push(pool, ocean_compute_normal_x, NULL, false, NULL);
-    BLI_task_pool_push(pool, ocean_compute_normal_z, NULL, false, NULL);
+    ocean_simulate_fft_add(&osd, o->_fft_in_nx, o->_N_x, 0.0);
+    ocean_simulate_fft_add(&osd, o->_fft_in_nz, o->_N_z, 0.0);
     o->_N_y = 1.0f / scale;
   }
 
-  BLI_task_pool_work_and_wait(pool);
+  if (osd.fft_num != 0) {
+    const int columns_num = 1 + o->_N / 2;
+    const int blocks_num = (columns_num + OCEAN_FFT_COLUMNS - 1) / OCEAN_FFT_COLUMNS;
+    BLI_task_parallel_range(0, blocks_num, &osd, ocean_compute_fft_columns, &settings);
+    BLI_task_parallel_range(0, o->_M, &osd, ocean_compute_fft_row, &settings);
+  }
 
   BLI_rw_mutex_unlock(&o->oceanmutex);
-
-  BLI_task_pool_free(pool);
 }
 
 static void set_height_normalize_factor(struct Ocean *oc)
@@ -865,6 +791,7 @@ void BKE_ocean_init(struct Ocean *o,
   o->_do_jacobian = do_jacobian;
 
   o->_k = (float *)MEM_mallocN(M * (1 + N / 2) * sizeof(float), "ocean_k");
+  o->_omega = (float *)MEM_mallocN(M * (1 + N / 2) * sizeof(float), "ocean_omega");
   o->_h0 = (fftw_complex *)MEM_mallocN(M * N * sizeof(fftw_complex), "ocean_h0");
   o->_h0_minus = (fftw_complex *)MEM_mallocN(M * N * sizeof(fftw_complex), "ocean_h0_minus");
   o->_kx = (float *)MEM_mallocN(o->_M * sizeof(float), "ocean_kx");
@@ -899,10 +826,12 @@ void BKE_ocean_init(struct Ocean *o,
     o->_kz[i] = -2.0f * (float)M_PI * ii / o->_Lz;
   }
 
-  /* pre-calculate the k matrix */
+  /* pre-calculate the k matrix, and the angular frequencies which only depend on it */
   for (i = 0; i < o->_M; i++) {
     for (j = 0; j <= o->_N / 2; j++) {
-      o->_k[i * (1 + o->_N / 2) + j] = sqrt(o->_kx[i] * o->_kx[i] + o->_kz[j] * o->_kz[j]);
+      const int index = i * (1 + o->_N / 2) + j;
+      o->_k[index] = sqrt(o->_kx[i] * o->_kx[i] + o->_kz[j] * o->_kz[j]);
+      o->_omega[index] = omega(o->_k[index], o->_depth);
     }
   }
 
@@ -972,7 +901,6 @@ void BKE_ocean_init(struct Ocean *o,
 
   if (o->_do_disp_y) {
     o->_disp_y = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_disp_y");
-    o->_disp_y_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in, o->_disp_y, FFTW_ESTIMATE);
   }
 
   if (o->_do_normals) {
@@ -984,9 +912,6 @@ void BKE_ocean_init(struct Ocean *o,
     o->_N_x = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_N_x");
     /* o->_N_y = (float *) fftwf_malloc(o->_M * o->_N * sizeof(float)); (MEM01) */
     o->_N_z = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_N_z");
-
-    o->_N_x_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_nx, o->_N_x, FFTW_ESTIMATE);
-    o->_N_z_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_nz, o->_N_z, FFTW_ESTIMATE);
   }
 
   if (o->_do_chop) {
@@ -997,9 +922,6 @@ void BKE_ocean_init(struct Ocean *o,
 
     o->_disp_x = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_disp_x");
     o->_disp_z = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_disp_z");
-
-    o->_disp_x_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_x, o->_disp_x, FFTW_ESTIMATE);
-    o->_disp_z_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_z, o->_disp_z, FFTW_ESTIMATE);
   }
   if (o->_do_jacobian) {
     o->_fft_in_jxx = (fftw_complex *)MEM_mallocN(o->_M * (1 + o->_N / 2) * sizeof(fftw_complex),
@@ -1012,10 +934,47 @@ void BKE_ocean_init(struct Ocean *o,
     o->_Jxx = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_Jxx");
     o->_Jzz = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_Jzz");
     o->_Jxz = (double *)MEM_mallocN(o->_M * o->_N * sizeof(double), "ocean_Jxz");
+  }
 
-    o->_Jxx_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_jxx, o->_Jxx, FFTW_ESTIMATE);
-    o->_Jzz_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_jzz, o->_Jzz, FFTW_ESTIMATE);
-    o->_Jxz_plan = fftw_plan_dft_c2r_2d(o->_M, o->_N, o->_fft_in_jxz, o->_Jxz, FFTW_ESTIMATE);
+  {
+    /* Plans are executed on other arrays of the same layout, which are not aligned the same. */
+    const int flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+    const int columns_num = 1 + o->_N / 2;
+    const int columns_remainder = columns_num % OCEAN_FFT_COLUMNS;
+    double *row_out = (double *)MEM_mallocN(o->_N * sizeof(double), "ocean_row_out");
+
+    o->_columns_plan = fftw_plan_many_dft(1,
+                                          &o->_M,
+                                          OCEAN_FFT_COLUMNS,
+                                          o->_fft_in,
+                                          NULL,
+                                          columns_num,
+                                          1,
+                                          o->_fft_in,
+                                          NULL,
+                                          columns_num,
+                                          1,
+                                          FFTW_BACKWARD,
+                                          flags);
+    o->_columns_remainder_plan = NULL;
+    if (columns_remainder != 0) {
+      o->_columns_remainder_plan = fftw_plan_many_dft(1,
+                                                      &o->_M,
+                                                      columns_remainder,
+                                                      o->_fft_in,
+                                                      NULL,
+                                                      columns_num,
+                                                      1,
+                                                      o->_fft_in,
+                                                      NULL,
+                                                      columns_num,
+                                                      1,
+                                                      FFTW_BACKWARD,
+                                                      flags);
+    }
+    o->_row_plan = fftw_plan_dft_c2r_1d(o->_N, o->_fft_in, row_out, flags);
+
+    MEM_freeN(row_out);
   }
 
   BLI_thread_unlock(LOCK_FFTW);
@@ -1037,16 +996,22 @@ void BKE_ocean_free_data(struct Ocean *oc)
 
   BLI_thread_lock(LOCK_FFTW);
 
+  /* check that ocean data has been initialized */
+  if (oc->_htilda) {
+    fftw_destroy_plan(oc->_columns_plan);
+    if (oc->_columns_remainder_plan) {
+      fftw_destroy_plan(oc->_columns_remainder_plan);
+    }
+    fftw_destroy_plan(oc->_row_plan);
+  }
+
   if (oc->_do_disp_y) {
-    fftw_destroy_plan(oc->_disp_y_plan);
     MEM_freeN(oc->_disp_y);
   }
 
   if (oc->_do_normals) {
     MEM_freeN(oc->_fft_in_nx);
     MEM_freeN(oc->_fft_in_nz);
-    fftw_destroy_plan(oc->_N_x_plan);
-    fftw_destroy_plan(oc->_N_z_plan);
     MEM_freeN(oc->_N_x);
     /*fftwf_free(oc->_N_y); (MEM01)*/
     MEM_freeN(oc->_N_z);
@@ -1055,8 +1020,6 @@ void BKE_ocean_free_data(struct Ocean *oc)
   if (oc->_do_chop) {
     MEM_freeN(oc->_fft_in_x);
     MEM_freeN(oc->_fft_in_z);
-    fftw_destroy_plan(oc->_disp_x_plan);
-    fftw_destroy_plan(oc->_disp_z_plan);
     MEM_freeN(oc->_disp_x);
     MEM_freeN(oc->_disp_z);
   }
@@ -1065,9 +1028,6 @@ void BKE_ocean_free_data(struct Ocean *oc)
     MEM_freeN(oc->_fft_in_jxx);
     MEM_freeN(oc->_fft_in_jzz);
     MEM_freeN(oc->_fft_in_jxz);
-    fftw_destroy_plan(oc->_Jxx_plan);
-    fftw_destroy_plan(oc->_Jzz_plan);
-    fftw_destroy_plan(oc->_Jxz_plan);
     MEM_freeN(oc->_Jxx);
     MEM_freeN(oc->_Jzz);
     MEM_freeN(oc->_Jxz);
@@ -1083,6 +1043,7 @@ void BKE_ocean_free_data(struct Ocean *oc)
   if (oc->_htilda) {
     MEM_freeN(oc->_htilda);
     MEM_freeN(oc->_k);
+    MEM_freeN(oc->_omega);
     MEM_freeN(oc->_h0);
     MEM_freeN(oc->_h0_minus);
     MEM_freeN(oc->_kx);
@@ -1372,179 +1333,236 @@ void BKE_ocean_simulate_cache(struct OceanCache *och, int frame)
   och->ibufs_norm[f] = IMB_loadiffname(string, 0, NULL);
 }
 
-void BKE_ocean_bake(struct Ocean *o,
-                    struct OceanCache *och,
-                    void (*update_cb)(void *, float progress, int *cancel),
-                    void *update_cb_data)
-{
+typedef struct OceanBakeFrame {
+  int frame;
+  ImBuf *ibuf_foam, *ibuf_disp, *ibuf_normal, *ibuf_spray, *ibuf_spray_inverse;
+} OceanBakeFrame;
+
+typedef struct OceanBakeData {
+  struct Ocean *o;
+  struct OceanCache *och;
+  ImageFormatData imf;
+  OceanBakeFrame *bake_frame;
+  float *prev_foam;
+  /* Index of the baked frame in the cache. */
+  int index;
+} OceanBakeData;
+
+static void ocean_bake_row(void *__restrict userdata,
+                           const int y,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  OceanBakeData *obd = userdata;
+  struct Ocean *o = obd->o;
+  struct OceanCache *och = obd->och;
+  OceanBakeFrame *bake_frame = obd->bake_frame;
+  float *prev_foam = obd->prev_foam;
+  const int res_x = och->resolution_x;
+
   /* note: some of these values remain uninitialized unless certain options
    * are enabled, take care that BKE_ocean_eval_ij() initializes a member
    * before use - campbell */
   OceanResult ocr;
 
-  ImageFormatData imf = {0};
+  for (int x = 0; x < res_x; x++) {
 
-  int f, i = 0, x, y, cancel = 0;
-  float progress;
+    BKE_ocean_eval_ij(o, &ocr, x, y);
 
-  ImBuf *ibuf_foam, *ibuf_disp, *ibuf_normal, *ibuf_spray, *ibuf_spray_inverse;
-  float *prev_foam;
-  int res_x = och->resolution_x;
-  int res_y = och->resolution_y;
-  char string[FILE_MAX];
-  // RNG *rng;
+    /* add to the image */
+    rgb_to_rgba_unit_alpha(&bake_frame->ibuf_disp->rect_float[4 * (res_x * y + x)], ocr.disp);
 
-  if (!o) {
-    return;
-  }
+    if (o->_do_jacobian) {
+      /* TODO, cleanup unused code - campbell */
 
-  if (o->_do_jacobian) {
-    prev_foam = MEM_callocN(res_x * res_y * sizeof(float), "previous frame foam bake data");
-  }
-  else {
-    prev_foam = NULL;
-  }
+      float /*r, */ /* UNUSED */ pr = 0.0f, foam_result;
+      float neg_disp, neg_eplus;
 
-  // rng = BLI_rng_new(0);
+      ocr.foam = BKE_ocean_jminus_to_foam(ocr.Jminus, och->foam_coverage);
 
-  /* setup image format */
-  imf.imtype = R_IMF_IMTYPE_OPENEXR;
-  imf.depth = R_IMF_CHAN_DEPTH_16;
-  imf.exr_codec = R_IMF_EXR_CODEC_ZIP;
+      /* accumulate previous value for this cell */
+      if (obd->index > 0) {
+        pr = prev_foam[res_x * y + x];
+      }
 
-  for (f = och->start, i = 0; f <= och->end; f++, i++) {
+      /* r = BLI_rng_get_float(rng); */ /* UNUSED */ /* randomly reduce foam */
 
-    /* create a new imbuf to store image for this frame */
-    ibuf_foam = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
-    ibuf_disp = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
-    ibuf_normal = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
-    ibuf_spray = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
-    ibuf_spray_inverse = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+      /* pr = pr * och->foam_fade; */ /* overall fade */
 
-    BKE_ocean_simulate(o, och->time[i], och->wave_scale, och->chop_amount);
+      /* Remember ocean coord sys is Y up!
+       * break up the foam where height (Y) is low (wave valley),
+       * and X and Z displacement is greatest. */
 
-    /* add new foam */
-    for (y = 0; y < res_y; y++) {
-      for (x = 0; x < res_x; x++) {
+      neg_disp = ocr.disp[1] < 0.0f ? 1.0f + ocr.disp[1] : 1.0f;
+      neg_disp = neg_disp < 0.0f ? 0.0f : neg_disp;
 
-        BKE_ocean_eval_ij(o, &ocr, x, y);
+      /* foam, 'ocr.Eplus' only initialized with do_jacobian */
+      neg_eplus = ocr.Eplus[2] < 0.0f ? 1.0f + ocr.Eplus[2] : 1.0f;
+      neg_eplus = neg_eplus < 0.0f ? 0.0f : neg_eplus;
 
-        /* add to the image */
-        rgb_to_rgba_unit_alpha(&ibuf_disp->rect_float[4 * (res_x * y + x)], ocr.disp);
+      if (pr < 1.0f) {
+        pr *= pr;
+      }
 
-        if (o->_do_jacobian) {
-          /* TODO, cleanup unused code - campbell */
+      pr *= och->foam_fade * (0.75f + neg_eplus * 0.25f);
 
-          float /*r, */ /* UNUSED */ pr = 0.0f, foam_result;
-          float neg_disp, neg_eplus;
+      /* A full clamping should not be needed! */
+      foam_result = min_ff(pr + ocr.foam, 1.0f);
 
-          ocr.foam = BKE_ocean_jminus_to_foam(ocr.Jminus, och->foam_coverage);
+      prev_foam[res_x * y + x] = foam_result;
 
-          /* accumulate previous value for this cell */
-          if (i > 0) {
-            pr = prev_foam[res_x * y + x];
-          }
+      /*foam_result = min_ff(foam_result, 1.0f); */
 
-          /* r = BLI_rng_get_float(rng); */ /* UNUSED */ /* randomly reduce foam */
+      value_to_rgba_unit_alpha(&bake_frame->ibuf_foam->rect_float[4 * (res_x * y + x)],
+                               foam_result);
 
-          /* pr = pr * och->foam_fade; */ /* overall fade */
+      /* spray map baking */
+      if (o->_do_spray) {
+        rgb_to_rgba_unit_alpha(&bake_frame->ibuf_spray->rect_float[4 * (res_x * y + x)],
+                               ocr.Eplus);
+        rgb_to_rgba_unit_alpha(&bake_frame->ibuf_spray_inverse->rect_float[4 * (res_x * y + x)],
+                               ocr.Eminus);
+      }
+    }
 
-          /* Remember ocean coord sys is Y up!
-           * break up the foam where height (Y) is low (wave valley),
-           * and X and Z displacement is greatest. */
+    if (o->_do_normals) {
+      rgb_to_rgba_unit_alpha(&bake_frame->ibuf_normal->rect_float[4 * (res_x * y + x)],
+                             ocr.normal);
+    }
+  }
+}
 
-          neg_disp = ocr.disp[1] < 0.0f ? 1.0f + ocr.disp[1] : 1.0f;
-          neg_disp = neg_disp < 0.0f ? 0.0f : neg_disp;
+/* Write the images of a baked frame and free them, ran in background while the next frame is
+ * being simulated. */
+static void ocean_bake_write_frame(TaskPool *__restrict pool, void *taskdata)
+{
+  OceanBakeData *obd = BLI_task_pool_user_data(pool);
+  const struct Ocean *o = obd->o;
+  const struct OceanCache *och = obd->och;
+  OceanBakeFrame *bake_frame = taskdata;
+  const int f = bake_frame->frame;
+  char string[FILE_MAX];
 
-          /* foam, 'ocr.Eplus' only initialized with do_jacobian */
-          neg_eplus = ocr.Eplus[2] < 0.0f ? 1.0f + ocr.Eplus[2] : 1.0f;
-          neg_eplus = neg_eplus < 0.0f ? 0.0f : neg_eplus;
+  /* write the images */
+  cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_DISPLACE);
+  if (0 == BKE_imbuf_write(bake_frame->ibuf_disp, string, &obd->imf)) {
+    printf("Cannot save Displacement File Output to %s\n", string);
+  }
 
-          if (pr < 1.0f) {
-            pr *= pr;
-          }
+  if (o->_do_jacobian) {
+    cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_FOAM);
+    if (0 == BKE_imbuf_write(bake_frame->ibuf_foam, string, &obd->imf)) {
+      printf("Cannot save Foam File Output to %s\n", string);
+    }
 
-          pr *= och->foam_fade * (0.75f + neg_eplus * 0.25f);
+    if (o->_do_spray) {
+      cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_SPRAY);
+      if (0 == BKE_imbuf_write(bake_frame->ibuf_spray, string, &obd->imf)) {
+        printf("Cannot save Spray File Output to %s\n", string);
+      }
 
-          /* A full clamping should not be needed! */
-          foam_result = min_ff(pr + ocr.foam, 1.0f);
+      cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_SPRAY_INVERSE);
+      if (0 == BKE_imbuf_write(bake_frame->ibuf_spray_inverse, string, &obd->imf)) {
+        printf("Cannot save Spray Inverse File Output to %s\n", string);
+      }
+    }
+  }
 
-          prev_foam[res_x * y + x] = foam_result;
+  if (o->_do_normals) {
+    cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_NORMAL);
+    if (0 == BKE_imbuf_write(bake_frame->ibuf_normal, string, &obd->imf)) {
+      printf("Cannot save Normal File Output to %s\n", string);
+    }
+  }
 
-          /*foam_result = min_ff(foam_result, 1.0f); */
+  IMB_freeImBuf(bake_frame->ibuf_disp);
+  IMB_freeImBuf(bake_frame->ibuf_foam);
+  IMB_freeImBuf(bake_frame->ibuf_normal);
+  IMB_freeImBuf(bake_frame->ibuf_spray);
+  IMB_freeImBuf(bake_frame->ibuf_spray_inverse);
+}
 
-          value_to_rgba_unit_alpha(&ibuf_foam->rect_float[4 * (res_x * y + x)], foam_result);
+void BKE_ocean_bake(struct Ocean *o,
+                    struct OceanCache *och,
+                    void (*update_cb)(void *, float progress, int *cancel),
+                    void *update_cb_data)
+{
+  OceanBakeData obd = {NULL};
 
-          /* spray map baking */
-          if (o->_do_spray) {
-            rgb_to_rgba_unit_alpha(&ibuf_spray->rect_float[4 * (res_x * y + x)], ocr.Eplus);
-            rgb_to_rgba_unit_alpha(&ibuf_spray_inverse->rect_float[4 * (res_x * y + x)],
-                                   ocr.Eminus);
-          }
-        }
+  int f, i = 0, cancel = 0;
+  float progress;
 
-        if (o->_do_normals) {
-          rgb_to_rgba_unit_alpha(&ibuf_normal->rect_float[4 * (res_x * y + x)], ocr.normal);
-        }
-      }
-    }
+  int res_x = och->resolution_x;
+  int res_y = och->resolution_y;
+  // RNG *rng;
 
-    /* write the images */
-    cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_DISPLACE);
-    if (0 == BKE_imbuf_write(ibuf_disp, string, &imf)) {
-      printf("Cannot save Displacement File Output to %s\n", string);
-    }
+  if (!o) {
+    return;
+  }
 
-    if (o->_do_jacobian) {
-      cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_FOAM);
-      if (0 == BKE_imbuf_write(ibuf_foam, string, &imf)) {
-        printf("Cannot save Foam File Output to %s\n", string);
-      }
+  obd.o = o;
+  obd.och = och;
 
-      if (o->_do_spray) {
-        cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_SPRAY);
-        if (0 == BKE_imbuf_write(ibuf_spray, string, &imf)) {
-          printf("Cannot save Spray File Output to %s\n", string);
-        }
-
-        cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_SPRAY_INVERSE);
-        if (0 == BKE_imbuf_write(ibuf_spray_inverse, string, &imf)) {
-          printf("Cannot save Spray Inverse File Output to %s\n", string);
-        }
-      }
-    }
+  if (o->_do_jacobian) {
+    obd.prev_foam = MEM_callocN(res_x * res_y * sizeof(float), "previous frame foam bake data");
+  }
+  else {
+    obd.prev_foam = NULL;
+  }
 
-    if (o->_do_normals) {
-      cache_filename(string, och->bakepath, och->relbase, f, CACHE_TYPE_NORMAL);
-      if (0 == BKE_imbuf_write(ibuf_normal, string, &imf)) {
-        printf("Cannot save Normal File Output to %s\n", string);
-      }
-    }
+  // rng = BLI_rng_new(0);
+
+  /* setup image format */
+  obd.imf.imtype = R_IMF_IMTYPE_OPENEXR;
+  obd.imf.depth = R_IMF_CHAN_DEPTH_16;
+  obd.imf.exr_codec = R_IMF_EXR_CODEC_ZIP;
+
+  /* Images are written (and compressed) in background while the next frame is baked. */
+  TaskPool *write_pool = BLI_task_pool_create_background_serial(&obd, TASK_PRIORITY_HIGH);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  for (f = och->start, i = 0; f <= och->end; f++, i++) {
+    OceanBakeFrame *bake_frame = MEM_callocN(sizeof(*bake_frame), __func__);
+    bake_frame->frame = f;
 
-    IMB_freeImBuf(ibuf_disp);
-    IMB_freeImBuf(ibuf_foam);
-    IMB_freeImBuf(ibuf_normal);
-    IMB_freeImBuf(ibuf_spray);
-    IMB_freeImBuf(ibuf_spray_inverse);
+    /* create a new imbuf to store image for this frame */
+    bake_frame->ibuf_foam = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+    bake_frame->ibuf_disp = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+    bake_frame->ibuf_normal = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+    bake_frame->ibuf_spray = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+    bake_frame->ibuf_spray_inverse = IMB_allocImBuf(res_x, res_y, 32, IB_rectfloat);
+
+    BKE_ocean_simulate(o, och->time[i], och->wave_scale, och->chop_amount);
+
+    /* add new foam */
+    obd.bake_frame = bake_frame;
+    obd.index = i;
+    BLI_task_parallel_range(0, res_y, &obd, ocean_bake_row, &settings);
+
+    /* Only keep a single frame waiting to be written, to bound memory usage. */
+    BLI_task_pool_work_and_wait(write_pool);
+    BLI_task_pool_push(write_pool, ocean_bake_write_frame, bake_frame, true, NULL);
 
     progress = (f - och->start) / (float)och->duration;
 
     update_cb(update_cb_data, progress, &cancel);
 
     if (cancel) {
-      if (prev_foam) {
-        MEM_freeN(prev_foam);
-      }
-      // BLI_rng_free(rng);
-      return;
+      break;
     }
   }
 
+  BLI_task_pool_work_and_wait(write_pool);
+  BLI_task_pool_free(write_pool);
+
   // BLI_rng_free(rng);
-  if (prev_foam) {
-    MEM_freeN(prev_foam);
+  if (obd.prev_foam) {
+    MEM_freeN(obd.prev_foam);
+  }
+  if (!cancel) {
+    och->baked = 1;
   }
-  och->baked = 1;
 }
 
 #else /* WITH_OCEANSIM */
@@ -84,15 +84,11 @@ typedef struct Ocean {
   fftw_complex *_fft_in_nz;  /* init w   sim w */
   fftw_complex *_htilda;     /* init w   sim w (only once) */
 
-  /* fftw "plans" */
-  fftw_plan _disp_y_plan; /* init w   sim r */
-  fftw_plan _disp_x_plan; /* init w   sim r */
-  fftw_plan _disp_z_plan; /* init w   sim r */
-  fftw_plan _N_x_plan;    /* init w   sim r */
-  fftw_plan _N_z_plan;    /* init w   sim r */
-  fftw_plan _Jxx_plan;    /* init w   sim r */
-  fftw_plan _Jxz_plan;    /* init w   sim r */
-  fftw_plan _Jzz_plan;    /* init w   sim r */
+  /* fftw "plans", shared by all the transforms. The 2D transforms are split in 1D transforms
+   * over columns and then rows, which are executed in parallel. */
+  fftw_plan _columns_plan;           /* init w   sim r */
+  fftw_plan _columns_remainder_plan; /* init w   sim r, NULL when not needed */
+  fftw_plan _row_plan;               /* init w   sim r */
 
   /* two dimensional arrays of float */
   double *_disp_y; /* init w   sim w via plan? */
@@ -119,8 +115,9 @@ typedef struct Ocean {
   fftw_complex *_h0;       /* init w   sim r */
   fftw_complex *_h0_minus; /* init w   sim r */
 
-  /* two dimensional float array */
-  float *_k; /* init w   sim r */
+  /* two dimensional float arrays */
+  float *_k;     /* init w   sim r */
+  float *_omega; /* init w   sim r */
 } Ocean;
 #else
 /* stub */
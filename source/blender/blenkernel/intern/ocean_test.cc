@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "DNA_modifier_types.h"
+
+#include "BKE_ocean.h"
+
+#ifdef WITH_OCEANSIM
+#  include "ocean_intern.h"
+#endif
+
+namespace blender::bke::tests {
+
+#ifdef WITH_OCEANSIM
+
+/* Complex to real 2D transform of the FFT input of the height field, computed directly from its
+ * definition. */
+static double ocean_height_reference(const Ocean *o, const double scale, const int x, const int y)
+{
+  const int columns_num = 1 + o->_N / 2;
+  double height = 0.0;
+
+  for (int ky = 0; ky < columns_num; ky++) {
+    std::complex<double> column(0.0, 0.0);
+    for (int kx = 0; kx < o->_M; kx++) {
+      const double *htilda = o->_htilda[kx * columns_num + ky];
+      column += std::complex<double>(htilda[0], htilda[1]) *
+                std::polar(1.0, 2.0 * M_PI * kx * x / o->_M);
+    }
+    const std::complex<double> value = column * std::polar(1.0, 2.0 * M_PI * ky * y / o->_N);
+    /* Other columns stand for their conjugate as well, except the first and the middle one. */
+    height += (ky == 0 || 2 * ky == o->_N) ? value.real() : 2.0 * value.real();
+  }
+
+  return height * scale;
+}
+
+TEST(ocean, SimulateHeightField)
+{
+  /* 9 columns in the spectrum, so the remaining column plan is used as well. */
+  const int resolution = 16;
+
+  Ocean *o = BKE_ocean_add();
+  BKE_ocean_init(o,
+                 resolution,
+                 resolution,
+                 50.0f,
+                 50.0f,
+                 30.0f,
+                 0.01f,
+                 1.0f,
+                 0.0f,
+                 0.5f,
+                 1.0f,
+                 200.0f,
+                 0.0f,
+                 MOD_OCEAN_SPECTRUM_PHILLIPS,
+                 120.0f,
+                 0.0f,
+                 true,
+                 false,
+                 false,
+                 false,
+                 false,
+                 0);
+  BKE_ocean_simulate(o, 1.5f, 1.0f, 0.0f);
+
+  double height_max = 0.0;
+  for (int i = 0; i < resolution * resolution; i++) {
+    height_max = std::max(height_max, std::abs(o->_disp_y[i]));
+  }
+  ASSERT_GT(height_max, 0.0);
+
+  for (int x = 0; x < resolution; x++) {
+    for (int y = 0; y < resolution; y++) {
+      EXPECT_NEAR(o->_disp_y[x * resolution + y],
+                  ocean_height_reference(o, o->normalize_factor, x, y),
+                  height_max * 1e-6);
+    }
+  }
+
+  BKE_ocean_free(o);
+}
+
+#endif
+
+}  // namespace blender::bke::tests
@@ -32,6 +32,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_boid_types.h"
 #include "DNA_curve_types.h"
@@ -91,7 +93,7 @@
 #  include "manta_fluid_API.h"
 #endif  // WITH_FLUID
 
-static ThreadRWMutex psys_bvhtree_rwlock = BLI_RWLOCK_INITIALIZER;
+static ThreadRWMutex psys_sph_grid_rwlock = BLI_RWLOCK_INITIALIZER;
 
 /************************************************/
 /*          Reacting to system events           */
@@ -1318,47 +1320,6 @@ void psys_get_pointcache_start_end(Scene *scene, ParticleSystem *psys, int *sfra
 /************************************************/
 /*          Effectors                           */
 /************************************************/
-static void psys_update_particle_bvhtree(ParticleSystem *psys, float cfra)
-{
-  if (psys) {
-    PARTICLE_P;
-    int totpart = 0;
-    bool need_rebuild;
-
-    BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
-    need_rebuild = !psys->bvhtree || psys->bvhtree_frame != cfra;
-    BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
-
-    if (need_rebuild) {
-      LOOP_SHOWN_PARTICLES
-      {
-        totpart++;
-      }
-
-      BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_WRITE);
-
-      BLI_bvhtree_free(psys->bvhtree);
-      psys->bvhtree = BLI_bvhtree_new(totpart, 0.0, 4, 6);
-
-      LOOP_SHOWN_PARTICLES
-      {
-        if (pa->alive == PARS_ALIVE) {
-          if (pa->state.time == cfra) {
-            BLI_bvhtree_insert(psys->bvhtree, p, pa->prev_state.co, 1);
-          }
-          else {
-            BLI_bvhtree_insert(psys->bvhtree, p, pa->state.co, 1);
-          }
-        }
-      }
-      BLI_bvhtree_balance(psys->bvhtree);
-
-      psys->bvhtree_frame = cfra;
-
-      BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
-    }
-  }
-}
 void psys_update_particle_tree(ParticleSystem *psys, float cfra)
 {
   if (psys) {
@@ -1547,6 +1508,285 @@ static void integrate_particle(
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name SPH Neighbor Grid
+ *
+ * Uniform grid of the alive particles of a system, used to find the neighbors of SPH fluid
+ * particles. The grid cells are hashed into a fixed number of buckets, and the particles are
+ * sorted by bucket so that the particles of a cell are stored next to each other.
+ * \{ */
+
+typedef struct SPHNeighborGrid {
+  float cell_size_inv;
+  /* The number of buckets is a power of two. */
+  unsigned int buckets_mask;
+  /* Start of the particles of each bucket in the arrays below, (buckets_num + 1) items. */
+  unsigned int *bucket_offsets;
+  /* Particle indices and positions, sorted by bucket. */
+  int *indices;
+  float (*co)[3];
+  int totpoint;
+} SPHNeighborGrid;
+
+typedef struct SPHNeighborGridBuildData {
+  SPHNeighborGrid *grid;
+  ParticleSystem *psys;
+  float cfra;
+
+  const int *unsorted_indices;
+  float (*unsorted_co)[3];
+  unsigned int *unsorted_buckets;
+  unsigned int *bucket_fill;
+} SPHNeighborGridBuildData;
+
+BLI_INLINE void sph_grid_cell(const SPHNeighborGrid *grid, const float co[3], int r_cell[3])
+{
+  for (int i = 0; i < 3; i++) {
+    const float f = co[i] * grid->cell_size_inv;
+    /* Avoid integer overflows for particles far away (or not finite). */
+    r_cell[i] = (f > -1e9f && f < 1e9f) ? (int)floorf(f) : 0;
+  }
+}
+
+BLI_INLINE unsigned int sph_grid_bucket(const SPHNeighborGrid *grid, const int cell[3])
+{
+  /* Primes from "Optimized Spatial Hashing for Collision Detection of Deformable Objects". */
+  return (((unsigned int)cell[0] * 73856093u) ^ ((unsigned int)cell[1] * 19349663u) ^
+          ((unsigned int)cell[2] * 83492791u)) &
+         grid->buckets_mask;
+}
+
+/* Use the interaction radius of the solvers, so that only the cells around a particle
+ * have to be checked to find its neighbors. */
+static float sph_grid_cell_size(const ParticleSystem *psys)
+{
+  const SPHFluidSettings *fluid = psys->part->fluid;
+  float radius = 0.0f;
+
+  if (fluid) {
+    radius = fluid->radius * (fluid->flag & SPH_FAC_RADIUS ? 4.0f * psys->part->size : 1.0f);
+  }
+
+  return (radius > FLT_EPSILON) ? radius : 1.0f;
+}
+
+static void sph_grid_build_count_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SPHNeighborGridBuildData *data = userdata;
+  const ParticleData *pa = data->psys->particles + data->unsorted_indices[i];
+  int cell[3];
+
+  copy_v3_v3(data->unsorted_co[i],
+             (pa->state.time == data->cfra) ? pa->prev_state.co : pa->state.co);
+
+  sph_grid_cell(data->grid, data->unsorted_co[i], cell);
+  const unsigned int bucket = sph_grid_bucket(data->grid, cell);
+
+  data->unsorted_buckets[i] = bucket;
+  atomic_add_and_fetch_uint32(&data->grid->bucket_offsets[bucket + 1], 1);
+}
+
+static void sph_grid_build_scatter_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SPHNeighborGridBuildData *data = userdata;
+  SPHNeighborGrid *grid = data->grid;
+  const unsigned int slot = atomic_fetch_and_add_uint32(
+      &data->bucket_fill[data->unsorted_buckets[i]], 1);
+
+  grid->indices[slot] = data->unsorted_indices[i];
+  copy_v3_v3(grid->co[slot], data->unsorted_co[i]);
+}
+
+/* The order of the particles in a bucket depends on the threads scheduling,
+ * sort them by index to get the same simulation results every time. */
+static void sph_grid_build_sort_cb(void *__restrict userdata,
+                                   const int bucket,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SPHNeighborGridBuildData *data = userdata;
+  SPHNeighborGrid *grid = data->grid;
+  const unsigned int start = grid->bucket_offsets[bucket];
+  const unsigned int end = grid->bucket_offsets[bucket + 1];
+
+  for (unsigned int i = start + 1; i < end; i++) {
+    const int index = grid->indices[i];
+    float co[3];
+    unsigned int j;
+
+    copy_v3_v3(co, grid->co[i]);
+    for (j = i; j > start && grid->indices[j - 1] > index; j--) {
+      grid->indices[j] = grid->indices[j - 1];
+      copy_v3_v3(grid->co[j], grid->co[j - 1]);
+    }
+    grid->indices[j] = index;
+    copy_v3_v3(grid->co[j], co);
+  }
+}
+
+static SPHNeighborGrid *sph_grid_build(ParticleSystem *psys, float cfra)
+{
+  SPHNeighborGrid *grid = MEM_callocN(sizeof(SPHNeighborGrid), __func__);
+  SPHNeighborGridBuildData data;
+  TaskParallelSettings settings;
+  PARTICLE_P;
+  int totpoint = 0;
+
+  LOOP_SHOWN_PARTICLES
+  {
+    if (pa->alive == PARS_ALIVE) {
+      totpoint++;
+    }
+  }
+
+  grid->cell_size_inv = 1.0f / sph_grid_cell_size(psys);
+  grid->buckets_mask = power_of_2_max_u((unsigned int)max_ii(totpoint, 1)) - 1;
+  grid->bucket_offsets = MEM_calloc_arrayN(
+      grid->buckets_mask + 2, sizeof(unsigned int), "SPH grid bucket offsets");
+  grid->indices = MEM_malloc_arrayN(totpoint, sizeof(int), "SPH grid indices");
+  grid->co = MEM_malloc_arrayN(totpoint, sizeof(float[3]), "SPH grid co");
+  grid->totpoint = totpoint;
+
+  int *unsorted_indices = MEM_malloc_arrayN(totpoint, sizeof(int), __func__);
+  int i = 0;
+  LOOP_SHOWN_PARTICLES
+  {
+    if (pa->alive == PARS_ALIVE) {
+      unsorted_indices[i++] = p;
+    }
+  }
+
+  data.grid = grid;
+  data.psys = psys;
+  data.cfra = cfra;
+  data.unsorted_indices = unsorted_indices;
+  data.unsorted_co = MEM_malloc_arrayN(totpoint, sizeof(float[3]), __func__);
+  data.unsorted_buckets = MEM_malloc_arrayN(totpoint, sizeof(unsigned int), __func__);
+
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  /* Counting sort of the particles by bucket. */
+  BLI_task_parallel_range(0, totpoint, &data, sph_grid_build_count_cb, &settings);
+
+  for (unsigned int bucket = 0; bucket <= grid->buckets_mask; bucket++) {
+    grid->bucket_offsets[bucket + 1] += grid->bucket_offsets[bucket];
+  }
+  data.bucket_fill = MEM_dupallocN(grid->bucket_offsets);
+
+  BLI_task_parallel_range(0, totpoint, &data, sph_grid_build_scatter_cb, &settings);
+  BLI_task_parallel_range(
+      0, (int)grid->buckets_mask + 1, &data, sph_grid_build_sort_cb, &settings);
+
+  MEM_freeN(unsorted_indices);
+  MEM_freeN(data.unsorted_co);
+  MEM_freeN(data.unsorted_buckets);
+  MEM_freeN(data.bucket_fill);
+
+  return grid;
+}
+
+void psys_sph_grid_free(SPHNeighborGrid *grid)
+{
+  if (grid == NULL) {
+    return;
+  }
+
+  MEM_freeN(grid->bucket_offsets);
+  MEM_freeN(grid->indices);
+  MEM_freeN(grid->co);
+  MEM_freeN(grid);
+}
+
+/* Same as #BLI_bvhtree_range_query, but on the grid. */
+static void sph_grid_range_query(const SPHNeighborGrid *grid,
+                                 const float co[3],
+                                 float radius,
+                                 BVHTree_RangeQuery callback,
+                                 void *userdata)
+{
+  const float radius_sq = radius * radius;
+  float co_min[3], co_max[3];
+  int cell_min[3], cell_max[3];
+  int cell[3];
+
+  for (int i = 0; i < 3; i++) {
+    co_min[i] = co[i] - radius;
+    co_max[i] = co[i] + radius;
+  }
+  sph_grid_cell(grid, co_min, cell_min);
+  sph_grid_cell(grid, co_max, cell_max);
+
+  const int64_t cells_num = (int64_t)(cell_max[0] - cell_min[0] + 1) *
+                            (int64_t)(cell_max[1] - cell_min[1] + 1) *
+                            (int64_t)(cell_max[2] - cell_min[2] + 1);
+
+  /* Radius much larger than the cells, faster to check all the particles. */
+  if (cells_num > (int64_t)grid->buckets_mask + 1) {
+    for (int i = 0; i < grid->totpoint; i++) {
+      const float dist_sq = len_squared_v3v3(co, grid->co[i]);
+      if (dist_sq < radius_sq) {
+        callback(userdata, grid->indices[i], co, dist_sq);
+      }
+    }
+    return;
+  }
+
+  for (cell[2] = cell_min[2]; cell[2] <= cell_max[2]; cell[2]++) {
+    for (cell[1] = cell_min[1]; cell[1] <= cell_max[1]; cell[1]++) {
+      for (cell[0] = cell_min[0]; cell[0] <= cell_max[0]; cell[0]++) {
+        const unsigned int bucket = sph_grid_bucket(grid, cell);
+        const unsigned int end = grid->bucket_offsets[bucket + 1];
+
+        for (unsigned int i = grid->bucket_offsets[bucket]; i < end; i++) {
+          const float dist_sq = len_squared_v3v3(co, grid->co[i]);
+          int point_cell[3];
+
+          if (dist_sq >= radius_sq) {
+            continue;
+          }
+          /* Other cells can be hashed to the same bucket. */
+          sph_grid_cell(grid, grid->co[i], point_cell);
+          if (!equals_v3v3_int(point_cell, cell)) {
+            continue;
+          }
+
+          callback(userdata, grid->indices[i], co, dist_sq);
+        }
+      }
+    }
+  }
+}
+
+static void psys_update_particle_sph_grid(ParticleSystem *psys, float cfra)
+{
+  if (psys) {
+    bool need_rebuild;
+
+    BLI_rw_mutex_lock(&psys_sph_grid_rwlock, THREAD_LOCK_READ);
+    need_rebuild = !psys->sph_grid || psys->sph_grid_frame != cfra;
+    BLI_rw_mutex_unlock(&psys_sph_grid_rwlock);
+
+    if (need_rebuild) {
+      /* Built without lock, other systems can keep reading the previous grid meanwhile. */
+      SPHNeighborGrid *grid = sph_grid_build(psys, cfra);
+
+      BLI_rw_mutex_lock(&psys_sph_grid_rwlock, THREAD_LOCK_WRITE);
+
+      psys_sph_grid_free(psys->sph_grid);
+      psys->sph_grid = grid;
+      psys->sph_grid_frame = cfra;
+
+      BLI_rw_mutex_unlock(&psys_sph_grid_rwlock);
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name SPH fluid physics
  *
@@ -1708,11 +1948,13 @@ static void sph_evaluate_func(BVHTree *tree,
       break;
     }
 
-    BLI_rw_mutex_lock(&psys_bvhtree_rwlock, THREAD_LOCK_READ);
+    BLI_rw_mutex_lock(&psys_sph_grid_rwlock, THREAD_LOCK_READ);
 
-    BLI_bvhtree_range_query(psys[i]->bvhtree, co, interaction_radius, callback, pfr);
+    if (psys[i]->sph_grid) {
+      sph_grid_range_query(psys[i]->sph_grid, co, interaction_radius, callback, pfr);
+    }
 
-    BLI_rw_mutex_unlock(&psys_bvhtree_rwlock);
+    BLI_rw_mutex_unlock(&psys_sph_grid_rwlock);
   }
 }
 static void sph_density_accum_cb(void *userdata, int index, const float co[3], float squared_dist)
@@ -3870,12 +4112,12 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
     }
     case PART_PHYS_FLUID: {
       ParticleTarget *pt = psys->targets.first;
-      psys_update_particle_bvhtree(psys, cfra);
+      psys_update_particle_sph_grid(psys, cfra);
 
       for (; pt;
            pt = pt->next) { /* Updating others systems particle tree for fluid-fluid interaction */
         if (pt->ob) {
-          psys_update_particle_bvhtree(BLI_findlink(&pt->ob->particlesystem, pt->psys - 1), cfra);
+          psys_update_particle_sph_grid(BLI_findlink(&pt->ob->particlesystem, pt->psys - 1), cfra);
         }
       }
       break;
@@ -45,6 +45,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_mmap.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
 
@@ -145,11 +146,11 @@ static int ptcache_basic_header_read(PTCacheFile *pf)
   int error = 0;
 
   /* Custom functions should read these basic elements too! */
-  if (!error && !fread(&pf->totpoint, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->totpoint, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
-  if (!error && !fread(&pf->data_types, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &pf->data_types, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -1466,19 +1467,73 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 
   pf = MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
   pf->fp = fp;
+  pf->mmap_file = NULL;
+  pf->mmap_offset = 0;
   pf->old_format = 0;
   pf->frame = cfra;
 
+  /* Reading from a mapped file avoids a system call and a copy for every value read,
+   * compressed data is also decompressed directly from the mapped memory. */
+  if (mode == PTCACHE_FILE_READ) {
+    pf->mmap_file = BLI_mmap_open(fileno(fp));
+    if (pf->mmap_file) {
+      fclose(pf->fp);
+      pf->fp = NULL;
+    }
+  }
+
   return pf;
 }
 static void ptcache_file_close(PTCacheFile *pf)
 {
   if (pf) {
-    fclose(pf->fp);
+    if (pf->mmap_file) {
+      BLI_mmap_free(pf->mmap_file);
+    }
+    else {
+      fclose(pf->fp);
+    }
     MEM_freeN(pf);
   }
 }
 
+/* Read the file in place, only possible for mapped files.
+ * Returns NULL if the file isn't mapped or is too short. */
+static const void *ptcache_file_read_in_place(PTCacheFile *pf, size_t len)
+{
+  if (pf->mmap_file == NULL) {
+    return NULL;
+  }
+
+  const size_t file_len = BLI_mmap_get_length(pf->mmap_file);
+  if ((pf->mmap_offset > file_len) || (len > file_len - pf->mmap_offset)) {
+    return NULL;
+  }
+
+  const char *data = (const char *)BLI_mmap_get_pointer(pf->mmap_file) + pf->mmap_offset;
+  pf->mmap_offset += len;
+  return data;
+}
+
+/* TODO: Storing all frames in a single file with a frame index would let the cache be mapped
+ * once, making seeking a lookup instead of opening a file per frame. That is a new on-disk format
+ * to support next to the current one: listing, clearing and renaming frames, and external caches,
+ * all work with one file per frame. A faster per-frame compressor (LZ4 or zstd) also needs a new
+ * library in extern/, LZO is the fast one for now. */
+
+/* Start loading a frame file in the background, when it exists. */
+static void ptcache_file_readahead(PTCacheID *pid, int cfra)
+{
+  char filename[FILE_MAX * 2];
+
+  if (!G.relbase_valid && (pid->cache->flag & PTCACHE_EXTERNAL) == 0) {
+    return;
+  }
+
+  ptcache_filename(pid, filename, cfra, 1, 1);
+  BLI_file_readahead(filename);
+}
+
 static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len)
 {
   int r = 0;
@@ -1487,7 +1542,8 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
 #ifdef WITH_LZO
   size_t out_len = len;
 #endif
-  unsigned char *in;
+  const unsigned char *in;
+  unsigned char *in_alloc = NULL;
   unsigned char *props = MEM_callocN(sizeof(char[16]), "tmp");
 
   ptcache_file_read(pf, &compressed, 1, sizeof(unsigned char));
@@ -1499,12 +1555,16 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
       /* do nothing */
     }
     else {
-      in = (unsigned char *)MEM_callocN(sizeof(unsigned char) * in_len,
-                                        "pointcache_compressed_buffer");
-      ptcache_file_read(pf, in, in_len, sizeof(unsigned char));
+      in = ptcache_file_read_in_place(pf, in_len);
+      if (in == NULL) {
+        in = in_alloc = (unsigned char *)MEM_callocN(sizeof(unsigned char) * in_len,
+                                                     "pointcache_compressed_buffer");
+        ptcache_file_read(pf, in_alloc, in_len, sizeof(unsigned char));
+      }
 #ifdef WITH_LZO
       if (compressed == 1) {
-        r = lzo1x_decompress_safe(in, (lzo_uint)in_len, result, (lzo_uint *)&out_len, NULL);
+        r = lzo1x_decompress_safe(
+            (unsigned char *)in, (lzo_uint)in_len, result, (lzo_uint *)&out_len, NULL);
       }
 #endif
 #ifdef WITH_LZMA
@@ -1517,7 +1577,9 @@ static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result,
         r = LzmaUncompress(result, &leno, in, &leni, props, sizeOfIt);
       }
 #endif
-      MEM_freeN(in);
+      if (in_alloc) {
+        MEM_freeN(in_alloc);
+      }
     }
   }
   else {
@@ -1601,6 +1663,14 @@ static int ptcache_file_compressed_write(
 }
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
+  if (pf->mmap_file) {
+    const size_t len = (size_t)tot * size;
+    if (!BLI_mmap_read(pf->mmap_file, f, pf->mmap_offset, len)) {
+      return 0;
+    }
+    pf->mmap_offset += len;
+    return 1;
+  }
   return (fread(f, size, tot, pf->fp) == tot);
 }
 static int ptcache_file_write(PTCacheFile *pf, const void *f, unsigned int tot, unsigned int size)
@@ -1641,7 +1711,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   pf->data_types = 0;
 
-  if (fread(bphysics, sizeof(char), 8, pf->fp) != 8) {
+  if (!ptcache_file_read(pf, bphysics, 8, sizeof(char))) {
     error = 1;
   }
 
@@ -1649,7 +1719,7 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
     error = 1;
   }
 
-  if (!error && !fread(&typeflag, sizeof(unsigned int), 1, pf->fp)) {
+  if (!error && !ptcache_file_read(pf, &typeflag, 1, sizeof(unsigned int))) {
     error = 1;
   }
 
@@ -1658,7 +1728,12 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 
   /* if there was an error set file as it was */
   if (error) {
-    BLI_fseek(pf->fp, 0, SEEK_SET);
+    if (pf->mmap_file) {
+      pf->mmap_offset = 0;
+    }
+    else {
+      BLI_fseek(pf->fp, 0, SEEK_SET);
+    }
   }
 
   return !error;
@@ -2324,6 +2399,12 @@ int BKE_ptcache_read(PTCacheID *pid, float cfra, bool no_extrapolate_old)
     }
   }
 
+  /* Frames are mostly read one after the other during playback, so the next cached frame is
+   * likely to be read soon. */
+  if (pid->cache->flag & PTCACHE_DISK_CACHE) {
+    ptcache_file_readahead(pid, MAX2(cfra1, cfra2) + max_ii(pid->cache->step, 1));
+  }
+
   if (cfra1) {
     ret = (cfra2 ? PTCACHE_READ_INTERPOLATED : PTCACHE_READ_EXACT);
   }
@@ -169,6 +169,10 @@ static bool undosys_step_encode(bContext *C, Main *bmain, UndoStack *ustack, Und
       ustack->step_active_memfile = us;
     }
 #endif
+    if (us->type != BKE_UNDOSYS_TYPE_MEMFILE) {
+      /* Mode data is edited in-place and only loaded back into IDs on the next memfile step. */
+      bmain->is_memfile_undo_untagged_change = true;
+    }
   }
   if (ok == false) {
     CLOG_INFO(&LOG, 2, "encode callback didn't create undo step");
@@ -215,6 +219,9 @@ static void undosys_step_decode(
     ustack->step_active_memfile = us;
   }
 #endif
+  if (us->type != BKE_UNDOSYS_TYPE_MEMFILE) {
+    bmain->is_memfile_undo_untagged_change = true;
+  }
 }
 
 static void undosys_step_free_and_unlink(UndoStack *ustack, UndoStep *us)
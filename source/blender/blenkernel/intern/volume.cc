@@ -33,6 +33,7 @@
 #include "BLI_math.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_anim_data.h"
@@ -64,6 +65,7 @@ static CLG_LogRef LOG = {"bke.volume"};
 #define VOLUME_FRAME_NONE INT_MAX
 
 #ifdef WITH_OPENVDB
+#  include <algorithm>
 #  include <atomic>
 #  include <list>
 #  include <mutex>
@@ -87,6 +89,9 @@ static CLG_LogRef LOG = {"bke.volume"};
  *
  * When the number of users drops to zero, the grid data is immediately deleted.
  *
+ * Grids of upcoming frames of image sequences may also be held by the
+ * prefetcher below, which reads them on a background thread.
+ *
  * TODO: also add a cache for OpenVDB files rather than individual grids,
  * so getting the list of grids is also cached.
  * TODO: Further, we could cache openvdb::io::File so that loading a grid
@@ -256,6 +261,12 @@ static struct VolumeFileCache {
   EntrySet cache;
   /* Mutex for multithreaded access. */
   std::mutex mutex;
+
+ public:
+  /* Statistics, see #VolumeFileCacheStats. */
+  std::atomic<int> num_hits{0};
+  std::atomic<int> num_misses{0};
+  std::atomic<int> num_prefetched{0};
 } GLOBAL_CACHE;
 
 /* VolumeGrid
@@ -292,7 +303,10 @@ struct VolumeGrid {
     }
   }
 
-  void load(const char *volume_name, const char *filepath)
+  /* Load the grid tree from file. Leaf buffers are read lazily from the memory mapped file on
+   * first access, except when prefetching, where everything is read right away so that no file
+   * access remains for the thread using the grid later. */
+  void load(const char *volume_name, const char *filepath, const bool prefetch = false)
   {
     /* If already loaded or not file-backed, nothing to do. */
     if (is_loaded || entry == NULL) {
@@ -310,18 +324,27 @@ struct VolumeGrid {
 
     /* If already loaded by another user, nothing further to do. */
     if (entry->is_loaded) {
+      if (!prefetch) {
+        GLOBAL_CACHE.num_hits++;
+      }
       is_loaded = true;
       return;
     }
 
     /* Load grid from file. */
-    CLOG_INFO(&LOG, 1, "Volume %s: load grid '%s'", volume_name, name());
+    CLOG_INFO(&LOG,
+              1,
+              "Volume %s: %s grid '%s'",
+              volume_name,
+              prefetch ? "prefetch" : "load",
+              name());
+    (prefetch ? GLOBAL_CACHE.num_prefetched : GLOBAL_CACHE.num_misses)++;
 
     openvdb::io::File file(filepath);
 
     try {
       file.setCopyMaxBytes(0);
-      file.open();
+      file.open(!prefetch);
       openvdb::GridBase::Ptr vdb_grid = file.readGrid(name());
       entry->grid->setTree(vdb_grid->baseTreePtr());
     }
@@ -480,6 +503,223 @@ struct VolumeGridVector : public std::list<VolumeGrid> {
   /* Mutex for file loading of grids list. */
   std::mutex mutex;
 };
+
+/* Read the list of grids and the file metadata from grids.filepath. Only grid metadata is read,
+ * trees are loaded on demand. */
+static void volume_grids_read_metadata(VolumeGridVector &grids,
+                                       const char *volume_name,
+                                       const int simplify_level)
+{
+  /* Test if file exists. */
+  if (!BLI_exists(grids.filepath)) {
+    char filename[FILE_MAX];
+    BLI_split_file_part(grids.filepath, filename, sizeof(filename));
+    grids.error_msg = filename + std::string(" not found");
+    CLOG_INFO(&LOG, 1, "Volume %s: %s", volume_name, grids.error_msg.c_str());
+    return;
+  }
+
+  /* Open OpenVDB file. */
+  openvdb::io::File file(grids.filepath);
+  openvdb::GridPtrVec vdb_grids;
+
+  try {
+    file.setCopyMaxBytes(0);
+    file.open();
+    vdb_grids = *(file.readAllGridMetadata());
+    grids.metadata = file.getMetadata();
+  }
+  catch (const openvdb::IoError &e) {
+    grids.error_msg = e.what();
+    CLOG_INFO(&LOG, 1, "Volume %s: %s", volume_name, grids.error_msg.c_str());
+  }
+
+  /* Add grids read from file to own vector, filtering out any NULL pointers. */
+  for (const openvdb::GridBase::Ptr &vdb_grid : vdb_grids) {
+    if (vdb_grid) {
+      VolumeFileCache::Entry template_entry(grids.filepath, vdb_grid);
+      grids.emplace_back(template_entry, simplify_level);
+    }
+  }
+}
+
+/* Volume Prefetch
+ *
+ * While playing back an image sequence, the grids of the next frames are read
+ * on a background thread, so that changing frame does not wait for file
+ * reading. Prefetched frames keep their grids in the global file cache until
+ * BKE_volume_load() picks them up. Frames that playback went past, that were
+ * loaded without them or that belong to unloaded volumes are dropped. */
+
+#  define VOLUME_PREFETCH_FRAMES 2
+#  define VOLUME_PREFETCH_MAX_FRAMES 8
+
+static struct VolumePrefetchCache {
+  struct Frame {
+    /* Original volume datablock the frame is read for. */
+    const ID *owner;
+    int frame;
+    std::string volume_name;
+    int simplify_level;
+    VolumeGridVector grids;
+    /* Set once the background task is done with the frame. */
+    bool is_loaded = false;
+    /* Not needed anymore, freed as soon as the background task is done with it. */
+    std::atomic<bool> is_stale{false};
+  };
+
+  ~VolumePrefetchCache()
+  {
+    clear();
+  }
+
+  void prefetch(const ID *owner,
+                const char *volume_name,
+                const int frame_number,
+                const char *filepath,
+                const int simplify_level)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const Frame &frame : frames) {
+      if (!frame.is_stale && STREQ(frame.grids.filepath, filepath)) {
+        return;
+      }
+    }
+
+    if (frames.size() >= VOLUME_PREFETCH_MAX_FRAMES) {
+      /* Drop the oldest frame that is not being loaded. */
+      std::list<Frame>::iterator it = std::find_if(
+          frames.begin(), frames.end(), [](const Frame &frame) { return frame.is_loaded; });
+      if (it == frames.end()) {
+        return;
+      }
+      frames.erase(it);
+    }
+
+    if (task_pool == NULL) {
+      task_pool = BLI_task_pool_create_background_serial(this, TASK_PRIORITY_LOW);
+    }
+
+    frames.emplace_back();
+    Frame &frame = frames.back();
+    frame.owner = owner;
+    frame.frame = frame_number;
+    frame.volume_name = volume_name;
+    frame.simplify_level = simplify_level;
+    STRNCPY(frame.grids.filepath, filepath);
+
+    BLI_task_pool_push(task_pool, prefetch_task_run, &frame, false, NULL);
+  }
+
+  /* Move the grids prefetched for grids.filepath into grids, if any. */
+  bool take(VolumeGridVector &grids, const int simplify_level)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (std::list<Frame>::iterator it = frames.begin(); it != frames.end(); it++) {
+      Frame &frame = *it;
+      if (frame.is_stale || !STREQ(frame.grids.filepath, grids.filepath)) {
+        continue;
+      }
+      if (!frame.is_loaded) {
+        /* Still being read, loading the grids will wait for the ones in progress and share the
+         * ones already done through the file cache. The frame itself is of no use after that. */
+        frame.is_stale = true;
+        return false;
+      }
+
+      grids.splice(grids.end(), frame.grids);
+      grids.metadata = frame.grids.metadata;
+      grids.error_msg = frame.grids.error_msg;
+      for (VolumeGrid &grid : grids) {
+        grid.set_simplify_level(simplify_level);
+      }
+      GLOBAL_CACHE.num_hits += (int)grids.size();
+
+      frames.erase(it);
+      return true;
+    }
+
+    return false;
+  }
+
+  /* Drop the frames of owner other than the given ones, e.g. the ones playback went past. */
+  void retain(const ID *owner, const int *frame_numbers, const int frame_numbers_len)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    drop_if([&](const Frame &frame) {
+      return frame.owner == owner &&
+             std::find(frame_numbers, frame_numbers + frame_numbers_len, frame.frame) ==
+                 frame_numbers + frame_numbers_len;
+    });
+  }
+
+  /* Drop all frames of owner, when its file is unloaded, reloaded or changed. */
+  void remove(const ID *owner)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    drop_if([&](const Frame &frame) { return frame.owner == owner; });
+  }
+
+  void clear()
+  {
+    if (task_pool) {
+      BLI_task_pool_cancel(task_pool);
+      BLI_task_pool_free(task_pool);
+      task_pool = NULL;
+    }
+    frames.clear();
+  }
+
+ private:
+  template<typename Predicate> void drop_if(const Predicate &predicate)
+  {
+    for (std::list<Frame>::iterator it = frames.begin(); it != frames.end();) {
+      if (!predicate(*it)) {
+        it++;
+      }
+      else if (it->is_loaded) {
+        it = frames.erase(it);
+      }
+      else {
+        /* The background task still uses it. */
+        it->is_stale = true;
+        it++;
+      }
+    }
+  }
+
+  static void prefetch_task_run(TaskPool *__restrict pool, void *taskdata)
+  {
+    VolumePrefetchCache *prefetch_cache = (VolumePrefetchCache *)BLI_task_pool_user_data(pool);
+    Frame &frame = *(Frame *)taskdata;
+    const char *volume_name = frame.volume_name.c_str();
+
+    volume_grids_read_metadata(frame.grids, volume_name, frame.simplify_level);
+
+    for (VolumeGrid &grid : frame.grids) {
+      if (BLI_task_pool_canceled(pool) || frame.is_stale) {
+        break;
+      }
+      grid.load(volume_name, frame.grids.filepath, true);
+      /* Create the simplified grid used for display in advance as well. */
+      grid.grid();
+    }
+
+    std::lock_guard<std::mutex> lock(prefetch_cache->mutex);
+    frame.is_loaded = true;
+    if (frame.is_stale) {
+      prefetch_cache->frames.remove_if([&](const Frame &other) { return &other == &frame; });
+    }
+  }
+
+  /* Frames in the order they were requested. List items keep their address,
+   * which is used by the background task. */
+  std::list<Frame> frames;
+  std::mutex mutex;
+  TaskPool *task_pool = NULL;
+} GLOBAL_PREFETCH;
 #endif
 
 /* Module */
@@ -491,6 +731,50 @@ void BKE_volumes_init()
 #endif
 }
 
+void BKE_volumes_exit()
+{
+#ifdef WITH_OPENVDB
+  GLOBAL_PREFETCH.clear();
+
+  VolumeFileCacheStats stats;
+  BKE_volume_file_cache_stats(&stats);
+  CLOG_INFO(&LOG,
+            1,
+            "File cache: %d hits, %d misses, %d prefetched",
+            stats.hits,
+            stats.misses,
+            stats.prefetched);
+#endif
+}
+
+/* Stop reading frames in advance and free the ones already read, e.g. when loading a file. */
+void BKE_volumes_prefetch_clear()
+{
+#ifdef WITH_OPENVDB
+  GLOBAL_PREFETCH.clear();
+#endif
+}
+
+void BKE_volume_file_cache_stats(VolumeFileCacheStats *r_stats)
+{
+#ifdef WITH_OPENVDB
+  r_stats->hits = GLOBAL_CACHE.num_hits;
+  r_stats->misses = GLOBAL_CACHE.num_misses;
+  r_stats->prefetched = GLOBAL_CACHE.num_prefetched;
+#else
+  memset(r_stats, 0, sizeof(*r_stats));
+#endif
+}
+
+void BKE_volume_file_cache_stats_reset()
+{
+#ifdef WITH_OPENVDB
+  GLOBAL_CACHE.num_hits = 0;
+  GLOBAL_CACHE.num_misses = 0;
+  GLOBAL_CACHE.num_prefetched = 0;
+#endif
+}
+
 /* Volume datablock */
 
 static void volume_init_data(ID *id)
@@ -531,6 +815,9 @@ static void volume_free_data(ID *id)
   BKE_volume_batch_cache_free(volume);
   MEM_SAFE_FREE(volume->mat);
 #ifdef WITH_OPENVDB
+  if ((volume->id.tag & LIB_TAG_COPIED_ON_WRITE) == 0) {
+    GLOBAL_PREFETCH.remove(&volume->id);
+  }
   OBJECT_GUARDED_SAFE_DELETE(volume->runtime.grids, VolumeGridVector);
 #endif
 }
@@ -655,7 +942,7 @@ void *BKE_volume_add(Main *bmain, const char *name)
 
 /* Sequence */
 
-static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volume)
+static int volume_sequence_frame_at(const Volume *volume, const int scene_frame)
 {
   if (!volume->is_sequence) {
     return 0;
@@ -668,7 +955,6 @@ static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volum
     return 0;
   }
 
-  const int scene_frame = DEG_get_ctime(depsgraph);
   const VolumeSequenceMode mode = (VolumeSequenceMode)volume->sequence_mode;
   const int frame_duration = volume->frame_duration;
   const int frame_start = volume->frame_start;
@@ -723,8 +1009,16 @@ static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volum
   return frame;
 }
 
+static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volume)
+{
+  return volume_sequence_frame_at(volume, DEG_get_ctime(depsgraph));
+}
+
 #ifdef WITH_OPENVDB
-static void volume_filepath_get(const Main *bmain, const Volume *volume, char r_filepath[FILE_MAX])
+static void volume_filepath_get(const Main *bmain,
+                                const Volume *volume,
+                                const int frame,
+                                char r_filepath[FILE_MAX])
 {
   BLI_strncpy(r_filepath, volume->filepath, FILE_MAX);
   BLI_path_abs(r_filepath, ID_BLEND_PATH(bmain, &volume->id));
@@ -733,7 +1027,7 @@ static void volume_filepath_get(const Main *bmain, const Volume *volume, char r_
   if (volume->is_sequence && BLI_path_frame_get(r_filepath, &path_frame, &path_digits)) {
     char ext[32];
     BLI_path_frame_strip(r_filepath, ext);
-    BLI_path_frame(r_filepath, volume->runtime.frame, path_digits);
+    BLI_path_frame(r_filepath, frame, path_digits);
     BLI_path_extension_ensure(r_filepath, FILE_MAX, ext);
   }
 }
@@ -774,41 +1068,17 @@ bool BKE_volume_load(Volume *volume, Main *bmain)
 
   /* Get absolute file path at current frame. */
   const char *volume_name = volume->id.name + 2;
-  volume_filepath_get(bmain, volume, grids.filepath);
+  volume_filepath_get(bmain, volume, volume->runtime.frame, grids.filepath);
 
-  CLOG_INFO(&LOG, 1, "Volume %s: load %s", volume_name, grids.filepath);
-
-  /* Test if file exists. */
-  if (!BLI_exists(grids.filepath)) {
-    char filename[FILE_MAX];
-    BLI_split_file_part(grids.filepath, filename, sizeof(filename));
-    grids.error_msg = filename + std::string(" not found");
-    CLOG_INFO(&LOG, 1, "Volume %s: %s", volume_name, grids.error_msg.c_str());
-    return false;
+  /* Use the grids read in advance by the prefetcher if possible. */
+  if (GLOBAL_PREFETCH.take(grids, volume->runtime.default_simplify_level)) {
+    CLOG_INFO(&LOG, 1, "Volume %s: load %s (prefetched)", volume_name, grids.filepath);
+    return grids.error_msg.empty();
   }
 
-  /* Open OpenVDB file. */
-  openvdb::io::File file(grids.filepath);
-  openvdb::GridPtrVec vdb_grids;
-
-  try {
-    file.setCopyMaxBytes(0);
-    file.open();
-    vdb_grids = *(file.readAllGridMetadata());
-    grids.metadata = file.getMetadata();
-  }
-  catch (const openvdb::IoError &e) {
-    grids.error_msg = e.what();
-    CLOG_INFO(&LOG, 1, "Volume %s: %s", volume_name, grids.error_msg.c_str());
-  }
+  CLOG_INFO(&LOG, 1, "Volume %s: load %s", volume_name, grids.filepath);
 
-  /* Add grids read from file to own vector, filtering out any NULL pointers. */
-  for (const openvdb::GridBase::Ptr &vdb_grid : vdb_grids) {
-    if (vdb_grid) {
-      VolumeFileCache::Entry template_entry(grids.filepath, vdb_grid);
-      grids.emplace_back(template_entry, volume->runtime.default_simplify_level);
-    }
-  }
+  volume_grids_read_metadata(grids, volume_name, volume->runtime.default_simplify_level);
 
   return grids.error_msg.empty();
 #else
@@ -817,7 +1087,7 @@ bool BKE_volume_load(Volume *volume, Main *bmain)
 #endif
 }
 
-void BKE_volume_unload(Volume *volume)
+static void volume_grids_unload(Volume *volume)
 {
 #ifdef WITH_OPENVDB
   VolumeGridVector &grids = *volume->runtime.grids;
@@ -831,6 +1101,17 @@ void BKE_volume_unload(Volume *volume)
 #endif
 }
 
+void BKE_volume_unload(Volume *volume)
+{
+  volume_grids_unload(volume);
+#ifdef WITH_OPENVDB
+  /* The file may be reloaded or changed, prefetched frames would be outdated. */
+  GLOBAL_PREFETCH.remove(DEG_get_original_id(&volume->id));
+#else
+  UNUSED_VARS(volume);
+#endif
+}
+
 /* File Save */
 
 bool BKE_volume_save(Volume *volume, Main *bmain, ReportList *reports, const char *filepath)
@@ -892,8 +1173,14 @@ BoundBox *BKE_volume_boundbox_get(Object *ob)
         VolumeGrid *grid = BKE_volume_grid_get(volume, i);
         float grid_min[3], grid_max[3];
 
-        BKE_volume_grid_load(volume, grid);
-        if (BKE_volume_grid_bounds(grid, grid_min, grid_max)) {
+        /* Try the bounds stored in the file metadata first, which avoids reading the tree. */
+        bool has_bounds = BKE_volume_grid_bounds(grid, grid_min, grid_max);
+        if (!has_bounds && !BKE_volume_grid_is_loaded(grid)) {
+          BKE_volume_grid_load(volume, grid);
+          has_bounds = BKE_volume_grid_bounds(grid, grid_min, grid_max);
+        }
+
+        if (has_bounds) {
           DO_MIN(grid_min, min);
           DO_MAX(grid_max, max);
           have_minmax = true;
@@ -1014,6 +1301,45 @@ static Volume *volume_evaluate_modifiers(struct Depsgraph *depsgraph,
   return volume;
 }
 
+static void volume_sequence_prefetch(const Depsgraph *depsgraph, const Volume *volume)
+{
+#ifdef WITH_OPENVDB
+  /* Only for the active depsgraph, to keep up with playback. Final renders and exporters
+   * evaluate one frame at a time and don't benefit from it. */
+  if (!volume->is_sequence || !DEG_is_active(depsgraph)) {
+    return;
+  }
+
+  const Main *bmain = DEG_get_bmain(depsgraph);
+  const ID *owner = DEG_get_original_id((ID *)&volume->id);
+  const int scene_frame = DEG_get_ctime(depsgraph);
+  const char *volume_name = volume->id.name + 2;
+
+  /* The current frame may not be picked up from the prefetcher yet, keep it as well. */
+  int frames[VOLUME_PREFETCH_FRAMES + 1];
+  frames[0] = volume->runtime.frame;
+  for (int i = 1; i <= VOLUME_PREFETCH_FRAMES; i++) {
+    frames[i] = volume_sequence_frame_at(volume, scene_frame + i);
+  }
+  GLOBAL_PREFETCH.retain(owner, frames, ARRAY_SIZE(frames));
+
+  for (int i = 1; i <= VOLUME_PREFETCH_FRAMES; i++) {
+    if (ELEM(frames[i], VOLUME_FRAME_NONE, volume->runtime.frame)) {
+      continue;
+    }
+
+    char filepath[FILE_MAX];
+    volume_filepath_get(bmain, volume, frames[i], filepath);
+    if (BLI_exists(filepath)) {
+      GLOBAL_PREFETCH.prefetch(
+          owner, volume_name, frames[i], filepath, volume->runtime.default_simplify_level);
+    }
+  }
+#else
+  UNUSED_VARS(depsgraph, volume);
+#endif
+}
+
 void BKE_volume_eval_geometry(struct Depsgraph *depsgraph, Volume *volume)
 {
   volume_update_simplify_level(volume, depsgraph);
@@ -1021,15 +1347,16 @@ void BKE_volume_eval_geometry(struct Depsgraph *depsgraph, Volume *volume)
   /* TODO: can we avoid modifier re-evaluation when frame did not change? */
   int frame = volume_sequence_frame(depsgraph, volume);
   if (frame != volume->runtime.frame) {
-    BKE_volume_unload(volume);
+    volume_grids_unload(volume);
     volume->runtime.frame = frame;
+    volume_sequence_prefetch(depsgraph, volume);
   }
 
   /* Flush back to original. */
   if (DEG_is_active(depsgraph)) {
     Volume *volume_orig = (Volume *)DEG_get_original_id(&volume->id);
     if (volume_orig->runtime.frame != volume->runtime.frame) {
-      BKE_volume_unload(volume_orig);
+      volume_grids_unload(volume_orig);
       volume_orig->runtime.frame = volume->runtime.frame;
     }
   }
@@ -1320,14 +1647,35 @@ void BKE_volume_grid_transform_matrix(const VolumeGrid *volume_grid, float mat[4
 bool BKE_volume_grid_bounds(const VolumeGrid *volume_grid, float min[3], float max[3])
 {
 #ifdef WITH_OPENVDB
-  /* TODO: we can get this from grid metadata in some cases? */
   const openvdb::GridBase::Ptr grid = volume_grid->grid();
-  BLI_assert(BKE_volume_grid_is_loaded(volume_grid));
 
   openvdb::CoordBBox coordbbox;
-  if (!grid->baseTree().evalLeafBoundingBox(coordbbox)) {
-    INIT_MINMAX(min, max);
-    return false;
+  if (BKE_volume_grid_is_loaded(volume_grid)) {
+    /* Same bounds as the ones written in the file metadata, so that they do not change when the
+     * tree gets loaded. */
+    if (!grid->baseTree().evalActiveVoxelBoundingBox(coordbbox)) {
+      INIT_MINMAX(min, max);
+      return false;
+    }
+  }
+  else {
+    /* Use the active voxel bounds OpenVDB stores in the file, which are read along with the
+     * grid metadata. */
+    openvdb::Vec3IMetadata::ConstPtr file_bbox_min = grid->getMetadata<openvdb::Vec3IMetadata>(
+        openvdb::GridBase::META_FILE_BBOX_MIN);
+    openvdb::Vec3IMetadata::ConstPtr file_bbox_max = grid->getMetadata<openvdb::Vec3IMetadata>(
+        openvdb::GridBase::META_FILE_BBOX_MAX);
+    if (!file_bbox_min || !file_bbox_max) {
+      INIT_MINMAX(min, max);
+      return false;
+    }
+
+    coordbbox = openvdb::CoordBBox(openvdb::Coord(file_bbox_min->value()),
+                                   openvdb::Coord(file_bbox_max->value()));
+    if (coordbbox.empty()) {
+      INIT_MINMAX(min, max);
+      return false;
+    }
   }
 
   openvdb::BBoxd bbox = grid->transform().indexToWorld(coordbbox);
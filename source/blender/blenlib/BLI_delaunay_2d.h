@@ -208,6 +208,7 @@ void BLI_delaunay_2d_cdt_free(CDT_result *result);
 #  include "BLI_double2.hh"
 #  include "BLI_math_mpq.hh"
 #  include "BLI_mpq2.hh"
+#  include "BLI_span.hh"
 #  include "BLI_vector.hh"
 
 namespace blender::meshintersect {
@@ -264,6 +265,18 @@ CDT_result<mpq_class> delaunay_2d_calc(const CDT_input<mpq_class> &input,
                                        CDT_output_type output_type);
 #  endif
 
+/**
+ * Calculate the CDTs of several independent inputs, possibly in parallel.
+ * The result at each index is the same as calling #delaunay_2d_calc on the input at that index.
+ */
+Array<CDT_result<double>> delaunay_2d_calc(Span<CDT_input<double>> inputs,
+                                           CDT_output_type output_type);
+
+#  ifdef WITH_GMP
+Array<CDT_result<mpq_class>> delaunay_2d_calc(Span<CDT_input<mpq_class>> inputs,
+                                              CDT_output_type output_type);
+#  endif
+
 } /* namespace blender::meshintersect */
 
 #endif /* __cplusplus */
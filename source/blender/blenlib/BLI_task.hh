@@ -71,4 +71,17 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
 #endif
 }
 
+/**
+ * Call all the given functions, possibly in parallel.
+ * Returns when all of them are finished.
+ */
+template<typename... Functions> void parallel_invoke(Functions &&... functions)
+{
+#ifdef WITH_TBB
+  tbb::parallel_invoke(std::forward<Functions>(functions)...);
+#else
+  (functions(), ...);
+#endif
+}
+
 }  // namespace blender
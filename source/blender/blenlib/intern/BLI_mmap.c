@@ -0,0 +1,129 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <fcntl.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+
+#ifdef WIN32
+#  include "BLI_winstuff.h"
+#  include <io.h>
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+struct BLI_mmap_file {
+  /* The address at which the file content is mapped. */
+  char *memory;
+  /* The length of the file (and therefore the mapped region). */
+  size_t length;
+};
+
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  void *memory;
+  const size_t length = BLI_file_descriptor_size(fd);
+
+  /* Mapping an empty file is not allowed, there is nothing to read anyway. */
+  if (ELEM(length, 0, (size_t)-1)) {
+    return NULL;
+  }
+
+#ifndef WIN32
+  memory = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+#else
+  HANDLE handle = (HANDLE)_get_osfhandle(fd);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  HANDLE mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) {
+    return NULL;
+  }
+  memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  /* The view keeps a reference to the mapping object. */
+  CloseHandle(mapping);
+  if (memory == NULL) {
+    return NULL;
+  }
+#endif
+
+  BLI_mmap_file *file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+  file->memory = memory;
+  file->length = length;
+
+  return file;
+}
+
+bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
+{
+  /* Written so that it can't overflow. */
+  if ((offset > file->length) || (length > file->length - offset)) {
+    return false;
+  }
+
+  memcpy(dest, file->memory + offset, length);
+  return true;
+}
+
+const void *BLI_mmap_get_pointer(const BLI_mmap_file *file)
+{
+  return file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+void BLI_mmap_free(BLI_mmap_file *file)
+{
+#ifndef WIN32
+  munmap(file->memory, file->length);
+#else
+  UnmapViewOfFile(file->memory);
+#endif
+
+  MEM_freeN(file);
+}
+
+void BLI_file_readahead(const char *filepath)
+{
+#ifdef POSIX_FADV_WILLNEED
+  const int fd = BLI_open(filepath, O_RDONLY, 0);
+  if (fd == -1) {
+    return;
+  }
+  /* The read-ahead started by the kernel goes on after the file is closed. */
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
+#else
+  UNUSED_VARS(filepath);
+#endif
+}
@@ -29,6 +29,7 @@
 #include "BLI_math_boolean.hh"
 #include "BLI_math_mpq.hh"
 #include "BLI_mpq2.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BLI_delaunay_2d.h"
@@ -178,6 +179,12 @@ template<typename Arith_t> struct CDTArrangement {
    * based on these counts of input elements. */
   void reserve(int num_verts, int num_edges, int num_faces);
 
+  /**
+   * Take ownership of all the verts, edges, and faces of \a other, leaving it empty.
+   * Both arrangements are assumed to share the same outer face, which is not moved.
+   */
+  void absorb(CDTArrangement<Arith_t> &other);
+
   /**
    * Add a new vertex to the arrangement, with the given 2D coordinate.
    * It will not be connected to anything yet.
@@ -594,6 +601,18 @@ template<typename T> void CDTArrangement<T>::reserve(int num_verts, int num_edge
   this->faces.reserve(2 * num_verts + 2 * num_edges + 2 * num_faces);
 }
 
+template<typename T> void CDTArrangement<T>::absorb(CDTArrangement<T> &other)
+{
+  for (CDTVert<T> *v : other.verts) {
+    v->index = this->verts.append_and_get_index(v);
+  }
+  this->edges.extend(other.edges.as_span());
+  this->faces.extend(other.faces.as_span());
+  other.verts.clear();
+  other.edges.clear();
+  other.faces.clear();
+}
+
 template<typename T>
 CDT_state<T>::CDT_state(int num_input_verts, int num_input_edges, int num_input_faces, T epsilon)
 {
@@ -972,6 +991,13 @@ inline bool dc_tri_valid(SymEdge<T> *se, SymEdge<T> *basel, SymEdge<T> *basel_sy
   return orient2d(se->next->vert->co, basel_sym->vert->co, basel->vert->co) > 0;
 }
 
+/**
+ * Sub-problems of #dc_tri with at least this many sites have their halves
+ * triangulated in parallel. Below this, the task overhead is not worth it.
+ * The split does not depend on the number of threads, so the output is deterministic.
+ */
+constexpr int dc_tri_parallel_min_sites = 10000;
+
 /**
  * Delaunay triangulate sites[start} to sites[end-1].
  * Assume sites are lexicographically sorted by coordinate.
@@ -1038,8 +1064,22 @@ void dc_tri(CDTArrangement<T> *cdt,
   SymEdge<T> *ldi;
   SymEdge<T> *rdi;
   SymEdge<T> *rdo;
-  dc_tri(cdt, sites, start, start + n2, &ldo, &ldi);
-  dc_tri(cdt, sites, start + n2, end, &rdi, &rdo);
+  if (n >= dc_tri_parallel_min_sites) {
+    /* The halves only touch their own sites, so they can be triangulated in parallel
+     * as long as each one adds its edges and faces to a separate arrangement. */
+    CDTArrangement<T> cdt_l;
+    CDTArrangement<T> cdt_r;
+    cdt_l.outer_face = cdt_r.outer_face = cdt->outer_face;
+    parallel_invoke([&]() { dc_tri(&cdt_l, sites, start, start + n2, &ldo, &ldi); },
+                    [&]() { dc_tri(&cdt_r, sites, start + n2, end, &rdi, &rdo); });
+    BLI_assert(cdt_l.outer_face == cdt->outer_face && cdt_r.outer_face == cdt->outer_face);
+    cdt->absorb(cdt_l);
+    cdt->absorb(cdt_r);
+  }
+  else {
+    dc_tri(cdt, sites, start, start + n2, &ldo, &ldi);
+    dc_tri(cdt, sites, start + n2, end, &rdi, &rdo);
+  }
   if (dbg_level > 0) {
     std::cout << "\nDC_TRI merge step for start=" << start << ", end=" << end << "\n";
     std::cout << "ldo " << ldo << "\n"
@@ -2362,6 +2402,32 @@ blender::meshintersect::CDT_result<mpq_class> delaunay_2d_calc(const CDT_input<m
 }
 #endif
 
+template<typename T>
+Array<CDT_result<T>> delaunay_calc_multi(Span<CDT_input<T>> inputs, CDT_output_type output_type)
+{
+  Array<CDT_result<T>> results(inputs.size());
+  parallel_for(inputs.index_range(), 1, [&](IndexRange range) {
+    for (const int i : range) {
+      results[i] = delaunay_calc(inputs[i], output_type);
+    }
+  });
+  return results;
+}
+
+Array<CDT_result<double>> delaunay_2d_calc(Span<CDT_input<double>> inputs,
+                                           CDT_output_type output_type)
+{
+  return delaunay_calc_multi(inputs, output_type);
+}
+
+#ifdef WITH_GMP
+Array<CDT_result<mpq_class>> delaunay_2d_calc(Span<CDT_input<mpq_class>> inputs,
+                                              CDT_output_type output_type)
+{
+  return delaunay_calc_multi(inputs, output_type);
+}
+#endif
+
 } /* namespace blender::meshintersect */
 
 /* C interface. */
@@ -173,6 +173,9 @@ void Face::populate_plane(bool need_exact)
     if (!need_exact || plane->exact_populated()) {
       return;
     }
+    /* Replace the double-only plane by one that also has the exact values. */
+    delete plane;
+    plane = nullptr;
   }
   if (need_exact) {
     mpq3 normal_exact;
@@ -1550,12 +1553,32 @@ static int filter_plane_side(const double3 &p,
   }
   double supremum = double3::dot(abs_p + abs_plane_p, abs_plane_no);
   double err_bound = supremum * index_plane_side * DBL_EPSILON;
-  if (d > err_bound) {
+  if (fabs(d) > err_bound) {
     return d > 0 ? 1 : -1;
   }
   return 0;
 }
 
+/**
+ * Fill r_side with the approximate sides (see #filter_plane_side) of the three vertices
+ * of triangle `tri` with respect to the plane of triangle `tri_plane`.
+ * Only needs the double version of the plane of `tri_plane` to be populated.
+ * Return true if the filter proved that all three vertices are strictly on the same side.
+ */
+static bool filter_tri_plane_sides(const Face &tri, const Face &tri_plane, int r_side[3])
+{
+  const double3 &d_r = tri_plane[2]->co;
+  const double3 &d_n = tri_plane.plane->norm;
+  const double3 abs_d_r = double3::abs(d_r);
+  const double3 abs_d_n = double3::abs(d_n);
+  for (int i = 0; i < 3; ++i) {
+    const double3 &d_p = tri[i]->co;
+    r_side[i] = filter_plane_side(d_p, d_r, d_n, double3::abs(d_p), abs_d_r, abs_d_n);
+  }
+  return (r_side[0] > 0 && r_side[1] > 0 && r_side[2] > 0) ||
+         (r_side[0] < 0 && r_side[1] < 0 && r_side[2] < 0);
+}
+
 /* Not using this at the moment. Leave it here for a while in case we want it again. */
 #  if 0
 /**
@@ -1874,24 +1897,8 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   /* Try first getting signs with double arithmetic, with error bounds.
    * If the signs calculated in this section are not 0, they are the same
    * as what they would be using exact arithmetic. */
-  const double3 &d_p1 = vp1->co;
-  const double3 &d_q1 = vq1->co;
-  const double3 &d_r1 = vr1->co;
-  const double3 &d_p2 = vp2->co;
-  const double3 &d_q2 = vq2->co;
-  const double3 &d_r2 = vr2->co;
-  const double3 &d_n2 = tri2.plane->norm;
-
-  const double3 &abs_d_p1 = double3::abs(d_p1);
-  const double3 &abs_d_q1 = double3::abs(d_q1);
-  const double3 &abs_d_r1 = double3::abs(d_r1);
-  const double3 &abs_d_r2 = double3::abs(d_r2);
-  const double3 &abs_d_n2 = double3::abs(d_n2);
-
-  int sp1 = filter_plane_side(d_p1, d_r2, d_n2, abs_d_p1, abs_d_r2, abs_d_n2);
-  int sq1 = filter_plane_side(d_q1, d_r2, d_n2, abs_d_q1, abs_d_r2, abs_d_n2);
-  int sr1 = filter_plane_side(d_r1, d_r2, d_n2, abs_d_r1, abs_d_r2, abs_d_n2);
-  if ((sp1 > 0 && sq1 > 0 && sr1 > 0) || (sp1 < 0 && sq1 < 0 && sr1 < 0)) {
+  int side1[3];
+  if (filter_tri_plane_sides(tri1, tri2, side1)) {
 #  ifdef PERFDEBUG
     incperfcount(2); /* Tri tri intersects decided by filter plane tests. */
 #  endif
@@ -1900,16 +1907,12 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
     }
     return ITT_value(INONE);
   }
+  int sp1 = side1[0];
+  int sq1 = side1[1];
+  int sr1 = side1[2];
 
-  const double3 &d_n1 = tri1.plane->norm;
-  const double3 &abs_d_p2 = double3::abs(d_p2);
-  const double3 &abs_d_q2 = double3::abs(d_q2);
-  const double3 &abs_d_n1 = double3::abs(d_n1);
-
-  int sp2 = filter_plane_side(d_p2, d_r1, d_n1, abs_d_p2, abs_d_r1, abs_d_n1);
-  int sq2 = filter_plane_side(d_q2, d_r1, d_n1, abs_d_q2, abs_d_r1, abs_d_n1);
-  int sr2 = filter_plane_side(d_r2, d_r1, d_n1, abs_d_r2, abs_d_r1, abs_d_n1);
-  if ((sp2 > 0 && sq2 > 0 && sr2 > 0) || (sp2 < 0 && sq2 < 0 && sr2 < 0)) {
+  int side2[3];
+  if (filter_tri_plane_sides(tri2, tri1, side2)) {
 #  ifdef PERFDEBUG
     incperfcount(2); /* Tri tri intersects decided by filter plane tests. */
 #  endif
@@ -1918,6 +1921,9 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
     }
     return ITT_value(INONE);
   }
+  int sp2 = side2[0];
+  int sq2 = side2[1];
+  int sr2 = side2[2];
 
   const mpq3 &p1 = vp1->co_exact;
   const mpq3 &q1 = vq1->co_exact;
@@ -2559,6 +2565,59 @@ static std::pair<int, int> canon_int_pair(int a, int b)
   return std::pair<int, int>(a, b);
 }
 
+/**
+ * Data needed for parallelization of #populate_planes.
+ */
+struct PopulatePlanesData {
+  const IMesh &tm;
+  Span<int> tris;
+  bool need_exact;
+};
+
+static void populate_planes_range_func(void *__restrict userdata,
+                                       const int iter,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PopulatePlanesData *data = static_cast<PopulatePlanesData *>(userdata);
+  data->tm.face(data->tris[iter])->populate_plane(data->need_exact);
+}
+
+/**
+ * Populate the planes of the triangles with indices in `tris`, in parallel.
+ * Each triangle must appear only once in `tris`.
+ */
+static void populate_planes(const IMesh &tm, Span<int> tris, bool need_exact)
+{
+  PopulatePlanesData data = {tm, tris, need_exact};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1000;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(0, tris.size(), &data, populate_planes_range_func, &settings);
+}
+
+/**
+ * Data needed for the filter pass of #calc_overlap_itts.
+ */
+struct FilterIttsData {
+  Span<std::pair<int, int>> intersect_pairs;
+  const IMesh &tm;
+  MutableSpan<bool> r_filtered;
+};
+
+static void filter_overlap_itts_range_func(void *__restrict userdata,
+                                           const int iter,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  FilterIttsData *data = static_cast<FilterIttsData *>(userdata);
+  std::pair<int, int> tri_pair = data->intersect_pairs[iter];
+  const Face &tri1 = *data->tm.face(tri_pair.first);
+  const Face &tri2 = *data->tm.face(tri_pair.second);
+  int side[3];
+  data->r_filtered[iter] = filter_tri_plane_sides(tri1, tri2, side) ||
+                           filter_tri_plane_sides(tri2, tri1, side);
+}
+
 static void calc_overlap_itts_range_func(void *__restrict userdata,
                                          const int iter,
                                          const TaskParallelTLS *__restrict UNUSED(tls))
@@ -2582,6 +2641,13 @@ static void calc_overlap_itts_range_func(void *__restrict userdata,
 /**
  * Fill in itt_map with the vector of ITT_values that result from intersecting the triangles in ov.
  * Use a canonical order for triangles: (a,b) where  a < b.
+ *
+ * This is done in stages, so that the expensive exact planes only get calculated for
+ * the triangles that need them. First the double planes are populated for every overlapping
+ * triangle and the floating-point filter decides as many pairs as it can. Then the exact
+ * planes are populated for triangles involved in the remaining pairs, and only those pairs
+ * are intersected exactly. All the stages are done in parallel.
+ * On return, every triangle that has a non-#INONE intersection has an exact plane.
  */
 static void calc_overlap_itts(Map<std::pair<int, int>, ITT_value> &itt_map,
                               const IMesh &tm,
@@ -2592,18 +2658,57 @@ static void calc_overlap_itts(Map<std::pair<int, int>, ITT_value> &itt_map,
   /* Put dummy values in `itt_map` initially,
    * so map entries will exist when doing the range function.
    * This means we won't have to protect the `itt_map.add_overwrite` function with a lock. */
+  Vector<int> overlap_tris;
   for (const BVHTreeOverlap &olap : ov.overlap()) {
     std::pair<int, int> key = canon_int_pair(olap.indexA, olap.indexB);
     if (!itt_map.contains(key)) {
       itt_map.add_new(key, ITT_value());
       data.intersect_pairs.append(key);
     }
+    /* Overlaps are sorted by indexA, so this catches each overlapping triangle once. */
+    if (overlap_tris.is_empty() || overlap_tris.last() != olap.indexA) {
+      overlap_tris.append(olap.indexA);
+    }
   }
-  int tot_intersect_pairs = data.intersect_pairs.size();
+  populate_planes(tm, overlap_tris, false);
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.min_iter_per_thread = 1000;
   settings.use_threading = intersect_use_threading;
+
+  Array<bool> filtered(data.intersect_pairs.size());
+  FilterIttsData filter_data = {data.intersect_pairs, tm, filtered};
+  BLI_task_parallel_range(
+      0, data.intersect_pairs.size(), &filter_data, filter_overlap_itts_range_func, &settings);
+
+  /* The filtered pairs keep their #INONE dummy value. Compact the rest, and gather the
+   * triangles that they involve, which are the ones that need exact planes. */
+  Array<bool> need_exact(tm.face_size(), false);
+  int tot_intersect_pairs = 0;
+  for (int i : data.intersect_pairs.index_range()) {
+    if (!filtered[i]) {
+      std::pair<int, int> key = data.intersect_pairs[i];
+      need_exact[key.first] = true;
+      need_exact[key.second] = true;
+      data.intersect_pairs[tot_intersect_pairs++] = key;
+    }
+  }
+  data.intersect_pairs.resize(tot_intersect_pairs);
+#  ifdef PERFDEBUG
+  bumpperfcount(5, filtered.size() - tot_intersect_pairs); /* Pairs decided by filter pass. */
+#  endif
+  Vector<int> exact_tris;
+  for (int t : overlap_tris) {
+    if (need_exact[t]) {
+      exact_tris.append(t);
+    }
+  }
+#  ifdef PERFDEBUG
+  bumpperfcount(6, exact_tris.size()); /* Exact planes populated. */
+#  endif
+  populate_planes(tm, exact_tris, true);
+
   BLI_task_parallel_range(0, tot_intersect_pairs, &data, calc_overlap_itts_range_func, &settings);
 }
 
@@ -2656,7 +2761,8 @@ static void calc_subdivided_tri_range_func(void *__restrict userdata,
               << " len=" << otr.len << "\n";
   }
   constexpr int inline_capacity = 100;
-  Vector<ITT_value, inline_capacity> itts(otr.len);
+  Vector<ITT_value, inline_capacity> itts;
+  itts.reserve(otr.len);
   for (int j = otr.overlap_start; j < otr.overlap_start + otr.len; ++j) {
     int t_other = data->overlap[j].indexB;
     std::pair<int, int> key = canon_int_pair(t, t_other);
@@ -2787,6 +2893,47 @@ static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
   return cd_data;
 }
 
+/**
+ * Data needed for parallelization of #calc_clusters_subdivided.
+ */
+struct ClusterSubdivideData {
+  MutableSpan<CDT_data> r_cluster_subdivided;
+  const CoplanarClusterInfo &clinfo;
+  const IMesh &tm;
+  const TriOverlaps &ov;
+  const Map<std::pair<int, int>, ITT_value> &itt_map;
+  IMeshArena *arena;
+};
+
+static void calc_cluster_subdivided_range_func(void *__restrict userdata,
+                                               const int iter,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ClusterSubdivideData *data = static_cast<ClusterSubdivideData *>(userdata);
+  data->r_cluster_subdivided[iter] = calc_cluster_subdivided(
+      data->clinfo, iter, data->tm, data->ov, data->itt_map, data->arena);
+}
+
+/**
+ * Fill in r_cluster_subdivided with the subdivided CDT of each cluster in clinfo.
+ * The clusters are independent of each other, so their CDTs are calculated in parallel.
+ */
+static void calc_clusters_subdivided(MutableSpan<CDT_data> r_cluster_subdivided,
+                                     const CoplanarClusterInfo &clinfo,
+                                     const IMesh &tm,
+                                     const TriOverlaps &ov,
+                                     const Map<std::pair<int, int>, ITT_value> &itt_map,
+                                     IMeshArena *arena)
+{
+  ClusterSubdivideData data = {r_cluster_subdivided, clinfo, tm, ov, itt_map, arena};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(
+      0, clinfo.tot_cluster(), &data, calc_cluster_subdivided_range_func, &settings);
+}
+
 static IMesh union_tri_subdivides(const blender::Array<IMesh> &tri_subdivided)
 {
   int tot_tri = 0;
@@ -3076,24 +3223,16 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
 #  ifdef PERFDEBUG
   double overlap_time = PIL_check_seconds_timer();
   std::cout << "intersect overlaps calculated, time = " << overlap_time - bb_calc_time << "\n";
-#  endif
-  for (int t : tm_clean->face_index_range()) {
-    if (tri_ov.first_overlap_index(t) != -1) {
-      tm_clean->face(t)->populate_plane(true);
-    }
-  }
-#  ifdef PERFDEBUG
-  double plane_populate = PIL_check_seconds_timer();
-  std::cout << "planes populated, time = " << plane_populate - overlap_time << "\n";
 #  endif
   /* itt_map((a,b)) will hold the intersection value resulting from intersecting
-   * triangles with indices a and b, where a < b. */
+   * triangles with indices a and b, where a < b.
+   * This also populates the planes of the overlapping triangles. */
   Map<std::pair<int, int>, ITT_value> itt_map;
   itt_map.reserve(tri_ov.overlap().size());
   calc_overlap_itts(itt_map, *tm_clean, tri_ov, arena);
 #  ifdef PERFDEBUG
   double itt_time = PIL_check_seconds_timer();
-  std::cout << "itts found, time = " << itt_time - plane_populate << "\n";
+  std::cout << "itts found, time = " << itt_time - overlap_time << "\n";
 #  endif
   CoplanarClusterInfo clinfo = find_clusters(*tm_clean, tri_bb, itt_map);
   if (dbg_level > 1) {
@@ -3113,9 +3252,7 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   std::cout << "subdivided tris found, time = " << subdivided_tris_time - itt_time << "\n";
 #  endif
   Array<CDT_data> cluster_subdivided(clinfo.tot_cluster());
-  for (int c : clinfo.index_range()) {
-    cluster_subdivided[c] = calc_cluster_subdivided(clinfo, c, *tm_clean, tri_ov, itt_map, arena);
-  }
+  calc_clusters_subdivided(cluster_subdivided, clinfo, *tm_clean, tri_ov, itt_map, arena);
 #  ifdef PERFDEBUG
   double cluster_subdivide_time = PIL_check_seconds_timer();
   std::cout << "subdivided clusters found, time = "
@@ -3276,6 +3413,14 @@ static void perfdata_init(void)
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("tri tri intersects decided by filter pass");
+
+  /* count 6. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("exact planes populated");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
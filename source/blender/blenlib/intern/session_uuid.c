@@ -74,5 +74,6 @@ bool BLI_session_uuid_ghash_compare(const void *lhs_v, const void *rhs_v)
 {
   const SessionUUID *lhs = (const SessionUUID *)lhs_v;
   const SessionUUID *rhs = (const SessionUUID *)rhs_v;
-  return BLI_session_uuid_is_equal(lhs, rhs);
+  /* GHash compare callbacks return false for equal keys. */
+  return !BLI_session_uuid_is_equal(lhs, rhs);
 }
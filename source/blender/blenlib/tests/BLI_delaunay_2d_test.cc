@@ -1245,6 +1245,57 @@ template<typename T> void repeattri_test()
   }
 }
 
+template<typename T> void multi_test()
+{
+  const char *spec0 = R"(4 0 0
+  0.0 0.0
+  1.0 0.0
+  0.0 1.0
+  1.0 1.0
+  )";
+  const char *spec1 = R"(6 0 2
+  0.0 0.0
+  1.0 0.0
+  0.5 1.0
+  0.3 0.2
+  0.7 0.2
+  0.5 0.5
+  0 1 2
+  3 4 5
+  )";
+
+  Array<CDT_input<T>> in = {fill_input_from_string<T>(spec0), fill_input_from_string<T>(spec1)};
+  Array<CDT_result<T>> out = delaunay_2d_calc(in.as_span(), CDT_INSIDE);
+  EXPECT_EQ(out.size(), 2);
+  for (int i : in.index_range()) {
+    CDT_result<T> out_single = delaunay_2d_calc(in[i], CDT_INSIDE);
+    EXPECT_EQ(out[i].vert.size(), out_single.vert.size());
+    EXPECT_EQ(out[i].edge.size(), out_single.edge.size());
+    EXPECT_EQ(out[i].face.size(), out_single.face.size());
+  }
+}
+
+/* A grid big enough that the initial triangulation uses the parallel divide and conquer. */
+template<typename T> void largegrid_test()
+{
+  constexpr int n = 120;
+  CDT_input<T> in;
+  in.vert = Array<vec2<T>>(n * n);
+  for (int iy = 0; iy < n; ++iy) {
+    for (int ix = 0; ix < n; ++ix) {
+      in.vert[iy * n + ix] = vec2<T>(T(ix), T(iy));
+    }
+  }
+  in.epsilon = T(0);
+  CDT_result<T> out = delaunay_2d_calc(in, CDT_FULL);
+  EXPECT_EQ(out.vert.size(), n * n);
+  EXPECT_EQ(out.edge.size(), 3 * (n - 1) * (n - 1) + 2 * (n - 1));
+  EXPECT_EQ(out.face.size(), 2 * (n - 1) * (n - 1));
+  for (const Vector<int> &face : out.face) {
+    EXPECT_EQ(face.size(), 3);
+  }
+}
+
 TEST(delaunay_d, Empty)
 {
   empty_test<double>();
@@ -1370,6 +1421,16 @@ TEST(delaunay_d, RepeatTri)
   repeattri_test<double>();
 }
 
+TEST(delaunay_d, Multi)
+{
+  multi_test<double>();
+}
+
+TEST(delaunay_d, LargeGrid)
+{
+  largegrid_test<double>();
+}
+
 #  ifdef WITH_GMP
 TEST(delaunay_m, Empty)
 {
@@ -1494,6 +1555,16 @@ TEST(delaunay_m, RepeatTri)
 {
   repeattri_test<mpq_class>();
 }
+
+TEST(delaunay_m, Multi)
+{
+  multi_test<mpq_class>();
+}
+
+TEST(delaunay_m, LargeGrid)
+{
+  largegrid_test<mpq_class>();
+}
 #  endif
 
 #endif
@@ -1095,6 +1095,16 @@ TEST(mesh_intersect_perf, SphereGrid)
   spheregrid_test(512, 4, 0.1, false);
 }
 
+TEST(mesh_intersect_perf, SphereSphereSelf)
+{
+  spheresphere_test(256, 0.5, true);
+}
+
+TEST(mesh_intersect_perf, SphereGridSelf)
+{
+  spheregrid_test(256, 4, 0.1, true);
+}
+
 #  endif
 
 }  // namespace blender::meshintersect::tests
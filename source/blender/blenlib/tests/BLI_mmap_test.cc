@@ -0,0 +1,45 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstdio>
+
+#include "BLI_mmap.h"
+
+TEST(mmap, Read)
+{
+  const char data[] = "0123456789";
+  FILE *fp = tmpfile();
+  ASSERT_NE(fp, nullptr);
+  fwrite(data, 1, sizeof(data), fp);
+  fflush(fp);
+
+  BLI_mmap_file *file = BLI_mmap_open(fileno(fp));
+  /* The mapping stays valid once the file is closed. */
+  fclose(fp);
+  ASSERT_NE(file, nullptr);
+
+  EXPECT_EQ(BLI_mmap_get_length(file), sizeof(data));
+  EXPECT_STREQ((const char *)BLI_mmap_get_pointer(file), data);
+
+  char buf[4] = {0};
+  EXPECT_TRUE(BLI_mmap_read(file, buf, 3, 3));
+  EXPECT_STREQ(buf, "345");
+  EXPECT_TRUE(BLI_mmap_read(file, buf, sizeof(data) - 1, 1));
+  EXPECT_EQ(buf[0], '\0');
+
+  /* Out of bounds. */
+  EXPECT_FALSE(BLI_mmap_read(file, buf, sizeof(data) - 1, 2));
+  EXPECT_FALSE(BLI_mmap_read(file, buf, sizeof(data) + 1, 0));
+  EXPECT_FALSE(BLI_mmap_read(file, buf, 1, (size_t)-1));
+
+  BLI_mmap_free(file);
+}
+
+TEST(mmap, EmptyFile)
+{
+  FILE *fp = tmpfile();
+  ASSERT_NE(fp, nullptr);
+  EXPECT_EQ(BLI_mmap_open(fileno(fp)), nullptr);
+  fclose(fp);
+}
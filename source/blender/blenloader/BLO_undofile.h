@@ -24,15 +24,26 @@
  * \ingroup blenloader
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
+struct MemFileSharedBuffer;
 struct Scene;
 
 typedef struct {
   void *next, *prev;
+  /** Content of the chunk, NULL while its buffer is compressed. */
   const char *buf;
+  /**
+   * Reference counted storage of #buf, shared by all chunks with the same content in any
+   * #MemFile (see #BLO_memfile_chunk_add).
+   */
+  struct MemFileSharedBuffer *buffer;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching chunk of the previous #MemFile. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -45,7 +56,12 @@ typedef struct {
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the buffers which were not shared with any other memfile when writing. */
   size_t size;
+  /** Size of all chunks, i.e. of the file this memfile represents. */
+  size_t size_total;
+  /** Number of ID's which chunks were taken from the reference memfile without writing them. */
+  int id_reused_num;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -57,6 +73,12 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+
+  /**
+   * Allow re-using the reference chunks of ID's which were not tagged as changed since the
+   * reference memfile was written, instead of writing them again.
+   */
+  bool use_id_reuse;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -73,14 +95,22 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
+bool BLO_memfile_write_id_reuse(MemFileWriteData *mem_data);
 
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_compress_start(MemFile *memfile);
+extern void BLO_memfile_compress_wait(void);
+extern void BLO_memfile_ensure_uncompressed(MemFile *memfile);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
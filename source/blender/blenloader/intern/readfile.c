@@ -140,6 +140,7 @@
 #include "BKE_lib_query.h"
 #include "BKE_main.h" /* for Main */
 #include "BKE_main_idmap.h"
+#include "BKE_main_namemap.h"
 #include "BKE_material.h"
 #include "BKE_mesh.h" /* for ME_ defines (patching) */
 #include "BKE_mesh_runtime.h"
@@ -529,6 +530,8 @@ static void add_main_to_main(Main *mainvar, Main *from)
   while (a--) {
     BLI_movelisttolist(lbarray[a], fromarray[a]);
   }
+  BKE_main_namemap_clear(mainvar);
+  BKE_main_namemap_clear(from);
 }
 
 void blo_join_main(ListBase *mainlist)
@@ -1562,6 +1565,9 @@ FileData *blo_filedata_from_memfile(MemFile *memfile,
     return NULL;
   }
 
+  /* Chunks of older undo steps may be compressed. */
+  BLO_memfile_ensure_uncompressed(memfile);
+
   FileData *fd = filedata_new();
   fd->memfile = memfile;
   fd->undo_direction = params->undo_direction;
@@ -3154,7 +3160,7 @@ static void direct_link_particlesystems(BlendDataReader *reader, ListBase *parti
     }
 
     psys->tree = NULL;
-    psys->bvhtree = NULL;
+    psys->sph_grid = NULL;
 
     psys->orig_psys = NULL;
     psys->batch_cache = NULL;
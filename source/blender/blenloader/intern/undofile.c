@@ -42,6 +42,8 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -49,65 +51,344 @@
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
 
+#include "zlib.h"
+
 /* keep last */
 #include "BLI_strict_flags.h"
 
-/* **************** support for memory-write, for undo buffers *************** */
+/* -------------------------------------------------------------------- */
+/** \name Shared Chunk Buffers
+ *
+ * The content of chunks is stored once for all memfiles: buffers are reference counted and
+ * registered by content in #memfile_buffer_store, so a chunk identical to any existing one shares
+ * its memory, not only a chunk identical to the one at the same position in the previous step.
+ * \{ */
+
+typedef struct MemFileSharedBuffer {
+  /** NULL while compressed. */
+  char *data;
+  size_t size;
+  uint hash;
+  /** Number of chunks using this buffer. */
+  uint users;
+  /** The memfile which size accounts for this buffer, if any. */
+  MemFile *owner;
+  /** zlib compressed #data, only for buffers with a single user (see #BLO_memfile_compress_start). */
+  void *data_compressed;
+  size_t size_compressed;
+} MemFileSharedBuffer;
+
+/** All uncompressed buffers, NULL when there are none. */
+static GSet *memfile_buffer_store = NULL;
+
+static uint memfile_buffer_hash(const void *key)
+{
+  return ((const MemFileSharedBuffer *)key)->hash;
+}
+
+static bool memfile_buffer_cmp(const void *a, const void *b)
+{
+  const MemFileSharedBuffer *buffer_a = a;
+  const MemFileSharedBuffer *buffer_b = b;
+  return (buffer_a->hash != buffer_b->hash) || (buffer_a->size != buffer_b->size) ||
+         (memcmp(buffer_a->data, buffer_b->data, buffer_a->size) != 0);
+}
+
+static void memfile_buffer_store_add(MemFileSharedBuffer **buffer_p)
+{
+  if (memfile_buffer_store == NULL) {
+    memfile_buffer_store = BLI_gset_new(memfile_buffer_hash, memfile_buffer_cmp, __func__);
+  }
+
+  void **key_p;
+  if (BLI_gset_ensure_p_ex(memfile_buffer_store, *buffer_p, &key_p)) {
+    /* Identical content is stored already, share that buffer instead. */
+    MemFileSharedBuffer *buffer = *key_p;
+    BLI_assert(buffer != *buffer_p);
+    buffer->users++;
+    *buffer_p = buffer;
+  }
+  else {
+    *key_p = *buffer_p;
+  }
+}
+
+static void memfile_buffer_store_remove(MemFileSharedBuffer *buffer)
+{
+  BLI_gset_remove(memfile_buffer_store, buffer, NULL);
+  if (BLI_gset_len(memfile_buffer_store) == 0) {
+    BLI_gset_free(memfile_buffer_store, NULL);
+    memfile_buffer_store = NULL;
+  }
+}
+
+/**
+ * Find or create a buffer with the given content, adding a user to it.
+ */
+static MemFileSharedBuffer *memfile_buffer_ensure(const char *buf, size_t size, bool *r_is_new)
+{
+  MemFileSharedBuffer key = {
+      .data = (char *)buf,
+      .size = size,
+      .hash = BLI_hash_mm2((const uchar *)buf, size, 0),
+  };
+
+  if (memfile_buffer_store != NULL) {
+    MemFileSharedBuffer *buffer = BLI_gset_lookup(memfile_buffer_store, &key);
+    if (buffer != NULL) {
+      buffer->users++;
+      *r_is_new = false;
+      return buffer;
+    }
+  }
+
+  MemFileSharedBuffer *buffer = MEM_mallocN(sizeof(*buffer), __func__);
+  *buffer = key;
+  buffer->data = MEM_mallocN(size, "Chunk buffer");
+  memcpy(buffer->data, buf, size);
+  buffer->users = 1;
+  memfile_buffer_store_add(&buffer);
+  BLI_assert(buffer->users == 1);
+
+  *r_is_new = true;
+  return buffer;
+}
+
+/** Memory used by the buffer content, which is less while compressed. */
+static size_t memfile_buffer_mem_size(const MemFileSharedBuffer *buffer)
+{
+  return (buffer->data != NULL) ? buffer->size : buffer->size_compressed;
+}
+
+static void memfile_buffer_release(MemFileSharedBuffer *buffer)
+{
+  BLI_assert(buffer->users > 0);
+  if (--buffer->users != 0) {
+    return;
+  }
+
+  if (buffer->data != NULL) {
+    memfile_buffer_store_remove(buffer);
+    MEM_freeN(buffer->data);
+  }
+  MEM_SAFE_FREE(buffer->data_compressed);
+  MEM_freeN(buffer);
+}
+
+static MemFileChunk *memfile_chunk_add_ex(MemFileWriteData *mem_data,
+                                          MemFileSharedBuffer *buffer,
+                                          bool is_identical)
+{
+  MemFile *memfile = mem_data->written_memfile;
+
+  MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
+  curchunk->buf = buffer->data;
+  curchunk->buffer = buffer;
+  curchunk->size = buffer->size;
+  curchunk->is_identical = is_identical;
+  /* This is unsafe in the sense that an app handler or other code that does not
+   * perform an undo push may make changes after the last undo push that
+   * will then not be undo. Though it's not entirely clear that is wrong behavior. */
+  curchunk->is_identical_future = true;
+  curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  BLI_addtail(&memfile->chunks, curchunk);
+
+  memfile->size_total += buffer->size;
+
+  return curchunk;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Background Compression
+ *
+ * Buffers only used by old undo steps are rarely read again, they are compressed by a background
+ * task between undo pushes. Every function accessing memfile content stops that task first.
+ * \{ */
+
+static TaskPool *memfile_compress_pool = NULL;
+
+/* Only compress when it saves at least this fraction of the memory. */
+#define MEMFILE_COMPRESS_MIN_RATIO 0.9
+
+static void memfile_compress_task(TaskPool *__restrict pool, void *taskdata)
+{
+  MemFile *memfile = taskdata;
+
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (BLI_task_pool_canceled(pool)) {
+      break;
+    }
+
+    MemFileSharedBuffer *buffer = chunk->buffer;
+    if (buffer->users != 1 || buffer->data == NULL) {
+      continue;
+    }
+
+    uLongf size_compressed = compressBound((uLong)buffer->size);
+    Bytef *data_compressed = MEM_mallocN(size_compressed, "Chunk buffer compressed");
+    if (compress2(data_compressed,
+                  &size_compressed,
+                  (const Bytef *)buffer->data,
+                  (uLong)buffer->size,
+                  Z_BEST_SPEED) != Z_OK ||
+        size_compressed > (uLongf)((double)buffer->size * MEMFILE_COMPRESS_MIN_RATIO)) {
+      MEM_freeN(data_compressed);
+      continue;
+    }
+
+    /* Safe without locking, the main thread does not access memfiles while this runs. */
+    memfile_buffer_store_remove(buffer);
+    MEM_freeN(buffer->data);
+    buffer->data = NULL;
+    buffer->data_compressed = MEM_reallocN(data_compressed, size_compressed);
+    buffer->size_compressed = size_compressed;
+    chunk->buf = NULL;
+    if (buffer->owner != NULL) {
+      buffer->owner->size -= buffer->size - buffer->size_compressed;
+    }
+  }
+}
+
+/**
+ * Cancel background compression, must be called before accessing any memfile.
+ */
+static void memfile_compress_stop(void)
+{
+  if (memfile_compress_pool != NULL) {
+    BLI_task_pool_cancel(memfile_compress_pool);
+    BLI_task_pool_free(memfile_compress_pool);
+    memfile_compress_pool = NULL;
+  }
+}
+
+/**
+ * Start compressing the buffers only used by \a memfile in the background.
+ */
+void BLO_memfile_compress_start(MemFile *memfile)
+{
+  if (memfile_compress_pool == NULL) {
+    memfile_compress_pool = BLI_task_pool_create_background(NULL, TASK_PRIORITY_LOW);
+  }
+  BLI_task_pool_push(memfile_compress_pool, memfile_compress_task, memfile, false, NULL);
+}
+
+/**
+ * Wait until all memfiles passed to #BLO_memfile_compress_start are compressed.
+ */
+void BLO_memfile_compress_wait(void)
+{
+  if (memfile_compress_pool != NULL) {
+    BLI_task_pool_work_and_wait(memfile_compress_pool);
+    BLI_task_pool_free(memfile_compress_pool);
+    memfile_compress_pool = NULL;
+  }
+}
+
+/**
+ * Stop background compression and uncompress all chunks of \a memfile, so their content can be
+ * accessed with #MemFileChunk.buf.
+ */
+void BLO_memfile_ensure_uncompressed(MemFile *memfile)
+{
+  memfile_compress_stop();
+
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->buf != NULL) {
+      continue;
+    }
+
+    MemFileSharedBuffer *buffer = chunk->buffer;
+    BLI_assert(buffer->users == 1 && buffer->data_compressed != NULL);
+    buffer->data = MEM_mallocN(buffer->size, "Chunk buffer");
+    uLongf size = (uLongf)buffer->size;
+    const int error = uncompress((Bytef *)buffer->data,
+                                 &size,
+                                 (const Bytef *)buffer->data_compressed,
+                                 (uLong)buffer->size_compressed);
+    BLI_assert(error == Z_OK && size == buffer->size);
+    UNUSED_VARS_NDEBUG(error);
+    if (buffer->owner != NULL) {
+      buffer->owner->size += buffer->size - buffer->size_compressed;
+    }
+    MEM_SAFE_FREE(buffer->data_compressed);
+    buffer->size_compressed = 0;
+
+    /* Meanwhile another chunk with the same content may have been added. */
+    memfile_buffer_store_add(&chunk->buffer);
+    if (chunk->buffer != buffer) {
+      if (buffer->owner != NULL) {
+        buffer->owner->size -= buffer->size;
+      }
+      memfile_buffer_release(buffer);
+    }
+    chunk->buf = chunk->buffer->data;
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory Write, for Undo Buffers
+ * \{ */
 
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
+  memfile_compress_stop();
+
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
+    if (chunk->buffer->owner == memfile) {
+      chunk->buffer->owner = NULL;
     }
+    memfile_buffer_release(chunk->buffer);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
+  memfile->size_total = 0;
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
+  memfile_compress_stop();
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* Buffers are reference counted, this only has to hand over the changes made in the first
+   * memfile to the second one: a chunk of the second memfile identical to one changed in the
+   * first memfile is a change compared to the memfile before the first one. */
+  GSet *first_changed_buffers = BLI_gset_ptr_new(__func__);
+  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
+    if (!fc->is_identical) {
+      BLI_gset_add(first_changed_buffers, fc->buffer);
+    }
+  }
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (sc->is_identical && BLI_gset_haskey(first_changed_buffers, sc->buffer)) {
+      sc->is_identical = false;
     }
   }
+  BLI_gset_free(first_changed_buffers, NULL);
 
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+  /* Memory accounted to the first memfile and still used by the second one moves along. */
+  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
+    if (sc->buffer->owner == first) {
+      sc->buffer->owner = second;
+      second->size += memfile_buffer_mem_size(sc->buffer);
     }
   }
 
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
-
   BLO_memfile_free(first);
 }
 
 /* Clear is_identical_future before adding next memfile. */
 void BLO_memfile_clear_future(MemFile *memfile)
 {
+  memfile_compress_stop();
+
   LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
     chunk->is_identical_future = false;
   }
@@ -120,6 +401,9 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
+  mem_data->use_id_reuse = false;
+
+  memfile_compress_stop();
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
@@ -127,6 +411,8 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
    * current Main data-base broke the order matching with the memchunks from previous step.
    */
   if (reference_memfile != NULL) {
+    BLO_memfile_ensure_uncompressed(reference_memfile);
+
     mem_data->id_session_uuid_mapping = BLI_ghash_new(
         BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
     uint current_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
@@ -159,39 +445,61 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   MemFile *memfile = mem_data->written_memfile;
   MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
 
-  MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
-  curchunk->size = size;
-  curchunk->buf = NULL;
-  curchunk->is_identical = false;
-  /* This is unsafe in the sense that an app handler or other code that does not
-   * perform an undo push may make changes after the last undo push that
-   * will then not be undo. Though it's not entirely clear that is wrong behavior. */
-  curchunk->is_identical_future = true;
-  curchunk->id_session_uuid = mem_data->current_id_session_uuid;
-  BLI_addtail(&memfile->chunks, curchunk);
-
   /* we compare compchunk with buf */
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
-    if (compchunk->size == curchunk->size) {
+    *compchunk_step = compchunk->next;
+    if (compchunk->size == size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
-        curchunk->is_identical = true;
+        compchunk->buffer->users++;
+        memfile_chunk_add_ex(mem_data, compchunk->buffer, true);
         compchunk->is_identical_future = true;
+        return;
       }
     }
-    *compchunk_step = compchunk->next;
   }
 
   /* not equal... */
-  if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
+  bool is_new;
+  MemFileSharedBuffer *buffer = memfile_buffer_ensure(buf, size, &is_new);
+  if (is_new) {
+    buffer->owner = memfile;
     memfile->size += size;
   }
+  memfile_chunk_add_ex(mem_data, buffer, false);
 }
 
+/**
+ * Add the chunks of the current ID from the reference memfile to the written one without
+ * comparing their content, used for ID's known to be unchanged since the reference was written.
+ * Must be called right after the ID's session UUID was set, see #MemFileWriteData.use_id_reuse.
+ *
+ * \return false when the reference memfile has no chunks for the ID, it needs to be written.
+ */
+bool BLO_memfile_write_id_reuse(MemFileWriteData *mem_data)
+{
+  const uint session_uuid = mem_data->current_id_session_uuid;
+  MemFileChunk *compchunk = mem_data->reference_current_chunk;
+
+  if (!mem_data->use_id_reuse || session_uuid == MAIN_ID_SESSION_UUID_UNSET ||
+      compchunk == NULL || compchunk->id_session_uuid != session_uuid) {
+    return false;
+  }
+
+  for (; compchunk != NULL && compchunk->id_session_uuid == session_uuid;
+       compchunk = compchunk->next) {
+    compchunk->buffer->users++;
+    memfile_chunk_add_ex(mem_data, compchunk->buffer, true);
+    compchunk->is_identical_future = true;
+  }
+  mem_data->reference_current_chunk = compchunk;
+  mem_data->written_memfile->id_reused_num++;
+
+  return true;
+}
+
+/** \} */
+
 struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                   struct Main *bmain,
                                   struct Scene **r_scene)
@@ -251,6 +559,8 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     return false;
   }
 
+  BLO_memfile_ensure_uncompressed(memfile);
+
   for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
 #ifdef _WIN32
     if ((size_t)write(file, chunk->buf, (uint)chunk->size) != chunk->size)
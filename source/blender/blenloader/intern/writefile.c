@@ -529,6 +529,69 @@ static void mywrite_id_end(WriteData *wd, ID *UNUSED(id))
   }
 }
 
+/**
+ * Whether the ID or its embedded data were tagged as changed since the last undo push.
+ * Must be called before #ID.recalc_after_undo_push is cleared for the written undo step.
+ */
+static bool write_id_is_tagged_for_undo(ID *id)
+{
+  if (id->recalc_after_undo_push != 0) {
+    return true;
+  }
+  bNodeTree *nodetree = ntreeFromID(id);
+  if (nodetree != NULL && nodetree->id.recalc_after_undo_push != 0) {
+    return true;
+  }
+  if (GS(id->name) == ID_SCE) {
+    Scene *scene = (Scene *)id;
+    if (scene->master_collection != NULL &&
+        scene->master_collection->id.recalc_after_undo_push != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Store an untagged ID by re-using its chunks from the reference undo step instead of writing
+ * it again, see #MemFileWriteData.use_id_reuse. Must be called right after #mywrite_id_begin.
+ *
+ * \return true when the ID was stored.
+ */
+static bool mywrite_id_reuse(WriteData *wd, ID *id)
+{
+  if (!wd->use_memfile || !wd->mem.use_id_reuse) {
+    return false;
+  }
+
+  /* UI data and scenes are changed without being tagged, e.g. the current frame. */
+  if (ELEM(GS(id->name), ID_WM, ID_WS, ID_SCR, ID_SCE)) {
+    return false;
+  }
+  /* Edited by the text editor and paint tools without tagging, since they are not evaluated. */
+  if (GS(id->name) == ID_TXT || !ID_TYPE_IS_COW(GS(id->name))) {
+    return false;
+  }
+
+  /* The ID struct is written first. Check it was written from the same address, and that the
+   * generic ID data did not change, which is not always tagged (e.g. users or renaming). */
+  const MemFileChunk *chunk = wd->mem.reference_current_chunk;
+  if (chunk == NULL || chunk->buf == NULL || chunk->id_session_uuid != id->session_uuid ||
+      chunk->size < sizeof(BHead) + sizeof(ID)) {
+    return false;
+  }
+  const BHead *bhead = (const BHead *)chunk->buf;
+  const ID *id_written = (const ID *)(bhead + 1);
+  if (bhead->old != id || bhead->code != GS(id->name) || !STREQ(id_written->name, id->name) ||
+      id_written->us != id->us || id_written->flag != id->flag || id_written->lib != id->lib ||
+      id_written->properties != id->properties ||
+      id_written->override_library != id->override_library) {
+    return false;
+  }
+
+  return BLO_memfile_write_id_reuse(&wd->mem);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2216,6 +2279,7 @@ static bool write_file_handle(Main *mainvar,
                               MemFile *current,
                               int write_flags,
                               bool use_userdef,
+                              bool use_id_reuse,
                               const BlendThumbnail *thumb)
 {
   BHead bhead;
@@ -2228,6 +2292,10 @@ static bool write_file_handle(Main *mainvar,
   wd = mywrite_begin(ww, compare, current);
   BlendWriter writer = {wd};
 
+  if (wd->use_memfile) {
+    wd->mem.use_id_reuse = use_id_reuse && (compare != NULL);
+  }
+
   sprintf(buf,
           "BLENDER%c%c%.3d",
           (sizeof(void *) == 8) ? '-' : '_',
@@ -2284,6 +2352,8 @@ static bool write_file_handle(Main *mainvar,
           BKE_lib_override_library_operations_store_start(bmain, override_storage, id);
         }
 
+        const bool is_tagged_for_undo = wd->use_memfile && write_id_is_tagged_for_undo(id);
+
         if (wd->use_memfile) {
           /* Record the changes that happened up to this undo push in
            * recalc_up_to_undo_push, and clear recalc_after_undo_push again
@@ -2308,6 +2378,14 @@ static bool write_file_handle(Main *mainvar,
 
         mywrite_id_begin(wd, id);
 
+        /* The re-used chunks keep the #ID.recalc_up_to_undo_push of the previous undo step,
+         * which only causes more updates than needed when undoing to this step. */
+        if (!is_tagged_for_undo && mywrite_id_reuse(wd, id)) {
+          BLI_assert(!do_override);
+          mywrite_id_end(wd, id);
+          continue;
+        }
+
         memcpy(id_buffer, id, idtype_struct_size);
 
         ((ID *)id_buffer)->tag = 0;
@@ -2593,7 +2671,8 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  const bool err = write_file_handle(
+      mainvar, &ww, NULL, NULL, write_flags, use_userdef, false, thumb);
 
   ww.close(&ww);
 
@@ -2633,14 +2712,18 @@ bool BLO_write_file(Main *mainvar,
 }
 
 /**
+ * \param use_id_reuse: Store ID's which were not tagged as changed since \a compare was written
+ * by re-using its chunks, see #MemFileWriteData.use_id_reuse. Only valid when all ID's of
+ * \a mainvar were written to \a compare and none changed without being tagged since then.
  * \return Success.
  */
-bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int write_flags)
+bool BLO_write_file_mem(
+    Main *mainvar, MemFile *compare, MemFile *current, int write_flags, bool use_id_reuse)
 {
   bool use_userdef = false;
 
   const bool err = write_file_handle(
-      mainvar, NULL, compare, current, write_flags, use_userdef, NULL);
+      mainvar, NULL, compare, current, write_flags, use_userdef, use_id_reuse, NULL);
 
   return (err == 0);
 }
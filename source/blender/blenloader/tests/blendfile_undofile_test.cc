@@ -0,0 +1,119 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "BLO_undofile.h"
+
+namespace blender::blenloader::tests {
+
+static void memfile_write(MemFile *memfile,
+                          MemFile *reference,
+                          const std::vector<std::string> &chunks)
+{
+  MemFileWriteData mem_data = {};
+  BLO_memfile_write_init(&mem_data, memfile, reference);
+  for (const std::string &chunk : chunks) {
+    BLO_memfile_chunk_add(&mem_data, chunk.c_str(), chunk.size() + 1);
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+static std::vector<std::string> memfile_content(const MemFile *memfile)
+{
+  std::vector<std::string> chunks;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    EXPECT_NE(chunk->buf, nullptr);
+    chunks.emplace_back(chunk->buf);
+    EXPECT_EQ(chunks.back().size() + 1, chunk->size);
+  }
+  return chunks;
+}
+
+TEST(memfile_undo, SharedChunks)
+{
+  const std::vector<std::string> chunks_a = {"scene", "object", "mesh"};
+  /* Reordered and partially modified. */
+  const std::vector<std::string> chunks_b = {"mesh", "object", "scene", "material"};
+
+  MemFile memfile_a = {};
+  MemFile memfile_b = {};
+  memfile_write(&memfile_a, nullptr, chunks_a);
+  memfile_write(&memfile_b, &memfile_a, chunks_b);
+
+  EXPECT_EQ(memfile_a.size, size_t(6 + 7 + 5));
+  EXPECT_EQ(memfile_a.size_total, memfile_a.size);
+  /* Only the new chunk uses new memory, the others share the content of the first memfile. */
+  EXPECT_EQ(memfile_b.size, size_t(9));
+  EXPECT_EQ(memfile_b.size_total, size_t(5 + 7 + 6 + 9));
+
+  const MemFileChunk *chunk_b = (const MemFileChunk *)BLI_findlink(&memfile_b.chunks, 1);
+  const MemFileChunk *chunk_a = (const MemFileChunk *)BLI_findlink(&memfile_a.chunks, 1);
+  EXPECT_EQ(chunk_a->buf, chunk_b->buf);
+  EXPECT_TRUE(chunk_b->is_identical);
+
+  /* The merged memfile takes over the memory of the buffers it still uses. */
+  BLO_memfile_merge(&memfile_a, &memfile_b);
+  EXPECT_EQ(memfile_b.size, size_t(6 + 7 + 5 + 9));
+  EXPECT_EQ(memfile_content(&memfile_b), chunks_b);
+
+  BLO_memfile_free(&memfile_b);
+  EXPECT_EQ(memfile_b.size, size_t(0));
+}
+
+TEST(memfile_undo, CompressRoundtrip)
+{
+  BLI_threadapi_init();
+
+  std::vector<std::string> chunks;
+  for (int i = 0; i < 8; i++) {
+    chunks.emplace_back(std::string(4096, 'a' + i));
+  }
+  /* Too small to be compressed. */
+  chunks.emplace_back("id");
+
+  MemFile memfile_a = {};
+  MemFile memfile_b = {};
+  memfile_write(&memfile_a, nullptr, chunks);
+  chunks[0] = std::string(4096, 'z');
+  memfile_write(&memfile_b, &memfile_a, chunks);
+
+  BLO_memfile_compress_start(&memfile_a);
+  BLO_memfile_compress_wait();
+
+  /* Only the modified chunk is not shared with the newer memfile. */
+  int num_compressed = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile_a.chunks) {
+    num_compressed += (chunk->buf == nullptr);
+  }
+  EXPECT_EQ(num_compressed, 1);
+  EXPECT_EQ(((const MemFileChunk *)memfile_a.chunks.first)->buf, nullptr);
+
+  BLO_memfile_ensure_uncompressed(&memfile_a);
+  const std::vector<std::string> content_a = memfile_content(&memfile_a);
+  EXPECT_EQ(content_a[0], std::string(4096, 'a'));
+  EXPECT_EQ(content_a.size(), chunks.size());
+
+  /* Writing against a compressed reference uncompresses it, all content is shared. */
+  BLO_memfile_compress_start(&memfile_a);
+  MemFile memfile_c = {};
+  memfile_write(&memfile_c, &memfile_a, memfile_content(&memfile_b));
+  EXPECT_EQ(memfile_c.size, size_t(0));
+  EXPECT_EQ(memfile_content(&memfile_c), memfile_content(&memfile_b));
+
+  BLO_memfile_free(&memfile_a);
+  BLO_memfile_free(&memfile_b);
+  BLO_memfile_free(&memfile_c);
+
+  BLI_threadapi_exit();
+}
+
+}  // namespace blender::blenloader::tests
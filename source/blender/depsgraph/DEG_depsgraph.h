@@ -122,6 +122,10 @@ const char *DEG_update_tag_as_string(IDRecalcFlag flag);
 void DEG_id_tag_update(struct ID *id, int flag);
 void DEG_id_tag_update_ex(struct Main *bmain, struct ID *id, int flag);
 
+/* Record a change of the ID for undo only, for changes made without running any update (e.g.
+ * from Python). Nothing is tagged for re-evaluation. */
+void DEG_id_tag_undo_changed(struct ID *id);
+
 void DEG_graph_id_tag_update(struct Main *bmain,
                              struct Depsgraph *depsgraph,
                              struct ID *id,
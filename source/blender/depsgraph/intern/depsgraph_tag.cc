@@ -753,6 +753,15 @@ void DEG_id_tag_update_ex(Main *bmain, ID *id, int flag)
   deg::id_tag_update(bmain, id, flag, deg::DEG_UPDATE_SOURCE_USER_EDIT);
 }
 
+void DEG_id_tag_undo_changed(ID *id)
+{
+  if (id == nullptr) {
+    return;
+  }
+  /* Same accumulation as #id_tag_update, the memfile undo only stores tagged IDs again. */
+  id->recalc_after_undo_push |= ID_RECALC_COPY_ON_WRITE;
+}
+
 void DEG_graph_id_tag_update(struct Main *bmain,
                              struct Depsgraph *depsgraph,
                              struct ID *id,
@@ -24,6 +24,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 
 #include "DNA_node_types.h"
 #include "DNA_object_enums.h"
@@ -61,6 +62,24 @@ typedef struct MemFileUndoStep {
   MemFileUndoData *data;
 } MemFileUndoStep;
 
+/** With undo compression, the memfile step this many steps before the new one is compressed. */
+#define MEMFILE_UNDO_COMPRESS_OFFSET 4
+
+/**
+ * Update the memory used by all memfile steps, which changes when their buffers get compressed,
+ * uncompressed or handed over to the next step.
+ */
+static void memfile_undosys_steps_update_size(UndoStack *ustack)
+{
+  LISTBASE_FOREACH (UndoStep *, us_iter, &ustack->steps) {
+    if (us_iter->type == BKE_UNDOSYS_TYPE_MEMFILE) {
+      MemFileUndoData *mfu = ((MemFileUndoStep *)us_iter)->data;
+      mfu->undo_size = mfu->memfile.size;
+      us_iter->data_size = mfu->undo_size;
+    }
+  }
+}
+
 static bool memfile_undosys_poll(bContext *C)
 {
   /* other poll functions must run first, this is a catch-all. */
@@ -95,6 +114,19 @@ static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
       ustack, BKE_UNDOSYS_TYPE_MEMFILE);
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : NULL);
   us->step.data_size = us->data->undo_size;
+  /* Writing stopped the background compression, apply what it saved so far. */
+  memfile_undosys_steps_update_size(ustack);
+
+  if (USER_EXPERIMENTAL_TEST(&U, use_undo_compress)) {
+    /* Older steps are rarely loaded again, compress their data in the background. */
+    MemFileUndoStep *us_compress = us_prev;
+    for (int i = 1; i < MEMFILE_UNDO_COMPRESS_OFFSET && us_compress != NULL; i++) {
+      us_compress = (MemFileUndoStep *)BKE_undosys_step_same_type_prev(&us_compress->step);
+    }
+    if (us_compress != NULL) {
+      BLO_memfile_compress_start(&us_compress->data->memfile);
+    }
+  }
 
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
@@ -188,6 +220,7 @@ static void memfile_undosys_step_decode(struct bContext *C,
 
   MemFileUndoStep *us = (MemFileUndoStep *)us_p;
   BKE_memfile_undo_decode(us->data, undo_direction, use_old_bmain_data, C);
+  memfile_undosys_steps_update_size(ED_undo_stack_get());
 
   for (UndoStep *us_iter = us_p->next; us_iter; us_iter = us_iter->next) {
     if (BKE_UNDOSYS_TYPE_IS_MEMFILE_SKIP(us_iter->type)) {
@@ -262,6 +295,8 @@ static void memfile_undosys_step_free(UndoStep *us_p)
     if (us_next_p != NULL) {
       MemFileUndoStep *us_next = (MemFileUndoStep *)us_next_p;
       BLO_memfile_merge(&us->data->memfile, &us_next->data->memfile);
+      us_next->data->undo_size = us_next->data->memfile.size;
+      us_next_p->data_size = us_next->data->undo_size;
     }
   }
 
@@ -297,6 +297,9 @@ bool ED_editors_flush_edits_ex(Main *bmain, bool for_render, bool check_needs_fl
   }
 
   bmain->is_memfile_undo_flush_needed = false;
+  if (has_edited) {
+    bmain->is_memfile_undo_untagged_change = true;
+  }
 
   return has_edited;
 }
@@ -19,6 +19,8 @@
 
 #include "abc_archive.h"
 
+#include "BLI_task.h"
+
 #include "BKE_blender_version.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
@@ -172,7 +174,8 @@ ABCArchive::ABCArchive(const Main *bmain,
                        const Scene *scene,
                        AlembicExportParams params,
                        std::string filename)
-    : archive(nullptr)
+    : archive(nullptr),
+      deferred_writes_pool_(BLI_task_pool_create_background_serial(this, TASK_PRIORITY_HIGH))
 {
   double scene_fps = FPS;
   MetaData abc_metadata = create_abc_metadata(bmain, scene_fps);
@@ -211,6 +214,11 @@ ABCArchive::ABCArchive(const Main *bmain,
 
 ABCArchive::~ABCArchive()
 {
+  /* A successful export waited for all deferred writes already. When an exception unwinds the
+   * export, the remaining writes may refer to writers that are gone, so they are dropped. */
+  BLI_task_pool_cancel(deferred_writes_pool_);
+  BLI_task_pool_free(deferred_writes_pool_);
+
   delete archive;
 }
 
@@ -255,7 +263,56 @@ ExportSubset ABCArchive::export_subset_for_frame(double frame) const
 
 void ABCArchive::update_bounding_box(const Imath::Box3d &bounds)
 {
-  abc_archive_bbox_.set(bounds);
+  defer_write([this, bounds]() { abc_archive_bbox_.set(bounds); });
+}
+
+void ABCArchive::deferred_write_run(TaskPool *__restrict pool, void *taskdata)
+{
+  ABCArchive *abc_archive = static_cast<ABCArchive *>(BLI_task_pool_user_data(pool));
+  std::function<void()> &write_fn = *static_cast<std::function<void()> *>(taskdata);
+
+  {
+    std::lock_guard<std::mutex> lock(abc_archive->deferred_writes_mutex_);
+    if (abc_archive->deferred_writes_exception_) {
+      return;
+    }
+  }
+
+  try {
+    write_fn();
+  }
+  catch (...) {
+    std::lock_guard<std::mutex> lock(abc_archive->deferred_writes_mutex_);
+    abc_archive->deferred_writes_exception_ = std::current_exception();
+  }
+}
+
+void ABCArchive::deferred_write_free(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  delete static_cast<std::function<void()> *>(taskdata);
+}
+
+void ABCArchive::defer_write(std::function<void()> write_fn)
+{
+  BLI_task_pool_push(deferred_writes_pool_,
+                     deferred_write_run,
+                     new std::function<void()>(std::move(write_fn)),
+                     true,
+                     deferred_write_free);
+}
+
+void ABCArchive::wait_for_deferred_writes()
+{
+  BLI_task_pool_work_and_wait(deferred_writes_pool_);
+
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(deferred_writes_mutex_);
+    std::swap(exception, deferred_writes_exception_);
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
 }
 
 }  // namespace blender::io::alembic
@@ -29,12 +29,16 @@
 #include <Alembic/Abc/OArchive.h>
 #include <Alembic/Abc/OTypedScalarProperty.h>
 
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <mutex>
 #include <set>
 #include <string>
 
 struct Main;
 struct Scene;
+struct TaskPool;
 
 namespace blender::io::alembic {
 
@@ -68,6 +72,17 @@ class ABCArchive {
 
   void update_bounding_box(const Imath::Box3d &bounds);
 
+  /* Write to the archive on a background thread, so that writing the samples of a frame overlaps
+   * with the evaluation of the next one. Deferred writes run one after the other in the order they
+   * were added, which keeps the archive identical to writing them immediately. The function can
+   * only use data it owns, as the depsgraph is likely evaluated for another frame when it runs. */
+  void defer_write(std::function<void()> write_fn);
+
+  /* Wait for all deferred writes to finish. This has to be called before writing to the archive
+   * directly, including the creation of new Alembic objects. Rethrows the first exception thrown
+   * by a deferred write. */
+  void wait_for_deferred_writes();
+
  private:
   std::ofstream abc_ostream_;
   uint32_t time_sampling_index_transforms_;
@@ -78,6 +93,14 @@ class ABCArchive {
   Frames export_frames_;
 
   Alembic::Abc::OBox3dProperty abc_archive_bbox_;
+
+  TaskPool *deferred_writes_pool_;
+  std::mutex deferred_writes_mutex_;
+  /* Once a deferred write fails, the remaining ones are skipped. */
+  std::exception_ptr deferred_writes_exception_;
+
+  static void deferred_write_run(TaskPool *__restrict pool, void *taskdata);
+  static void deferred_write_free(TaskPool *__restrict pool, void *taskdata);
 };
 
 }  // namespace blender::io::alembic
@@ -148,7 +148,8 @@ static void export_startjob(void *customdata,
         break;
       }
 
-      /* Update the scene for the next frame to render. */
+      /* Update the scene for the next frame to render. The samples of the previous frame are
+       * written to the archive in the background meanwhile, see ABCArchive::defer_write(). */
       scene->r.cfra = static_cast<int>(frame);
       scene->r.subframe = frame - scene->r.cfra;
       BKE_scene_graph_update_for_newframe(data->depsgraph);
@@ -167,6 +168,8 @@ static void export_startjob(void *customdata,
     iter.iterate_and_write();
   }
 
+  /* Samples of the last frame may still be written in the background. */
+  abc_archive->wait_for_deferred_writes();
   iter.release_writers();
 
   /* Finish up by going back to the keyframe that was current before we started. */
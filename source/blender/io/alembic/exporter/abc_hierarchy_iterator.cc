@@ -158,6 +158,10 @@ Alembic::Abc::OObject ABCHierarchyIterator::get_alembic_parent(
 ABCWriterConstructorArgs ABCHierarchyIterator::writer_constructor_args(
     const HierarchyContext *context) const
 {
+  /* The writers create their Alembic objects right after construction, which writes to the
+   * archive. */
+  abc_archive_->wait_for_deferred_writes();
+
   ABCWriterConstructorArgs constructor_args;
   constructor_args.depsgraph = depsgraph_;
   constructor_args.abc_archive = abc_archive_;
@@ -20,6 +20,7 @@
 #include "abc_hierarchy_iterator.h"
 
 #include "BKE_animsys.h"
+#include "BKE_idprop.h"
 #include "BKE_key.h"
 #include "BKE_object.h"
 
@@ -29,6 +30,8 @@
 
 #include <Alembic/AbcGeom/Visibility.h>
 
+#include <memory>
+
 #include "CLG_log.h"
 static CLG_LogRef LOG = {"io.alembic"};
 
@@ -54,6 +57,11 @@ bool ABCAbstractWriter::is_supported(const HierarchyContext * /*context*/) const
   return true;
 }
 
+bool ABCAbstractWriter::defers_writes() const
+{
+  return false;
+}
+
 void ABCAbstractWriter::write(HierarchyContext &context)
 {
   if (!frame_has_been_written_) {
@@ -66,10 +74,24 @@ void ABCAbstractWriter::write(HierarchyContext &context)
     return;
   }
 
+  const bool defer_writes = frame_has_been_written_ && defers_writes();
+  if (!defer_writes) {
+    args_.abc_archive->wait_for_deferred_writes();
+  }
+
   do_write(context);
 
   if (custom_props_) {
-    custom_props_->write_all(get_id_properties(context));
+    const IDProperty *id_properties = get_id_properties(context);
+    if (!defer_writes || id_properties == nullptr) {
+      custom_props_->write_all(id_properties);
+    }
+    else {
+      /* Freed with the deferred write, also when it is skipped because of an earlier error. */
+      std::shared_ptr<IDProperty> properties(IDP_CopyProperty(id_properties), IDP_FreeProperty);
+      args_.abc_archive->defer_write(
+          [this, properties]() { custom_props_->write_all(properties.get()); });
+    }
   }
 
   frame_has_been_written_ = true;
@@ -141,7 +163,11 @@ void ABCAbstractWriter::update_bounding_box(Object *object)
 
 void ABCAbstractWriter::write_visibility(const HierarchyContext &context)
 {
-  const bool is_visible = context.is_object_visible(DAG_EVAL_RENDER);
+  write_visibility(context.is_object_visible(DAG_EVAL_RENDER));
+}
+
+void ABCAbstractWriter::write_visibility(const bool is_visible)
+{
   Alembic::Abc::OObject abc_object = get_alembic_object();
 
   if (!abc_visibility_.valid()) {
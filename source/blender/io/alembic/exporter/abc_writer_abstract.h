@@ -86,6 +86,11 @@ class ABCAbstractWriter : public AbstractHierarchyWriter {
  protected:
   virtual void do_write(HierarchyContext &context) = 0;
 
+  /* Returns true when do_write() only copies data once the first frame has been written, leaving
+   * the writing to ABCArchive::defer_write(). Other writers wait for the deferred writes to finish
+   * before writing, as the archive can only be written from one thread at a time. */
+  virtual bool defers_writes() const;
+
   virtual void update_bounding_box(Object *object);
 
   /* Return ID properties of whatever ID datablock is written by this writer. Defaults to the
@@ -96,6 +101,7 @@ class ABCAbstractWriter : public AbstractHierarchyWriter {
   virtual void ensure_custom_properties_exporter(const HierarchyContext &context);
 
   void write_visibility(const HierarchyContext &context);
+  void write_visibility(bool is_visible);
 
   /* Return the Alembic schema's compound property, which will be used for writing custom
    * properties.
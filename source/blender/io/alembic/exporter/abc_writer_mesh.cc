@@ -211,7 +211,15 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
   m_custom_data_config.totvert = mesh->totvert;
 
   try {
-    if (is_subd_) {
+    if (frame_has_been_written_) {
+      if (is_subd_) {
+        defer_subd_sample(context, mesh);
+      }
+      else {
+        defer_mesh_sample(context, mesh);
+      }
+    }
+    else if (is_subd_) {
       write_subd(context, mesh);
     }
     else {
@@ -346,6 +354,104 @@ void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *me
   write_arb_geo_params(mesh);
 }
 
+bool ABCGenericMeshWriter::defers_writes() const
+{
+  return true;
+}
+
+/* After the first frame, the face sets, UVs and other arbitrary geometry parameters have been
+ * written and only the data copied below remains. It is written to the archive in the background,
+ * while the next frame is evaluated. */
+
+void ABCGenericMeshWriter::defer_mesh_sample(HierarchyContext &context, struct Mesh *mesh)
+{
+  std::vector<Imath::V3f> points, normals;
+  std::vector<int32_t> poly_verts, loop_counts;
+  std::vector<Imath::V3f> velocities;
+  bool has_flat_shaded_poly = false;
+
+  get_vertices(mesh, points);
+  get_topology(mesh, poly_verts, loop_counts, has_flat_shaded_poly);
+
+  const bool write_normals = args_.export_params->normals;
+  if (write_normals) {
+    get_loop_normals(mesh, normals, has_flat_shaded_poly);
+  }
+
+  const bool write_velocities = liquid_sim_modifier_ != nullptr;
+  if (write_velocities) {
+    get_velocities(mesh, velocities);
+  }
+
+  update_bounding_box(context.object);
+
+  args_.abc_archive->defer_write([this,
+                                  points = std::move(points),
+                                  poly_verts = std::move(poly_verts),
+                                  loop_counts = std::move(loop_counts),
+                                  normals = std::move(normals),
+                                  velocities = std::move(velocities),
+                                  write_normals,
+                                  write_velocities,
+                                  bounds = bounding_box_]() {
+    OPolyMeshSchema::Sample mesh_sample = OPolyMeshSchema::Sample(
+        V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+
+    if (write_normals) {
+      ON3fGeomParam::Sample normals_sample;
+      if (!normals.empty()) {
+        normals_sample.setScope(kFacevaryingScope);
+        normals_sample.setVals(V3fArraySample(normals));
+      }
+
+      mesh_sample.setNormals(normals_sample);
+    }
+
+    if (write_velocities) {
+      mesh_sample.setVelocities(V3fArraySample(velocities));
+    }
+
+    mesh_sample.setSelfBounds(bounds);
+    abc_poly_mesh_schema_.set(mesh_sample);
+  });
+}
+
+void ABCGenericMeshWriter::defer_subd_sample(HierarchyContext &context, struct Mesh *mesh)
+{
+  std::vector<float> crease_sharpness;
+  std::vector<Imath::V3f> points;
+  std::vector<int32_t> poly_verts, loop_counts;
+  std::vector<int32_t> crease_indices, crease_lengths;
+  bool has_flat_poly = false;
+
+  get_vertices(mesh, points);
+  get_topology(mesh, poly_verts, loop_counts, has_flat_poly);
+  get_creases(mesh, crease_indices, crease_lengths, crease_sharpness);
+
+  update_bounding_box(context.object);
+
+  args_.abc_archive->defer_write([this,
+                                  points = std::move(points),
+                                  poly_verts = std::move(poly_verts),
+                                  loop_counts = std::move(loop_counts),
+                                  crease_indices = std::move(crease_indices),
+                                  crease_lengths = std::move(crease_lengths),
+                                  crease_sharpness = std::move(crease_sharpness),
+                                  bounds = bounding_box_]() {
+    OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(
+        V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+
+    if (!crease_indices.empty()) {
+      subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices));
+      subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths));
+      subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness));
+    }
+
+    subdiv_sample.setSelfBounds(bounds);
+    abc_subdiv_schema_.set(subdiv_sample);
+  });
+}
+
 template<typename Schema>
 void ABCGenericMeshWriter::write_face_sets(Object *object, struct Mesh *mesh, Schema &schema)
 {
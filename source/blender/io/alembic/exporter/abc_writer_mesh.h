@@ -60,6 +60,7 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
  protected:
   virtual bool is_supported(const HierarchyContext *context) const override;
   virtual void do_write(HierarchyContext &context) override;
+  virtual bool defers_writes() const override;
 
   virtual Mesh *get_export_mesh(Object *object_eval, bool &r_needsfree) = 0;
   virtual void free_export_mesh(Mesh *mesh);
@@ -69,6 +70,8 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
  private:
   void write_mesh(HierarchyContext &context, Mesh *mesh);
   void write_subd(HierarchyContext &context, Mesh *mesh);
+  void defer_mesh_sample(HierarchyContext &context, Mesh *mesh);
+  void defer_subd_sample(HierarchyContext &context, Mesh *mesh);
   template<typename Schema> void write_face_sets(Object *object, Mesh *mesh, Schema &schema);
 
   ModifierData *get_liquid_sim_modifier(Scene *scene_eval, Object *ob_eval);
@@ -100,9 +100,23 @@ void ABCTransformWriter::do_write(HierarchyContext &context)
   XformSample xform_sample;
   xform_sample.setMatrix(convert_matrix_datatype(parent_relative_matrix));
   xform_sample.setInheritsXforms(true);
-  abc_xform_schema_.set(xform_sample);
 
-  write_visibility(context);
+  if (!frame_has_been_written_) {
+    abc_xform_schema_.set(xform_sample);
+    write_visibility(context);
+    return;
+  }
+
+  const bool is_visible = context.is_object_visible(DAG_EVAL_RENDER);
+  args_.abc_archive->defer_write([this, xform_sample, is_visible]() mutable {
+    abc_xform_schema_.set(xform_sample);
+    write_visibility(is_visible);
+  });
+}
+
+bool ABCTransformWriter::defers_writes() const
+{
+  return true;
 }
 
 OObject ABCTransformWriter::get_alembic_object() const
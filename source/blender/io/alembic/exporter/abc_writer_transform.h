@@ -38,6 +38,7 @@ class ABCTransformWriter : public ABCAbstractWriter {
 
  protected:
   virtual void do_write(HierarchyContext &context) override;
+  virtual bool defers_writes() const override;
   virtual bool check_is_animated(const HierarchyContext &context) const override;
   virtual Alembic::Abc::OObject get_alembic_object() const override;
   const IDProperty *get_id_properties(const HierarchyContext &context) const override;
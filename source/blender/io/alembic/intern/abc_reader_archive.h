@@ -26,6 +26,7 @@
 #include <Alembic/AbcCoreOgawa/All.h>
 
 #include <fstream>
+#include <memory>
 
 struct Main;
 struct Scene;
@@ -39,11 +40,13 @@ namespace blender::io::alembic {
 
 class ArchiveReader {
   Alembic::Abc::IArchive m_archive;
-  std::ifstream m_infile;
+  std::vector<std::unique_ptr<std::ifstream>> m_infiles;
   std::vector<std::istream *> m_streams;
 
  public:
-  ArchiveReader(struct Main *bmain, const char *filename);
+  /* Opening the file multiple times allows reading different objects from multiple threads at
+   * once, Alembic picks a free stream for every read. */
+  ArchiveReader(struct Main *bmain, const char *filename, int num_streams = 1);
 
   bool valid() const;
 
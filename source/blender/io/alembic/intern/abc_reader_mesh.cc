@@ -24,6 +24,7 @@
 #include "abc_util.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "MEM_guardedalloc.h"
 
@@ -34,6 +35,7 @@
 
 #include "BLI_compiler_compat.h"
 #include "BLI_math_geom.h"
+#include "BLI_task.hh"
 
 #include "BKE_main.h"
 #include "BKE_material.h"
@@ -140,17 +142,19 @@ static void read_mverts_interp(MVert *mverts,
                                const P3fArraySamplePtr &ceil_positions,
                                const float weight)
 {
-  float tmp[3];
-  for (int i = 0; i < positions->size(); i++) {
-    MVert &mvert = mverts[i];
-    const Imath::V3f &floor_pos = (*positions)[i];
-    const Imath::V3f &ceil_pos = (*ceil_positions)[i];
+  parallel_for(IndexRange(positions->size()), 4096, [&](IndexRange range) {
+    float tmp[3];
+    for (const int64_t i : range) {
+      MVert &mvert = mverts[i];
+      const Imath::V3f &floor_pos = (*positions)[i];
+      const Imath::V3f &ceil_pos = (*ceil_positions)[i];
 
-    interp_v3_v3v3(tmp, floor_pos.getValue(), ceil_pos.getValue(), weight);
-    copy_zup_from_yup(mvert.co, tmp);
+      interp_v3_v3v3(tmp, floor_pos.getValue(), ceil_pos.getValue(), weight);
+      copy_zup_from_yup(mvert.co, tmp);
 
-    mvert.bweight = 0;
-  }
+      mvert.bweight = 0;
+    }
+  });
 }
 
 static void read_mverts(CDStreamConfig &config, const AbcMeshData &mesh_data)
@@ -169,23 +173,25 @@ static void read_mverts(CDStreamConfig &config, const AbcMeshData &mesh_data)
 
 void read_mverts(MVert *mverts, const P3fArraySamplePtr positions, const N3fArraySamplePtr normals)
 {
-  for (int i = 0; i < positions->size(); i++) {
-    MVert &mvert = mverts[i];
-    Imath::V3f pos_in = (*positions)[i];
+  parallel_for(IndexRange(positions->size()), 4096, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      MVert &mvert = mverts[i];
+      Imath::V3f pos_in = (*positions)[i];
 
-    copy_zup_from_yup(mvert.co, pos_in.getValue());
+      copy_zup_from_yup(mvert.co, pos_in.getValue());
 
-    mvert.bweight = 0;
+      mvert.bweight = 0;
 
-    if (normals) {
-      Imath::V3f nor_in = (*normals)[i];
+      if (normals) {
+        Imath::V3f nor_in = (*normals)[i];
 
-      short no[3];
-      normal_float_to_short_v3(no, nor_in.getValue());
+        short no[3];
+        normal_float_to_short_v3(no, nor_in.getValue());
 
-      copy_zup_from_yup(mvert.no, no);
+        copy_zup_from_yup(mvert.no, no);
+      }
     }
-  }
+  });
 }
 
 static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
@@ -203,52 +209,61 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
 
   const bool do_uvs = (mloopuvs && uvs && uvs_indices) &&
                       (uvs_indices->size() == face_indices->size());
-  unsigned int loop_index = 0;
-  unsigned int rev_loop_index = 0;
-  unsigned int uv_index = 0;
-  bool seen_invalid_geometry = false;
 
+  /* Polygon offsets first, so that the loops can be read in parallel. */
+  unsigned int loopstart = 0;
   for (int i = 0; i < face_counts->size(); i++) {
     const int face_size = (*face_counts)[i];
 
     MPoly &poly = mpolys[i];
-    poly.loopstart = loop_index;
+    poly.loopstart = loopstart;
     poly.totloop = face_size;
 
     /* Polygons are always assumed to be smooth-shaded. If the Alembic mesh should be flat-shaded,
      * this is encoded in custom loop normals. See T71246. */
     poly.flag |= ME_SMOOTH;
 
-    /* NOTE: Alembic data is stored in the reverse order. */
-    rev_loop_index = loop_index + (face_size - 1);
+    loopstart += face_size;
+  }
 
-    uint last_vertex_index = 0;
-    for (int f = 0; f < face_size; f++, loop_index++, rev_loop_index--) {
-      MLoop &loop = mloops[rev_loop_index];
-      loop.v = (*face_indices)[loop_index];
+  std::atomic<bool> seen_invalid_geometry = false;
 
-      if (f > 0 && loop.v == last_vertex_index) {
-        /* This face is invalid, as it has consecutive loops from the same vertex. This is caused
-         * by invalid geometry in the Alembic file, such as in T76514. */
-        seen_invalid_geometry = true;
-      }
-      last_vertex_index = loop.v;
+  parallel_for(IndexRange(face_counts->size()), 1024, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      const MPoly &poly = mpolys[i];
+      unsigned int loop_index = poly.loopstart;
 
-      if (do_uvs) {
-        MLoopUV &loopuv = mloopuvs[rev_loop_index];
+      /* NOTE: Alembic data is stored in the reverse order. */
+      unsigned int rev_loop_index = loop_index + (poly.totloop - 1);
 
-        uv_index = (*uvs_indices)[loop_index];
+      uint last_vertex_index = 0;
+      for (int f = 0; f < poly.totloop; f++, loop_index++, rev_loop_index--) {
+        MLoop &loop = mloops[rev_loop_index];
+        loop.v = (*face_indices)[loop_index];
 
-        /* Some Alembic files are broken (or at least export UVs in a way we don't expect). */
-        if (uv_index >= uvs_size) {
-          continue;
+        if (f > 0 && loop.v == last_vertex_index) {
+          /* This face is invalid, as it has consecutive loops from the same vertex. This is
+           * caused by invalid geometry in the Alembic file, such as in T76514. */
+          seen_invalid_geometry = true;
         }
+        last_vertex_index = loop.v;
 
-        loopuv.uv[0] = (*uvs)[uv_index][0];
-        loopuv.uv[1] = (*uvs)[uv_index][1];
+        if (do_uvs) {
+          MLoopUV &loopuv = mloopuvs[rev_loop_index];
+
+          const unsigned int uv_index = (*uvs_indices)[loop_index];
+
+          /* Some Alembic files are broken (or at least export UVs in a way we don't expect). */
+          if (uv_index >= uvs_size) {
+            continue;
+          }
+
+          loopuv.uv[0] = (*uvs)[uv_index][0];
+          loopuv.uv[1] = (*uvs)[uv_index][1];
+        }
       }
     }
-  }
+  });
 
   BKE_mesh_calc_edges(config.mesh, false, false);
   if (seen_invalid_geometry) {
@@ -287,16 +302,19 @@ static void process_loop_normals(CDStreamConfig &config, const N3fArraySamplePtr
   float(*lnors)[3] = static_cast<float(*)[3]>(
       MEM_malloc_arrayN(loop_count, sizeof(float[3]), "ABC::FaceNormals"));
 
-  MPoly *mpoly = mesh->mpoly;
+  const MPoly *mpolys = mesh->mpoly;
   const N3fArraySample &loop_normals = *loop_normals_ptr;
-  int abc_index = 0;
-  for (int i = 0, e = mesh->totpoly; i < e; i++, mpoly++) {
-    /* As usual, ABC orders the loops in reverse. */
-    for (int j = mpoly->totloop - 1; j >= 0; j--, abc_index++) {
-      int blender_index = mpoly->loopstart + j;
-      copy_zup_from_yup(lnors[blender_index], loop_normals[abc_index].getValue());
+  parallel_for(IndexRange(mesh->totpoly), 1024, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      const MPoly &mpoly = mpolys[i];
+      /* As usual, ABC orders the loops in reverse. */
+      int abc_index = mpoly.loopstart;
+      for (int j = mpoly.totloop - 1; j >= 0; j--, abc_index++) {
+        int blender_index = mpoly.loopstart + j;
+        copy_zup_from_yup(lnors[blender_index], loop_normals[abc_index].getValue());
+      }
     }
-  }
+  });
 
   mesh->flag |= ME_AUTOSMOOTH;
   BKE_mesh_set_custom_normals(mesh, lnors);
@@ -317,9 +335,11 @@ static void process_vertex_normals(CDStreamConfig &config,
       MEM_malloc_arrayN(normals_count, sizeof(float[3]), "ABC::VertexNormals"));
 
   const N3fArraySample &vertex_normals = *vertex_normals_ptr;
-  for (int index = 0; index < normals_count; index++) {
-    copy_zup_from_yup(vnors[index], vertex_normals[index].getValue());
-  }
+  parallel_for(IndexRange(normals_count), 4096, [&](IndexRange range) {
+    for (const int64_t index : range) {
+      copy_zup_from_yup(vnors[index], vertex_normals[index].getValue());
+    }
+  });
 
   config.mesh->flag |= ME_AUTOSMOOTH;
   BKE_mesh_set_custom_normals_from_vertices(config.mesh, vnors);
@@ -562,7 +582,7 @@ void AbcMeshReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelec
   m_object = BKE_object_add_only_object(bmain, OB_MESH, m_object_name.c_str());
   m_object->data = mesh;
 
-  Mesh *read_mesh = this->read_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL, NULL);
+  Mesh *read_mesh = read_prefetched_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL);
   if (read_mesh != mesh) {
     /* XXX fixme after 2.80; mesh->flag isn't copied by BKE_mesh_nomain_to_mesh() */
     /* read_mesh can be freed by BKE_mesh_nomain_to_mesh(), so get the flag before that happens. */
@@ -582,6 +602,11 @@ void AbcMeshReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelec
   }
 }
 
+void AbcMeshReader::prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel)
+{
+  prefetch_mesh(sample_sel, MOD_MESHSEQ_READ_ALL);
+}
+
 bool AbcMeshReader::accepts_object_type(
     const Alembic::AbcCoreAbstract::ObjectHeader &alembic_header,
     const Object *const ob,
@@ -870,6 +895,11 @@ bool AbcSubDReader::accepts_object_type(
   return true;
 }
 
+void AbcSubDReader::prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel)
+{
+  prefetch_mesh(sample_sel, MOD_MESHSEQ_READ_ALL);
+}
+
 void AbcSubDReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel)
 {
   Mesh *mesh = BKE_mesh_add(bmain, m_data_name.c_str());
@@ -877,7 +907,7 @@ void AbcSubDReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelec
   m_object = BKE_object_add_only_object(bmain, OB_MESH, m_object_name.c_str());
   m_object->data = mesh;
 
-  Mesh *read_mesh = this->read_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL, NULL);
+  Mesh *read_mesh = read_prefetched_mesh(mesh, sample_sel, MOD_MESHSEQ_READ_ALL);
   if (read_mesh != mesh) {
     BKE_mesh_nomain_to_mesh(read_mesh, mesh, m_object, &CD_MASK_MESH, true);
   }
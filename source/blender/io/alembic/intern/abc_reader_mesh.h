@@ -39,6 +39,7 @@ class AbcMeshReader : public AbcObjectReader {
                            const Object *const ob,
                            const char **err_str) const override;
   void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel) override;
+  void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel) override;
 
   struct Mesh *read_mesh(struct Mesh *existing_mesh,
                          const Alembic::Abc::ISampleSelector &sample_sel,
@@ -71,6 +72,7 @@ class AbcSubDReader : public AbcObjectReader {
                            const Object *const ob,
                            const char **err_str) const;
   void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel);
+  void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel);
   struct Mesh *read_mesh(struct Mesh *existing_mesh,
                          const Alembic::Abc::ISampleSelector &sample_sel,
                          int read_flag,
@@ -29,6 +29,7 @@
 
 #include "BKE_constraint.h"
 #include "BKE_lib_id.h"
+#include "BKE_mesh.h"
 #include "BKE_modifier.h"
 #include "BKE_object.h"
 
@@ -50,6 +51,7 @@ AbcObjectReader::AbcObjectReader(const IObject &object, ImportSettings &settings
       m_min_time(std::numeric_limits<chrono_t>::max()),
       m_max_time(std::numeric_limits<chrono_t>::min()),
       m_refcount(0),
+      m_prefetched_mesh(NULL),
       parent_reader(NULL)
 {
   m_name = object.getFullName();
@@ -99,6 +101,9 @@ void AbcObjectReader::determine_inherits_xform()
 
 AbcObjectReader::~AbcObjectReader()
 {
+  if (m_prefetched_mesh) {
+    BKE_id_free(NULL, m_prefetched_mesh);
+  }
 }
 
 const IObject &AbcObjectReader::iobject() const
@@ -176,6 +181,39 @@ struct Mesh *AbcObjectReader::read_mesh(struct Mesh *existing_mesh,
   return existing_mesh;
 }
 
+void AbcObjectReader::prefetchObjectData(const Alembic::Abc::ISampleSelector & /*sample_sel*/)
+{
+  /* Nothing to read ahead by default, everything happens in readObjectData(). */
+}
+
+void AbcObjectReader::prefetch_mesh(const Alembic::Abc::ISampleSelector &sample_sel,
+                                    const int read_flag)
+{
+  BLI_assert(m_prefetched_mesh == NULL);
+
+  /* Same as reading into the new empty mesh of readObjectData(), without adding it to Main. */
+  Mesh *empty_mesh = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  Mesh *mesh = read_mesh(empty_mesh, sample_sel, read_flag, NULL);
+
+  /* When nothing was read, readObjectData() will read again and handle it. */
+  if (mesh != empty_mesh) {
+    m_prefetched_mesh = mesh;
+  }
+  BKE_id_free(NULL, empty_mesh);
+}
+
+Mesh *AbcObjectReader::read_prefetched_mesh(Mesh *mesh,
+                                            const Alembic::Abc::ISampleSelector &sample_sel,
+                                            const int read_flag)
+{
+  if (m_prefetched_mesh) {
+    Mesh *prefetched_mesh = m_prefetched_mesh;
+    m_prefetched_mesh = NULL;
+    return prefetched_mesh;
+  }
+  return read_mesh(mesh, sample_sel, read_flag, NULL);
+}
+
 bool AbcObjectReader::topology_changed(Mesh * /*existing_mesh*/,
                                        const Alembic::Abc::ISampleSelector & /*sample_sel*/)
 {
@@ -94,6 +94,9 @@ class AbcObjectReader {
 
   bool m_inherits_xform;
 
+  /* Mesh outside of Main read by prefetchObjectData(), owned by the reader until used. */
+  Mesh *m_prefetched_mesh;
+
  public:
   AbcObjectReader *parent_reader;
 
@@ -139,6 +142,12 @@ class AbcObjectReader {
 
   virtual void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel) = 0;
 
+  /**
+   * Read ahead the data that readObjectData() needs for the same sample. This doesn't access
+   * Main, so that it can run for many readers in parallel before the IDs get created.
+   */
+  virtual void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel);
+
   virtual struct Mesh *read_mesh(struct Mesh *mesh,
                                  const Alembic::Abc::ISampleSelector &sample_sel,
                                  int read_flag,
@@ -162,6 +171,12 @@ class AbcObjectReader {
 
  protected:
   void determine_inherits_xform();
+
+  void prefetch_mesh(const Alembic::Abc::ISampleSelector &sample_sel, int read_flag);
+  /** Mesh read by prefetch_mesh() if any, or read_mesh() of the given mesh otherwise. */
+  Mesh *read_prefetched_mesh(Mesh *mesh,
+                             const Alembic::Abc::ISampleSelector &sample_sel,
+                             int read_flag);
 };
 
 Imath::M44d get_matrix(const Alembic::AbcGeom::IXformSchema &schema, const float time);
@@ -82,7 +82,7 @@ bool AbcPointsReader::accepts_object_type(
 void AbcPointsReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel)
 {
   Mesh *mesh = BKE_mesh_add(bmain, m_data_name.c_str());
-  Mesh *read_mesh = this->read_mesh(mesh, sample_sel, 0, NULL);
+  Mesh *read_mesh = read_prefetched_mesh(mesh, sample_sel, 0);
 
   if (read_mesh != mesh) {
     BKE_mesh_nomain_to_mesh(read_mesh, mesh, m_object, &CD_MASK_MESH, true);
@@ -100,6 +100,11 @@ void AbcPointsReader::readObjectData(Main *bmain, const Alembic::Abc::ISampleSel
   }
 }
 
+void AbcPointsReader::prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel)
+{
+  prefetch_mesh(sample_sel, 0);
+}
+
 void read_points_sample(const IPointsSchema &schema,
                         const ISampleSelector &selector,
                         CDStreamConfig &config)
@@ -40,6 +40,7 @@ class AbcPointsReader : public AbcObjectReader {
                            const char **err_str) const;
 
   void readObjectData(Main *bmain, const Alembic::Abc::ISampleSelector &sample_sel);
+  void prefetchObjectData(const Alembic::Abc::ISampleSelector &sample_sel);
 
   struct Mesh *read_mesh(struct Mesh *existing_mesh,
                          const Alembic::Abc::ISampleSelector &sample_sel,
@@ -62,6 +62,8 @@
 #include "BLI_math.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
+#include "BLI_threads.h"
 
 #include "WM_api.h"
 #include "WM_types.h"
@@ -449,7 +451,8 @@ static void import_startjob(void *user_data, short *stop, short *do_update, floa
 
   WM_set_locked_interface(data->wm, true);
 
-  ArchiveReader *archive = new ArchiveReader(data->bmain, data->filename);
+  ArchiveReader *archive = new ArchiveReader(
+      data->bmain, data->filename, BLI_system_thread_count());
 
   if (!archive->valid()) {
     data->error_code = ABC_ARCHIVE_FAIL;
@@ -490,6 +493,30 @@ static void import_startjob(void *user_data, short *stop, short *do_update, floa
   *data->do_update = true;
   *data->progress = 0.1f;
 
+  /* Read the object data in parallel, Main is not thread-safe so the IDs are created afterwards
+   * on this thread. */
+  ISampleSelector sample_sel(0.0f);
+  blender::parallel_for(
+      blender::IndexRange(data->readers.size()), 1, [&](blender::IndexRange range) {
+        for (const int64_t index : range) {
+          if (G.is_break) {
+            return;
+          }
+          AbcObjectReader *reader = data->readers[index];
+          if (reader->valid()) {
+            reader->prefetchObjectData(sample_sel);
+          }
+        }
+      });
+
+  if (G.is_break) {
+    data->was_cancelled = true;
+    return;
+  }
+
+  *data->do_update = true;
+  *data->progress = 0.3f;
+
   /* Create objects and set scene frame range. */
 
   const float size = static_cast<float>(data->readers.size());
@@ -498,7 +525,6 @@ static void import_startjob(void *user_data, short *stop, short *do_update, floa
   chrono_t min_time = std::numeric_limits<chrono_t>::max();
   chrono_t max_time = std::numeric_limits<chrono_t>::min();
 
-  ISampleSelector sample_sel(0.0f);
   std::vector<AbcObjectReader *>::iterator iter;
   for (iter = data->readers.begin(); iter != data->readers.end(); ++iter) {
     AbcObjectReader *reader = *iter;
@@ -514,7 +540,7 @@ static void import_startjob(void *user_data, short *stop, short *do_update, floa
                 << " is invalid.\n";
     }
 
-    *data->progress = 0.1f + 0.3f * (++i / size);
+    *data->progress = 0.3f + 0.1f * (++i / size);
     *data->do_update = true;
 
     if (G.is_break) {
@@ -130,7 +130,7 @@ typedef struct ClothSimSettings {
   int preroll DNA_DEPRECATED;
   /** In percent!; if tearing enabled, a spring will get cut. */
   int maxspringlen;
-  /** Which solver should be used? txold. */
+  /** Linear solver for the implicit step, see #eClothSolverType. */
   short solver_type;
   /** Vertex group for scaling bending stiffness. */
   short vgroup_bend;
@@ -212,6 +212,15 @@ typedef enum {
   CLOTH_BENDING_ANGULAR = 1,
 } CLOTH_BENDING_MODEL;
 
+/* ClothSimSettings.solver_type. */
+typedef enum eClothSolverType {
+  CLOTH_SOLVER_CG = 0,
+  /* Parallel conjugate gradient on block rows of the system matrix. */
+  CLOTH_SOLVER_BLOCK_CG = 1,
+  /* Same as above, with a block Jacobi preconditioner. */
+  CLOTH_SOLVER_BLOCK_PCG = 2,
+} eClothSolverType;
+
 typedef struct ClothCollSettings {
   /** E.g. pointer to temp memory for collisions. */
   struct LinkNode *collision_list;
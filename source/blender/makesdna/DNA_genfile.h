@@ -104,6 +104,10 @@ void DNA_reconstruct_info_free(struct DNA_ReconstructInfo *reconstruct_info);
 int DNA_struct_find_nr_ex(const struct SDNA *sdna, const char *str, unsigned int *index_last);
 int DNA_struct_find_nr(const struct SDNA *sdna, const char *str);
 void DNA_struct_switch_endian(const struct SDNA *sdna, int struct_nr, char *data);
+unsigned int DNA_struct_hash_values(const struct SDNA *sdna,
+                                    int struct_nr,
+                                    const void *data,
+                                    unsigned int seed);
 const char *DNA_struct_get_compareflags(const struct SDNA *sdna, const struct SDNA *newsdna);
 void *DNA_struct_reconstruct(const struct DNA_ReconstructInfo *reconstruct_info,
                              int old_struct_nr,
@@ -143,6 +143,8 @@ typedef enum {
   eModifierFlag_OverrideLibrary_Local = (1 << 0),
   /* This modifier does not own its caches, but instead shares them with another modifier. */
   eModifierFlag_SharedCaches = (1 << 1),
+  /* Keep a copy of the result, reused while input mesh and settings stay unchanged. */
+  eModifierFlag_UseResultCache = (1 << 2),
 } ModifierFlag;
 
 /* not a real modifier */
@@ -2002,6 +2004,7 @@ typedef struct WeldModifierData {
 /* WeldModifierData->flag */
 enum {
   MOD_WELD_INVERT_VGROUP = (1 << 0),
+  MOD_WELD_SPATIAL_HASH = (1 << 1),
 };
 
 typedef struct DataTransferModifierData {
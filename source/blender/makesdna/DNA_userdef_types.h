@@ -635,7 +635,9 @@ typedef struct UserDef_Experimental {
   char use_sculpt_vertex_colors;
   char use_switch_object_operator;
   char use_sculpt_tools_tilt;
-  char _pad[7];
+  char use_undo_id_reuse;
+  char use_undo_compress;
+  char _pad[5];
   /** `makesdna` does not allow empty structs. */
 } UserDef_Experimental;
 
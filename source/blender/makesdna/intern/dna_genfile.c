@@ -35,6 +35,7 @@
 #include "MEM_guardedalloc.h" /* for MEM_freeN MEM_mallocN MEM_callocN */
 
 #include "BLI_endian_switch.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_memarena.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -1087,6 +1088,154 @@ void DNA_struct_switch_endian(const SDNA *sdna, int struct_nr, char *data)
   }
 }
 
+/** Limit for following pointers, also protects against reference cycles. */
+#define STRUCT_HASH_MAX_DEPTH 16
+
+typedef struct StructHashState {
+  BLI_HashMurmur2A mm2;
+  /** Structs currently being hashed, pointers back to these are not followed. */
+  int struct_stack[STRUCT_HASH_MAX_DEPTH];
+  int depth;
+} StructHashState;
+
+static void struct_hash_values_recursive(const SDNA *sdna,
+                                         int struct_nr,
+                                         const char *data,
+                                         StructHashState *state);
+
+static bool struct_hash_is_id(const SDNA *sdna, int struct_nr)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+  return (struct_info->members_len > 0 &&
+          STREQ(sdna->types[struct_info->members[0].type], "ID"));
+}
+
+/**
+ * Hash the data a pointer member points to. Only plain pointers to primitive types and to
+ * non-ID structs are followed, the data is expected to be allocated with guarded-alloc
+ * (as all DNA data is) so the number of elements is known.
+ */
+static void struct_hash_pointer_data(const SDNA *sdna,
+                                     const SDNA_StructMember *member,
+                                     const char *member_data,
+                                     StructHashState *state)
+{
+  const char *member_name = sdna->names[member->name];
+  /* Function pointers and pointers to pointers can't be followed. */
+  if (member_name[0] != '*' || member_name[1] == '*') {
+    return;
+  }
+
+  int substruct_nr = -1;
+  if (member->type >= SDNA_TYPE_VOID && member->type != SDNA_TYPE_INT64 &&
+      member->type != SDNA_TYPE_UINT64) {
+    substruct_nr = DNA_struct_find_nr(sdna, sdna->types[member->type]);
+    if (substruct_nr == -1 || struct_hash_is_id(sdna, substruct_nr)) {
+      /* Untyped, runtime only or ID data, owned by something else. */
+      return;
+    }
+    if (state->depth == STRUCT_HASH_MAX_DEPTH) {
+      return;
+    }
+    for (int i = 0; i < state->depth; i++) {
+      if (state->struct_stack[i] == substruct_nr) {
+        return;
+      }
+    }
+  }
+
+  const int member_array_length = sdna->names_array_len[member->name];
+  for (int a = 0; a < member_array_length; a++) {
+    const char *pointed_data = ((const char *const *)member_data)[a];
+    const bool is_set = (pointed_data != NULL);
+    BLI_hash_mm2a_add_int(&state->mm2, is_set);
+    if (!is_set) {
+      continue;
+    }
+    const size_t data_len = MEM_allocN_len(pointed_data);
+    if (substruct_nr == -1) {
+      BLI_hash_mm2a_add(&state->mm2, (const unsigned char *)pointed_data, data_len);
+      continue;
+    }
+    const size_t substruct_size = (size_t)sdna->types_size[member->type];
+    for (size_t offset = 0; offset + substruct_size <= data_len; offset += substruct_size) {
+      struct_hash_values_recursive(sdna, substruct_nr, pointed_data + offset, state);
+    }
+  }
+}
+
+static void struct_hash_values_recursive(const SDNA *sdna,
+                                         int struct_nr,
+                                         const char *data,
+                                         StructHashState *state)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+
+  if (state->depth == STRUCT_HASH_MAX_DEPTH) {
+    return;
+  }
+  state->struct_stack[state->depth++] = struct_nr;
+
+  int offset_in_bytes = 0;
+  for (int member_index = 0; member_index < struct_info->members_len; member_index++) {
+    const SDNA_StructMember *member = &struct_info->members[member_index];
+    const eStructMemberCategory member_category = get_struct_member_category(sdna, member);
+    const char *member_data = data + offset_in_bytes;
+    const int member_size = get_member_size_in_bytes(sdna, member);
+
+    switch (member_category) {
+      case STRUCT_MEMBER_CATEGORY_STRUCT: {
+        const char *member_type_name = sdna->types[member->type];
+        const int member_array_length = sdna->names_array_len[member->name];
+        const int substruct_size = sdna->types_size[member->type];
+        const int substruct_nr = DNA_struct_find_nr(sdna, member_type_name);
+        BLI_assert(substruct_nr != -1);
+        for (int a = 0; a < member_array_length; a++) {
+          struct_hash_values_recursive(
+              sdna, substruct_nr, member_data + a * substruct_size, state);
+        }
+        break;
+      }
+      case STRUCT_MEMBER_CATEGORY_PRIMITIVE: {
+        BLI_hash_mm2a_add(&state->mm2, (const unsigned char *)member_data, (size_t)member_size);
+        break;
+      }
+      case STRUCT_MEMBER_CATEGORY_POINTER: {
+        /* Pointer values change with every copy, hash the data they point to instead. */
+        struct_hash_pointer_data(sdna, member, member_data, state);
+        break;
+      }
+    }
+    offset_in_bytes += member_size;
+  }
+
+  state->depth--;
+}
+
+/**
+ * Hash the values of all members of a struct, recursing into nested structs and into the
+ * non-ID data owned through pointers (see #struct_hash_pointer_data).
+ * Padding bytes are included, callers are expected to pass zero initialized structs
+ * (as all DNA data is).
+ *
+ * \param sdna: Must be the current SDNA, since \a data is in memory.
+ * \param struct_nr: Index of struct info within sdna
+ * \param data: Struct data that is to be hashed
+ */
+unsigned int DNA_struct_hash_values(const SDNA *sdna,
+                                    int struct_nr,
+                                    const void *data,
+                                    unsigned int seed)
+{
+  StructHashState state;
+  BLI_hash_mm2a_init(&state.mm2, seed);
+  state.depth = 0;
+  if (struct_nr != -1) {
+    struct_hash_values_recursive(sdna, struct_nr, data, &state);
+  }
+  return BLI_hash_mm2a_end(&state.mm2);
+}
+
 typedef enum eReconstructStepType {
   RECONSTRUCT_STEP_MEMCPY,
   RECONSTRUCT_STEP_CAST_PRIMITIVE,
@@ -101,6 +101,7 @@ const EnumPropertyItem rna_enum_id_type_items[] = {
 #  include "BKE_lib_query.h"
 #  include "BKE_lib_remap.h"
 #  include "BKE_library.h"
+#  include "BKE_main.h"
 #  include "BKE_material.h"
 
 #  include "DEG_depsgraph.h"
@@ -149,9 +150,17 @@ int rna_ID_name_length(PointerRNA *ptr)
 void rna_ID_name_set(PointerRNA *ptr, const char *value)
 {
   ID *id = (ID *)ptr->data;
-  BLI_strncpy_utf8(id->name + 2, value, sizeof(id->name) - 2);
   BLI_assert(BKE_id_is_in_global_main(id));
-  BLI_libblock_ensure_unique_name(G_MAIN, id->name);
+  if (ID_IS_LINKED(id)) {
+    BLI_strncpy_utf8(id->name + 2, value, sizeof(id->name) - 2);
+  }
+  else {
+    char name[MAX_ID_NAME - 2];
+    BLI_strncpy_utf8(name, value, sizeof(name));
+    /* Only updates the entry of this ID in the name index. */
+    BKE_libblock_rename(G_MAIN, id, name);
+  }
+  G_MAIN->is_memfile_undo_written = false;
 
   if (GS(id->name) == ID_OB) {
     Object *ob = (Object *)id;
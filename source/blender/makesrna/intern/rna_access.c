@@ -4828,7 +4828,12 @@ int RNA_property_collection_raw_set(ReportList *reports,
                                     RawPropertyType type,
                                     int len)
 {
-  return rna_raw_access(reports, ptr, prop, propname, array, type, len, 1);
+  const int ok = rna_raw_access(reports, ptr, prop, propname, array, type, len, 1);
+  if (ok) {
+    /* Raw access skips property updates, callers tag for re-evaluation themselves. */
+    DEG_id_tag_undo_changed(ptr->owner_id);
+  }
+  return ok;
 }
 
 /* Standard iterator functions */
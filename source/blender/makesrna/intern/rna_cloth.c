@@ -543,6 +543,35 @@ static void rna_def_cloth_solver_result(BlenderRNA *brna)
   RNA_def_property_clear_flag(prop, PROP_EDITABLE);
   RNA_def_property_ui_text(prop, "Average Iterations", "Average iterations during substeps");
 
+  prop = RNA_def_property(srna, "collision_broadphase_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "collision_broadphase_time");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision Broad Phase Time",
+                           "Time spent finding overlapping triangles during substeps, in seconds");
+
+  prop = RNA_def_property(srna, "collision_narrowphase_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "collision_narrowphase_time");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision Narrow Phase Time",
+                           "Time spent computing contacts during substeps, in seconds");
+
+  prop = RNA_def_property(srna, "collision_response_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "collision_response_time");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Collision Response Time",
+                           "Time spent resolving contacts during substeps, in seconds");
+
+  prop = RNA_def_property(srna, "self_overlap_reuse_count", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "self_overlap_reuse_count");
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop,
+      "Reused Self Collision Overlaps",
+      "Number of substeps which reused the self collision overlaps of an earlier substep");
+
   RNA_define_verify_sdna(1);
 }
 
@@ -561,6 +590,23 @@ static void rna_def_cloth_sim_settings(BlenderRNA *brna)
       {0, NULL, 0, NULL, NULL},
   };
 
+  static const EnumPropertyItem prop_solver_type_items[] = {
+      {CLOTH_SOLVER_CG, "CG", 0, "Conjugate Gradient", "Single threaded conjugate gradient"},
+      {CLOTH_SOLVER_BLOCK_CG,
+       "BLOCK_CG",
+       0,
+       "Block Conjugate Gradient",
+       "Multi-threaded conjugate gradient on the block rows of the system, faster on dense "
+       "meshes"},
+      {CLOTH_SOLVER_BLOCK_PCG,
+       "BLOCK_PCG",
+       0,
+       "Block Preconditioned",
+       "Multi-threaded conjugate gradient with a block Jacobi preconditioner, fewer iterations "
+       "for cloth with large differences in mass or stiffness"},
+      {0, NULL, 0, NULL, NULL},
+  };
+
   srna = RNA_def_struct(brna, "ClothSettings", NULL);
   RNA_def_struct_ui_text(srna, "Cloth Settings", "Cloth simulation settings for an object");
   RNA_def_struct_sdna(srna, "ClothSimSettings");
@@ -874,6 +920,14 @@ static void rna_def_cloth_sim_settings(BlenderRNA *brna)
   RNA_def_property_update(prop, 0, "rna_cloth_update");
   RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
 
+  prop = RNA_def_property(srna, "solver_type", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "solver_type");
+  RNA_def_property_enum_items(prop, prop_solver_type_items);
+  RNA_def_property_ui_text(
+      prop, "Solver", "Linear solver used to compute the velocity change of each step");
+  RNA_def_property_update(prop, 0, "rna_cloth_update");
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+
   prop = RNA_def_property(srna, "use_internal_springs", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flags", CLOTH_SIMSETTINGS_FLAG_INTERNAL_SPRINGS);
   RNA_def_property_ui_text(prop,
@@ -6178,6 +6178,19 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "use_sculpt_tools_tilt", 1);
   RNA_def_property_ui_text(
       prop, "Sculpt Mode Tilt Support", "Support for pen tablet tilt events in Sculpt Mode");
+
+  prop = RNA_def_property(srna, "use_undo_id_reuse", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_undo_id_reuse", 1);
+  RNA_def_property_ui_text(prop,
+                           "Undo Skip Unchanged Data-Blocks",
+                           "Only write data-blocks tagged as changed when storing global undo "
+                           "steps, re-use the stored data of all others");
+
+  prop = RNA_def_property(srna, "use_undo_compress", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_undo_compress", 1);
+  RNA_def_property_ui_text(prop,
+                           "Undo Compression",
+                           "Compress the memory of older global undo steps in the background");
 }
 
 static void rna_def_userdef_addon_collection(BlenderRNA *brna, PropertyRNA *cprop)
@@ -37,8 +37,10 @@
 
 #include "BLI_alloca.h"
 #include "BLI_bitmap.h"
+#include "BLI_hash.h"
 #include "BLI_kdtree.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -464,6 +466,66 @@ static void weld_vert_groups_setup(const uint mvert_len,
 /** \name Weld Edge API
  * \{ */
 
+struct WeldEdgeOverlapData {
+  const struct WeldGroup *v_links;
+  const uint *link_edge_buffer;
+  WeldEdge *wedge;
+  uint *edge_dest_map;
+};
+
+/**
+ * Edges connecting the same pair of vertices are merged into the one with the lowest index.
+ * Only the tested edge is written, so all edges can be tested in parallel.
+ */
+static void weld_edge_overlap_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldEdgeOverlapData *data = userdata;
+  WeldEdge *we = &data->wedge[i];
+  if (we->edge_dest != OUT_OF_CONTEXT) {
+    /* Collapsed edge. */
+    return;
+  }
+
+  const struct WeldGroup *link_a = &data->v_links[we->vert_a];
+  const struct WeldGroup *link_b = &data->v_links[we->vert_b];
+  uint edges_len_a = link_a->len;
+  uint edges_len_b = link_b->len;
+  if (edges_len_a <= 1 || edges_len_b <= 1) {
+    return;
+  }
+
+  /* Both lists are sorted and both contain this edge,
+   * so the first edge they share is the lowest index edge connecting the same vertices. */
+  const uint *edges_ctx_a = &data->link_edge_buffer[link_a->ofs];
+  const uint *edges_ctx_b = &data->link_edge_buffer[link_b->ofs];
+  while (edges_len_a && edges_len_b) {
+    const uint e_ctx_a = *edges_ctx_a;
+    const uint e_ctx_b = *edges_ctx_b;
+    if (e_ctx_a < e_ctx_b) {
+      edges_ctx_a++;
+      edges_len_a--;
+    }
+    else if (e_ctx_b < e_ctx_a) {
+      edges_ctx_b++;
+      edges_len_b--;
+    }
+    else {
+      if (e_ctx_a != (uint)i) {
+        BLI_assert(e_ctx_a < (uint)i);
+        const WeldEdge *we_dst = &data->wedge[e_ctx_a];
+        BLI_assert(ELEM(we_dst->vert_a, we->vert_a, we->vert_b));
+        BLI_assert(ELEM(we_dst->vert_b, we->vert_a, we->vert_b));
+        data->edge_dest_map[we->edge_orig] = we_dst->edge_orig;
+        we->edge_dest = we_dst->edge_orig;
+      }
+      return;
+    }
+  }
+  BLI_assert(!"Edge not found in the links of its own vertices");
+}
+
 static void weld_edge_ctx_setup(const uint mvert_len,
                                 const uint wedge_len,
                                 struct WeldGroup *r_vlinks,
@@ -526,54 +588,21 @@ static void weld_edge_ctx_setup(const uint mvert_len,
       vl_iter->ofs -= vl_iter->len;
     }
 
-    we = &r_wedge[0];
-    for (uint i = 0; i < wedge_len; i++, we++) {
-      if (we->edge_dest != OUT_OF_CONTEXT) {
-        /* No need to retest edges.
-         * (Already includes collapsed edges). */
-        continue;
-      }
-
-      uint dst_vert_a = we->vert_a;
-      uint dst_vert_b = we->vert_b;
-
-      struct WeldGroup *link_a = &v_links[dst_vert_a];
-      struct WeldGroup *link_b = &v_links[dst_vert_b];
-
-      uint edges_len_a = link_a->len;
-      uint edges_len_b = link_b->len;
-
-      if (edges_len_a <= 1 || edges_len_b <= 1) {
-        continue;
-      }
-
-      uint *edges_ctx_a = &link_edge_buffer[link_a->ofs];
-      uint *edges_ctx_b = &link_edge_buffer[link_b->ofs];
-      uint edge_orig = we->edge_orig;
+    struct WeldEdgeOverlapData data = {
+        .v_links = v_links,
+        .link_edge_buffer = link_edge_buffer,
+        .wedge = r_wedge,
+        .edge_dest_map = r_edge_dest_map,
+    };
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, wedge_len, &data, weld_edge_overlap_cb, &settings);
 
-      for (; edges_len_a--; edges_ctx_a++) {
-        uint e_ctx_a = *edges_ctx_a;
-        if (e_ctx_a == i) {
-          continue;
-        }
-        while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-          edges_ctx_b++;
-          edges_len_b--;
-        }
-        if (edges_len_b == 0) {
-          break;
-        }
-        uint e_ctx_b = *edges_ctx_b;
-        if (e_ctx_a == e_ctx_b) {
-          WeldEdge *we_b = &r_wedge[e_ctx_b];
-          BLI_assert(ELEM(we_b->vert_a, dst_vert_a, dst_vert_b));
-          BLI_assert(ELEM(we_b->vert_b, dst_vert_a, dst_vert_b));
-          BLI_assert(we_b->edge_dest == OUT_OF_CONTEXT);
-          BLI_assert(we_b->edge_orig != edge_orig);
-          r_edge_dest_map[we_b->edge_orig] = edge_orig;
-          we_b->edge_dest = edge_orig;
-          edge_kill_len++;
-        }
+    we = &r_wedge[0];
+    for (uint i = wedge_len; i--; we++) {
+      if (we->edge_dest != OUT_OF_CONTEXT && we->flag != ELEM_COLLAPSED) {
+        edge_kill_len++;
       }
     }
 
@@ -1068,6 +1097,84 @@ static void weld_poly_split_recursive(const uint *vert_dest_map,
   }
 }
 
+struct WeldPolyOverlapData {
+  WeldPoly *wpoly;
+  const WeldLoop *wloop;
+  const MLoop *mloop;
+  const uint *loop_map;
+  const struct WeldGroup *v_links;
+  const uint *link_poly_buffer;
+};
+
+/**
+ * Polygons using the same vertices are merged into the one with the lowest index.
+ * Only the tested polygon is written, so all polygons can be tested in parallel.
+ */
+static void weld_poly_overlap_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldPolyOverlapData *data = userdata;
+  const uint *link_poly_buffer = data->link_poly_buffer;
+  const struct WeldGroup *v_links = data->v_links;
+  WeldPoly *wp = &data->wpoly[i];
+
+  WeldLoopOfPolyIter iter;
+  if (!weld_iter_loop_of_poly_begin(&iter, wp, data->wloop, data->mloop, data->loop_map, NULL)) {
+    /* Collapsed polygon. */
+    return;
+  }
+  weld_iter_loop_of_poly_next(&iter);
+  const struct WeldGroup *link_a = &v_links[iter.v];
+  uint polys_len_a = link_a->len;
+  if (polys_len_a == 1) {
+    BLI_assert(link_poly_buffer[link_a->ofs] == (uint)i);
+    return;
+  }
+  const uint wp_len = wp->len;
+  const uint *polys_ctx_a = &link_poly_buffer[link_a->ofs];
+  for (; polys_len_a--; polys_ctx_a++) {
+    const uint p_ctx_a = *polys_ctx_a;
+    if (p_ctx_a >= (uint)i) {
+      /* Sorted, only lower index polygons are merge targets. */
+      break;
+    }
+
+    const WeldPoly *wp_tmp = &data->wpoly[p_ctx_a];
+    if (wp_tmp->len != wp_len) {
+      continue;
+    }
+
+    /* Check that all other vertices are used by the candidate too. */
+    uint polys_len_b = 0;
+    WeldLoopOfPolyIter iter_b = iter;
+    while (weld_iter_loop_of_poly_next(&iter_b)) {
+      const struct WeldGroup *link_b = &v_links[iter_b.v];
+      polys_len_b = link_b->len;
+      const uint *polys_ctx_b = &link_poly_buffer[link_b->ofs];
+      for (; polys_len_b; polys_len_b--, polys_ctx_b++) {
+        const uint p_ctx_b = *polys_ctx_b;
+        if (p_ctx_b < p_ctx_a) {
+          continue;
+        }
+        if (p_ctx_b > p_ctx_a) {
+          polys_len_b = 0;
+        }
+        break;
+      }
+      if (polys_len_b == 0) {
+        break;
+      }
+    }
+    if (polys_len_b == 0) {
+      continue;
+    }
+    BLI_assert(wp_tmp != wp);
+    wp->poly_dst = wp_tmp->poly_orig;
+    return;
+  }
+}
+
 static void weld_poly_loop_ctx_setup(const MLoop *mloop,
 #ifdef USE_WELD_DEBUG
                                      const MPoly *mpoly,
@@ -1207,75 +1314,23 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
         vl_iter->ofs -= vl_iter->len;
       }
 
-      uint polys_len_a, polys_len_b, *polys_ctx_a, *polys_ctx_b, p_ctx_a, p_ctx_b;
-      polys_len_b = p_ctx_b = 0; /* silence warnings */
+      struct WeldPolyOverlapData data = {
+          .wpoly = wpoly,
+          .wloop = wloop,
+          .mloop = mloop,
+          .loop_map = loop_map,
+          .v_links = v_links,
+          .link_poly_buffer = link_poly_buffer,
+      };
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.min_iter_per_thread = 1024;
+      BLI_task_parallel_range(0, wpoly_and_new_len, &data, weld_poly_overlap_cb, &settings);
 
       wp = &wpoly[0];
-      for (uint i = 0; i < wpoly_and_new_len; i++, wp++) {
-        if (wp->poly_dst != OUT_OF_CONTEXT) {
-          /* No need to retest poly.
-           * (Already includes collapsed polygons). */
-          continue;
-        }
-
-        WeldLoopOfPolyIter iter;
-        weld_iter_loop_of_poly_begin(&iter, wp, wloop, mloop, loop_map, NULL);
-        weld_iter_loop_of_poly_next(&iter);
-        struct WeldGroup *link_a = &v_links[iter.v];
-        polys_len_a = link_a->len;
-        if (polys_len_a == 1) {
-          BLI_assert(link_poly_buffer[link_a->ofs] == i);
-          continue;
-        }
-        uint wp_len = wp->len;
-        polys_ctx_a = &link_poly_buffer[link_a->ofs];
-        for (; polys_len_a--; polys_ctx_a++) {
-          p_ctx_a = *polys_ctx_a;
-          if (p_ctx_a == i) {
-            continue;
-          }
-
-          WeldPoly *wp_tmp = &wpoly[p_ctx_a];
-          if (wp_tmp->len != wp_len) {
-            continue;
-          }
-
-          WeldLoopOfPolyIter iter_b = iter;
-          while (weld_iter_loop_of_poly_next(&iter_b)) {
-            struct WeldGroup *link_b = &v_links[iter_b.v];
-            polys_len_b = link_b->len;
-            if (polys_len_b == 1) {
-              BLI_assert(link_poly_buffer[link_b->ofs] == i);
-              polys_len_b = 0;
-              break;
-            }
-
-            polys_ctx_b = &link_poly_buffer[link_b->ofs];
-            for (; polys_len_b; polys_len_b--, polys_ctx_b++) {
-              p_ctx_b = *polys_ctx_b;
-              if (p_ctx_b < p_ctx_a) {
-                continue;
-              }
-              if (p_ctx_b >= p_ctx_a) {
-                if (p_ctx_b > p_ctx_a) {
-                  polys_len_b = 0;
-                }
-                break;
-              }
-            }
-            if (polys_len_b == 0) {
-              break;
-            }
-          }
-          if (polys_len_b == 0) {
-            continue;
-          }
-          BLI_assert(p_ctx_a > i);
-          BLI_assert(p_ctx_a == p_ctx_b);
-          BLI_assert(wp_tmp->poly_dst == OUT_OF_CONTEXT);
-          BLI_assert(wp_tmp != wp);
-          wp_tmp->poly_dst = wp->poly_orig;
-          loop_kill_len += wp_tmp->len;
+      for (uint i = wpoly_and_new_len; i--; wp++) {
+        if (wp->poly_dst != OUT_OF_CONTEXT && wp->flag != ELEM_COLLAPSED) {
+          loop_kill_len += wp->len;
           poly_kill_len++;
         }
       }
@@ -1545,10 +1600,481 @@ static void customdata_weld(
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Weld Result
+ *
+ * The result mesh is filled in parallel. Destination indices are computed first with a prefix
+ * sum over the source elements, so every source element (or block of them) knows where to
+ * write its data independently of the others.
+ * \{ */
+
+#define WELD_RESULT_BLOCK_SIZE 1024
+
+struct WeldResultData {
+  const Mesh *mesh;
+  Mesh *result;
+  const WeldMesh *weld_mesh;
+
+  /* Group map of source vertices and edges (see #weld_vert_groups_setup). */
+  const uint *vert_groups_map;
+  const uint *edge_groups_map;
+  /* Index of source vertices and edges in the result, #ELEM_MERGED if they are merged. */
+  const uint *vert_final;
+  const uint *edge_final;
+  /* Result polygon index and loop start, per source polygon followed by new polygons,
+   * #OUT_OF_CONTEXT if the polygon is removed. */
+  const uint *poly_final;
+  const uint *poly_loop_start;
+};
+
+static void weld_result_verts_cb(void *__restrict userdata,
+                                 const int block,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultData *data = userdata;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const uint totvert = (uint)data->mesh->totvert;
+  const uint start = (uint)block * WELD_RESULT_BLOCK_SIZE;
+  const uint end = MIN2(start + WELD_RESULT_BLOCK_SIZE, totvert);
+
+  for (uint i = start; i < end; i++) {
+    const uint group_index = data->vert_groups_map[i];
+    if (group_index == OUT_OF_CONTEXT) {
+      /* Unaffected vertices are consecutive in the result too, copy them at once. */
+      uint count = 1;
+      while (i + count < end && data->vert_groups_map[i + count] == OUT_OF_CONTEXT) {
+        count++;
+      }
+      CustomData_copy_data(
+          &data->mesh->vdata, &data->result->vdata, i, data->vert_final[i], count);
+      i += count - 1;
+    }
+    else if (group_index != ELEM_MERGED) {
+      const struct WeldGroup *wgroup = &weld_mesh->vert_groups[group_index];
+      customdata_weld(&data->mesh->vdata,
+                      &data->result->vdata,
+                      &weld_mesh->vert_groups_buffer[wgroup->ofs],
+                      wgroup->len,
+                      data->vert_final[i]);
+    }
+  }
+}
+
+static void weld_result_edges_cb(void *__restrict userdata,
+                                 const int block,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultData *data = userdata;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const uint *vert_final = data->vert_final;
+  const uint totedge = (uint)data->mesh->totedge;
+  const uint start = (uint)block * WELD_RESULT_BLOCK_SIZE;
+  const uint end = MIN2(start + WELD_RESULT_BLOCK_SIZE, totedge);
+
+  for (uint i = start; i < end; i++) {
+    const uint group_index = data->edge_groups_map[i];
+    if (group_index == OUT_OF_CONTEXT) {
+      uint count = 1;
+      while (i + count < end && data->edge_groups_map[i + count] == OUT_OF_CONTEXT) {
+        count++;
+      }
+      const uint dest_index = data->edge_final[i];
+      CustomData_copy_data(&data->mesh->edata, &data->result->edata, i, dest_index, count);
+      MEdge *me = &data->result->medge[dest_index];
+      for (uint j = count; j--; me++) {
+        me->v1 = vert_final[me->v1];
+        me->v2 = vert_final[me->v2];
+      }
+      i += count - 1;
+    }
+    else if (group_index != ELEM_MERGED) {
+      const uint dest_index = data->edge_final[i];
+      const struct WeldGroupEdge *wegrp = &weld_mesh->edge_groups[group_index];
+      customdata_weld(&data->mesh->edata,
+                      &data->result->edata,
+                      &weld_mesh->edge_groups_buffer[wegrp->group.ofs],
+                      wegrp->group.len,
+                      dest_index);
+      MEdge *me = &data->result->medge[dest_index];
+      me->v1 = vert_final[wegrp->v1];
+      me->v2 = vert_final[wegrp->v2];
+      /* Cleared when used by a polygon, see #weld_result_loose_edges_update. */
+      me->flag |= ME_LOOSEEDGE;
+    }
+  }
+}
+
+struct WeldPolyLenData {
+  const Mesh *mesh;
+  const WeldMesh *weld_mesh;
+  uint *r_poly_len;
+};
+
+/* Polygon of the weld context, or NULL for unaffected polygons. */
+static const WeldPoly *weld_result_wpoly_get(const WeldMesh *weld_mesh,
+                                             const uint totpoly,
+                                             const uint i)
+{
+  if (i >= totpoly) {
+    return &weld_mesh->wpoly_new[i - totpoly];
+  }
+  const uint poly_ctx = weld_mesh->poly_map[i];
+  return (poly_ctx == OUT_OF_CONTEXT) ? NULL : &weld_mesh->wpoly[poly_ctx];
+}
+
+/**
+ * Number of loops of a polygon in the result, zero when the polygon is removed.
+ * Called for the source polygons followed by the new ones.
+ */
+static void weld_result_poly_len_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldPolyLenData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  uint *r_poly_len = data->r_poly_len;
+
+  const WeldPoly *wp = weld_result_wpoly_get(weld_mesh, (uint)mesh->totpoly, (uint)i);
+  if (wp == NULL) {
+    r_poly_len[i] = (uint)mesh->mpoly[i].totloop;
+    return;
+  }
+
+  uint len = 0;
+  WeldLoopOfPolyIter iter;
+  if (weld_iter_loop_of_poly_begin(
+          &iter, wp, weld_mesh->wloop, mesh->mloop, weld_mesh->loop_map, NULL) &&
+      (wp->poly_dst == OUT_OF_CONTEXT)) {
+    while (weld_iter_loop_of_poly_next(&iter)) {
+      len++;
+    }
+  }
+  r_poly_len[i] = len;
+}
+
+static void weld_result_polys_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict tls)
+{
+  const struct WeldResultData *data = userdata;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const uint totpoly = (uint)mesh->totpoly;
+
+  const uint r_i = data->poly_final[i];
+  if (r_i == OUT_OF_CONTEXT) {
+    return;
+  }
+
+  const uint *vert_final = data->vert_final;
+  const uint *edge_final = data->edge_final;
+  const uint loop_start = data->poly_loop_start[i];
+  uint loop_cur = loop_start;
+  MLoop *r_ml = &result->mloop[loop_start];
+
+  const WeldPoly *wp = weld_result_wpoly_get(weld_mesh, totpoly, (uint)i);
+  if (wp == NULL) {
+    const MPoly *mp = &mesh->mpoly[i];
+    uint mp_loop_len = mp->totloop;
+    CustomData_copy_data(&mesh->ldata, &result->ldata, mp->loopstart, loop_cur, mp_loop_len);
+    loop_cur += mp_loop_len;
+    for (; mp_loop_len--; r_ml++) {
+      r_ml->v = vert_final[r_ml->v];
+      r_ml->e = edge_final[r_ml->e];
+    }
+  }
+  else {
+    /* Each thread has its own buffer, of #WeldMesh.max_poly_len. */
+    uint *group_buffer = tls->userdata_chunk;
+    WeldLoopOfPolyIter iter;
+    weld_iter_loop_of_poly_begin(
+        &iter, wp, weld_mesh->wloop, mesh->mloop, weld_mesh->loop_map, group_buffer);
+    while (weld_iter_loop_of_poly_next(&iter)) {
+      customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
+      r_ml->v = vert_final[iter.v];
+      r_ml->e = edge_final[iter.e];
+      r_ml++;
+      loop_cur++;
+    }
+  }
+
+  if ((uint)i < totpoly) {
+    CustomData_copy_data(&mesh->pdata, &result->pdata, i, r_i, 1);
+  }
+  MPoly *r_mp = &result->mpoly[r_i];
+  r_mp->loopstart = loop_start;
+  r_mp->totloop = loop_cur - loop_start;
+}
+
+/**
+ * Edges created by merging are flagged as loose until a polygon is found using them.
+ * Done separately from filling the polygons, as polygons sharing edges run in parallel.
+ */
+static void weld_result_loose_edges_update(Mesh *result)
+{
+  const MLoop *ml = result->mloop;
+  MEdge *medge = result->medge;
+  for (int i = result->totloop; i--; ml++) {
+    medge[ml->e].flag &= ~ME_LOOSEEDGE;
+  }
+}
+
+static Mesh *weld_result_create(const Mesh *mesh, WeldMesh *weld_mesh, const uint *vert_groups_map)
+{
+  const uint totvert = (uint)mesh->totvert;
+  const uint totedge = (uint)mesh->totedge;
+  const uint totloop = (uint)mesh->totloop;
+  const uint totpoly = (uint)mesh->totpoly;
+  const uint wpoly_new_len = weld_mesh->wpoly_new_len;
+  const uint poly_and_new_len = totpoly + wpoly_new_len;
+
+  const int result_nverts = totvert - weld_mesh->vert_kill_len;
+  const int result_nedges = totedge - weld_mesh->edge_kill_len;
+  const int result_nloops = totloop - weld_mesh->loop_kill_len;
+  const int result_npolys = totpoly - weld_mesh->poly_kill_len + wpoly_new_len;
+
+  Mesh *result = BKE_mesh_new_nomain_from_template(
+      mesh, result_nverts, result_nedges, 0, result_nloops, result_npolys);
+
+  /* Destination indices of vertices and edges. */
+
+  uint *vert_final = MEM_malloc_arrayN(totvert, sizeof(*vert_final), __func__);
+  uint dest_index = 0;
+  for (uint i = 0; i < totvert; i++) {
+    vert_final[i] = (vert_groups_map[i] == ELEM_MERGED) ? ELEM_MERGED : dest_index++;
+  }
+  BLI_assert(dest_index == (uint)result_nverts);
+
+  const uint *edge_groups_map = weld_mesh->edge_groups_map;
+  uint *edge_final = MEM_malloc_arrayN(totedge, sizeof(*edge_final), __func__);
+  dest_index = 0;
+  for (uint i = 0; i < totedge; i++) {
+    edge_final[i] = ELEM(edge_groups_map[i], ELEM_MERGED, ELEM_COLLAPSED) ? ELEM_MERGED :
+                                                                             dest_index++;
+  }
+  BLI_assert(dest_index == (uint)result_nedges);
+
+  /* Destination indices and loop starts of polygons. */
+
+  uint *poly_final = MEM_malloc_arrayN(poly_and_new_len, sizeof(*poly_final), __func__);
+  uint *poly_loop_start = MEM_malloc_arrayN(poly_and_new_len, sizeof(*poly_loop_start), __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  /* Store the polygon lengths in `poly_loop_start`, converted to offsets below. */
+  struct WeldPolyLenData poly_len_data = {
+      .mesh = mesh,
+      .weld_mesh = weld_mesh,
+      .r_poly_len = poly_loop_start,
+  };
+  BLI_task_parallel_range(0, poly_and_new_len, &poly_len_data, weld_result_poly_len_cb, &settings);
+
+  uint poly_dest_index = 0;
+  uint loop_dest_index = 0;
+  for (uint i = 0; i < poly_and_new_len; i++) {
+    const uint poly_len = poly_loop_start[i];
+    if (poly_len == 0) {
+      poly_final[i] = OUT_OF_CONTEXT;
+    }
+    else {
+      poly_final[i] = poly_dest_index++;
+    }
+    poly_loop_start[i] = loop_dest_index;
+    loop_dest_index += poly_len;
+  }
+  BLI_assert(poly_dest_index == (uint)result_npolys);
+  BLI_assert(loop_dest_index == (uint)result_nloops);
+
+  /* Fill. */
+
+  struct WeldResultData data = {
+      .mesh = mesh,
+      .result = result,
+      .weld_mesh = weld_mesh,
+      .vert_groups_map = vert_groups_map,
+      .edge_groups_map = edge_groups_map,
+      .vert_final = vert_final,
+      .edge_final = edge_final,
+      .poly_final = poly_final,
+      .poly_loop_start = poly_loop_start,
+  };
+
+  TaskParallelSettings block_settings;
+  BLI_parallel_range_settings_defaults(&block_settings);
+  BLI_task_parallel_range(0,
+                          (int)divide_ceil_u(totvert, WELD_RESULT_BLOCK_SIZE),
+                          &data,
+                          weld_result_verts_cb,
+                          &block_settings);
+  BLI_task_parallel_range(0,
+                          (int)divide_ceil_u(totedge, WELD_RESULT_BLOCK_SIZE),
+                          &data,
+                          weld_result_edges_cb,
+                          &block_settings);
+
+  uint *group_buffer = BLI_array_alloca(group_buffer, weld_mesh->max_poly_len);
+  TaskParallelSettings poly_settings;
+  BLI_parallel_range_settings_defaults(&poly_settings);
+  poly_settings.min_iter_per_thread = 1024;
+  poly_settings.userdata_chunk = group_buffer;
+  poly_settings.userdata_chunk_size = sizeof(*group_buffer) * weld_mesh->max_poly_len;
+  BLI_task_parallel_range(0, poly_and_new_len, &data, weld_result_polys_cb, &poly_settings);
+
+  weld_result_loose_edges_update(result);
+
+  MEM_freeN(vert_final);
+  MEM_freeN(edge_final);
+  MEM_freeN(poly_final);
+  MEM_freeN(poly_loop_start);
+
+  /* is this needed? */
+  /* recalculate normals */
+  result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+
+  return result;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Weld Modifier Main
  * \{ */
 
+/* Cells of the spatial hash are addressed with this many bits per axis. */
+#define WELD_HASH_CELL_BITS 21
+
+BLI_INLINE uint weld_hash_cell(const int cell[3])
+{
+  return BLI_hash_int_2d(BLI_hash_int_2d((uint)cell[0], (uint)cell[1]), (uint)cell[2]);
+}
+
+BLI_INLINE void weld_hash_cell_calc(const float co[3],
+                                    const float min[3],
+                                    const float cell_size_inv,
+                                    int r_cell[3])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    r_cell[axis] = (int)((co[axis] - min[axis]) * cell_size_inv);
+  }
+}
+
+/**
+ * Alternative to #BLI_kdtree_3d_calc_duplicates_fast, finding the vertices to merge with a
+ * spatial hash, with cells the size of the merge distance.
+ *
+ * Vertices are searched in index order: each vertex not merged yet takes all vertices
+ * in range which are not merged yet. The result uses the same convention as the KD-tree:
+ * #OUT_OF_CONTEXT for vertices that are not merged, the target index otherwise.
+ *
+ * \return The number of merged vertices, or -1 when the coordinates span too many cells
+ * to be hashed (the KD-tree should be used then).
+ */
+static int weld_vert_dest_map_calc_spatial_hash(const MVert *mvert,
+                                                const uint totvert,
+                                                const BLI_bitmap *v_mask,
+                                                const float merge_dist,
+                                                uint *r_vert_dest_map)
+{
+  if (merge_dist <= 0.0f) {
+    return -1;
+  }
+
+  float min[3], max[3];
+  INIT_MINMAX(min, max);
+  uint hash_len = 0;
+  for (uint i = 0; i < totvert; i++) {
+    if (!v_mask || BLI_BITMAP_TEST(v_mask, i)) {
+      minmax_v3v3_v3(min, max, mvert[i].co);
+      hash_len++;
+    }
+    r_vert_dest_map[i] = OUT_OF_CONTEXT;
+  }
+  if (hash_len == 0) {
+    return 0;
+  }
+
+  /* Slightly bigger than the merge distance, so rounding can't put vertices in range further
+   * than one cell apart. */
+  const float cell_size = merge_dist * 1.001f;
+  const float cell_size_inv = 1.0f / cell_size;
+  for (int axis = 0; axis < 3; axis++) {
+    if ((max[axis] - min[axis]) * cell_size_inv >= (float)((1 << WELD_HASH_CELL_BITS) - 2)) {
+      return -1;
+    }
+  }
+
+  /* Vertices sorted by bucket, with a prefix sum of the bucket sizes. */
+  const uint buckets_len = power_of_2_max_u(hash_len);
+  const uint buckets_mask = buckets_len - 1;
+  uint *bucket_ofs = MEM_calloc_arrayN(buckets_len + 1, sizeof(*bucket_ofs), __func__);
+  uint *vert_bucket = MEM_malloc_arrayN(totvert, sizeof(*vert_bucket), __func__);
+  for (uint i = 0; i < totvert; i++) {
+    if (!v_mask || BLI_BITMAP_TEST(v_mask, i)) {
+      int cell[3];
+      weld_hash_cell_calc(mvert[i].co, min, cell_size_inv, cell);
+      vert_bucket[i] = weld_hash_cell(cell) & buckets_mask;
+      bucket_ofs[vert_bucket[i] + 1]++;
+    }
+  }
+  for (uint i = 0; i < buckets_len; i++) {
+    bucket_ofs[i + 1] += bucket_ofs[i];
+  }
+  uint *bucket_verts = MEM_malloc_arrayN(hash_len, sizeof(*bucket_verts), __func__);
+  uint *bucket_fill = MEM_dupallocN(bucket_ofs);
+  for (uint i = 0; i < totvert; i++) {
+    if (!v_mask || BLI_BITMAP_TEST(v_mask, i)) {
+      bucket_verts[bucket_fill[vert_bucket[i]]++] = i;
+    }
+  }
+  MEM_freeN(bucket_fill);
+  MEM_freeN(vert_bucket);
+
+  const float merge_dist_sq = square_f(merge_dist);
+  int found = 0;
+  for (uint i = 0; i < totvert; i++) {
+    if (v_mask && !BLI_BITMAP_TEST(v_mask, i)) {
+      continue;
+    }
+    if (!ELEM(r_vert_dest_map[i], OUT_OF_CONTEXT, i)) {
+      continue;
+    }
+    const float *co = mvert[i].co;
+    int cell[3];
+    weld_hash_cell_calc(co, min, cell_size_inv, cell);
+
+    const int found_prev = found;
+    int cell_iter[3];
+    for (cell_iter[0] = cell[0] - 1; cell_iter[0] <= cell[0] + 1; cell_iter[0]++) {
+      for (cell_iter[1] = cell[1] - 1; cell_iter[1] <= cell[1] + 1; cell_iter[1]++) {
+        for (cell_iter[2] = cell[2] - 1; cell_iter[2] <= cell[2] + 1; cell_iter[2]++) {
+          /* Different cells may share a bucket, only vertices in range are taken anyway. */
+          const uint bucket = weld_hash_cell(cell_iter) & buckets_mask;
+          for (uint j = bucket_ofs[bucket]; j < bucket_ofs[bucket + 1]; j++) {
+            const uint v_other = bucket_verts[j];
+            if ((v_other != i) && (r_vert_dest_map[v_other] == OUT_OF_CONTEXT) &&
+                (len_squared_v3v3(co, mvert[v_other].co) <= merge_dist_sq)) {
+              r_vert_dest_map[v_other] = i;
+              found++;
+            }
+          }
+        }
+      }
+    }
+    if (found != found_prev) {
+      /* Prevent chains of doubles. */
+      r_vert_dest_map[i] = i;
+    }
+  }
+
+  MEM_freeN(bucket_ofs);
+  MEM_freeN(bucket_verts);
+  return found;
+}
+
 #ifdef USE_BVHTREEKDOP
 struct WeldOverlapData {
   const MVert *mvert;
@@ -1575,13 +2101,8 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   BLI_bitmap *v_mask = NULL;
   int v_mask_act = 0;
 
-  const MVert *mvert;
-  const MLoop *mloop;
-  const MPoly *mpoly, *mp;
-  uint totvert, totedge, totloop, totpoly;
-
-  mvert = mesh->mvert;
-  totvert = mesh->totvert;
+  const MVert *mvert = mesh->mvert;
+  const uint totvert = mesh->totvert;
 
   /* Vertex Group. */
   const int defgrp_index = BKE_object_defgroup_name_index(ob, wmd->defgrp_name);
@@ -1686,7 +2207,15 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     }
   }
 #else
-  {
+  int spatial_hash_found = -1;
+  if (wmd->flag & MOD_WELD_SPATIAL_HASH) {
+    spatial_hash_found = weld_vert_dest_map_calc_spatial_hash(
+        mvert, totvert, v_mask, wmd->merge_dist, vert_dest_map);
+  }
+  if (spatial_hash_found != -1) {
+    vert_kill_len = (uint)spatial_hash_found;
+  }
+  else {
     KDTree_3d *tree = BLI_kdtree_3d_new(v_mask ? v_mask_act : totvert);
     for (uint i = 0; i < totvert; i++) {
       if (!v_mask || BLI_BITMAP_TEST(v_mask, i)) {
@@ -1710,192 +2239,7 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     WeldMesh weld_mesh;
     weld_mesh_context_create(mesh, vert_dest_map, vert_kill_len, &weld_mesh);
 
-    mloop = mesh->mloop;
-    mpoly = mesh->mpoly;
-
-    totedge = mesh->totedge;
-    totloop = mesh->totloop;
-    totpoly = mesh->totpoly;
-
-    const int result_nverts = totvert - weld_mesh.vert_kill_len;
-    const int result_nedges = totedge - weld_mesh.edge_kill_len;
-    const int result_nloops = totloop - weld_mesh.loop_kill_len;
-    const int result_npolys = totpoly - weld_mesh.poly_kill_len + weld_mesh.wpoly_new_len;
-
-    result = BKE_mesh_new_nomain_from_template(
-        mesh, result_nverts, result_nedges, 0, result_nloops, result_npolys);
-
-    /* Vertices */
-
-    uint *vert_final = vert_dest_map;
-    uint *index_iter = &vert_final[0];
-    int dest_index = 0;
-    for (uint i = 0; i < totvert; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totvert && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->vdata, &result->vdata, source_index, dest_index, count);
-        dest_index += count;
-      }
-      if (i == totvert) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroup *wgroup = &weld_mesh.vert_groups[*index_iter];
-        customdata_weld(&mesh->vdata,
-                        &result->vdata,
-                        &weld_mesh.vert_groups_buffer[wgroup->ofs],
-                        wgroup->len,
-                        dest_index);
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
-
-    BLI_assert(dest_index == result_nverts);
-
-    /* Edges */
-
-    uint *edge_final = weld_mesh.edge_groups_map;
-    index_iter = &edge_final[0];
-    dest_index = 0;
-    for (uint i = 0; i < totedge; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totedge && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->edata, &result->edata, source_index, dest_index, count);
-        MEdge *me = &result->medge[dest_index];
-        dest_index += count;
-        for (; count--; me++) {
-          me->v1 = vert_final[me->v1];
-          me->v2 = vert_final[me->v2];
-        }
-      }
-      if (i == totedge) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroupEdge *wegrp = &weld_mesh.edge_groups[*index_iter];
-        customdata_weld(&mesh->edata,
-                        &result->edata,
-                        &weld_mesh.edge_groups_buffer[wegrp->group.ofs],
-                        wegrp->group.len,
-                        dest_index);
-        MEdge *me = &result->medge[dest_index];
-        me->v1 = vert_final[wegrp->v1];
-        me->v2 = vert_final[wegrp->v2];
-        me->flag |= ME_LOOSEEDGE;
-
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
-
-    BLI_assert(dest_index == result_nedges);
-
-    /* Polys/Loops */
-
-    mp = &mpoly[0];
-    MPoly *r_mp = &result->mpoly[0];
-    MLoop *r_ml = &result->mloop[0];
-    uint r_i = 0;
-    int loop_cur = 0;
-    uint *group_buffer = BLI_array_alloca(group_buffer, weld_mesh.max_poly_len);
-    for (uint i = 0; i < totpoly; i++, mp++) {
-      int loop_start = loop_cur;
-      uint poly_ctx = weld_mesh.poly_map[i];
-      if (poly_ctx == OUT_OF_CONTEXT) {
-        uint mp_loop_len = mp->totloop;
-        CustomData_copy_data(&mesh->ldata, &result->ldata, mp->loopstart, loop_cur, mp_loop_len);
-        loop_cur += mp_loop_len;
-        for (; mp_loop_len--; r_ml++) {
-          r_ml->v = vert_final[r_ml->v];
-          r_ml->e = edge_final[r_ml->e];
-        }
-      }
-      else {
-        WeldPoly *wp = &weld_mesh.wpoly[poly_ctx];
-        WeldLoopOfPolyIter iter;
-        if (!weld_iter_loop_of_poly_begin(
-                &iter, wp, weld_mesh.wloop, mloop, weld_mesh.loop_map, group_buffer)) {
-          continue;
-        }
-
-        if (wp->poly_dst != OUT_OF_CONTEXT) {
-          continue;
-        }
-        while (weld_iter_loop_of_poly_next(&iter)) {
-          customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
-          uint v = vert_final[iter.v];
-          uint e = edge_final[iter.e];
-          r_ml->v = v;
-          r_ml->e = e;
-          r_ml++;
-          loop_cur++;
-          if (iter.type) {
-            result->medge[e].flag &= ~ME_LOOSEEDGE;
-          }
-          BLI_assert((result->medge[e].flag & ME_LOOSEEDGE) == 0);
-        }
-      }
-
-      CustomData_copy_data(&mesh->pdata, &result->pdata, i, r_i, 1);
-      r_mp->loopstart = loop_start;
-      r_mp->totloop = loop_cur - loop_start;
-      r_mp++;
-      r_i++;
-    }
-
-    WeldPoly *wp = &weld_mesh.wpoly_new[0];
-    for (uint i = 0; i < weld_mesh.wpoly_new_len; i++, wp++) {
-      int loop_start = loop_cur;
-      WeldLoopOfPolyIter iter;
-      if (!weld_iter_loop_of_poly_begin(
-              &iter, wp, weld_mesh.wloop, mloop, weld_mesh.loop_map, group_buffer)) {
-        continue;
-      }
-
-      if (wp->poly_dst != OUT_OF_CONTEXT) {
-        continue;
-      }
-      while (weld_iter_loop_of_poly_next(&iter)) {
-        customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
-        uint v = vert_final[iter.v];
-        uint e = edge_final[iter.e];
-        r_ml->v = v;
-        r_ml->e = e;
-        r_ml++;
-        loop_cur++;
-        if (iter.type) {
-          result->medge[e].flag &= ~ME_LOOSEEDGE;
-        }
-        BLI_assert((result->medge[e].flag & ME_LOOSEEDGE) == 0);
-      }
-
-      r_mp->loopstart = loop_start;
-      r_mp->totloop = loop_cur - loop_start;
-      r_mp++;
-      r_i++;
-    }
-
-    BLI_assert((int)r_i == result_npolys);
-    BLI_assert(loop_cur == result_nloops);
-
-    /* is this needed? */
-    /* recalculate normals */
-    result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+    result = weld_result_create(mesh, &weld_mesh, vert_dest_map);
 
     weld_mesh_context_free(&weld_mesh);
   }
@@ -1941,6 +2285,7 @@ static void panel_draw(const bContext *UNUSED(C), Panel *panel)
   uiLayoutSetPropSep(layout, true);
 
   uiItemR(layout, ptr, "merge_threshold", 0, IFACE_("Distance"), ICON_NONE);
+  uiItemR(layout, ptr, "use_spatial_hash", 0, NULL, ICON_NONE);
   modifier_vgroup_ui(layout, ptr, &ob_ptr, "vertex_group", "invert_vertex_group", NULL);
 
   modifier_panel_end(layout, ptr);
@@ -30,6 +30,8 @@
 
 #include "BKE_idprop.h"
 
+#include "DEG_depsgraph.h"
+
 #define USE_STRING_COERCE
 
 #ifdef USE_STRING_COERCE
@@ -756,7 +758,12 @@ int BPy_Wrap_SetMapItem(IDProperty *prop, PyObject *key, PyObject *val)
 
 static int BPy_IDGroup_Map_SetItem(BPy_IDProperty *self, PyObject *key, PyObject *val)
 {
-  return BPy_Wrap_SetMapItem(self->prop, key, val);
+  const int ret = BPy_Wrap_SetMapItem(self->prop, key, val);
+  if (ret == 0) {
+    /* Nothing else tags the change, the memfile undo would skip storing it. */
+    DEG_id_tag_undo_changed(self->id);
+  }
+  return ret;
 }
 
 static PyObject *BPy_IDGroup_iter(BPy_IDProperty *self)
@@ -924,6 +931,7 @@ static PyObject *BPy_IDGroup_pop(BPy_IDProperty *self, PyObject *args)
   }
 
   IDP_RemoveFromGroup(self->prop, idprop);
+  DEG_id_tag_undo_changed(self->id);
   return pyform;
 }
 
@@ -1120,6 +1128,7 @@ PyDoc_STRVAR(BPy_IDGroup_clear_doc,
 static PyObject *BPy_IDGroup_clear(BPy_IDProperty *self)
 {
   IDP_ClearProperty(self->prop);
+  DEG_id_tag_undo_changed(self->id);
   Py_RETURN_NONE;
 }
 
@@ -1382,6 +1391,7 @@ static int BPy_IDArray_SetItem(BPy_IDArray *self, int index, PyObject *value)
       break;
     }
   }
+  DEG_id_tag_undo_changed(self->id);
   return 0;
 }
 
@@ -1470,6 +1480,7 @@ static int BPy_IDArray_ass_slice(BPy_IDArray *self, int begin, int end, PyObject
   memcpy((void *)(((char *)IDP_Array(prop)) + (begin * elem_size)), vec, alloc_len);
 
   MEM_freeN(vec);
+  DEG_id_tag_undo_changed(self->id);
   return 0;
 }
 
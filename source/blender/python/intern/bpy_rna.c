@@ -46,6 +46,7 @@
 #include "bpy_props.h"
 #include "bpy_rna.h"
 #include "bpy_rna_anim.h"
+#include "bpy_rna_buffer.h"
 #include "bpy_rna_callback.h"
 
 #ifdef USE_PYRNA_INVALIDATE_WEAKREF
@@ -70,6 +71,7 @@
 /* Only for types. */
 #include "BKE_node.h"
 
+#include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
 #include "../generic/idprop_py_api.h" /* For IDprop lookups. */
@@ -2219,6 +2221,9 @@ static int pyrna_py_to_prop(
   if (RNA_property_update_check(prop)) {
     RNA_property_update(BPY_context_get(), ptr, prop);
   }
+  else {
+    DEG_id_tag_undo_changed(ptr->owner_id);
+  }
 
   return 0;
 }
@@ -2295,6 +2300,9 @@ static int pyrna_py_to_prop_array_index(BPy_PropertyArrayRNA *self, int index, P
   if (RNA_property_update_check(prop)) {
     RNA_property_update(BPY_context_get(), ptr, prop);
   }
+  else {
+    DEG_id_tag_undo_changed(ptr->owner_id);
+  }
 
   return ret;
 }
@@ -3299,6 +3307,9 @@ static int pyrna_prop_array_ass_subscript(BPy_PropertyArrayRNA *self,
     if (RNA_property_update_check(self->prop)) {
       RNA_property_update(BPY_context_get(), &self->ptr, self->prop);
     }
+    else {
+      DEG_id_tag_undo_changed(self->ptr.owner_id);
+    }
   }
 
   return ret;
@@ -3512,7 +3523,12 @@ static int pyrna_struct_ass_subscript(BPy_StructRNA *self, PyObject *key, PyObje
     }
   }
 
-  return BPy_Wrap_SetMapItem(group, key, value);
+  const int ret = BPy_Wrap_SetMapItem(group, key, value);
+  if (ret == 0) {
+    /* ID properties have no update function. */
+    DEG_id_tag_undo_changed(self->ptr.owner_id);
+  }
+  return ret;
 }
 
 static PyMappingMethods pyrna_struct_as_mapping = {
@@ -5552,6 +5568,11 @@ static PyObject *pyprop_array_foreach_getset(BPy_PropertyArrayRNA *self,
     PyBuffer_Release(&buf);
   }
 
+  if (do_set) {
+    /* Like #pyrna_prop_collection_foreach_set, no property update is run. */
+    DEG_id_tag_undo_changed(self->ptr.owner_id);
+  }
+
   Py_RETURN_NONE;
 }
 
@@ -5746,6 +5767,10 @@ static struct PyMethodDef pyrna_prop_collection_methods[] = {
      (PyCFunction)pyrna_prop_collection_foreach_set,
      METH_VARARGS,
      pyrna_prop_collection_foreach_set_doc},
+    {"as_buffer",
+     (PyCFunction)pyrna_prop_collection_as_buffer,
+     METH_VARARGS | METH_KEYWORDS,
+     pyrna_prop_collection_as_buffer_doc},
 
     {"keys", (PyCFunction)pyrna_prop_collection_keys, METH_NOARGS, pyrna_prop_collection_keys_doc},
     {"items",
@@ -7600,6 +7625,10 @@ void BPY_rna_init(void)
     return;
   }
 
+  if (PyType_Ready(&pyrna_prop_collection_buffer_Type) < 0) {
+    return;
+  }
+
 #ifdef USE_PYRNA_ITER
   if (PyType_Ready(&pyrna_prop_collection_iter_Type) < 0) {
     return;
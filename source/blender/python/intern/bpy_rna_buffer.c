@@ -0,0 +1,274 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup pythonintern
+ *
+ * This file exposes the attributes of collections stored in plain contiguous arrays
+ * (mesh vertices, loops, custom-data layers...) through the Python buffer protocol,
+ * giving direct access to Blender's memory without any per-item RNA lookup.
+ */
+
+#include <Python.h>
+
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+
+#include "RNA_access.h"
+
+#include "bpy_capi_utils.h"
+#include "bpy_rna.h"
+#include "bpy_rna_buffer.h"
+
+#include "../generic/py_capi_utils.h"
+
+/**
+ * The object exporting the buffer, only used internally: Python code gets a `memoryview` of it.
+ */
+typedef struct BPy_PropertyBufferRNA {
+  PyObject_HEAD
+  /** The collection the buffer is created from, kept alive as long as the buffer. */
+  BPy_PropertyRNA *py_collection;
+  RawArray raw;
+  bool attr_signed;
+  bool readonly;
+  int ndim;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+} BPy_PropertyBufferRNA;
+
+/* Same types as accepted by foreach_get/set. */
+static const char *pyrna_buffer_format_from_raw_type(RawPropertyType raw_type, bool attr_signed)
+{
+  switch (raw_type) {
+    case PROP_RAW_CHAR:
+      return attr_signed ? "b" : "B";
+    case PROP_RAW_SHORT:
+      return attr_signed ? "h" : "H";
+    case PROP_RAW_INT:
+      return attr_signed ? "i" : "I";
+    case PROP_RAW_BOOLEAN:
+      return "?";
+    case PROP_RAW_FLOAT:
+      return "f";
+    case PROP_RAW_DOUBLE:
+      return "d";
+    case PROP_RAW_UNSET:
+      break;
+  }
+  BLI_assert(!"Invalid raw type");
+  return "B";
+}
+
+static int pyrna_prop_collection_buffer_getbuffer(BPy_PropertyBufferRNA *self,
+                                                  Py_buffer *view,
+                                                  int flags)
+{
+  /* Used for empty collections, buffers must not be NULL. */
+  static char empty_buf[1];
+
+  const Py_ssize_t itemsize = RNA_raw_type_sizeof(self->raw.type);
+  const Py_ssize_t values_num = self->shape[0] * self->shape[1];
+  const bool is_contiguous = (self->shape[0] <= 1) ||
+                             (self->strides[0] == itemsize * self->shape[1]);
+
+  if ((flags & PyBUF_WRITABLE) && self->readonly) {
+    PyErr_SetString(PyExc_BufferError, "bpy_prop_collection buffer is read-only");
+    return -1;
+  }
+  if (!is_contiguous && (flags & PyBUF_STRIDES) != PyBUF_STRIDES) {
+    PyErr_SetString(PyExc_BufferError,
+                    "bpy_prop_collection buffer is not contiguous, strides are required");
+    return -1;
+  }
+
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->buf = self->raw.array ? self->raw.array : empty_buf;
+  view->len = values_num * itemsize;
+  view->itemsize = itemsize;
+  view->readonly = self->readonly;
+  view->format = (flags & PyBUF_FORMAT) ?
+                     (char *)pyrna_buffer_format_from_raw_type(self->raw.type, self->attr_signed) :
+                     NULL;
+  if ((flags & PyBUF_ND) == PyBUF_ND) {
+    view->ndim = self->ndim;
+    view->shape = self->shape;
+  }
+  else {
+    view->ndim = 1;
+    view->shape = NULL;
+  }
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  return 0;
+}
+
+static void pyrna_prop_collection_buffer_dealloc(BPy_PropertyBufferRNA *self)
+{
+  Py_DECREF(self->py_collection);
+  PyObject_DEL(self);
+}
+
+static PyBufferProcs pyrna_prop_collection_buffer_as_buffer = {
+    (getbufferproc)pyrna_prop_collection_buffer_getbuffer,
+    (releasebufferproc)NULL,
+};
+
+PyTypeObject pyrna_prop_collection_buffer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "bpy_prop_collection_buffer", /* tp_name */
+    sizeof(BPy_PropertyBufferRNA),                               /* tp_basicsize */
+    0,                                                           /* tp_itemsize */
+    /* methods */
+    (destructor)pyrna_prop_collection_buffer_dealloc, /* tp_dealloc */
+    (printfunc)NULL,                                  /* printfunc tp_print; */
+    NULL,                                             /* getattrfunc tp_getattr; */
+    NULL,                                             /* setattrfunc tp_setattr; */
+    NULL,                                             /* tp_compare */
+    NULL,                                             /* tp_repr */
+
+    /* Method suites for standard classes */
+
+    NULL, /* PyNumberMethods *tp_as_number; */
+    NULL, /* PySequenceMethods *tp_as_sequence; */
+    NULL, /* PyMappingMethods *tp_as_mapping; */
+
+    /* More standard operations (here for binary compatibility) */
+
+    NULL, /* hashfunc tp_hash; */
+    NULL, /* ternaryfunc tp_call; */
+    NULL, /* reprfunc tp_str; */
+    NULL, /* getattrofunc tp_getattro; */
+    NULL, /* setattrofunc tp_setattro; */
+
+    /* Functions to access object as input/output buffer */
+    &pyrna_prop_collection_buffer_as_buffer, /* PyBufferProcs *tp_as_buffer; */
+
+    /*** Flags to define presence of optional/expanded features ***/
+    Py_TPFLAGS_DEFAULT, /* long tp_flags; */
+};
+
+char pyrna_prop_collection_as_buffer_doc[] =
+    ".. method:: as_buffer(attr, *, write=False)\n"
+    "\n"
+    "   Direct access to an attribute of all items in the collection, without copying.\n"
+    "   Only available for collections stored in a contiguous array (e.g. mesh vertices or\n"
+    "   layers data), with non-dynamic boolean, integer or float attributes.\n"
+    "\n"
+    "   :arg attr: The name of the attribute.\n"
+    "   :type attr: string\n"
+    "   :arg write: Return a writable view, the attribute must be editable.\n"
+    "      Blender's data is then tagged as changed when the view is created.\n"
+    "   :type write: bool\n"
+    "   :return: A view of shape ``(len(collection), attribute length)``, or\n"
+    "      ``(len(collection),)`` for non-array attributes, read-only unless ``write`` is set.\n"
+    "   :rtype: :class:`memoryview`\n"
+    "\n"
+    "   .. warning:: The view must not be used anymore once the collection is resized or its\n"
+    "      owner data freed, e.g. ``mesh.vertices.add()``.\n";
+PyObject *pyrna_prop_collection_as_buffer(BPy_PropertyRNA *self, PyObject *args, PyObject *kw)
+{
+  const char *attr;
+  bool write = false;
+
+  PYRNA_PROP_CHECK_OBJ(self);
+
+  static const char *_keywords[] = {"", "write", NULL};
+  static _PyArg_Parser _parser = {"s|$O&:as_buffer", _keywords, 0};
+  if (!_PyArg_ParseTupleAndKeywordsFast(args, kw, &_parser, &attr, PyC_ParseBool, &write)) {
+    return NULL;
+  }
+
+  PointerRNA itemptr_base;
+  RNA_pointer_create(
+      self->ptr.owner_id, RNA_property_pointer_type(&self->ptr, self->prop), NULL, &itemptr_base);
+  PropertyRNA *itemprop = RNA_struct_find_property(&itemptr_base, attr);
+
+  if (itemprop == NULL) {
+    PyErr_Format(PyExc_AttributeError,
+                 "as_buffer: '%.200s.%.200s[...]' elements have no attribute '%.200s'",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  /* The first item stands for all of them, they share their owner ID. Empty collections are
+   * checked with the item type and owner ID only. */
+  PointerRNA itemptr = itemptr_base;
+  const bool has_item = RNA_property_collection_lookup_int(&self->ptr, self->prop, 0, &itemptr);
+
+  /* Raw access is only given to editable attributes of editable data, read-only attributes and
+   * linked or overridden data-blocks go through the regular API. */
+  if (!RNA_property_editable(&itemptr, itemprop)) {
+    PyErr_Format(PyExc_AttributeError,
+                 "as_buffer: '%.200s.%.200s[...].%.200s' is read-only",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+  if (write && !pyrna_write_check()) {
+    PyErr_SetString(PyExc_AttributeError,
+                    "as_buffer: writing to Blender's data is not allowed in this context");
+    return NULL;
+  }
+
+  RawArray raw;
+  if ((RNA_property_flag(itemprop) & PROP_DYNAMIC) ||
+      !RNA_property_collection_raw_array(&self->ptr, self->prop, itemprop, &raw)) {
+    PyErr_Format(PyExc_TypeError,
+                 "as_buffer: '%.200s.%.200s[...].%.200s' is not stored in a contiguous array",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+  if (raw.len == 0) {
+    /* Empty collections give no information about the type of the data. */
+    raw.type = RNA_property_raw_type(itemprop);
+  }
+
+  BPy_PropertyBufferRNA *py_buffer = PyObject_New(BPy_PropertyBufferRNA,
+                                                  &pyrna_prop_collection_buffer_Type);
+  const int attr_tot = max_ii(RNA_property_array_length(&itemptr_base, itemprop), 1);
+
+  py_buffer->py_collection = self;
+  Py_INCREF(self);
+  py_buffer->raw = raw;
+  py_buffer->attr_signed = (RNA_property_subtype(itemprop) != PROP_UNSIGNED);
+  py_buffer->readonly = !write;
+  py_buffer->ndim = (attr_tot > 1) ? 2 : 1;
+  py_buffer->shape[0] = raw.len;
+  py_buffer->shape[1] = attr_tot;
+  py_buffer->strides[0] = raw.stride;
+  py_buffer->strides[1] = RNA_raw_type_sizeof(raw.type);
+
+  PyObject *ret = PyMemoryView_FromObject((PyObject *)py_buffer);
+  Py_DECREF(py_buffer);
+
+  /* There is no way to know whether the data is actually modified, so writable views always tag
+   * it as changed. This is done when the view is created rather than when it is released: the
+   * owner data may have been freed by then, and the tagged updates only run once the script gives
+   * control back anyway. */
+  if (ret != NULL && write && has_item) {
+    RNA_property_update(BPY_context_get(), &itemptr, itemprop);
+  }
+
+  return ret;
+}
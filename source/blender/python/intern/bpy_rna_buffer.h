@@ -0,0 +1,35 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup pythonintern
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern PyTypeObject pyrna_prop_collection_buffer_Type;
+
+extern char pyrna_prop_collection_as_buffer_doc[];
+
+PyObject *pyrna_prop_collection_as_buffer(BPy_PropertyRNA *self, PyObject *args, PyObject *kw);
+
+#ifdef __cplusplus
+}
+#endif
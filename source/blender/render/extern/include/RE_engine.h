@@ -72,6 +72,7 @@ extern "C" {
 #define RE_ENGINE_DO_UPDATE 8
 #define RE_ENGINE_RENDERING 16
 #define RE_ENGINE_HIGHLIGHT_TILES 32
+#define RE_ENGINE_DEPSGRAPH_REUSED 64
 
 extern ListBase R_engines;
 
@@ -163,6 +164,7 @@ typedef struct RenderEngine {
 
 RenderEngine *RE_engine_create(RenderEngineType *type);
 void RE_engine_free(RenderEngine *engine);
+void RE_engine_free_persistent_depsgraph(RenderEngine *engine);
 
 void RE_layer_load_from_file(
     struct RenderLayer *layer, struct ReportList *reports, const char *filename, int x, int y);
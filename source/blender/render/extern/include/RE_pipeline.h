@@ -188,6 +188,10 @@ void RE_FreeAllRender(void);
  * Invoked when loading new file.
  */
 void RE_FreeAllPersistentData(void);
+/* Free the dependency graphs kept by render engines with persistent data, but keep the engines.
+ * Invoked on undo, which frees or re-reads the data-blocks they point to.
+ */
+void RE_FreeAllPersistentDepsgraphs(void);
 /* only call on file load */
 void RE_FreeAllRenderResults(void);
 /* for external render engines that can keep persistent data */
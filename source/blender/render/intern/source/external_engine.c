@@ -47,6 +47,7 @@
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
@@ -150,6 +151,10 @@ void RE_engine_free(RenderEngine *engine)
 
   BLI_mutex_end(&engine->update_render_passes_mutex);
 
+  if (engine->depsgraph) {
+    DEG_graph_free(engine->depsgraph);
+  }
+
   MEM_freeN(engine);
 }
 
@@ -599,13 +604,57 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+
+/* With persistent data the depsgraph is kept between renders, so that the engine only has to
+ * synchronize what changed since the previous frame instead of the whole scene.
+ *
+ * Only one depsgraph is kept, for the last rendered view layer. Scenes rendering multiple view
+ * layers get a new depsgraph for each of them, and don't benefit from this. */
+static bool engine_keep_depsgraph(RenderEngine *engine)
+{
+  Render *re = engine->re;
+  return (re->r.mode & R_PERSISTENT_DATA) && !(re->r.scemode & R_BUTS_PREVIEW);
+}
+
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+  DEG_graph_free(engine->depsgraph);
+
+  engine->depsgraph = NULL;
+}
+
+/* Free the depsgraph kept for persistent data, the next render builds a new one. */
+void RE_engine_free_persistent_depsgraph(RenderEngine *engine)
+{
+  if (engine->depsgraph && !(engine->flag & RE_ENGINE_RENDERING)) {
+    engine_depsgraph_free(engine);
+  }
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
 
-  engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(engine->depsgraph, "RENDER");
+  if (engine->depsgraph) {
+    /* A depsgraph kept from the previous render can only be reused for the same data. */
+    if (!engine_keep_depsgraph(engine) || DEG_get_bmain(engine->depsgraph) != bmain ||
+        DEG_get_input_scene(engine->depsgraph) != scene ||
+        DEG_get_input_view_layer(engine->depsgraph) != view_layer) {
+      engine_depsgraph_free(engine);
+    }
+  }
+
+  if (engine->depsgraph) {
+    /* IDs may have been added or removed since the previous render, e.g. by undo. */
+    DEG_graph_tag_relations_update(engine->depsgraph);
+    engine->flag |= RE_ENGINE_DEPSGRAPH_REUSED;
+  }
+  else {
+    engine->flag &= ~RE_ENGINE_DEPSGRAPH_REUSED;
+    engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(engine->depsgraph, "RENDER");
+  }
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
     Depsgraph *depsgraph = engine->depsgraph;
@@ -615,15 +664,25 @@ static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
     DEG_ids_clear_recalc(bmain, depsgraph);
   }
   else {
-    BKE_scene_graph_update_for_newframe(engine->depsgraph);
+    /* Keep the recalc flags for the engine to see what changed since the previous render. */
+    BKE_scene_graph_update_for_newframe_ex(engine->depsgraph, !engine_keep_depsgraph(engine));
   }
 }
 
-static void engine_depsgraph_free(RenderEngine *engine)
+static void engine_depsgraph_exit(RenderEngine *engine)
 {
-  DEG_graph_free(engine->depsgraph);
+  if (engine->depsgraph == NULL) {
+    return;
+  }
 
-  engine->depsgraph = NULL;
+  /* A cancelled render may not have synchronized all changes, start over in that case. */
+  if (engine_keep_depsgraph(engine) && !RE_engine_test_break(engine)) {
+    /* The engine has synchronized all changes, only tag what changes from now on. */
+    DEG_ids_clear_recalc(engine->re->main, engine->depsgraph);
+  }
+  else {
+    engine_depsgraph_free(engine);
+  }
 }
 
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
@@ -698,6 +757,10 @@ bool RE_bake_engine(Render *re,
   BLI_rw_mutex_unlock(&re->partsmutex);
 
   if (type->bake) {
+    /* Baking uses the depsgraph of the caller, not the one kept for persistent data. */
+    if (engine->depsgraph) {
+      engine_depsgraph_free(engine);
+    }
     engine->depsgraph = depsgraph;
 
     /* update is only called so we create the engine.session */
@@ -889,7 +952,7 @@ int RE_engine_render(Render *re, int do_all)
         DRW_render_gpencil(engine, engine->depsgraph);
       }
 
-      engine_depsgraph_free(engine);
+      engine_depsgraph_exit(engine);
 
       if (RE_engine_test_break(engine)) {
         break;
@@ -671,6 +671,16 @@ void RE_FreeAllPersistentData(void)
   }
 }
 
+void RE_FreeAllPersistentDepsgraphs(void)
+{
+  Render *re;
+  for (re = RenderGlobal.renderlist.first; re != NULL; re = re->next) {
+    if (re->engine != NULL) {
+      RE_engine_free_persistent_depsgraph(re->engine);
+    }
+  }
+}
+
 /* on file load, free all re */
 void RE_FreeAllRenderResults(void)
 {
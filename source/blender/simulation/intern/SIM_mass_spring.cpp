@@ -1216,6 +1216,9 @@ static void cloth_clear_result(ClothModifierData *clmd)
   sres->max_error = sres->min_error = sres->avg_error = 0.0f;
   sres->max_iterations = sres->min_iterations = 0;
   sres->avg_iterations = 0.0f;
+  sres->collision_broadphase_time = sres->collision_narrowphase_time = 0.0f;
+  sres->collision_response_time = 0.0f;
+  sres->self_overlap_reuse_count = 0;
 }
 
 static void cloth_record_result(ClothModifierData *clmd, ImplicitSolverResult *result, float dt)
@@ -1278,6 +1281,8 @@ int SIM_cloth_solve(
   }
   cloth_clear_result(clmd);
 
+  SIM_mass_spring_set_solver_mode(id, clmd->sim_parms->solver_type);
+
   if (clmd->sim_parms->vgroup_mass > 0) { /* Do goal stuff. */
     for (i = 0; i < mvert_num; i++) {
       /* update velocities with constrained velocities from pinned verts */
@@ -100,6 +100,8 @@ void SIM_mass_spring_add_constraint_ndof2(struct Implicit_Data *data,
                                           const float c1[3],
                                           const float dV[3]);
 
+/* Linear solver used for the velocity step, see #eClothSolverType */
+void SIM_mass_spring_set_solver_mode(struct Implicit_Data *data, int mode);
 bool SIM_mass_spring_solve_velocities(struct Implicit_Data *data,
                                       float dt,
                                       struct ImplicitSolverResult *result);
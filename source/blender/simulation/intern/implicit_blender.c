@@ -27,6 +27,7 @@
 
 #  include "MEM_guardedalloc.h"
 
+#  include "DNA_cloth_types.h"
 #  include "DNA_meshdata_types.h"
 #  include "DNA_object_force_types.h"
 #  include "DNA_object_types.h"
@@ -34,6 +35,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -658,6 +660,308 @@ DO_INLINE void subadd_bfmatrixS_bfmatrixS(
   }
 }
 
+///////////////////////////
+/* SPARSE SYMMETRIC big matrix in block compressed sparse row format */
+///////////////////////////
+
+/* Number of vertices processed by one task. Reductions are summed per chunk first and the
+ * partial sums are added in a fixed order, so results don't depend on the number of threads. */
+#  define BLOCK_CHUNK_SIZE 1024
+
+/**
+ * Copy of a #fmatrix3x3 big matrix where the blocks of each row are stored contiguously.
+ * Both triangles are stored, so rows can be multiplied independently from each other.
+ * The structure is shared by all big matrices with the same off-diagonal blocks,
+ * values are gathered from one of them before use.
+ */
+typedef struct BlockCSRMatrix {
+  unsigned int rows;
+  unsigned int blocks_len, blocks_alloc;
+  /* Range of blocks in each row (rows + 1 items). */
+  unsigned int *row_offsets;
+  /* Column and source block in the big matrix for each block. */
+  unsigned int *cols;
+  unsigned int *src;
+  /* Blocks of the upper triangle are transposed copies of the source block. */
+  bool *src_transposed;
+  float (*values)[3][3];
+} BlockCSRMatrix;
+
+static void del_bcsrmatrix(BlockCSRMatrix *csr)
+{
+  MEM_SAFE_FREE(csr->row_offsets);
+  MEM_SAFE_FREE(csr->cols);
+  MEM_SAFE_FREE(csr->src);
+  MEM_SAFE_FREE(csr->src_transposed);
+  MEM_SAFE_FREE(csr->values);
+  csr->rows = csr->blocks_len = csr->blocks_alloc = 0;
+}
+
+/* Build the structure from the diagonal and the first num_blocks off-diagonal blocks. */
+static void build_bcsrmatrix(BlockCSRMatrix *csr, const fmatrix3x3 *from, unsigned int num_blocks)
+{
+  const unsigned int rows = from[0].vcount;
+  const unsigned int blocks_len = rows + 2 * num_blocks;
+  unsigned int i, s;
+
+  if (csr->rows != rows) {
+    MEM_SAFE_FREE(csr->row_offsets);
+    csr->row_offsets = MEM_malloc_arrayN(rows + 1, sizeof(*csr->row_offsets), __func__);
+    csr->rows = rows;
+  }
+  if (csr->blocks_alloc < blocks_len) {
+    MEM_SAFE_FREE(csr->cols);
+    MEM_SAFE_FREE(csr->src);
+    MEM_SAFE_FREE(csr->src_transposed);
+    MEM_SAFE_FREE(csr->values);
+    csr->cols = MEM_malloc_arrayN(blocks_len, sizeof(*csr->cols), __func__);
+    csr->src = MEM_malloc_arrayN(blocks_len, sizeof(*csr->src), __func__);
+    csr->src_transposed = MEM_malloc_arrayN(blocks_len, sizeof(*csr->src_transposed), __func__);
+    csr->values = MEM_malloc_arrayN(blocks_len, sizeof(*csr->values), __func__);
+    csr->blocks_alloc = blocks_len;
+  }
+  csr->blocks_len = blocks_len;
+
+  /* Count blocks per row, then turn the counts into offsets. */
+  unsigned int *row_offsets = csr->row_offsets;
+  row_offsets[0] = 0;
+  for (i = 0; i < rows; i++) {
+    row_offsets[i + 1] = 1;
+  }
+  for (s = rows; s < rows + num_blocks; s++) {
+    row_offsets[from[s].r + 1]++;
+    row_offsets[from[s].c + 1]++;
+  }
+  for (i = 0; i < rows; i++) {
+    row_offsets[i + 1] += row_offsets[i];
+  }
+
+  /* Diagonal block first, then off-diagonal blocks in the order of the big matrix. */
+  unsigned int *row_fill = MEM_malloc_arrayN(rows, sizeof(*row_fill), __func__);
+  for (i = 0; i < rows; i++) {
+    const unsigned int k = row_offsets[i];
+    csr->cols[k] = i;
+    csr->src[k] = i;
+    csr->src_transposed[k] = false;
+    row_fill[i] = k + 1;
+  }
+  for (s = rows; s < rows + num_blocks; s++) {
+    /* Same layout as #mul_bfmatrix_lfvector: the block multiplies column c in row r,
+     * and its transpose multiplies column r in row c. */
+    unsigned int k = row_fill[from[s].r]++;
+    csr->cols[k] = from[s].c;
+    csr->src[k] = s;
+    csr->src_transposed[k] = false;
+
+    k = row_fill[from[s].c]++;
+    csr->cols[k] = from[s].r;
+    csr->src[k] = s;
+    csr->src_transposed[k] = true;
+  }
+  MEM_freeN(row_fill);
+}
+
+BLI_INLINE unsigned int bcsr_chunks_len(const BlockCSRMatrix *csr)
+{
+  return (csr->rows + BLOCK_CHUNK_SIZE - 1) / BLOCK_CHUNK_SIZE;
+}
+
+BLI_INLINE void bcsr_chunk_range(const BlockCSRMatrix *csr,
+                                 const int chunk,
+                                 unsigned int *r_start,
+                                 unsigned int *r_end)
+{
+  *r_start = (unsigned int)chunk * BLOCK_CHUNK_SIZE;
+  *r_end = MIN2(*r_start + BLOCK_CHUNK_SIZE, csr->rows);
+}
+
+/* Shared by the tasks of the block solver, each task only uses some of the members. */
+typedef struct BlockSolverTaskData {
+  BlockCSRMatrix *csr;
+  const fmatrix3x3 *from;
+  const fmatrix3x3 *S;
+  fmatrix3x3 *Pinv;
+
+  lfVector *in, *out;
+  lfVector *B, *AdV, *fB;
+  lfVector *dV, *r, *c, *q, *s;
+  float alpha, beta;
+  bool use_precond;
+
+  /* Partial sums of the reductions, one per chunk. */
+  float *partial, *partial_b;
+} BlockSolverTaskData;
+
+static void bcsr_solver_task_run(BlockSolverTaskData *data, TaskParallelRangeFunc func)
+{
+  const unsigned int chunks_len = bcsr_chunks_len(data->csr);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (chunks_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, (int)chunks_len, data, func, &settings);
+}
+
+static float bcsr_partial_sum(const BlockCSRMatrix *csr, const float *partial)
+{
+  const unsigned int chunks_len = bcsr_chunks_len(csr);
+  double sum = 0.0;
+  for (unsigned int i = 0; i < chunks_len; i++) {
+    sum += partial[i];
+  }
+  return (float)sum;
+}
+
+static void bcsr_gather_values_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockSolverTaskData *data = userdata;
+  BlockCSRMatrix *csr = data->csr;
+  unsigned int start, end;
+  bcsr_chunk_range(csr, chunk, &start, &end);
+
+  for (unsigned int k = csr->row_offsets[start]; k < csr->row_offsets[end]; k++) {
+    if (csr->src_transposed[k]) {
+      transpose_m3_m3(csr->values[k], data->from[csr->src[k]].m);
+    }
+    else {
+      copy_m3_m3(csr->values[k], data->from[csr->src[k]].m);
+    }
+  }
+}
+
+/* Copy the values of a big matrix with the same structure into the blocks. */
+static void gather_bcsrmatrix(BlockCSRMatrix *csr, const fmatrix3x3 *from)
+{
+  BlockSolverTaskData data = {.csr = csr, .from = from};
+  bcsr_solver_task_run(&data, bcsr_gather_values_cb);
+}
+
+BLI_INLINE void bcsr_mul_row(float r[3], const BlockCSRMatrix *csr, unsigned int row, lfVector *v)
+{
+  zero_v3(r);
+  for (unsigned int k = csr->row_offsets[row]; k < csr->row_offsets[row + 1]; k++) {
+    muladd_fmatrix_fvector(r, csr->values[k], v[csr->cols[k]]);
+  }
+}
+
+/* out = filter(A * in), optionally partial = in^T * out */
+static void bcsr_mul_lfvector_cb(void *__restrict userdata,
+                                 const int chunk,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockSolverTaskData *data = userdata;
+  unsigned int start, end;
+  bcsr_chunk_range(data->csr, chunk, &start, &end);
+
+  float dot = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    bcsr_mul_row(data->out[i], data->csr, i, data->in);
+    if (data->S) {
+      mul_m3_v3(data->S[i].m, data->out[i]);
+    }
+    dot += dot_v3v3(data->in[i], data->out[i]);
+  }
+  if (data->partial) {
+    data->partial[chunk] = dot;
+  }
+}
+
+static void mul_bcsrmatrix_lfvector(lfVector *to, BlockCSRMatrix *csr, lfVector *from)
+{
+  BlockSolverTaskData data = {.csr = csr, .in = from, .out = to};
+  bcsr_solver_task_run(&data, bcsr_mul_lfvector_cb);
+}
+
+BLI_INLINE void bcsr_precond_apply(const BlockSolverTaskData *data,
+                                   unsigned int i,
+                                   float r[3],
+                                   const float v[3])
+{
+  if (data->use_precond) {
+    mul_v3_m3v3(r, data->Pinv[i].m, v);
+  }
+  else {
+    copy_v3_v3(r, v);
+  }
+}
+
+/* Initial residual and search direction of the CG, see #cg_filtered. */
+static void bcsr_cg_init_cb(void *__restrict userdata,
+                            const int chunk,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockSolverTaskData *data = userdata;
+  unsigned int start, end;
+  bcsr_chunk_range(data->csr, chunk, &start, &end);
+
+  float delta = 0.0f, bnorm2 = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    if (data->use_precond) {
+      /* Block Jacobi, from the diagonal blocks of A. */
+      const float(*diag)[3] = data->csr->values[data->csr->row_offsets[i]];
+      if (!invert_m3_m3(data->Pinv[i].m, diag)) {
+        unit_m3(data->Pinv[i].m);
+      }
+    }
+
+    float tmp[3];
+
+    /* fB = filter(B) */
+    copy_v3_v3(data->fB[i], data->B[i]);
+    mul_m3_v3(data->S[i].m, data->fB[i]);
+    bcsr_precond_apply(data, i, tmp, data->fB[i]);
+    bnorm2 += dot_v3v3(data->fB[i], tmp);
+
+    /* r = filter(B - A * dV) */
+    sub_v3_v3v3(data->r[i], data->B[i], data->AdV[i]);
+    mul_m3_v3(data->S[i].m, data->r[i]);
+
+    /* c = filter(P^-1 * r) */
+    bcsr_precond_apply(data, i, data->c[i], data->r[i]);
+    mul_m3_v3(data->S[i].m, data->c[i]);
+
+    delta += dot_v3v3(data->r[i], data->c[i]);
+  }
+  data->partial[chunk] = delta;
+  data->partial_b[chunk] = bnorm2;
+}
+
+/* dV += alpha * c, r -= alpha * q, s = P^-1 * r, partial = r^T * s */
+static void bcsr_cg_update_cb(void *__restrict userdata,
+                              const int chunk,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockSolverTaskData *data = userdata;
+  unsigned int start, end;
+  bcsr_chunk_range(data->csr, chunk, &start, &end);
+
+  float delta = 0.0f;
+  for (unsigned int i = start; i < end; i++) {
+    madd_v3_v3fl(data->dV[i], data->c[i], data->alpha);
+    madd_v3_v3fl(data->r[i], data->q[i], -data->alpha);
+    bcsr_precond_apply(data, i, data->s[i], data->r[i]);
+    delta += dot_v3v3(data->r[i], data->s[i]);
+  }
+  data->partial[chunk] = delta;
+}
+
+/* c = filter(s + beta * c) */
+static void bcsr_cg_direction_cb(void *__restrict userdata,
+                                 const int chunk,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockSolverTaskData *data = userdata;
+  unsigned int start, end;
+  bcsr_chunk_range(data->csr, chunk, &start, &end);
+
+  for (unsigned int i = start; i < end; i++) {
+    VECADDS(data->c[i], data->s[i], data->c[i], data->beta);
+    mul_m3_v3(data->S[i].m, data->c[i]);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////
 /* simulator start */
 ///////////////////////////////////////////////////////////////////
@@ -683,6 +987,9 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+
+  int solver_mode;     /* eClothSolverType */
+  BlockCSRMatrix csr; /* row major copy of A and dFdX for the block solvers */
 } Implicit_Data;
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -734,9 +1041,16 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  del_bcsrmatrix(&id->csr);
+
   MEM_freeN(id);
 }
 
+void SIM_mass_spring_set_solver_mode(Implicit_Data *id, int mode)
+{
+  id->solver_mode = mode;
+}
+
 /* ==== Transformation from/to root reference frames ==== */
 
 BLI_INLINE void world_to_root_v3(Implicit_Data *data, int index, float r[3], const float v[3])
@@ -945,6 +1259,83 @@ static int cg_filtered(lfVector *ldV,
          conjgrad_looplimit; /* true means we reached desired accuracy in given time - ie stable */
 }
 
+/**
+ * Same algorithm as #cg_filtered, using the block rows of A in data->csr.
+ * Vector operations of each iteration are merged into three passes over the vertices,
+ * which run in parallel.
+ */
+static int cg_filtered_block(Implicit_Data *id, bool use_precond, ImplicitSolverResult *result)
+{
+  /* Solves for unknown X in equation AX=B */
+  unsigned int conjgrad_loopcount = 0, conjgrad_looplimit = 100;
+  float conjgrad_epsilon = 0.01f;
+
+  unsigned int numverts = id->A[0].vcount;
+  BlockCSRMatrix *csr = &id->csr;
+  const unsigned int chunks_len = bcsr_chunks_len(csr);
+  float bnorm2, delta_new, delta_old, delta_target;
+
+  BlockSolverTaskData data = {
+      .csr = csr,
+      .S = id->S,
+      .Pinv = id->Pinv,
+      .B = id->B,
+      .dV = id->dV,
+      .use_precond = use_precond,
+  };
+  data.fB = create_lfvector(numverts);
+  data.AdV = create_lfvector(numverts);
+  data.r = create_lfvector(numverts);
+  data.c = create_lfvector(numverts);
+  data.q = create_lfvector(numverts);
+  data.s = create_lfvector(numverts);
+  data.partial = MEM_malloc_arrayN(chunks_len, sizeof(float), __func__);
+  data.partial_b = MEM_malloc_arrayN(chunks_len, sizeof(float), __func__);
+
+  cp_lfvector(id->dV, id->z, numverts);
+
+  mul_bcsrmatrix_lfvector(data.AdV, csr, id->dV);
+
+  bcsr_solver_task_run(&data, bcsr_cg_init_cb);
+  delta_new = bcsr_partial_sum(csr, data.partial);
+  bnorm2 = bcsr_partial_sum(csr, data.partial_b);
+  delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
+
+  while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
+    /* q = filter(A * c) */
+    data.in = data.c;
+    data.out = data.q;
+    bcsr_solver_task_run(&data, bcsr_mul_lfvector_cb);
+
+    data.alpha = delta_new / bcsr_partial_sum(csr, data.partial);
+
+    bcsr_solver_task_run(&data, bcsr_cg_update_cb);
+    delta_old = delta_new;
+    delta_new = bcsr_partial_sum(csr, data.partial);
+
+    data.beta = delta_new / delta_old;
+    bcsr_solver_task_run(&data, bcsr_cg_direction_cb);
+
+    conjgrad_loopcount++;
+  }
+
+  del_lfvector(data.fB);
+  del_lfvector(data.AdV);
+  del_lfvector(data.r);
+  del_lfvector(data.c);
+  del_lfvector(data.q);
+  del_lfvector(data.s);
+  MEM_freeN(data.partial);
+  MEM_freeN(data.partial_b);
+
+  result->status = conjgrad_loopcount < conjgrad_looplimit ? SIM_SOLVER_SUCCESS :
+                                                             SIM_SOLVER_NO_CONVERGENCE;
+  result->iterations = conjgrad_loopcount;
+  result->error = bnorm2 > 0.0f ? sqrtf(delta_new / bnorm2) : 0.0f;
+
+  return conjgrad_loopcount < conjgrad_looplimit;
+}
+
 #  if 0
 /* block diagonalizer */
 DO_INLINE void BuildPPinv(fmatrix3x3 *lA, fmatrix3x3 *P, fmatrix3x3 *Pinv)
@@ -1158,11 +1549,21 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
   lfVector *dFdXmV = create_lfvector(numverts);
   zero_lfvector(data->dV, numverts);
 
+  const bool use_block_solver = ELEM(
+      data->solver_mode, CLOTH_SOLVER_BLOCK_CG, CLOTH_SOLVER_BLOCK_PCG);
+
   cp_bfmatrix(data->A, data->M);
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  if (use_block_solver) {
+    build_bcsrmatrix(&data->csr, data->A, data->num_blocks);
+    gather_bcsrmatrix(&data->csr, data->dFdX);
+    mul_bcsrmatrix_lfvector(dFdXmV, &data->csr, data->V);
+  }
+  else {
+    mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  }
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1171,7 +1572,13 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  if (use_block_solver) {
+    gather_bcsrmatrix(&data->csr, data->A);
+    cg_filtered_block(data, data->solver_mode == CLOTH_SOLVER_BLOCK_PCG, result);
+  }
+  else {
+    cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  }
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
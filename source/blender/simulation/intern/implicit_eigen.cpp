@@ -483,6 +483,11 @@ int SIM_mass_spring_solver_numvert(Implicit_Data *id)
   }
 }
 
+void SIM_mass_spring_set_solver_mode(Implicit_Data *UNUSED(id), int UNUSED(mode))
+{
+  /* Eigen solver has a single mode. */
+}
+
 /* ==== Transformation from/to root reference frames ==== */
 
 BLI_INLINE void world_to_root_v3(Implicit_Data *data, int index, float r[3], const float v[3])
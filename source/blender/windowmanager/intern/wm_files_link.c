@@ -56,6 +56,7 @@
 #include "BKE_lib_override.h"
 #include "BKE_lib_remap.h"
 #include "BKE_main.h"
+#include "BKE_main_namemap.h"
 #include "BKE_report.h"
 
 #include "BKE_idtype.h"
@@ -786,6 +787,7 @@ static void lib_relocate_do_remap(Main *bmain,
     }
 
     id_sort_by_name(which_libbase(bmain, GS(old_id->name)), old_id, NULL);
+    BKE_main_namemap_clear(bmain);
 
     BKE_reportf(
         reports,
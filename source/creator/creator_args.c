@@ -620,6 +620,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--app-template");
   BLI_argsPrintArgDoc(ba, "--factory-startup");
   BLI_argsPrintArgDoc(ba, "--enable-event-simulate");
+  BLI_argsPrintArgDoc(ba, "--enable-memory-pool");
   printf("\n");
   BLI_argsPrintArgDoc(ba, "--env-system-datafiles");
   BLI_argsPrintArgDoc(ba, "--env-system-scripts");
@@ -1150,6 +1151,17 @@ static int arg_handle_enable_event_simulate(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_enable_memory_pool_doc[] =
+    "\n\t"
+    "Serve small memory allocations from per-thread pools (ignored with '--debug-memory').";
+static int arg_handle_enable_memory_pool(int UNUSED(argc),
+                                         const char **UNUSED(argv),
+                                         void *UNUSED(data))
+{
+  MEM_use_small_object_pool(true);
+  return 0;
+}
+
 static const char arg_handle_env_system_set_doc_datafiles[] =
     "\n\t"
     "Set the " STRINGIFY_ARG(BLENDER_SYSTEM_DATAFILES) " environment variable.";
@@ -2240,6 +2252,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_argsAdd(ba, NULL, "--app-template", CB(arg_handle_app_template), NULL);
   BLI_argsAdd(ba, NULL, "--factory-startup", CB(arg_handle_factory_startup_set), NULL);
   BLI_argsAdd(ba, NULL, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), NULL);
+  BLI_argsAdd(ba, NULL, "--enable-memory-pool", CB(arg_handle_enable_memory_pool), NULL);
 
   /* Pass: Custom Window Stuff. */
   BLI_argsPassSet(ba, ARG_PASS_SETTINGS_GUI);
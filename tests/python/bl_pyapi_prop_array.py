@@ -79,6 +79,68 @@ class TestPropArray(unittest.TestCase):
             self.assertEqual(v1, v2)
 
 
+class TestPropCollectionBuffer(unittest.TestCase):
+    def setUp(self):
+        self.mesh = bpy.data.meshes.new("TestPropCollectionBuffer")
+        self.mesh.vertices.add(4)
+        self.mesh.edges.add(2)
+
+    def tearDown(self):
+        bpy.data.meshes.remove(self.mesh)
+
+    def test_as_buffer_read(self):
+        co = np.arange(12, dtype=np.float32)
+        self.mesh.vertices.foreach_set("co", co)
+
+        view = self.mesh.vertices.as_buffer("co")
+        self.assertEqual(view.format, "f")
+        self.assertEqual(view.shape, (4, 3))
+        self.assertTrue(view.readonly)
+        self.assertTrue(np.array_equal(np.asarray(view).ravel(), co))
+
+        view = self.mesh.edges.as_buffer("vertices")
+        self.assertEqual(view.format, "I")
+        self.assertEqual(view.shape, (2, 2))
+
+    def test_as_buffer_write(self):
+        view = self.mesh.vertices.as_buffer("co", write=True)
+        self.assertFalse(view.readonly)
+        with view:
+            np.asarray(view)[:] = np.arange(12, dtype=np.float32).reshape(4, 3)
+
+        co = np.empty(12, dtype=np.float32)
+        self.mesh.vertices.foreach_get("co", co)
+        self.assertTrue(np.array_equal(co, np.arange(12, dtype=np.float32)))
+        self.assertEqual(tuple(self.mesh.vertices[3].co), (9.0, 10.0, 11.0))
+
+    def test_as_buffer_empty(self):
+        mesh = bpy.data.meshes.new("TestPropCollectionBufferEmpty")
+        view = mesh.vertices.as_buffer("co")
+        self.assertEqual(view.shape, (0, 3))
+        self.assertEqual(view.tobytes(), b"")
+        bpy.data.meshes.remove(mesh)
+
+    def test_as_buffer_errors(self):
+        with self.assertRaises(AttributeError):
+            self.mesh.vertices.as_buffer("not_an_attribute")
+
+        # Not stored in a contiguous array.
+        with self.assertRaises(TypeError):
+            bpy.data.meshes.as_buffer("name")
+
+        # Stored as a bit-flag.
+        with self.assertRaises(TypeError):
+            self.mesh.vertices.as_buffer("select")
+
+        # Read-only attribute.
+        self.mesh.polygons.add(1)
+        self.mesh.loops.add(3)
+        self.mesh.polygons[0].loop_total = 3
+        self.mesh.calc_loop_triangles()
+        with self.assertRaises(AttributeError):
+            self.mesh.loop_triangles.as_buffer("loops")
+
+
 if __name__ == '__main__':
     import sys
     sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])